@@ -40,6 +40,7 @@
     Paper           *pSelf;         // Paper piece that owns the instance
     Paper           *pTarget1;      // Target for seek, flee, etc
     Paper           *pTarget2;
+    int             targetRetirements;  // pTarget1's retirements when it was set
     
     int             iFlags;         // holds flags that determine behavior
 
@@ -133,6 +134,7 @@
 
 
 - (id)initBehavior;
+- (void)resetBehavior;
 
 - (BOOL)isOn:(BehaviorType)bt;
 - (void)turnOn:(BehaviorType)bt;
@@ -53,6 +53,28 @@
     return self;
 }
 
+// Back to how initBehavior left it, for a piece coming back out of its pool
+- (void)resetBehavior {
+    [vel zero];
+    [vRunning zero];
+    vTarget = nil;
+    idTarget = 0;
+    pTarget1 = nil;
+    pTarget2 = nil;
+    [timers removeAllObjects];
+    
+    iFlags = 0;
+    flip = 1;
+    rotateAngle = 0.0;
+    rotateAngleMemory = 0.0;
+    sinkAngleInterval = 0.0;
+    spawnCountCheck = 0;
+    
+    weightSeparation = 1.0;
+    weightAlignment = 0.5;
+    weightCohesion = 0.1;
+}
+
 - (BOOL)isOn:(BehaviorType)bt       { return ((iFlags & bt) == bt); }
 - (void)turnOn:(BehaviorType)bt     { if (![self isOn:bt]) { iFlags |= bt; } }
 
@@ -110,6 +132,12 @@
 
 - (void)setTarget:(Paper*)pTarget {
     pTarget1 = pTarget;
+    targetRetirements = (pTarget) ? pTarget->retirements : 0;
+}
+
+// a target that has since gone back to its pool isn't one any more
+- (BOOL)hasTarget {
+    return ((pTarget1 != nil) && (pTarget1->retirements == targetRetirements));
 }
 
 - (void)addTimer:(Timer *)objTimer forBehavior:(BehaviorType)bt {
@@ -272,7 +300,7 @@ else {
     // FORCE PROCESSING
     
     // ___ FLEE
-    if (([self isOn:btFlee]) && (pTarget1 != nil)) {
+    if (([self isOn:btFlee]) && ([self hasTarget])) {
         
         Vector2D *targetPos = [[Vector2D alloc] init];
         targetPos = [targetPos initWithX:pTarget1.center.x Y:pTarget1.center.y];
@@ -441,12 +469,12 @@ else {
             [vel zero];
             
             // randomly choose a velocity
-            CGFloat randVel = RAND_NUM(rVelMax, rVelMin);
+            CGFloat randVel = SimRandomNextRange(&pSelf->random, rVelMax, rVelMin);
             if (!pSelf.isAnimating) { [pSelf startAnimating]; }
             
             // randomly choose a direction and apply to vel based on flipX
             int rDir = 1;
-            if (RAND_NUM(0.0,1.0) > 0.5) { rDir = -1; }
+            if (SimRandomNextFloat(&pSelf->random) > 0.5) { rDir = -1; }
             pSelf.dir = rDir;
             
             // determine new force
@@ -454,7 +482,7 @@ else {
             else         { vel.y = randVel * rDir; }
             
             // randomize the interval
-            [fTimer randomizeInterval];
+            [fTimer randomizeInterval:&pSelf->random];
         }
         
         // adjust for accelerometer
@@ -652,7 +680,7 @@ else {
     }
 
     // ___ SEEK
-    if (([self isOn:btSeek]) && (pTarget1 != nil)) {
+    if (([self isOn:btSeek]) && ([self hasTarget])) {
         newForce = [newForce initWithX:pTarget1.center.x Y:pTarget1.center.y];
         fTimer = [timers objectForKey:[NSNumber numberWithInt:btSeek]];
         
@@ -750,7 +778,7 @@ else {
                 [world turnOffState:osCleaning];
             }
             [fTimer timerReset];
-            [fTimer randomizeInterval];
+            [fTimer randomizeInterval:&pSelf->random];
             [fTimer turnTimerOff];
             
         }
@@ -789,10 +817,10 @@ else {
                 { vRunning.x = xSpawnOffset + world.viewWidth; }
                 
                 if (fObjID == 28) {  // DIVER should stay near the top
-                    vRunning.y = (arc4random() % (150-ySpawnOffset)) + ySpawnOffset;
+                    vRunning.y = (SimRandomNext(&pSelf->random) % (150-ySpawnOffset)) + ySpawnOffset;
                 }
                 else {
-                    vRunning.y = (arc4random() % (world.viewHeight-(ySpawnOffset*2))) + ySpawnOffset;
+                    vRunning.y = (SimRandomNext(&pSelf->random) % (world.viewHeight-(ySpawnOffset*2))) + ySpawnOffset;
                 }
             }
             else {
@@ -802,20 +830,20 @@ else {
                 }
                 else
                 { vRunning.y = ySpawnOffset + world.viewHeight; }
-                vRunning.x = (arc4random() % (world.viewWidth-(xSpawnOffset*2))) + xSpawnOffset;
+                vRunning.x = (SimRandomNext(&pSelf->random) % (world.viewWidth-(xSpawnOffset*2))) + xSpawnOffset;
             }
             
             // if path is angled, create new velocity and rotate angle
             if (angledPath) {
                 int bAngle = 1;
-                if (RAND_NUM(0.0,1.0) > 0.5) { bAngle = -1; }
+                if (SimRandomNextFloat(&pSelf->random) > 0.5) { bAngle = -1; }
                 
                 if (flipX) {
-                    vel.y = RAND_NUM(bSeekOffset.x, bSeekOffset.y);
+                    vel.y = SimRandomNextRange(&pSelf->random, bSeekOffset.x, bSeekOffset.y);
                     pSelf.behavior.velY = vel.y * bAngle;
                 }
                 else {
-                    vel.x = RAND_NUM(bSeekOffset.x, bSeekOffset.y);
+                    vel.x = SimRandomNextRange(&pSelf->random, bSeekOffset.x, bSeekOffset.y);
                     pSelf.behavior.velX = vel.x * bAngle;
                 }
             }
@@ -883,7 +911,7 @@ else {
             }
             
             int ySpawnOffset = world.borderWidth + (2 * pSelf.halfSize.y);
-            vRunning.y = (arc4random() % (world.viewHeight-(ySpawnOffset*2))) + ySpawnOffset;
+            vRunning.y = (SimRandomNext(&pSelf->random) % (world.viewHeight-(ySpawnOffset*2))) + ySpawnOffset;
             [vRunning sub:pos];
             
             // reset velocity
@@ -462,7 +462,9 @@
 
 - (void)stupidZPosition {
     // Move pinch objects back to the fore so they can be pinched
-    [_world changeZPosition:_world.objects_pinch toPos:1];
+    for (NSNumber *key in _world.objects_pinch) {
+        [_world changeZPosition:[_world.objects_pinch objectForKey:key] toPos:1];
+    }
 }
 
 @end
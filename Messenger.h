@@ -11,30 +11,23 @@
 //    - Turn behavior on/off
 //    - Start/stop frame animation
 //
+//  Messages are applied strictly in the order they were queued.  The
+//    queue is SimCore's lock-free ring (SimMessageQueue.h), so queueing
+//    never allocates.
+//
 
 #import <Foundation/Foundation.h>
 #import "Variables.h"
-
-
-typedef struct {
-    int             spawnID;
-    MessageType     mType;
-    BehaviorType    bType;
-    BOOL            turnOn;
-    int             targetSpawnID;
-    CGPoint         point;
-    BOOL            wasSpawned;
-} Message;
+#import "SimCore/SimMessageQueue.h"
 
 @class ObjManager;
 @class Behavior;
 
 @interface Messenger : NSObject {
 
-}
+    SimMessageRing  *queue;     // SIM_MESSAGE_CAPACITY messages between processQueue calls
 
-@property (assign) int queueID;
-@property (nonatomic, retain) NSMutableDictionary *queue;
+}
 
 + (id) theMessenger;
 
@@ -51,6 +44,6 @@ typedef struct {
             atPoint:(CGPoint)point
          wasSpawned:(BOOL)wSpawn;
 
-- (void)processQueue;
+- (void)processQueue;     // applies everything queued before the call, in order
 
 @end
@@ -49,8 +49,7 @@ static Messenger *mySharedMessenger = nil;
     self = [super init];
     if(nil != self)
     {
-        _queue = [[NSMutableDictionary alloc] init];
-        _queueID = 1;
+        queue = SimMessageRingCreate(SIM_MESSAGE_CAPACITY);
     }
     return self;
 }
@@ -91,20 +90,18 @@ static Messenger *mySharedMessenger = nil;
             atPoint:(CGPoint)point
          wasSpawned:(BOOL)wSpawn {
     
-    // create the Message struct
-    Message newMessage;
+    // create the message, then add to queue
+    SimMessagePost newMessage;
     newMessage.spawnID = spawnID;
     newMessage.mType = mType;
     newMessage.bType = bType;
     newMessage.turnOn = on;
     newMessage.targetSpawnID = targetID;
-    newMessage.point = point;
+    newMessage.x = point.x;
+    newMessage.y = point.y;
     newMessage.wasSpawned = wSpawn;
     
-    // wrap the Message struct in an NSValue object, then add to queue
-    NSValue *structValue = [NSValue value:&newMessage withObjCType:@encode(Message)];
-    [_queue setObject:structValue forKey:[NSNumber numberWithInt:_queueID]];
-    _queueID++;
+    SimMessageRingPush(queue, &newMessage);
     
     return;
 }
@@ -113,35 +110,33 @@ static Messenger *mySharedMessenger = nil;
     
     ObjManager *world = [ObjManager theWorld];
     
-    for (NSNumber *key in _queue) {
-        
-        NSValue *keyValue = [_queue objectForKey:key];
-        
-        // unwrap NSValue to Message
-        Message theMessage;
-        [keyValue getValue:&theMessage];
+    // messages queued while these are applied wait for the next call
+    size_t last = SimMessageRingPosted(queue);
+    SimMessagePost theMessage;
+    
+    while ((SimMessageRingTaken(queue) < last) && (SimMessageRingPop(queue, &theMessage))) {
         
         int msSpawnID   = theMessage.spawnID;
         int msTargetID  = theMessage.targetSpawnID;
-        CGPoint msPoint = theMessage.point;
-        BOOL msSpawned  = theMessage.wasSpawned;
+        CGPoint msPoint = CGPointMake(theMessage.x, theMessage.y);
+        BOOL msSpawned  = theMessage.wasSpawned ? YES : NO;
         
         // get Paper object for message
-        Paper *mPaper;
+        Paper *mPaper = nil;
         if (msSpawnID > 0) { mPaper = [world getObject:msSpawnID]; }
         
         // apply message
         
-        switch (theMessage.mType) {
+        switch ((MessageType)theMessage.mType) {
             
             // turning on / off behaviors
             case mtBehavior:
                 if (theMessage.turnOn) {
-                    [mPaper.behavior turnOn:theMessage.bType withTarget:msTargetID];
+                    [mPaper.behavior turnOn:(BehaviorType)theMessage.bType withTarget:msTargetID];
                 }
                 else {
                     // turn off
-                    [mPaper.behavior turnOff:theMessage.bType];
+                    [mPaper.behavior turnOff:(BehaviorType)theMessage.bType];
                 }
                 break;
                 
@@ -188,9 +183,6 @@ static Messenger *mySharedMessenger = nil;
         }
         
     }
-    
-    // empty the queue when all messages are processed
-    [_queue removeAllObjects];
 
 }
 
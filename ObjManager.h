@@ -14,12 +14,14 @@
 #import <AudioToolbox/AudioServices.h>
 #import <AVFoundation/AVAudioPlayer.h>
 #import "Variables.h"
+#import "SimCore/SimViewLayers.h"
 
 @class Paper;
 @class PaperPath;
 @class Border;
 @class Timer;
 @class Messenger;
+@class SceneFile;
 
 @interface ObjManager : NSObject < AVAudioPlayerDelegate >  {
     NSMutableDictionary *objects;       // dictionary of Paper objects
@@ -30,11 +32,18 @@
     NSMutableDictionary *objects_wiggle;
     NSMutableDictionary *objects_sounds;
     NSMutableDictionary *objects_sounds_splash;
-    NSMutableDictionary *queue_view;
+    NSMutableArray      *queue_view;        // pieces to add as subviews, in the order they came
+    SimLayerList        *viewLayers;        // the subviews, back to front, by their viewSlot
+    NSMutableIndexSet   *freeViewSlots;     // viewSlots given back by removed pieces
+    int                 viewSlotCount;      // viewSlots handed out so far
     NSMutableDictionary *world_timers;       // world-level timers
     
     NSMutableArray      *queue_shake;
     NSMutableArray      *queue_clean;
+    NSMutableArray      *queue_destroy;     // pieces flagged for removal this frame
+    
+    NSMutableDictionary *paperPools;        // retired pieces by objID, handed back out by its next spawns
+    NSMutableIndexSet   *spawnRows;         // property rows that can spawn after the scene loads
     
     UIAccelerometer     *accel;
     CGFloat             accelX;
@@ -45,6 +54,7 @@
     
     int                 spawnID;        // counter for spawned object IDs
     int                 timerID;        // counter for timer objects
+    uint64_t            pieceStreams;   // random streams handed out, one per piece built
     Border              *border;        // view border
     int                 borderWidth;    // border width
     int                 borderBound;    // border bounds
@@ -78,10 +88,11 @@
 @property (nonatomic, retain) AVAudioPlayer *bg_audio01;
 @property (nonatomic, retain) AVAudioPlayer *bg_audio02;
 
-@property (nonatomic, retain) NSMutableDictionary *queue_view;
+@property (nonatomic, retain) NSMutableArray      *queue_view;
 @property (nonatomic, retain) NSMutableDictionary *world_timers;
 @property (nonatomic, retain) NSMutableArray      *queue_shake;
 @property (nonatomic, retain) NSMutableArray      *queue_clean;
+@property (nonatomic, retain) NSMutableArray      *queue_destroy;
 
 @property (nonatomic, strong) Messenger *messenger;
 
@@ -116,6 +127,7 @@
 @property (assign) PaperRandom *objRandom;                  // holds PaperRandom from menu selection
 @property (assign) PaperPropsSounds *objSounds;             // holds PaperPropsSounds from menu selection
 @property (assign) PaperWorldTimers *objTimers;             // holds PaperWorldTimers from menu selection
+@property (nonatomic, strong) SceneFile *scene;             // story from a .pcs file, nil = the tables above
 
 @property (assign) BOOL optInteract;
 @property (assign) BOOL optSound;
@@ -127,9 +139,29 @@
 - (ObjManager*) initWithBlank;                                      // setup blank array of Papers
 - (void) initBorder;                                                // create border
 - (void) initScene;                                                 // create all Paper objects
+- (Paper*) buildSceneRow:(int)row;                                  // initScene for one property row, the Paper if it made one
+- (void) markSpawnRows;                                             // finds the rows a scene can spawn after it loads
+- (BOOL) isSpawnRow:(int)row;
+- (void) prewarmPool:(int)row;                                      // builds a spawn row's pool up to PAPER_POOL_PREWARM
+- (void) initWorldTimers;                                           // initScene's world timers
 - (void) resetObjManager;                                           // resets ObjManager singleton on return to main menu
 - (void) resetObjProperties;                                        // resets only Property arrays
 
+// property rows of the story, from the scene file if there is one,
+//   otherwise from the compiled-in tables
+- (int) numPropsRows;
+- (int) numTouchspots;
+- (int) numWorldTimers;
+- (int) numSounds;
+- (PaperProps) propsRow:(int)row;
+- (PaperProps) propsForObjID:(int)objID;
+- (PaperPropsAnim) animForProps:(PaperProps)prp;
+- (PaperPropsTouchspot) touchRow:(int)tsID;
+- (PaperGroups) groupRow:(int)groupID;
+- (PaperRandom) randomRow:(int)row;
+- (PaperPropsSounds) soundRow:(int)row;
+- (PaperWorldTimers) timerRow:(int)row;
+
 - (void) loadSounds;
 - (void) playSound:(int)sID;
 - (void) playSound:(int)sID atVolume:(CGFloat)vol;
@@ -147,6 +179,7 @@
 
 - (void) addToView:(Paper *)paperPiece;
 - (void) addToCleanQueue:(int)objID;
+- (void) addToDestroyQueue:(Paper *)paperPiece;
 
 - (void) addWorldTimer:(Timer *)objTimer forType:(WorldTimer)wt;    // adds a world timer to the ObjManager
 - (void) updateWorldTimers:(CGFloat)interval;                       // updates all active world timers
@@ -169,6 +202,7 @@
 - (void) updateGroup:(Paper *)mstrPiece                             // this one includes a specific transform (like scale)
            transform:(CGAffineTransform)mstrTransform;              
 
+- (SimRandomStream) newPieceStream;                                 // the next piece's own random stream, in build order
 - (Paper*) spawnPiece:(Paper *)touchedPiece isChild:(BOOL)child;    // spawning a child object
 - (Paper*) spawnPiece:(Paper *)touchedPiece objID:(int)childImage isChild:(BOOL)child;    // spawning based on Paper child/touchspot
 - (Paper*) spawnPiece:(int)objID;                                   // spawning based on Object ID
@@ -181,7 +215,9 @@
 - (BOOL) maxObjectsReached;             // have the maximum allowed # of objects been reached?
 
 - (void) tagNeighbors:(Paper*)piece ofQueue:(NSMutableArray*)queue;         // used for flocking, who is close to the object?
-- (void) changeZPosition:(NSMutableDictionary *)objDict toPos:(int)zPos;    // changes the z position for an object
+- (void) changeZPosition:(Paper *)paperPiece toPos:(int)zPos;              // changes the z position for an object
+- (NSArray*) layerViews:(NSArray *)pieces;                                 // links pieces into the view layers, the ones that went in front to back
+- (Paper*) pieceAbove:(Paper *)paperPiece;                                 // next subview up in the view layers, nil = top-most
 
 - (void) pauseAnimations;                                           // pauses update & saves all animation states
 - (void) resumeAnimations;                                          // resumes update & restores all animation states
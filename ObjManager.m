@@ -17,6 +17,7 @@
 #import "Messenger.h"
 #import "Behavior.h"
 #import "Timer.h"
+#import "SceneFile.h"
 
 static ObjManager *mySharedWorld = nil;
 
@@ -24,7 +25,7 @@ static ObjManager *mySharedWorld = nil;
 
 @synthesize objects, objects_coll, objects_pinch, objects_shake, objects_neighbors, objects_wiggle;
 @synthesize objects_sounds, objects_sounds_splash;
-@synthesize queue_shake, queue_clean, queue_view, accel, accelX, osFlags, world_timers;
+@synthesize queue_shake, queue_clean, queue_destroy, queue_view, accel, accelX, osFlags, world_timers;
 @synthesize spawnID, timerID, border, borderWidth, borderBound, viewWidth, viewHeight;
 @synthesize fps, bounceOffset, gravityFilter, elapsedTime, cleanMin, cleanMax;
 @synthesize maxNotes, numObjects;
@@ -64,13 +65,20 @@ static ObjManager *mySharedWorld = nil;
         objects_wiggle = [[NSMutableDictionary alloc] init];
         objects_sounds = [[NSMutableDictionary alloc] init];
         objects_sounds_splash = [[NSMutableDictionary alloc] init];
-        queue_view = [[NSMutableDictionary alloc] init];
+        queue_view = [[NSMutableArray alloc] init];
+        viewLayers = SimLayerListCreate();
+        freeViewSlots = [[NSMutableIndexSet alloc] init];
+        viewSlotCount = 0;
         queue_shake = [[NSMutableArray alloc] init];
         queue_clean = [[NSMutableArray alloc] init];
+        queue_destroy = [[NSMutableArray alloc] init];
+        paperPools = [[NSMutableDictionary alloc] init];
+        spawnRows = [[NSMutableIndexSet alloc] init];
         world_timers = [[NSMutableDictionary alloc] init];
         
         spawnID = 100;  // start of counter for dynamically spawned object IDs
         timerID = 1;
+        pieceStreams = 0;
         viewWidth = 0;
         viewHeight = 0;
         cleanMin = 4;
@@ -134,9 +142,16 @@ static ObjManager *mySharedWorld = nil;
     [queue_view removeAllObjects];
     [queue_shake removeAllObjects];
     [queue_clean removeAllObjects];
+    [queue_destroy removeAllObjects];
+    [paperPools removeAllObjects];
+    [spawnRows removeAllIndexes];
     [world_timers removeAllObjects];
+    SimLayerListClear(viewLayers);
+    [freeViewSlots removeAllIndexes];
+    viewSlotCount = 0;
     spawnID = 100;  // start of counter for dynamically spawned object IDs
     timerID = 1;
+    pieceStreams = 0;
     viewWidth = 0;
     viewHeight = 0;
     cleanMin = 4;
@@ -175,25 +190,93 @@ static ObjManager *mySharedWorld = nil;
     _objRandom        = nil;
     _objSounds        = nil;
     _objTimers        = nil;
+    _scene            = nil;
     
     //NSLog(@"Reset ObjM Props");
     
 }
 
+// ________________ PROPERTY ROWS
+
+// row counts, the compiled-in tables keep theirs in row 0
+- (int) numPropsRows {
+    if (_scene) { return [_scene numRows:scProps]; }
+    return _objProps[0].bobAmp + 1;         // bobAmp in border row is # of objects in table
+}
+
+- (int) numTouchspots {
+    if (_scene) { return [_scene numRows:scTouch] - 1; }
+    return _objTouchProps[0].objID;
+}
+
+- (int) numWorldTimers {
+    if (_scene) { return [_scene numRows:scTimers] - 1; }
+    return _objTimers[0].objTargetID;
+}
+
+- (int) numSounds {
+    if (_scene) { return [_scene numRows:scSounds] - 1; }
+    return _objSounds[0].soundID;
+}
+
+- (PaperProps) propsRow:(int)row {
+    if (_scene) { return [_scene propsRow:row]; }
+    return _objProps[row];
+}
+
+// the scene file maps objIDs to rows, the compiled-in tables are indexed by objID
+- (PaperProps) propsForObjID:(int)objID {
+    if (_scene) { return [_scene propsRow:[_scene rowForObjID:objID]]; }
+    return _objProps[objID];
+}
+
+// animID is a repeat count or -1 for some pieces, those get the default row
+- (PaperPropsAnim) animForProps:(PaperProps)prp {
+    int animID = (prp.animID > 0) ? prp.animID : 0;
+    if (_scene) { return [_scene animRow:animID]; }
+    return _objAnimProps[animID];
+}
+
+- (PaperPropsTouchspot) touchRow:(int)tsID {
+    if (_scene) { return [_scene touchRow:tsID]; }
+    return _objTouchProps[tsID];
+}
+
+- (PaperGroups) groupRow:(int)groupID {
+    if (_scene) { return [_scene groupsRow:groupID]; }
+    return _objGroups[groupID];
+}
+
+- (PaperRandom) randomRow:(int)row {
+    if (_scene) { return [_scene randomRow:row]; }
+    return _objRandom[row];
+}
+
+- (PaperPropsSounds) soundRow:(int)row {
+    if (_scene) { return [_scene soundsRow:row]; }
+    return _objSounds[row];
+}
+
+- (PaperWorldTimers) timerRow:(int)row {
+    if (_scene) { return [_scene timersRow:row]; }
+    return _objTimers[row];
+}
+
 - (void) loadSounds {
     
     NSString *soundFilePath;
     NSURL *fileURL;
     
     // get # of sounds in the array
-    int i = _objSounds[0].soundID;
+    int i = [self numSounds];
     
     for (int j=1; j<=i; j++) {
-        soundFilePath = [[NSBundle mainBundle] pathForResource: [NSString stringWithFormat:@"%s", _objSounds[j].soundPath]
-                                                        ofType: [NSString stringWithFormat:@"%s", _objSounds[j].fileType]];
+        PaperPropsSounds prpSound = [self soundRow:j];
+        soundFilePath = [[NSBundle mainBundle] pathForResource: [NSString stringWithFormat:@"%s", prpSound.soundPath]
+                                                        ofType: [NSString stringWithFormat:@"%s", prpSound.fileType]];
         fileURL = [[NSURL alloc] initFileURLWithPath: soundFilePath];
         
-        [objects_sounds setObject:fileURL forKey:[NSNumber numberWithInt:_objSounds[j].soundID]];
+        [objects_sounds setObject:fileURL forKey:[NSNumber numberWithInt:prpSound.soundID]];
     }
     
 }
@@ -292,8 +375,11 @@ static ObjManager *mySharedWorld = nil;
 - (void)turnOffAllStates { osFlags = 0; }
 
 - (void) addToView:(Paper *)paperPiece  {
-    // this queue adds objects to the view controller after message processing
-    [queue_view setObject:paperPiece forKey:[NSNumber numberWithInt:paperPiece.spawnID]];
+    // this queue adds objects to the view controller at the end of the main loop,
+    //   everything spawned in a frame goes in together
+    if ([queue_view indexOfObjectIdenticalTo:paperPiece] == NSNotFound) {
+        [queue_view addObject:paperPiece];
+    }
 }
 
 - (void) addToShakeQueue:(int)objID {
@@ -307,6 +393,12 @@ static ObjManager *mySharedWorld = nil;
     [queue_clean addObject:[NSNumber numberWithInt:objID]];
 }
 
+- (void) addToDestroyQueue:(Paper *)paperPiece {
+    // this queue holds every piece flagged for removal during the main loop,
+    //   they're all removed together once it's done enumerating
+    [queue_destroy addObject:paperPiece];
+}
+
 - (void) addWorldTimer:(Timer *)objTimer forType:(WorldTimer)wt {
     [world_timers setObject:objTimer forKey:[NSNumber numberWithInt:wt]];
 }
@@ -364,7 +456,7 @@ static ObjManager *mySharedWorld = nil;
                     
             }
             
-            [wTimer randomizeInterval];
+            [wTimer randomizeInterval:SimRandomShared()];
             [wTimer timerReset];
             
         }
@@ -405,18 +497,48 @@ static ObjManager *mySharedWorld = nil;
     if (paperPiece.objLimit) {
         if (numObjects > 0) { numObjects--; }
     }
-    [objects removeObjectForKey:[NSNumber numberWithInt:paperPiece.spawnID]];
+    NSNumber *delID = [NSNumber numberWithInt:paperPiece.spawnID];
+    [objects removeObjectForKey:delID];
+    
+    // and from the other managers, unless its spawnID has gone to a newer piece
+    if ([objects_coll objectForKey:delID] == paperPiece)    { [objects_coll removeObjectForKey:delID]; }
+    if ([objects_pinch objectForKey:delID] == paperPiece)   { [objects_pinch removeObjectForKey:delID]; }
+    if ([objects_wiggle objectForKey:delID] == paperPiece)  { [objects_wiggle removeObjectForKey:delID]; }
+    [queue_view removeObjectIdenticalTo:paperPiece];
+    
+    // its viewSlot goes to the next piece shown
+    if (paperPiece.viewSlot >= 0) {
+        SimLayerListRemove(viewLayers, paperPiece.viewSlot);
+        [freeViewSlots addIndex:paperPiece.viewSlot];
+        paperPiece.viewSlot = -1;
+    }
+    
+    // the piece waits in its objID's pool for the next spawn of it
+    [paperPiece retire];
+    NSMutableArray *pool = [self poolForObjID:paperPiece.objID];
+    if (pool.count < PAPER_POOL_CAP) { [pool addObject:paperPiece]; }
+}
+
+- (NSMutableArray*) poolForObjID:(int)objID {
+    NSNumber *poolID = [NSNumber numberWithInt:objID];
+    NSMutableArray *pool = [paperPools objectForKey:poolID];
+    if (!pool) {
+        pool = [[NSMutableArray alloc] initWithCapacity:PAPER_POOL_PREWARM];
+        [paperPools setObject:pool forKey:poolID];
+    }
+    return pool;
 }
 
 - (void) initBorder {
     
     border = [[Border alloc] initWithFrame:CGRectMake(0, 0, 768, 1024) ];
-    [border initProps:_objProps[0]];
+    PaperProps prpBorder = [self propsRow:0];
+    [border initProps:prpBorder];
     border.backgroundColor = [UIColor clearColor];
     
     // set manager border properties
-    borderWidth = _objProps[0].spawnX;
-    borderBound = _objProps[0].spawnY;
+    borderWidth = prpBorder.spawnX;
+    borderBound = prpBorder.spawnY;
     
     return;
 }
@@ -426,50 +548,124 @@ static ObjManager *mySharedWorld = nil;
     
     [self turnOffState:osPaused];
     
-    // create temp objects
-    Paper       *tPaper;
-    
     // loop through each property record, create each Paper piece and add it to the manager
     //   the first row (index = 0) is always the border row, so start at index = 1
     
-    int totalPieces = _objProps[0].bobAmp;        // bobAmp in border row is # of objects in table
+    int totalRows = [self numPropsRows];
+    
+    [self markSpawnRows];
+    
+	for (int i = 1; i < totalRows; i++) {
+        [self buildSceneRow:i];
+    }
+    
+    [self initWorldTimers];
     
-	for (unsigned int i = 1; i <= totalPieces; i++) {
-        // if the piece should appear upon view initialization,
-        //    then initialize and add to manager
-        if (_objProps[i].init) {
+    return;
+}
 
-            tPaper = [[Paper alloc] initWithProps:_objProps[i]
-                                        AnimProps:_objAnimProps[_objProps[i].animID]
-                                       TouchProps:_objTouchProps[_objProps[i].tsID]
-                                           Parent:nil];
-            [self addObj:tPaper wasSpawned:NO];
+// One property record of initScene, returns the Paper if the piece appears
+//   when the scene loads, so loadPapercut can build the scene a row at a time
+- (Paper*) buildSceneRow:(int)row {
+    
+    PaperProps prp = [self propsRow:row];
+    Paper *tPaper = nil;
+    
+    // if the piece should appear upon view initialization,
+    //    then initialize and add to manager
+    if (prp.init) {
+        tPaper = [self paperFromProps:prp Parent:nil];
+        [self addObj:tPaper wasSpawned:NO];
+    }
+    
+    // add objID to queue_shake if necessary
+    if (prp.spawnByShake) {
+        [self addToShakeQueue:prp.objID];
+    }
+    
+    [self prewarmPool:row];
+    
+    return tPaper;
+}
 
-        }
-        
-        // add objID to queue_shake if necessary
-        if (_objProps[i].spawnByShake) {
-            [self addToShakeQueue:_objProps[i].objID];
-        }
-        
+// Rows that can come in after the scene loads: the ones that don't load with
+//   it, and any the tables spawn as children, from touchspots and the random
+//   rows they pick from, or from world timers, same as SimWorld::prewarmPools
+- (void) markSpawnRows {
+    
+    // spawned by name in the code rather than through the tables: the
+    //   squid's and diver's bubbles (Paper frameAnimComplete) and the cleaning fish
+    static const int codeSpawns[] = { 6, 9, 25, 39, 46 };
+    
+    [spawnRows removeAllIndexes];
+    
+    int totalRows = [self numPropsRows];
+    for (int i = 1; i < totalRows; i++) {
+        PaperProps prp = [self propsRow:i];
+        if (!prp.init) { [self markSpawnObjID:prp.objID]; }
+        [self markSpawnObjID:prp.childImage];
+    }
+    // row 2 in objRandom is the random object row for the world touchspots
+    [self markRandomRow:2];
+    for (int i = 1; i <= [self numTouchspots]; i++) {
+        PaperPropsTouchspot tsRow = [self touchRow:i];
+        if (tsRow.random)   { [self markRandomRow:tsRow.objID]; }
+        else                { [self markSpawnObjID:tsRow.objID]; }
+    }
+    for (int i = 1; i <= [self numWorldTimers]; i++) {
+        [self markSpawnObjID:[self timerRow:i].objTargetID];
     }
+    for (size_t i = 0; i < sizeof(codeSpawns) / sizeof(codeSpawns[0]); i++) {
+        [self markSpawnObjID:codeSpawns[i]];
+    }
+}
+
+- (void) markSpawnObjID:(int)objID {
+    int totalRows = [self numPropsRows];
+    for (int i = 1; (objID > 0) && (i < totalRows); i++) {
+        if ([self propsRow:i].objID == objID) { [spawnRows addIndex:i]; return; }
+    }
+}
+
+- (void) markRandomRow:(int)row {
+    PaperRandom rRow = [self randomRow:row];
+    [self markSpawnObjID:rRow.rObjID01];
+    [self markSpawnObjID:rRow.rObjID02];
+    [self markSpawnObjID:rRow.rObjID03];
+    [self markSpawnObjID:rRow.rObjID04];
+    [self markSpawnObjID:rRow.rObjID05];
+}
+
+- (BOOL) isSpawnRow:(int)row { return [spawnRows containsIndex:row]; }
+
+// Builds the pieces ahead, they only take a random stream when they're spawned
+- (void) prewarmPool:(int)row {
+    
+    if (![self isSpawnRow:row]) { return; }
+    
+    PaperProps prp = [self propsRow:row];
+    NSMutableArray *pool = [self poolForObjID:prp.objID];
+    while (pool.count < PAPER_POOL_PREWARM) {
+        [pool addObject:[[Paper alloc] initForProps:prp]];
+    }
+}
+
+- (void) initWorldTimers {
     
-    // create world timers
-    int totalTimers = _objTimers[0].objTargetID;
+    int totalTimers = [self numWorldTimers];
     
-    for (unsigned int i = 1; i <= totalTimers; i++) {
-        WorldTimer timerType = _objTimers[i].wTimer;
+    for (int i = 1; i <= totalTimers; i++) {
+        PaperWorldTimers prpTimer = [self timerRow:i];
+        WorldTimer timerType = prpTimer.wTimer;
         Timer *wTimer = [[Timer alloc] initWorldTimer:timerType
-                                         worldMessage:_objTimers[i].mType
-                                          worldTarget:_objTimers[i].objTargetID
-                                         withInterval:_objTimers[i].wtInterval
-                                      withIntervalMax:_objTimers[i].wtIntervalMax
-                                      withIntervalMin:_objTimers[i].wtIntervalMin];
+                                         worldMessage:prpTimer.mType
+                                          worldTarget:prpTimer.objTargetID
+                                         withInterval:prpTimer.wtInterval
+                                      withIntervalMax:prpTimer.wtIntervalMax
+                                      withIntervalMin:prpTimer.wtIntervalMin];
         [self addWorldTimer:wTimer forType:timerType];
         [self turnWorldTimer:timerType toOn:YES];
     }
-    
-    return;
 }
 
 // Check if an object was touched by the user
@@ -738,7 +934,7 @@ static ObjManager *mySharedWorld = nil;
     // setup variables
     Paper *gPaper;
     CGPoint gPaperCenter;
-    PaperGroups gGrp = _objGroups[mstrPiece.groupID];
+    PaperGroups gGrp = [self groupRow:mstrPiece.groupID];
     int i = gGrp.numSubs;
     CGFloat mstrTransSX, mstrTransSY;
 
@@ -781,6 +977,34 @@ static ObjManager *mySharedWorld = nil;
     }
 }
 
+// Numbered the same as SimWorld's, so a piece draws what its SimPaper twin would
+- (SimRandomStream)newPieceStream {
+    return SimRandomStreamFor(pieceStreams++);
+}
+
+// Builds a Paper from its property row, with the animation and touchspot rows it refers to,
+//   in a retired piece of the same objID if its pool has one
+- (Paper*)paperFromProps:(PaperProps)prp Parent:(Paper *)parentPiece {
+    
+    NSMutableArray *pool = [paperPools objectForKey:[NSNumber numberWithInt:prp.objID]];
+    Paper *pooled = [pool lastObject];
+    if (pooled) {
+        [pool removeLastObject];
+        [pooled resetWithProps:prp
+                     AnimProps:[self animForProps:prp]
+                    TouchProps:[self touchRow:prp.tsID]
+                        Parent:parentPiece
+                        Stream:[self newPieceStream]];
+        return pooled;
+    }
+    
+    return [[Paper alloc] initWithProps:prp
+                              AnimProps:[self animForProps:prp]
+                             TouchProps:[self touchRow:prp.tsID]
+                                 Parent:parentPiece
+                                 Stream:[self newPieceStream]];
+}
+
 // Spawning new Paper objects due to user input
 - (Paper*)spawnPiece:(Paper *)touchedPiece isChild:(BOOL)child {
     Paper *sPaper;
@@ -796,16 +1020,10 @@ static ObjManager *mySharedWorld = nil;
     // initialize the spawn object
     
     if (child) {
-        sPaper = [[Paper alloc] initWithProps:_objProps[childImg]
-                                    AnimProps:_objAnimProps[_objProps[childImg].animID]
-                                   TouchProps:_objTouchProps[_objProps[childImg].tsID]
-                                       Parent:touchedPiece];
+        sPaper = [self paperFromProps:[self propsForObjID:childImg] Parent:touchedPiece];
     }
     else {
-        sPaper = [[Paper alloc] initWithProps:_objProps[childImg]
-                                    AnimProps:_objAnimProps[_objProps[childImg].animID]
-                                   TouchProps:_objTouchProps[_objProps[childImg].tsID]
-                                       Parent:nil];
+        sPaper = [self paperFromProps:[self propsForObjID:childImg] Parent:nil];
     }
     
     // add spawned Paper to object manager and return it to the viewcontroller
@@ -826,16 +1044,10 @@ static ObjManager *mySharedWorld = nil;
     
     // initialize the spawn object
     if (child > 0) {
-        sPaper = [[Paper alloc] initWithProps:_objProps[objectID]
-                                    AnimProps:_objAnimProps[_objProps[objectID].animID]
-                                   TouchProps:_objTouchProps[_objProps[objectID].tsID]
-                                       Parent:parentPiece];
+        sPaper = [self paperFromProps:[self propsForObjID:objectID] Parent:parentPiece];
     }
     else {
-        sPaper = [[Paper alloc] initWithProps:_objProps[objectID]
-                                    AnimProps:_objAnimProps[_objProps[objectID].animID]
-                                   TouchProps:_objTouchProps[_objProps[objectID].tsID]
-                                       Parent:nil];
+        sPaper = [self paperFromProps:[self propsForObjID:objectID] Parent:nil];
     }
     
     if (!CGPointEqualToPoint(pos, CGPointZero)) {
@@ -865,10 +1077,7 @@ static ObjManager *mySharedWorld = nil;
     Paper *sPaper;
     
     // initialize the spawn object
-    sPaper = [[Paper alloc] initWithProps:_objProps[objID]
-                                AnimProps:_objAnimProps[_objProps[objID].animID]
-                               TouchProps:_objTouchProps[_objProps[objID].tsID]
-                                   Parent:nil];
+    sPaper = [self paperFromProps:[self propsForObjID:objID] Parent:nil];
     
     // add spawned Paper to object manager and return it to the viewcontroller
     [self addObj:sPaper wasSpawned:spawn];
@@ -883,10 +1092,7 @@ static ObjManager *mySharedWorld = nil;
     Paper *sPaper;
 
     // initialize the spawn object
-    sPaper = [[Paper alloc] initWithProps:_objProps[objID]
-                                AnimProps:_objAnimProps[_objProps[objID].animID]
-                               TouchProps:_objTouchProps[_objProps[objID].tsID]
-                                   Parent:nil];
+    sPaper = [self paperFromProps:[self propsForObjID:objID] Parent:nil];
     [sPaper setCenter:pos];
     
     // add spawned Paper to object manager and return it to the viewcontroller
@@ -913,8 +1119,11 @@ static ObjManager *mySharedWorld = nil;
             
             //NSLog(@"Bubble Pop: %d", piece.objID);
             // select a sound
-            int randPop = arc4random_uniform(4)+15;
+            int randPop = SimRandomNextUniform(&piece->random, 4)+15;
             [self playSound:randPop];
+            
+            // the piece may be retired and spawned again before the fade is done
+            int retirements = piece->retirements;
 
             [UIView animateWithDuration:0.2
                                   delay:0.0
@@ -923,7 +1132,7 @@ static ObjManager *mySharedWorld = nil;
                                  piece.alpha = 0.0;
                              }
                              completion:^(BOOL finished){
-                                piece.remove = YES;
+                                if (piece->retirements == retirements) { piece.remove = YES; }
                              }];
         }
             
@@ -962,18 +1171,77 @@ static ObjManager *mySharedWorld = nil;
 }
 
 
-- (void) changeZPosition:(NSMutableDictionary *)objDict toPos:(int)zPos {
+- (void) changeZPosition:(Paper *)paperPiece toPos:(int)zPos {
     
     // changes the Z Position of an object to prevent
     //   it from overlapping a menu view controller
-    Paper *zPiece;
-    for (NSNumber *key in objDict) {
+    paperPiece.layer.zPosition = zPos;
+    
+    // not on screen yet, layerViews puts it in its new layer
+    if (paperPiece.viewSlot < 0) { return; }
+    
+    // on top of its new layer, so just under whatever is above that
+    SimLayerListChangeZ(viewLayers, paperPiece.viewSlot, zPos);
+    Paper *abovePiece = [self pieceAbove:paperPiece];
+    if (abovePiece) {
+        [paperPiece.superview insertSubview:paperPiece belowSubview:abovePiece];
+    }
+    else {
+        [paperPiece.superview bringSubviewToFront:paperPiece];
+    }
+    
+}
+
+- (NSArray*) layerViews:(NSArray *)pieces {
+    
+    // links the pieces on top of their layers, and hands back the ones
+    //   that went in front to back: adding each as a subview just under
+    //   pieceAbove then keeps the subviews in the layers' order, as the
+    //   piece above is always on screen already
+    NSUInteger numPieces = pieces.count;
+    if (numPieces == 0) { return [NSArray array]; }
+    
+    void *items[numPieces];
+    uint32_t slots[numPieces];
+    int zKeys[numPieces];
+    uint32_t inserted[numPieces];
+    NSUInteger numItems = 0;
+    
+    for (Paper *viewPiece in pieces) {
+        // removed before it was ever shown
+        if (viewPiece.remove) { continue; }
         
-        zPiece = [objDict objectForKey:key];
-        zPiece.layer.zPosition = zPos;
+        if (viewPiece.viewSlot < 0) {
+            NSUInteger freeSlot = [freeViewSlots firstIndex];
+            if (freeSlot != NSNotFound) {
+                [freeViewSlots removeIndex:freeSlot];
+                viewPiece.viewSlot = (int)freeSlot;
+            }
+            else {
+                viewPiece.viewSlot = viewSlotCount++;
+            }
+        }
         
+        items[numItems] = (__bridge void *)viewPiece;
+        slots[numItems] = (uint32_t)viewPiece.viewSlot;
+        zKeys[numItems] = (int)viewPiece.layer.zPosition;
+        numItems++;
+    }
+    if (numItems == 0) { return [NSArray array]; }
+    
+    size_t numInserted = SimLayerListInsert(viewLayers, items, slots, zKeys, numItems, inserted);
+    
+    NSMutableArray *layered = [[NSMutableArray alloc] initWithCapacity:numInserted];
+    for (size_t i = numInserted; i > 0; i--) {
+        [layered addObject:(__bridge Paper *)items[inserted[i - 1]]];
     }
+    return layered;
+}
+
+- (Paper*) pieceAbove:(Paper *)paperPiece {
     
+    if (paperPiece.viewSlot < 0) { return nil; }
+    return (__bridge Paper *)SimLayerListAbove(viewLayers, paperPiece.viewSlot);
 }
 
 
@@ -17,12 +17,16 @@
 @class Vector2D;
 @class Behavior;
 @class PocketSVG;
+@class SpriteSequence;
 
 @interface Paper : UIImageView {
 @public
     
     int         objID;          // unique identifier for object
     int         spawnID;        // unique key in dictionary
+    int         viewSlot;       // its links in ObjManager's view layers, -1 = not on screen
+    SimRandomStream random;     // its own draws, numbered in build order like SimPaper's
+    int         retirements;    // times it has gone back to ObjManager's pool, animations and seekers check it
     
     BOOL        tagged;         // tag for flocking behavior
     CGRect      bound;          // for collision detection
@@ -100,6 +104,13 @@
     
     CGPoint     curvePoint;         // final position of animated path curve
 
+    SpriteSequence  *frameSequence; // shared frame animation images, from the SpriteCache
+    
+    CGPoint     prevPosition;       // getCenterPoint at the start of the last tick
+    CGPoint     tickPosition;       // getCenterPoint at the end of the last tick
+    CGPoint     drawnPosition;      // where it is drawn, between the two
+    BOOL        hasPrevPosition;    // NO until the piece has been through a tick
+
 }
 
 @property (nonatomic, retain) NSString *imagePath;
@@ -110,6 +121,7 @@
 
 @property (assign) int objID;
 @property (assign) int spawnID;
+@property (assign) int viewSlot;
 
 @property (assign) BOOL tagged;
 @property (assign) BOOL bounded;
@@ -178,14 +190,31 @@
 
 @property (assign) CGPoint curvePoint;
 
+// Class methods
++ (void)preloadAssets:(PaperProps)prp;      // decode images and paths ahead of initWithProps, any thread
+
 // Instance methods
 - (id)initWithProps:(PaperProps)prp
           AnimProps:(PaperPropsAnim)prpAnim
          TouchProps:(PaperPropsTouchspot)prpTouch
-             Parent:(Paper*)parentPaper;
+             Parent:(Paper*)parentPaper
+             Stream:(SimRandomStream)stream;
+- (id)initForProps:(PaperProps)prp;         // just the view, image and layers, for a pool to hand out later
+- (void)resetWithProps:(PaperProps)prp      // a new spawn of the piece, in place
+             AnimProps:(PaperPropsAnim)prpAnim
+            TouchProps:(PaperPropsTouchspot)prpTouch
+                Parent:(Paper*)parentPaper
+                Stream:(SimRandomStream)stream;
+- (void)retire;                             // stops everything, it's going back to its pool
 
 - (void)applyForce:(Vector2D*)force;
 - (CGPoint)getCenterPoint;
+- (void)setCenterPoint:(CGPoint)point;
+
+// render interpolation, see mainSimulationLoop
+- (void)markPrevPosition;                   // start of a tick
+- (void)updateRender:(CGFloat)alpha;        // end of a display frame, alpha = how far it is past the last tick
+- (void)restoreTickPosition;                // start of the next one, back to where the last tick left it
 - (BOOL)isTagged;
 - (void)wiggle;
 
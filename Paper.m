@@ -13,13 +13,14 @@
 #import "Paper.h"
 #import "Vector2D.h"
 #import "Behavior.h"
-#import "PocketSVG.h"
+#import "PathCache.h"
 #import "Messenger.h"
 #import "Timer.h"
+#import "SpriteCache.h"
 
 @implementation Paper
 
-@synthesize objID, spawnID, posSpawn, tagged, bounded, collision, mass, transformEnabled;
+@synthesize objID, spawnID, viewSlot, posSpawn, tagged, bounded, collision, mass, transformEnabled;
 @synthesize dir, orientation, imagePath, imageType, halfSize, moveType, paperType, bindType, remove, pinch, pinchMax, pinchMin;
 @synthesize moveable, drag, decel, decelTime;
 @synthesize bob, bobAmp, bobOffset, flip, flipX, flipTime;
@@ -39,40 +40,86 @@
     return self;
 }
 
+- (void)dealloc {
+    // hand the frames back so the cache can drop them when it needs to
+    [[SpriteCache theSpriteCache] releaseSequence:frameSequence];
+}
+
+// Decodes the images and paths initWithProps will ask the caches for,
+//   safe from any thread so a loading scene can do it on its workers
++ (void)preloadAssets:(PaperProps)prp {
+
+    NSString *tName = [NSString stringWithUTF8String:prp.imagePath];
+
+    switch (prp.paperType) {
+
+        case Paper_Image:
+        {
+            [[SpriteCache theSpriteCache] stillImage:tName];
+
+#ifdef FRAMES_ON
+            if (prp.frames > 0) {
+                [[SpriteCache theSpriteCache] preloadSequence:tName frames:prp.frames autoReverse:prp.autoReverse];
+            }
+#endif
+
+            // every path it might pick
+            if (prp.movePath) {
+                if (prp.numPaths > 0) {
+                    for (int i = 1; i <= prp.numPaths; i++) {
+                        [[PathCache thePathCache] bezierNamed:[NSString stringWithFormat:@"P_%@%d", tName, i]];
+                    }
+                }
+                else {
+                    [[PathCache thePathCache] bezierNamed:[NSString stringWithFormat:@"P_%@", tName]];
+                }
+            }
+            break;
+        }
+
+        case Paper_Vector:
+        {
+            [[PathCache thePathCache] bezierNamed:tName];
+            [[PathCache thePathCache] bezierNamed:[NSString stringWithFormat:@"%@2", tName]];
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
 - (id)initWithProps:(PaperProps)prp
           AnimProps:(PaperPropsAnim)prpAnim
          TouchProps:(PaperPropsTouchspot)prpTouch
-             Parent:(Paper*)parentPaper {
+             Parent:(Paper*)parentPaper
+             Stream:(SimRandomStream)stream {
+    
+    self = [self initForProps:prp];
+    [self resetWithProps:prp AnimProps:prpAnim TouchProps:prpTouch Parent:parentPaper Stream:stream];
+    
+    return self;
+}
+
+// The parts of a piece that outlive one spawn of it: the view and its image,
+//   the layers and the behavior; resetWithProps sets up everything else
+- (id)initForProps:(PaperProps)prp {
     
     behavior        = [[Behavior alloc] initBehavior];
     animLayerKeys   = [[NSMutableDictionary alloc] initWithCapacity:0];
     
-    // create temp variables / objects
-    NSString *tName;
+    NSString *tName = [NSString stringWithUTF8String: prp.imagePath];
     UIImage  *tImage;
     
-    double   tRand;
-    CGFloat  tRandVel;
-    
-    tName = [NSString stringWithUTF8String: prp.imagePath];
-    
     // PAPER INITIALIZATION ________________________
     
     switch (prp.paperType) {
             
         case Paper_Image:
         {
-            tImage      = [UIImage imageNamed:[NSString stringWithFormat:@"%@.png", tName]];
+            tImage      = [[SpriteCache theSpriteCache] stillImage:tName];
+            if (!tImage) { tImage = [UIImage imageNamed:[NSString stringWithFormat:@"%@.png", tName]]; }
             self        = [self initWithImage: tImage];
-            
-            // set center here to avoid conflict with anchorPoint for svg images
-            if (parentPaper == nil) { self.center = CGPointMake(prp.spawnX, prp.spawnY); }
-            else {
-                // use dir to account for flipped parent images
-                self.center = CGPointMake(parentPaper.center.x + (parentPaper.dir * parentPaper.childSpawn.x),
-                                          parentPaper.center.y + parentPaper.childSpawn.y);
-            }
-            
             break;
         }
             
@@ -87,8 +134,6 @@
             
     }
     
-    // PROPERTIES _________________________________
-    
     animGroup = [CAAnimationGroup animation];
     animShape = [CAShapeLayer layer];
     
@@ -97,8 +142,58 @@
     [animShape setShouldRasterize:YES];
     [animShape setRasterizationScale:[[UIScreen mainScreen] scale]];
     
+    viewSlot        = -1;
+    retirements     = 0;
+    
+    return self;
+}
+
+// Everything about one spawn of the piece, for a new piece or one back out
+//   of ObjManager's pool for its objID
+- (void)resetWithProps:(PaperProps)prp
+             AnimProps:(PaperPropsAnim)prpAnim
+            TouchProps:(PaperPropsTouchspot)prpTouch
+                Parent:(Paper*)parentPaper
+                Stream:(SimRandomStream)stream {
+    
+    // create temp variables / objects
+    NSString *tName;
+    
+    double   tRand;
+    CGFloat  tRandVel;
+    
+    tName = [NSString stringWithUTF8String: prp.imagePath];
+    
+    // whatever the last spawn left on the view and its layers
+    self.transform          = CGAffineTransformIdentity;
+    self.alpha              = 1.0;
+    self.layer.anchorPoint  = CGPointMake(0.5, 0.5);
+    self.layer.zPosition    = 0.0;
+    self.layer.speed        = 1.0;
+    self.layer.timeOffset   = 0.0;
+    self.layer.beginTime    = 0.0;
+    animShape.transform     = CATransform3DIdentity;
+    animShape.speed         = 1.0;
+    animShape.timeOffset    = 0.0;
+    animShape.beginTime     = 0.0;
+    [animLayerKeys removeAllObjects];
+    [behavior resetBehavior];
+    
+    // set center here to avoid conflict with anchorPoint for svg images
+    if (prp.paperType == Paper_Image) {
+        if (parentPaper == nil) { self.center = CGPointMake(prp.spawnX, prp.spawnY); }
+        else {
+            // use dir to account for flipped parent images
+            self.center = CGPointMake(parentPaper.center.x + (parentPaper.dir * parentPaper.childSpawn.x),
+                                      parentPaper.center.y + parentPaper.childSpawn.y);
+        }
+    }
+    
+    // PROPERTIES _________________________________
+    
     // defaults / pre-calcs
     spawnID         = 0;
+    random          = stream;
     flip            = 1;
     killTimeCheck   = 0.0;
     tsRand          = 0;
@@ -109,6 +204,9 @@
     resumeFromBackground = NO;
     transformEnabled= NO;
     tagged          = NO;
+    hasPrevPosition = NO;
+    touchSpot       = CGRectZero;
+    curvePoint      = CGPointZero;
     halfSize        = CGPointMake(self.image.size.width/2, self.image.size.height/2);
     self.backgroundColor = [UIColor clearColor];
     
@@ -168,10 +266,13 @@
     // randomize some properties a little so multiples of the
     //   same vertical objects don't all bob/sway in sync or have the same velocity
     
-    tRand = floorf(((double)arc4random() / ARC4RANDOM_MAX) * 0.6f);
+    float tDraws[3];
+    SimRandomFillRange(&random, tDraws, 3, 0.0f, 1.0f);
+    
+    tRand = floorf(tDraws[0] * 0.6f);
     bobAmp              = prp.bobAmp + tRand;
     
-    tRand = floorf(((double)arc4random() / ARC4RANDOM_MAX) * 1.7f);
+    tRand = floorf(tDraws[1] * 1.7f);
     bobOffset           = prp.bobOffset + tRand;
     
     // don't randomize velocity for shaken objects
@@ -179,7 +280,7 @@
         behavior.vel = [behavior.vel initWithX:prp.velX Y:prp.velY];
     }
     else {
-        tRand = floorf(((double)arc4random() / ARC4RANDOM_MAX) * 1.5f);
+        tRand = floorf(tDraws[2] * 1.5f);
         if (prp.velY > 0.0) {
             tRandVel = prp.velY + tRand;
         }
@@ -244,7 +345,7 @@
     
     // ___ randvel
     if (prp.rVelOn) {
-        CGFloat brVelTime = RAND_NUM(prp.rVelTimeMax, prp.rVelTimeMin);
+        CGFloat brVelTime = SimRandomNextRange(&random, prp.rVelTimeMax, prp.rVelTimeMin);
         Timer *bTimer = [[Timer alloc] initTimer:btRandvel
                                     withInterval:brVelTime withIntervalMax:prp.rVelTimeMax withIntervalMin:prp.rVelTimeMin];
         [behavior addTimer:bTimer forBehavior:btRandvel];
@@ -377,6 +478,7 @@
                 animGroup.delegate = self;
                 animGroup.removedOnCompletion = killOnTouch;
                 [animGroup setValue:self forKey:[NSString stringWithFormat:@"paper.rot.pos.%d",objID]];
+                [animGroup setValue:[NSNumber numberWithInt:retirements] forKey:@"paper.retirements"];
                 
                 [self.layer addAnimation:animGroup forKey:[NSString stringWithFormat:@"rot.pos.%d",objID]];
                 
@@ -398,36 +500,13 @@
                     [behavior turnOn:btAnimframe];
                 }
                 
-                NSMutableArray *frameArray = [[NSMutableArray alloc] initWithCapacity:0];
-                UIImage *tFrame, *tempFrame;
-                
-                // Loop through each image and add to the frameArray
-                for(int i = 1; i < prp.frames + 1; i++) {
-                    tFrame = [UIImage imageNamed:[NSString stringWithFormat:@"%@%d.png", tName, i]];
-                    
-                    // if the image frame # doesn't exist, use the most recent one
-                    // remember the most recent valid image if it does exist
-                    // this currently does not work for autoreversing frame animations
-                    if (!tFrame) {
-                        [frameArray addObject:tempFrame];
-                    }
-                    else {
-                        [frameArray addObject:tFrame];
-                        tempFrame = tFrame;
-                    }
-                    
-                }
-                
-                // Just like above but instead loop back down and add the images in reverse except drop the first and last frames
-                if (prp.autoReverse) {
-                    for(int i = prp.frames - 1; i > 1; i--) {
-                        tFrame = [UIImage imageNamed:[NSString stringWithFormat:@"%@%d.png", tName, i]];
-                        [frameArray addObject:tFrame];
-                    }
+                // every instance shares the one decoded set of frames
+                if (!frameSequence) {
+                    frameSequence = [[SpriteCache theSpriteCache] acquireSequence:tName frames:prp.frames autoReverse:prp.autoReverse];
                 }
                 
                 // Overwrite initial static image, set duration and start animating if initial vel > 0
-                [self setAnimationImages:frameArray];
+                [self setAnimationImages:frameSequence.frameImages];
                 [self setAnimationDuration:behavior.animFrameDur];
                 [self setAnimationRepeatCount:prp.animID];
                 
@@ -447,18 +526,17 @@
                 
                 CAKeyframeAnimation *movePathAnim = [CAKeyframeAnimation animationWithKeyPath:@"position"];
                 
-                PocketSVG *tSVG;
                 UIBezierPath *tBezier;
                 
                 int randIndex;
                 if (numPaths > 0) {
                     // for those with multiple paths to choose from
-                    randIndex = arc4random_uniform(numPaths)+1;
+                    randIndex = SimRandomNextUniform(&random, numPaths)+1;
                     //NSLog(@"Rand Path %d", randIndex);
-                    tSVG = [[PocketSVG alloc] initFromSVGFileNamed:[NSString stringWithFormat:@"P_%@%d", tName, randIndex]];
+                    tBezier = [[PathCache thePathCache] bezierNamed:[NSString stringWithFormat:@"P_%@%d", tName, randIndex]];
                 }
                 else {
-                    tSVG = [[PocketSVG alloc] initFromSVGFileNamed:[NSString stringWithFormat:@"P_%@", tName]];
+                    tBezier = [[PathCache thePathCache] bezierNamed:[NSString stringWithFormat:@"P_%@", tName]];
                 }
                 
                 // flip the image direction based on the path direction
@@ -466,14 +544,14 @@
                     [self setTransform:CGAffineTransformMake(-1, 0, 0, 1, 0, 0)];
                 }
                 
-                // Use PocketSVG to convert the SVG to a Bezier Path
-                tBezier = tSVG.bezier;
+                // the parsed path is shared by every spawn
                 movePathAnim.path = tBezier.CGPath;
                 movePathAnim.calculationMode = kCAAnimationCubicPaced;
                 movePathAnim.fillMode = kCAFillModeForwards;
                 movePathAnim.duration = pathTime;
                 movePathAnim.delegate = self;
                 movePathAnim.removedOnCompletion = NO;
+                [movePathAnim setValue:[NSNumber numberWithInt:retirements] forKey:@"paper.retirements"];
                 
                 if (prp.animID == 0) {
                     movePathAnim.repeatCount = FLT_MAX;
@@ -494,19 +572,14 @@
         case Paper_Vector:
             {
                 
-                PocketSVG *tSVG;
                 UIBezierPath *tBezier;
-                
-                PocketSVG *tSVG2;
                 UIBezierPath *tBezier2;
                 CAShapeLayer *tLayer2;
                 CABasicAnimation *animBezier;
                 CABasicAnimation *animScale;
                 
-                tSVG = [[PocketSVG alloc] initFromSVGFileNamed:[NSString stringWithFormat:@"%@", tName]];
-                
-                // Use PocketSVG to convert the SVG to a Bezier Path
-                tBezier = tSVG.bezier;
+                // the shape and its morph target are parsed once for every spawn
+                tBezier = [[PathCache thePathCache] bezierNamed:tName];
                 animShape.path = tBezier.CGPath;
                 animShape.lineWidth = 1;
                 animShape.strokeColor = [[UIColor blackColor] CGColor];
@@ -553,8 +626,7 @@
                 animShape.anchorPoint = CGPointMake(prp.childSpawnX, prp.childSpawnY);
                 
                 // Create the end path for animation
-                tSVG2 = [[PocketSVG alloc] initFromSVGFileNamed:[NSString stringWithFormat:@"%@2", tName]];
-                tBezier2 = tSVG2.bezier;
+                tBezier2 = [[PathCache thePathCache] bezierNamed:[NSString stringWithFormat:@"%@2", tName]];
                 tLayer2 = [CAShapeLayer layer];
                 tLayer2.path = tBezier2.CGPath;
                 
@@ -566,6 +638,7 @@
                 animBezier.fillMode = kCAFillModeForwards;
                 animBezier.removedOnCompletion = NO;
                 animBezier.autoreverses = behavior.autoReverse;
+                [animBezier setValue:[NSNumber numberWithInt:retirements] forKey:@"paper.retirements"];
                 
                 if (prp.animID < 0)  {
                     animBezier.repeatCount = FLT_MAX;
@@ -590,6 +663,7 @@
                     animScale.removedOnCompletion = NO;
                     animScale.autoreverses = NO;
                     animScale.repeatCount = 0;
+                    [animScale setValue:[NSNumber numberWithInt:retirements] forKey:@"paper.retirements"];
                     animScale.fromValue = [NSValue valueWithCATransform3D:CATransform3DMakeScale(imageScale, imageScale, 0.0)];
                     animScale.toValue = [NSValue valueWithCATransform3D:CATransform3DMakeScale(1.0, 1.0, 0.0)];
                     [animShape addAnimation:animScale forKey:@"animateScale"];
@@ -598,9 +672,9 @@
                 // Movement along a curved path (notefish)
                 if (prp.crvXOffMin != 0.0) {
                     
-                    CGFloat curveXOffset = RAND_NUM(prp.crvXOffMin, prp.crvXOffMax);
-                    CGFloat curveYOffset = RAND_NUM(prp.crvYOffMin, prp.crvYOffMax);
-                    CGFloat curveCOffset = RAND_NUM(prp.crvCOffMin, prp.crvCOffMax);
+                    CGFloat curveXOffset = SimRandomNextRange(&random, prp.crvXOffMin, prp.crvXOffMax);
+                    CGFloat curveYOffset = SimRandomNextRange(&random, prp.crvYOffMin, prp.crvYOffMax);
+                    CGFloat curveCOffset = SimRandomNextRange(&random, prp.crvCOffMin, prp.crvCOffMax);
                     
                     //NSLog(@"Curve Offsets X:%f Y:%f C:%f",curveXOffset, curveYOffset, curveCOffset);
                     
@@ -613,6 +687,7 @@
                     movePathAnim.duration = prp.frameDur;
                     movePathAnim.delegate = self;
                     movePathAnim.repeatCount = 0;
+                    [movePathAnim setValue:[NSNumber numberWithInt:retirements] forKey:@"paper.retirements"];
                     
                     CGMutablePathRef tPath = CGPathCreateMutable();
                     CGPathMoveToPoint(tPath, nil, newCenter.x, newCenter.y);
@@ -642,8 +717,20 @@
         
     }
     
-    return self;
-    
+}
+
+// Out of the world and off the screen, waiting in its pool: everything it had
+//   running stops, and whatever still holds on to it can tell it's gone
+- (void)retire {
+    
+    retirements++;
+    
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(frameAnimComplete) object:nil];
+    [self stopAnimating];
+    [self.layer removeAllAnimations];
+    [animShape removeAllAnimations];
+    [animShape removeFromSuperlayer];
+    [behavior turnOffAll];
 }
 
 - (void)animationDidStart:(CAAnimation *)anim {
@@ -651,6 +738,9 @@
 }
 
 - (void)animationDidStop:(CAAnimation *)theAnimation finished:(BOOL)flag {
+    // one from before the piece was last retired, it's someone else now
+    if ([[theAnimation valueForKey:@"paper.retirements"] intValue] != retirements) { return; }
+    
     // remove paper if animation completes - only for temp spawned objects (objID > 99)
     if (spawnID > 99) {
         remove = YES;   // this removes the object from the world dictionary in the main timer
@@ -721,11 +811,17 @@
     paperCenter.x = force.x;
     paperCenter.y = force.y;
     
+    [self setCenterPoint:paperCenter];
+    
+}
+
+- (void)setCenterPoint:(CGPoint)point {
+    
     if (self.paperType == Paper_Image) {
-        [self setCenter:paperCenter];
+        [self setCenter:point];
     }
     else if (self.paperType == Paper_Vector) {
-        [self.animShape setPosition:paperCenter];
+        [self.animShape setPosition:point];
     }
     
 }
@@ -743,6 +839,38 @@
     
 }
 
+- (void)markPrevPosition {
+    prevPosition = [self getCenterPoint];
+    hasPrevPosition = YES;
+}
+
+- (void)updateRender:(CGFloat)alpha {
+    
+    tickPosition = [self getCenterPoint];
+    drawnPosition = tickPosition;
+    
+    if (hasPrevPosition) {
+        CGFloat dx = tickPosition.x - prevPosition.x;
+        CGFloat dy = tickPosition.y - prevPosition.y;
+        
+        if (((dx * dx) + (dy * dy)) <= (RENDER_SNAP * RENDER_SNAP)) {
+            drawnPosition = CGPointMake(prevPosition.x + (dx * alpha), prevPosition.y + (dy * alpha));
+        }
+    }
+    
+    [self setCenterPoint:drawnPosition];
+    
+}
+
+- (void)restoreTickPosition {
+    
+    // moved since it was drawn (a touch, a pinch), that's where it is now
+    if (!CGPointEqualToPoint([self getCenterPoint], drawnPosition)) { return; }
+    
+    [self setCenterPoint:tickPosition];
+    
+}
+
 - (BOOL)isTagged { return tagged; }
 
 - (void)wiggle {
@@ -789,6 +917,7 @@
     
     animWiggle.removedOnCompletion = YES;
     animWiggle.delegate = self;
+    [animWiggle setValue:[NSNumber numberWithInt:retirements] forKey:@"paper.retirements"];
     
     [animShape addAnimation:animWiggle forKey:@"Wiggle3D"];
     
@@ -17,12 +17,16 @@
 #import <unistd.h>
 
 #import "Variables.h"
+#import "SimCore/SimProfiler.h"
+#import "SimCore/SimJournal.h"
+#import "SimCore/SimRandom.h"
 
 @class Border;
 @class Paper;
 @class PaperPath;
 @class ObjManager;
 @class Messenger;
+@class SceneFile;
 
 @interface PapercutPadViewController : UIViewController <UIAccelerometerDelegate, UIGestureRecognizerDelegate, AVAudioPlayerDelegate> {
 
@@ -30,6 +34,21 @@
     CGFloat elapsedTime;            // amount of elasped time
     int     debugUpdate;
     int     frameUpdate;
+    double  tickAccumulator;        // real time not yet stepped, always less than a tick after a frame
+    
+    // scene loading
+    int     loadGeneration;         // bumped on every load / unload, stale loading work checks it
+    int     piecesLoading;          // property rows not built yet
+    int     nextSceneRow;           // the next row to build, rows are built in order whatever order they decode in
+    NSMutableIndexSet *decodedRows; // rows decoded and waiting on the rows before them
+    BOOL    traceFirstFrame;        // next frame is the first of this load
+    BOOL    traceInteractive;       // next frame is the first with the whole scene
+    
+    // frame profiling, NULL unless FRAME_PROFILE_ON
+    SimProfiler *profiler;
+    
+    // input recording, NULL unless INPUT_JOURNAL_ON
+    SimJournal *journal;
     
     CGRect infoRect;                // for the info button
     
@@ -44,6 +63,7 @@
 @property (nonatomic, strong) Messenger *messenger;
 @property (nonatomic, retain) NSTimer *mainTimer;           // OLD loop timer
 @property (nonatomic, retain) CADisplayLink *displayLoop;     // main game loop
+@property (nonatomic, retain) NSOperationQueue *loadQueue;  // SCENE_LOAD_WORKERS decoding scene assets
 @property (nonatomic, strong) Paper *touchPiece;            // temp Paper object for touch responses
 @property (nonatomic, strong) Paper *eachPiece;             // temp Paper object for dictionary iteration
 
@@ -65,6 +85,7 @@
             random:(PaperRandom[])prpRandom
              sound:(PaperPropsSounds[])prpSounds
              timer:(PaperWorldTimers[])prpTimers;    // custom initialization based on menu selection
+- (id)initPapercutScene:(SceneFile*)scene;              // same, for a story loaded from a .pcs file
 
 - (void)loadPapercut;
 - (void)unloadPapercut;
@@ -20,9 +20,14 @@
 #import "StoryViewController.h"
 #import "MenuViewController.h"
 #import "Math.h"
+#import "SceneFile.h"
+#import "StartupTrace.h"
 
 @interface PapercutPadViewController ()
 
+- (void)stepTick:(CGFloat)frameTime;
+- (void)placeViews:(NSArray *)pieces underBorder:(BOOL)under;
+
 @end
 
 @implementation PapercutPadViewController
@@ -60,6 +65,8 @@
     _world.objSounds        = prpSounds;
     _world.objTimers        = prpTimers;
     
+    _world.scene            = nil;
+    
     [_world turnOffState:osPaused];
     
     // initialize the messenger
@@ -101,32 +108,46 @@
     return self;
 }
 
+- (id)initPapercutScene:(SceneFile*)scene
+{
+    // a story from a .pcs file, read in place instead of from the compiled-in tables
+    self = [self initPapercut:NULL anim:NULL touch:NULL group:NULL random:NULL sound:NULL timer:NULL];
+    _world.scene = scene;
+    
+    return self;
+}
+
 - (void)loadPapercut {
     
-    // Setup background noise loops
-  NSString *soundFilePath = [[NSBundle mainBundle] pathForResource: @"BG_Water" ofType: @"mp3"];
-	NSURL *fileURL = [[NSURL alloc] initFileURLWithPath: soundFilePath];
-	AVAudioPlayer *newPlayer = [[AVAudioPlayer alloc] initWithContentsOfURL: fileURL error: nil];
-    _world.bg_audio01 = newPlayer;
-	[_world.bg_audio01 prepareToPlay];
-	[_world.bg_audio01 setNumberOfLoops:-1];
-	[_world.bg_audio01 setDelegate: self];
-    [_world.bg_audio01 setVolume:0.4];
-    
-	soundFilePath = [[NSBundle mainBundle] pathForResource: @"BG_Ambient" ofType: @"mp3"];
-	fileURL = [[NSURL alloc] initFileURLWithPath: soundFilePath];
-	newPlayer = [[AVAudioPlayer alloc] initWithContentsOfURL: fileURL error: nil];
-    _world.bg_audio02 = newPlayer;
-	[_world.bg_audio02 prepareToPlay];
-	[_world.bg_audio02 setNumberOfLoops:-1];
-	[_world.bg_audio02 setDelegate: self];
-    [_world.bg_audio02 setVolume:0.1];
+    // Load in stages: the scene's images and paths are decoded on a few
+    //   background workers, and each piece is built and shown on the main
+    //   thread as soon as its assets are ready, so the scene fills in
+    //   instead of holding the main thread until everything is decoded
+    StartupTrace *trace = [StartupTrace theStartupTrace];
+    [trace beginStage:@"setup"];
     
-    if (_world.optSound) {
-        [_world.bg_audio01 play];
-        [_world.bg_audio02 play];
+    loadGeneration++;
+    int generation = loadGeneration;
+    
+    if (!_loadQueue) {
+        _loadQueue = [[NSOperationQueue alloc] init];
+        [_loadQueue setMaxConcurrentOperationCount:SCENE_LOAD_WORKERS];
     }
     
+#ifdef FRAME_PROFILE_ON
+    if (!profiler) { profiler = SimProfilerCreate(SIM_PROFILE_HISTORY); }
+#endif
+    
+    // a fresh seed for every load, RAND_NUM and the pieces' own streams draw from it
+    SimRandomSeed(SimRandomNewSeed());
+    
+#ifdef INPUT_JOURNAL_ON
+    // the seed is kept so a headless replay draws from the same streams
+    SimJournalDestroy(journal);
+    journal = SimJournalCreate((_world.scene) ? [_world.scene.name UTF8String] : "mermaids", SimRandomCurrentSeed(),
+                               (int)self.view.bounds.size.width, (int)self.view.bounds.size.height);
+#endif
+    
     _world.fps = 0.0167;
     _world.elapsedTime = 0.0;
     
@@ -136,9 +157,6 @@
 	_world.accel.updateInterval = _world.fps;
 #endif
     
-    // setup the FX sounds
-    [_world loadSounds];
-    
     // Initialize variabless
     elapsedTime = 0.0;
     debugUpdate = 0;
@@ -147,6 +165,7 @@
     _lastScale = 1.0;
     _currScale = 1.0;
     _prevTimestamp = 0.0;
+    tickAccumulator = 0.0;
     
     // Mermaids-specific variables
     _world.bounceOffset = BOUNCE_OFFSET;
@@ -158,55 +177,98 @@
     _world.viewWidth = sBounds.size.width;
     _world.viewHeight = sBounds.size.height;
     
-    // Initialize the scene and border
-    [_world initScene];
-    [_world initBorder];
+    [trace endStage:@"setup"];
     
-    // Populate additional Paper object managers and add all subviews
-    for (NSNumber *key in _world.objects) {
+    // setup the FX sounds
+    [trace beginStage:@"sounds"];
+    [_world loadSounds];
+    [trace endStage:@"sounds"];
+    
+    // Setup background noise loops on a worker, they start playing once they're ready
+    [_loadQueue addOperationWithBlock:^{
         
-        _eachPiece = [_world.objects objectForKey:key];
+        [trace beginStage:@"background audio"];
         
-        // Populate other object managers
-        if (_eachPiece.collision) {
-            [_world addObj:_eachPiece forDictionary:_world.objects_coll];
-        }
+        NSString *soundFilePath = [[NSBundle mainBundle] pathForResource: @"BG_Water" ofType: @"mp3"];
+        NSURL *fileURL = [[NSURL alloc] initFileURLWithPath: soundFilePath];
+        AVAudioPlayer *water = [[AVAudioPlayer alloc] initWithContentsOfURL: fileURL error: nil];
+        [water prepareToPlay];
         
-        if (_eachPiece.pinch) {
-            [_world addObj:_eachPiece forDictionary:_world.objects_pinch];
-        }
+        soundFilePath = [[NSBundle mainBundle] pathForResource: @"BG_Ambient" ofType: @"mp3"];
+        fileURL = [[NSURL alloc] initFileURLWithPath: soundFilePath];
+        AVAudioPlayer *ambient = [[AVAudioPlayer alloc] initWithContentsOfURL: fileURL error: nil];
+        [ambient prepareToPlay];
         
-        if (_eachPiece.wiggleTime > 0.0) {
-            [_world addObj:_eachPiece forDictionary:_world.objects_wiggle];
-        }
+        [trace endStage:@"background audio"];
         
-        // Add each object as a subview
-        //   But... don't add Info button if menus are off
-        if (_eachPiece.objID == 45) {
-#ifdef MENUS_ON
-            [self.view addSubview:_eachPiece];
-            infoRect = _eachPiece.frame;
-#endif
-        }
-        else {
-            [self.view addSubview:_eachPiece];
-        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            
+            // the scene was unloaded while this was loading
+            if (generation != loadGeneration) { return; }
+            
+            _world.bg_audio01 = water;
+            [_world.bg_audio01 setNumberOfLoops:-1];
+            [_world.bg_audio01 setDelegate: self];
+            [_world.bg_audio01 setVolume:0.4];
+            
+            _world.bg_audio02 = ambient;
+            [_world.bg_audio02 setNumberOfLoops:-1];
+            [_world.bg_audio02 setDelegate: self];
+            [_world.bg_audio02 setVolume:0.1];
+            
+            if (_world.optSound) {
+                [_world.bg_audio01 play];
+                [_world.bg_audio02 play];
+            }
+        });
+    }];
+    
+    // The border goes up first, every piece is added underneath it
+    [trace beginStage:@"border"];
+    [_world initBorder];
+    [self.view addSubview:_world.border];
+    [trace endStage:@"border"];
+    
+    // Decode each row's assets on the workers, then build the pieces on the main thread
+    //   in row order, so each piece takes the same random stream SimWorld gives it
+    [trace beginStage:@"scene"];
+    
+    int totalRows = [_world numPropsRows];
+    piecesLoading = totalRows - 1;
+    nextSceneRow = 1;
+    if (!decodedRows) { decodedRows = [[NSMutableIndexSet alloc] init]; }
+    [decodedRows removeAllIndexes];
+    [_world markSpawnRows];
+    
+	for (int i = 1; i < totalRows; i++) {
         
-        // Adjust the starting scale if necessary
-        if (_eachPiece.scaleStart > 0.0) {
-            _eachPiece.transform = [_world imageTransform:_eachPiece withScale:_eachPiece.scaleStart];
-        }
+        PaperProps prp = [_world propsRow:i];
+        BOOL spawnRow = [_world isSpawnRow:i];
+        NSString *stageName = [NSString stringWithFormat:@"decode %s", prp.imagePath];
         
+        [_loadQueue addOperationWithBlock:^{
+            
+            // only the pieces that appear now, and those the row's pool
+            //   builds ahead, need their assets up front
+            if ((prp.init) || (spawnRow)) {
+                [trace beginStage:stageName];
+                [Paper preloadAssets:prp];
+                [trace endStage:stageName];
+            }
+            
+            dispatch_async(dispatch_get_main_queue(), ^{
+                if (generation != loadGeneration) { return; }
+                [self sceneRowDecoded:i];
+            });
+        }];
     }
     
-    // Add the border last so it's on top of all the other views
-    [self.view addSubview:_world.border];
-    
     // Create main timer OLD
     //self.mainTimer = [NSTimer scheduledTimerWithTimeInterval:UPDATE_PERIOD
     //                                                  target:self selector:@selector(mainTimerCallback:) userInfo:nil repeats:YES];
     
-    // Make sure the display loop is not paused
+    // Make sure the display loop is not paused, the world starts stepping once every piece is built
+    traceFirstFrame = YES;
     [_displayLoop setPaused:NO];
     
     // Create gesture recognizer for pinch/zoom objects
@@ -236,6 +298,68 @@
     
 }
 
+// A row's assets are decoded, build it and any rows after it that were only
+//   waiting on it
+- (void)sceneRowDecoded:(int)row {
+    
+    [decodedRows addIndex:row];
+    while ([decodedRows containsIndex:nextSceneRow]) {
+        [decodedRows removeIndex:nextSceneRow];
+        [self addSceneRow:nextSceneRow];
+        nextSceneRow++;
+    }
+}
+
+// Builds one property row's piece and shows it, the last row starts the
+//   world timers and makes the scene interactive
+- (void)addSceneRow:(int)row {
+    
+    Paper *tPaper = [_world buildSceneRow:row];
+    
+    if (tPaper) {
+        
+        // Populate other object managers
+        if (tPaper.collision) {
+            [_world addObj:tPaper forDictionary:_world.objects_coll];
+        }
+        
+        if (tPaper.pinch) {
+            [_world addObj:tPaper forDictionary:_world.objects_pinch];
+        }
+        
+        if (tPaper.wiggleTime > 0.0) {
+            [_world addObj:tPaper forDictionary:_world.objects_wiggle];
+        }
+        
+        // Add the object as a subview, under the border
+        //   But... don't add Info button if menus are off
+        if (tPaper.objID == 45) {
+#ifdef MENUS_ON
+            [self placeViews:[NSArray arrayWithObject:tPaper] underBorder:YES];
+            infoRect = tPaper.frame;
+#endif
+        }
+        else {
+            [self placeViews:[NSArray arrayWithObject:tPaper] underBorder:YES];
+        }
+        
+        // Adjust the starting scale if necessary
+        if (tPaper.scaleStart > 0.0) {
+            tPaper.transform = [_world imageTransform:tPaper withScale:tPaper.scaleStart];
+        }
+    }
+    
+    piecesLoading--;
+    if (piecesLoading == 0) {
+        [_world initWorldTimers];
+        
+        StartupTrace *trace = [StartupTrace theStartupTrace];
+        [trace endStage:@"scene"];
+        [trace mark:@"scene built"];
+        traceInteractive = YES;
+    }
+}
+
 - (void)viewDidLoad
 {
     
@@ -252,6 +376,7 @@
     // get the position where the user is touching and figure out if
     //   an object is being touched
     CGPoint currentPos = [[touches anyObject] locationInView:self.view];
+    SimJournalTouchBegan(journal, currentPos.x, currentPos.y);
     _touchPiece = [_world objTouched:currentPos];
     
     _firstTouch = currentPos;   // used for possible swiping
@@ -266,7 +391,9 @@
     
     // Info menu
     if (CGRectContainsPoint(infoRect, currentPos)) {
-        [_world changeZPosition:_world.objects_pinch toPos:-1];
+        for (NSNumber *key in _world.objects_pinch) {
+            [_world changeZPosition:[_world.objects_pinch objectForKey:key] toPos:-1];
+        }
         MenuViewController *popupVC = [[MenuViewController alloc] initWithVC:self nibName:@"MenuViewController" bundle:nil];
         [self presentPopupViewController:popupVC animationType:MJPopupViewAnimationFadeBottomLeft];
     }
@@ -279,29 +406,32 @@
         if (![_world maxObjectsReached]) {
         
             // spawn an object if a world touchspot is entered
-            int numTS = _world.objTouchProps[0].objID;
+            int numTS = [_world numTouchspots];
             
             for (int i = 1; i <= numTS; i++) {   // this skips the first record in the array intentionally
                 
-                if (_world.objTouchProps[i].objID > 0) {
+                PaperPropsTouchspot prpTouch = [_world touchRow:i];
+                
+                if (prpTouch.objID > 0) {
                     
-                    CGRect testTS = CGRectMake(_world.objTouchProps[i].tsX,
-                                               _world.objTouchProps[i].tsY,
-                                               _world.objTouchProps[i].tsWd,
-                                               _world.objTouchProps[i].tsHt);
+                    CGRect testTS = CGRectMake(prpTouch.tsX,
+                                               prpTouch.tsY,
+                                               prpTouch.tsWd,
+                                               prpTouch.tsHt);
                     
                     if (CGRectContainsPoint(testTS, currentPos)) {
                         
                         //NSLog(@"PROPS %d, POS: %f, %f", numTS, currentPos.x, currentPos.y);
                         
                         int childObj;
-                        NSUInteger randIndex = arc4random_uniform(5)+1;
+                        NSUInteger randIndex = SimRandomUniform(5)+1;
                         // row 2 in objRandom is the random object row for TS
-                        if (randIndex == 1) { childObj = _world.objRandom[2].rObjID01; }
-                        if (randIndex == 2) { childObj = _world.objRandom[2].rObjID02; }
-                        if (randIndex == 3) { childObj = _world.objRandom[2].rObjID03; }
-                        if (randIndex == 4) { childObj = _world.objRandom[2].rObjID04; }
-                        if (randIndex == 5) { childObj = _world.objRandom[2].rObjID05; }
+                        PaperRandom prpRandom = [_world randomRow:2];
+                        if (randIndex == 1) { childObj = prpRandom.rObjID01; }
+                        if (randIndex == 2) { childObj = prpRandom.rObjID02; }
+                        if (randIndex == 3) { childObj = prpRandom.rObjID03; }
+                        if (randIndex == 4) { childObj = prpRandom.rObjID04; }
+                        if (randIndex == 5) { childObj = prpRandom.rObjID05; }
                         //NSLog(@"TS Rand Obj %d", childObj);
                         
                         // spawn if an actual number is selected
@@ -314,7 +444,7 @@
                                     [_world addObj:sPaper forDictionary:_world.objects_coll];
                                 }
                                 
-                                [self.view addSubview:sPaper];
+                                [_world addToView:sPaper];
                                 
 #ifdef TEST_FLIGHT_ON
                                 //[TestFlight passCheckpoint:@"Touchspot"];
@@ -350,9 +480,10 @@
                 
                 // find a new random velocity
                 int bAngle = 1;
-                if (RAND_NUM(0.0,1.0) > 0.5) { bAngle = -1; }
-                _touchPiece.behavior.vel.y = RAND_NUM(_touchPiece.behavior.bSeekOffset.x,
-                                                      _touchPiece.behavior.bSeekOffset.y);
+                if (SimRandomNextFloat(&_touchPiece->random) > 0.5) { bAngle = -1; }
+                _touchPiece.behavior.vel.y = SimRandomNextRange(&_touchPiece->random,
+                                                                _touchPiece.behavior.bSeekOffset.x,
+                                                                _touchPiece.behavior.bSeekOffset.y);
                 _touchPiece.behavior.vel.y *= bAngle;
                 
                 int xDir = 1;
@@ -414,17 +545,18 @@
                             }
                             else {
                                 // if random spawn, then figure out which object
-                                NSUInteger randIndex = arc4random_uniform(5)+1;
+                                NSUInteger randIndex = SimRandomUniform(5)+1;
                                 //NSLog(@"randIndex %u", randIndex);
-                                if (randIndex == 1) { childObj = _world.objRandom[_touchPiece.tsRand].rObjID01; }
-                                if (randIndex == 2) { childObj = _world.objRandom[_touchPiece.tsRand].rObjID02; }
-                                if (randIndex == 3) { childObj = _world.objRandom[_touchPiece.tsRand].rObjID03; }
-                                if (randIndex == 4) { childObj = _world.objRandom[_touchPiece.tsRand].rObjID04; }
-                                if (randIndex == 5) { childObj = _world.objRandom[_touchPiece.tsRand].rObjID05; }
+                                PaperRandom prpRandom = [_world randomRow:_touchPiece.tsRand];
+                                if (randIndex == 1) { childObj = prpRandom.rObjID01; }
+                                if (randIndex == 2) { childObj = prpRandom.rObjID02; }
+                                if (randIndex == 3) { childObj = prpRandom.rObjID03; }
+                                if (randIndex == 4) { childObj = prpRandom.rObjID04; }
+                                if (randIndex == 5) { childObj = prpRandom.rObjID05; }
                             }
                             
-                            int randSax = arc4random_uniform(4)+1;
-                            int randHrn = arc4random_uniform(2)+5;
+                            int randSax = SimRandomUniform(4)+1;
+                            int randHrn = SimRandomUniform(2)+5;
                             
                             // set the volume for the mermaid horns based on the scale factor
                             //   0.9 = desired volume range (0.1 to 1.0)
@@ -450,7 +582,7 @@
                                     [_world addObj:sPaper forDictionary:_world.objects_coll];
                                 }
                                 
-                                [self.view addSubview:sPaper];
+                                [_world addToView:sPaper];
                                 //NSLog(@"sPaper: %d %@", sPaper.spawnID, sPaper.imagePath);
                             }
                             
@@ -468,7 +600,7 @@
                             [_world addObj:sPaper forDictionary:_world.objects_coll];
                         }
                         
-                        [self.view addSubview:sPaper];
+                        [_world addToView:sPaper];
                         
                     }
                     
@@ -489,6 +621,7 @@
         // get touch info
         CGPoint beginPos = [[touches anyObject] previousLocationInView:self.view];
         CGPoint currentPos = [[touches anyObject] locationInView:self.view];
+        SimJournalTouchMoved(journal, beginPos.x, beginPos.y, currentPos.x, currentPos.y);
         _touchPiece = [_world objTouched:currentPos];
         
         // as long as view can be seen, allow user to touch it
@@ -538,6 +671,7 @@
 - (void)touchesEnded:(NSSet *)touches withEvent:(UIEvent *)event {
     
     _lastTouch = [[touches anyObject] locationInView:self.view];
+    SimJournalTouchEnded(journal, _firstTouch.x, _firstTouch.y, _lastTouch.x, _lastTouch.y);
     
     //NSLog(@"Start [%f %f] End [%f %f]", _firstTouch.x, _firstTouch.y, _lastTouch.x, _lastTouch.y);
     
@@ -579,6 +713,7 @@
 {
     if (event.type == UIEventSubtypeMotionShake )
     {
+        SimJournalShake(journal);
         
         if (_world.optInteract) {
             
@@ -587,14 +722,14 @@
             if (_world.objects_shake.count == 0) {
                 
                 // randomly choose an object in the array
-                NSUInteger randIndex = arc4random_uniform([_world.queue_shake count]);
+                NSUInteger randIndex = SimRandomUniform([_world.queue_shake count]);
                 //NSLog(@"Shake Random: %u", randIndex);
                 int objID = [[_world.queue_shake objectAtIndex:randIndex] intValue];
                 
                 sPaper = [_world spawnPiece:objID];
                 [_world addObj:sPaper forDictionary:_world.objects_shake];
                 
-                [self.view addSubview:sPaper];
+                [_world addToView:sPaper];
                 
             }
             
@@ -622,6 +757,7 @@
 - (void)accelerometer:(UIAccelerometer *)accelerometer didAccelerate:(UIAcceleration *)acceleration
 {
 #ifdef ACCEL_ON
+    SimJournalAccelerate(journal, acceleration.x);
     if (_world.optInteract) {
         _world.accelX = (acceleration.x * GRAVITY_FILTER) + (_world.accelX * (1.0 - GRAVITY_FILTER));
     }
@@ -665,43 +801,137 @@
 
 - (void)mainSimulationLoop:(id)sender {
     
+    // startup milestones, the first frame drawn and the first with the whole scene
+    if (traceFirstFrame) {
+        traceFirstFrame = NO;
+        [[StartupTrace theStartupTrace] mark:@"first frame"];
+    }
+    if (traceInteractive) {
+        traceInteractive = NO;
+        [[StartupTrace theStartupTrace] mark:@"first interactive frame"];
+        [[StartupTrace theStartupTrace] finish];
+    }
+    
 // MAIN UPDATE LOOP
     
-// skip update if app is paused or in background
-if (![_world isStateOn:osPaused]) {
-    
-    Paper       *eachPiece;             // used for enumeration of _world.objects
-    Paper       *removePiece;           // Paper to remove from _world.objects
-    BOOL        transformEnabled = YES; // triggers transform function
+// skip update if app is paused or in background, or the scene is still being built
+if ((![_world isStateOn:osPaused]) && (piecesLoading == 0)) {
     
     debugUpdate++;
     frameUpdate++;
     
     NSDate *start = [NSDate date];
     
-    CGFloat frameTime = 0.0;
+    // the input since the last frame is replayed before this one
+    SimJournalFrame(journal, _displayLoop.timestamp);
+    
+    // phase timings, all no-ops unless profiling
+    SimProfilerNextFrame(profiler);
+    uint64_t frameStart = SimProfileStart(profiler);
+    
+    // the world always advances in fixed ticks of fps, a display frame
+    //   runs however many ticks of real time have built up since the last
+    //   one, so dropped frames no longer slow the world down
     CGFloat trueFrameTime = 0.0;
     if (_prevTimestamp != 0.0) {
         
-        frameTime = _displayLoop.timestamp - _prevTimestamp;
+        CGFloat frameTime = _displayLoop.timestamp - _prevTimestamp;
         trueFrameTime = frameTime;
         
         // because the timestamp always reflects the current time of the
-        //   device, overwrite any huge frameTime value that might occur
-        //   due to the app being put in an inactive state, otherwise when
-        //   resuming, some animations will jump forward in time and
-        //   disappear because they think they've been completed
-        if (frameTime > (_world.fps * 2.5)) {
+        //   device, count any huge frameTime value that might occur due
+        //   to the app being put in an inactive state as a single tick,
+        //   otherwise when resuming, some animations will jump forward in
+        //   time and disappear because they think they've been completed
+        if (frameTime > MAX_FRAME_TIME) {
             frameTime = _world.fps;
         }
         
+        tickAccumulator += frameTime;
     }
     _prevTimestamp = _displayLoop.timestamp;
     
+    // pieces are drawn partway between ticks, the ticks run from where
+    //   the last one left them
+    for (NSNumber *key in _world.objects) {
+        [[_world.objects objectForKey:key] restoreTickPosition];
+    }
+    
+    int ticks = 0;
+    while ((tickAccumulator >= _world.fps) && (ticks < MAX_TICKS)) {
+        [self stepTick:_world.fps];
+        tickAccumulator -= _world.fps;
+        ticks++;
+    }
+    
+    // too far behind to catch up, drop the rest rather than spiral
+    if (tickAccumulator >= _world.fps) {
+        tickAccumulator = fmod(tickAccumulator, _world.fps);
+    }
+    
+    // draw everything partway between its last two ticks
+    CGFloat renderAlpha = tickAccumulator / _world.fps;
+    for (NSNumber *key in _world.objects) {
+        [[_world.objects objectForKey:key] updateRender:renderAlpha];
+    }
+    
+    NSTimeInterval timeInterval;
+    
+    // for calculating / displaying the FPS
+    if (debugUpdate > (1/_world.fps)) {
+        
+        timeInterval = -1 / [start timeIntervalSinceNow];
+        
+#ifdef DEBUG_ON
+        [self updateTextLabel:deltaLabel gameTime:(1/trueFrameTime) loopTime:trueFrameTime];
+#endif
+        
+        // Reset debug update counter
+        debugUpdate = 0;
+    }
+    
+    // log framerate every 10 seconds
+    if (frameUpdate > ((1/_world.fps)*10)) {
+        timeInterval = -1 / [start timeIntervalSinceNow];
+        //NSLog(@"FPS: %f  Frametime (sec): %f", 1/trueFrameTime, trueFrameTime);
+        //NSLog(@"# of Objects: %u  MaxObjCount: %u", [_world.objects count], _world.numObjects);
+        frameUpdate = 0;
+    }
+    
+#ifdef DEBUG_ON
+    numObjects = [NSString stringWithFormat:@"[# of Objects: %u]",
+                           [_world.objects count]];
+    objectLabel.text = numObjects;
+#endif
+    
+    SimProfilerRecord(profiler, spFrame, 0, frameStart, SimProfileStart(profiler));
+    
+}
+    
+}
+
+// one fixed step of the world, frameTime is always _world.fps
+- (void)stepTick:(CGFloat)frameTime {
+    
+    Paper       *eachPiece;             // used for enumeration of _world.objects
+    BOOL        transformEnabled = YES; // triggers transform function
+    
+    uint64_t phaseStart;
+    SimProfileSpan boundsSpan = { 0, 0 };
+    SimProfileSpan collisionSpan = { 0, 0 };
+    SimProfileSpan transformSpan = { 0, 0 };
+    SimProfileSpan forceSpan = { 0, 0 };
+    
     // track total elapsed time
     _world.elapsedTime += frameTime;
+    
+    // note where each piece starts out for render interpolation
+    for (NSNumber *key in _world.objects) {
+        [[_world.objects objectForKey:key] markPrevPosition];
+    }
 
     // loop through each piece and update
+    uint64_t moveStart = SimProfileStart(profiler);
     for (NSNumber *key in _world.objects) {
         
         eachPiece = [_world.objects objectForKey:key];
@@ -716,9 +946,10 @@ if (![_world isStateOn:osPaused]) {
             //if (eachPiece.objID == 29) { NSLog(@"Eel Center [%f %f]", paperCenter.x, paperCenter.y); }
             
             // Update timers
-            [eachPiece.behavior updateTimers:_world.fps];
+            [eachPiece.behavior updateTimers:frameTime];
         
             // Handle bounded properties
+            phaseStart = SimProfileStart(profiler);
             if ((eachPiece.bindType == Bind_Always) || (eachPiece.bindType == Bind_OnEnter)) {
                 
                 // change bound property if Bind_OnEnter has entered the view
@@ -737,12 +968,15 @@ if (![_world isStateOn:osPaused]) {
                 }
 
             }
+            SimProfileSpanStop(profiler, &boundsSpan, phaseStart);
             
             if (COLLISION) {
                 
                 // collision detection - alter velocity vectors accordingly
                 if ((eachPiece.collision) && (_world.optInteract)) {
                     
+                    phaseStart = SimProfileStart(profiler);
+                    
                     // only check against objects with collision enabled
                     Paper *colPiece;
                     for (NSNumber *key in _world.objects_coll) {
@@ -780,6 +1014,8 @@ if (![_world isStateOn:osPaused]) {
                         }
                     }
                     
+                    SimProfileSpanStop(profiler, &collisionSpan, phaseStart);
+                    
                 }
                 
             }
@@ -789,6 +1025,7 @@ if (![_world isStateOn:osPaused]) {
             //   only transform if piece is within borders to prevent stuttering
             //   do not transform if Peek is on
                 
+            phaseStart = SimProfileStart(profiler);
             [_world updateDirection:eachPiece];
             CGAffineTransform transformPiece = [_world imageTransform:eachPiece];
             
@@ -797,14 +1034,17 @@ if (![_world isStateOn:osPaused]) {
                     eachPiece.transform = transformPiece;
                 }
             }
+            SimProfileSpanStop(profiler, &transformSpan, phaseStart);
             
             Vector2D *paperDest;
             paperDest = [[Vector2D alloc] init];
             paperDest = [paperDest pointToVector:paperCenter];
             
             // finally move the stupid thing!
+            phaseStart = SimProfileStart(profiler);
             [eachPiece.behavior calculateForce:frameTime totalTime:_world.elapsedTime forPoint:paperDest];
             [eachPiece applyForce:[paperDest add:eachPiece.behavior.vRunning]];
+            SimProfileSpanStop(profiler, &forceSpan, phaseStart);
             
             // if the object is a Master of a group,
             //   move all the group Subs based on their offsets
@@ -828,7 +1068,7 @@ if (![_world isStateOn:osPaused]) {
                     if ((sID == eachPiece.spawnID) && (![eachPiece.behavior isOn:btFlee])) {
                         
                         CGRect spawnRect = CGRectMake(110, 40, 40, 120);
-                        int randSpawn = arc4random_uniform(1000)+1;
+                        int randSpawn = SimRandomNextUniform(&eachPiece->random, 1000)+1;
                         if ((CGRectContainsPoint(spawnRect, paperCenter)) && (randSpawn <= 30) && (![_world isStateOn:osMurene])) {
                             
                             // turn on World State and Timer
@@ -864,23 +1104,29 @@ if (![_world isStateOn:osPaused]) {
             
         }
         
-        // if the piece should be removed from the world, tag it;
-        //   this will only grab the last piece found in the update;
-        //   but the loop is called fast enough that multiple removes will
-        //     appear to occur simultaneously
-        if (eachPiece.remove) { removePiece = eachPiece; }
+        // if the piece should be removed from the world, queue it,
+        //   every flagged piece goes at the end of the frame
+        if (eachPiece.remove) { [_world addToDestroyQueue:eachPiece]; }
         
     }
+    SimProfilerRecord(profiler, spMove, 0, moveStart, SimProfileStart(profiler));
+    SimProfilerRecordSpan(profiler, spBounds, 0, &boundsSpan);
+    SimProfilerRecordSpan(profiler, spCollision, 0, &collisionSpan);
+    SimProfilerRecordSpan(profiler, spTransform, 0, &transformSpan);
+    SimProfilerRecordSpan(profiler, spForce, 0, &forceSpan);
 // end MOVE UPDATE
     
     
     // ___ WORLD TIMERS _______________________
     // update any world timers and handle completed ones
-    [_world updateWorldTimers:_world.fps];
+    phaseStart = SimProfileStart(profiler);
+    [_world updateWorldTimers:frameTime];
     [_world processWorldTimers];
+    SimProfilerRecord(profiler, spWorldTimers, 0, phaseStart, SimProfileStart(profiler));
     
     // ___ WORLD CLEANING ________________________
     // initiate fish cleaning if necessary
+    phaseStart = SimProfileStart(profiler);
     if ((_world.queue_clean.count >= _world.cleanMax) && (![_world isStateOn:osCleaning])) {
         
 #ifdef TEST_FLIGHT_ON
@@ -895,7 +1141,7 @@ if (![_world isStateOn:osPaused]) {
             [_world addObj:sPaper forDictionary:_world.objects_coll];
         }
         
-        [self.view addSubview:sPaper];
+        [_world addToView:sPaper];
         
         // Add seek/flee messages
         int spawnID = [[_world.queue_clean objectAtIndex:0] intValue];
@@ -903,101 +1149,106 @@ if (![_world isStateOn:osPaused]) {
         [_messenger queueObject:spawnID behavior:btFlee turnOn:YES target:sPaper.spawnID];
         
     }
+    SimProfilerRecord(profiler, spCleaning, 0, phaseStart, SimProfileStart(profiler));
 
     // ___ MESSAGE PROCESSING _________________________
+    phaseStart = SimProfileStart(profiler);
     [_messenger processQueue];
-    for (NSNumber *key in _world.queue_view) {
-        // add spawned views to the view controller
-        eachPiece = [_world.queue_view objectForKey:key];
-        [self.view addSubview:eachPiece];
-    }
-    [_world.queue_view removeAllObjects];
+    SimProfilerRecord(profiler, spMessages, 0, phaseStart, SimProfileStart(profiler));
     
     // ___ REMOVE UPDATE ______________________________
-    // so now that we aren't enumerating, remove the last flagged piece
-    //   from the world and view/layer
-    if (removePiece != nil) {
-        //NSLog(@"Remove Piece: %d|%d %@", removePiece.objID, removePiece.spawnID, removePiece.imagePath);
+    // so now that we aren't enumerating, remove every flagged piece
+    //   from the world and view/layer in one go
+    phaseStart = SimProfileStart(profiler);
+    if (_world.queue_destroy.count > 0) {
         
-        // play a sound if needed on remove
-        if (removePiece.objID == 37) {  // BLOWFISH EXPLODE
+        for (Paper *removePiece in _world.queue_destroy) {
+            //NSLog(@"Remove Piece: %d|%d %@", removePiece.objID, removePiece.spawnID, removePiece.imagePath);
             
-            //int randPlop = arc4random_uniform(5)+10;
-            int randPlop = 7;
-            [_world playSound:randPlop];
-        }
-        
-        [_world delObj:removePiece];
-        Paper *sPaper;
-        
-        // only do this if not part of an image swap (i.e. note -> notefish)
-        if ((removePiece.childImage > 0) && (!removePiece.manageRemove)) {
+            // play a sound if needed on remove
+            if (removePiece.objID == 37) {  // BLOWFISH EXPLODE
+                
+                //int randPlop = SimRandomUniform(5)+10;
+                int randPlop = 7;
+                [_world playSound:randPlop];
+            }
             
-            if (removePiece.paperType == Paper_Vector) {
-                //CGPoint spawnPoint = CGPointMake(removePiece.animShape.position.x + (removePiece.animShape.frame.size.width/2),
-                //                                 removePiece.animShape.position.y + (removePiece.animShape.frame.size.height/2));
-                CGPoint spawnPoint = removePiece.curvePoint;
-
-                sPaper = [_world spawnPiece:removePiece.childImage atPoint:spawnPoint];
+            Paper *sPaper;
+            
+            // only do this if not part of an image swap (i.e. note -> notefish)
+            if ((removePiece.childImage > 0) && (!removePiece.manageRemove)) {
                 
-                if (![sPaper.behavior viewCheck:vcCenterOnScreen atPoint:spawnPoint]) {
-                    // immediately remove if fish is off screen
-                    sPaper.remove = YES;
+                if (removePiece.paperType == Paper_Vector) {
+                    CGPoint spawnPoint = removePiece.curvePoint;
+                    
+                    sPaper = [_world spawnPiece:removePiece.childImage atPoint:spawnPoint];
+                    
+                    if (![sPaper.behavior viewCheck:vcCenterOnScreen atPoint:spawnPoint]) {
+                        // immediately remove if fish is off screen
+                        sPaper.remove = YES;
+                    }
+                    else {
+                        // add to the clean queue for later removal
+                        [_world addToCleanQueue:sPaper.spawnID];
+                    }
+                    
                 }
                 else {
-                    // add to the clean queue for later removal
-                    [_world addToCleanQueue:sPaper.spawnID];
+                    sPaper = [_world spawnPiece:removePiece isChild:YES];
                 }
                 
-            }
-            else {
-                sPaper = [_world spawnPiece:removePiece isChild:YES];
-            }
-            
-            // Add to collision manager if needed
-            if (sPaper.collision) {
-                [_world addObj:sPaper forDictionary:_world.objects_coll];
+                // Add to collision manager if needed
+                if (sPaper.collision) {
+                    [_world addObj:sPaper forDictionary:_world.objects_coll];
+                }
+                
+                [_world addToView:sPaper];
+                
             }
             
-            [self.view addSubview:sPaper];
+            // anything still waiting to be cleaned goes from the clean queue too
+            [_world.queue_clean removeObject:[NSNumber numberWithInt:removePiece.spawnID]];
             
+            // last, so the child spawn above can't be handed this piece back out of its pool
+            [removePiece removeFromSuperview];
+            [_world delObj:removePiece];
         }
         
-        [removePiece removeFromSuperview];
-        removePiece = nil;
-    }
-    
-    NSTimeInterval timeInterval;
-    
-    // for calculating / displaying the FPS
-    if (debugUpdate > (1/_world.fps)) {
-        
-        timeInterval = -1 / [start timeIntervalSinceNow];
-        
-#ifdef DEBUG_ON
-        [self updateTextLabel:deltaLabel gameTime:(1/trueFrameTime) loopTime:trueFrameTime];
-#endif
-        
-        // Reset debug update counter
-        debugUpdate = 0;
+        [_world.queue_destroy removeAllObjects];
     }
-    
-    // log framerate every 10 seconds
-    if (frameUpdate > ((1/_world.fps)*10)) {
-        timeInterval = -1 / [start timeIntervalSinceNow];
-        //NSLog(@"FPS: %f  Frametime (sec): %f", 1/trueFrameTime, trueFrameTime);
-        //NSLog(@"# of Objects: %u  MaxObjCount: %u", [_world.objects count], _world.numObjects);
-        frameUpdate = 0;
+    SimProfilerRecord(profiler, spRemove, 0, phaseStart, SimProfileStart(profiler));
+    
+    // ___ VIEW INSERT ______________________________
+    // everything spawned this frame, child respawns included, goes on
+    //   screen in one pass, on top of its layer zPosition and in the
+    //   order it came within a layer
+    phaseStart = SimProfileStart(profiler);
+    if (_world.queue_view.count > 0) {
+        [self placeViews:_world.queue_view underBorder:NO];
+        [_world.queue_view removeAllObjects];
     }
-    
-#ifdef DEBUG_ON
-    numObjects = [NSString stringWithFormat:@"[# of Objects: %u]",
-                           [_world.objects count]];
-    objectLabel.text = numObjects;
-#endif
+    SimProfilerRecord(profiler, spViewInsert, 0, phaseStart, SimProfileStart(profiler));
     
 }
+
+// adds pieces as subviews where the view layers put them, just under the
+//   piece above; with nothing above, scene rows still go under the border
+//   and spawned pieces on top of everything
+- (void)placeViews:(NSArray *)pieces underBorder:(BOOL)under {
     
+    for (Paper *viewPiece in [_world layerViews:pieces]) {
+        
+        Paper *abovePiece = [_world pieceAbove:viewPiece];
+        if (abovePiece) {
+            [self.view insertSubview:viewPiece belowSubview:abovePiece];
+        }
+        else if (under) {
+            [self.view insertSubview:viewPiece belowSubview:_world.border];
+        }
+        else {
+            [self.view addSubview:viewPiece];
+        }
+    }
 }
 
 - (void)updateTextLabel:(UILabel *)theLabel gameTime:(CGFloat)fTime loopTime:(CGFloat)lTime {
@@ -1035,6 +1286,10 @@ if (![_world isStateOn:osPaused]) {
     id layerDelegate;
     
     CGPoint touchPoint = [recognizer locationInView:self.view];
+    if (recognizer.state == UIGestureRecognizerStateEnded
+        || recognizer.state == UIGestureRecognizerStateChanged) {
+        SimJournalPinch(journal, touchPoint.x, touchPoint.y, recognizer.scale);
+    }
     pinchLayer = [self.view.layer.presentationLayer hitTest: touchPoint];
     // The layer delegate of a view is usually the view it's associated with.
     layerDelegate = [pinchLayer delegate];
@@ -1092,10 +1347,10 @@ if (![_world isStateOn:osPaused]) {
     // determine sound based on swipe direction
     int randSound;
     if (dirLeft) {
-        randSound = arc4random_uniform(2)+20;
+        randSound = SimRandomUniform(2)+20;
     }
     else {
-        randSound = arc4random_uniform(2)+22;
+        randSound = SimRandomUniform(2)+22;
     }
     
     [_world playSound:randSound];
@@ -1193,8 +1448,67 @@ double MachTimeToSecs(uint64_t time)
     
 }
 
+// the last SIM_PROFILE_HISTORY seconds of frames, as a Chrome trace
+//   and a per-phase CSV in the app's Documents directory
+- (void)writeFrameProfile {
+    
+    NSString *docs = [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    NSString *tracePath = [docs stringByAppendingPathComponent:@"frame_profile.json"];
+    NSString *csvPath = [docs stringByAppendingPathComponent:@"frame_profile.csv"];
+    
+    FILE *file = fopen([tracePath fileSystemRepresentation], "w");
+    if (file) {
+        SimProfilerWriteTrace(profiler, file);
+        fclose(file);
+    }
+    
+    file = fopen([csvPath fileSystemRepresentation], "w");
+    if (file) {
+        SimProfilerWriteCSV(profiler, file);
+        fclose(file);
+    }
+    
+    NSLog(@"Frame profile written to %@", docs);
+}
+
+// everything the story was given since it loaded, for simbench -replay,
+//   in the app's Documents directory
+- (void)writeInputJournal {
+    
+    NSString *docs = [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    NSString *journalPath = [docs stringByAppendingPathComponent:@"input_journal.pcj"];
+    
+    FILE *file = fopen([journalPath fileSystemRepresentation], "wb");
+    if (file) {
+        SimJournalWrite(journal, file);
+        fclose(file);
+    }
+    
+    SimJournalDestroy(journal);
+    journal = NULL;
+    
+    NSLog(@"Input journal written to %@", journalPath);
+}
+
 - (void)unloadPapercut {
     
+    // drop whatever is still loading, pieces already queued for the main thread see the new generation and skip
+    [_loadQueue cancelAllOperations];
+    loadGeneration++;
+    piecesLoading = 0;
+    [decodedRows removeAllIndexes];
+    traceFirstFrame = NO;
+    traceInteractive = NO;
+    [[StartupTrace theStartupTrace] finish];
+    
+#ifdef FRAME_PROFILE_ON
+    [self writeFrameProfile];
+#endif
+    
+#ifdef INPUT_JOURNAL_ON
+    [self writeInputJournal];
+#endif
+    
     // Release any retained subviews of the main view
     for (NSNumber *key in _world.objects) {
         
@@ -0,0 +1,32 @@
+//
+//  PathCache.h
+//  Papercut
+//
+//  Every SVG path the pieces use, parsed once.  Path movers (P_ files)
+//    and vector pieces (weeds and their morph targets) used to build a
+//    PocketSVG from the XML on every spawn.  Now the first spawn maps
+//    the path svgpathc compiled at build time (name.pcp, see
+//    SimCore/SimPathFormat.h) and every later one gets the same
+//    UIBezierPath back.  An SVG without a compiled path still goes
+//    through PocketSVG, but only the once.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+#import "Variables.h"
+
+@interface PathCache : NSObject {
+
+}
+
+@property (nonatomic, retain) NSMutableDictionary *paths;
+
++ (id) thePathCache;
+
+- (id)init;
+
+// the same name PocketSVG's initFromSVGFileNamed: takes, nil if there's no such path;
+//   safe from any thread, scene loading warms the cache on workers
+- (UIBezierPath*)bezierNamed:(NSString*)name;
+
+@end
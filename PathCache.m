@@ -0,0 +1,120 @@
+//
+//  PathCache.m
+//  Papercut
+//
+//  Every SVG path the pieces use, mapped from its compiled .pcp or
+//    parsed once.
+//
+
+#import "PathCache.h"
+#import "PocketSVG.h"
+#import "SimCore/SimPathFormat.h"
+
+static PathCache *mySharedPathCache = nil;
+
+@interface PathCache ()
+
+- (UIBezierPath*)loadCompiledPath:(NSString*)name;
+
+@end
+
+@implementation PathCache
+
+@synthesize paths;
+
++ (id) thePathCache {
+    @synchronized([PathCache class]) {
+        if (!mySharedPathCache) { mySharedPathCache = [[self alloc] init]; }
+    }
+    return mySharedPathCache;
+}
+
++ (id) alloc
+{
+    @synchronized([PathCache class])
+    {
+        NSAssert(mySharedPathCache == nil, @"Attempted to allocate a second instance of the PathCache.");
+        mySharedPathCache = [super alloc];
+        return mySharedPathCache;
+    }
+
+    return nil;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    return self;
+}
+
+- (id)init {
+    self = [super init];
+    if(nil != self)
+    {
+        paths = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (UIBezierPath*)bezierNamed:(NSString*)name {
+
+    // looked up and loaded under the one lock, so each path is loaded
+    //   exactly once; compiled paths are only mapped, so workers loading
+    //   a scene don't wait on each other for long
+    @synchronized(self) {
+        UIBezierPath *tBezier = [paths objectForKey:name];
+        if (tBezier) { return tBezier; }
+
+        // compiled at build time, otherwise parse the SVG this one time
+        tBezier = [self loadCompiledPath:name];
+        if (!tBezier) {
+            PocketSVG *tSVG = [[PocketSVG alloc] initFromSVGFileNamed:name];
+            tBezier = tSVG.bezier;
+        }
+
+        if (tBezier) { [paths setObject:tBezier forKey:name]; }
+        return tBezier;
+    }
+}
+
+- (UIBezierPath*)loadCompiledPath:(NSString*)name {
+
+    NSString *pathFile = [[NSBundle mainBundle] pathForResource:name ofType:@SIM_PATH_EXT];
+    if (!pathFile) { return nil; }
+
+    // read straight out of the mapped file, nothing is copied or parsed
+    NSData *pathData = [NSData dataWithContentsOfFile:pathFile options:NSDataReadingMappedAlways error:nil];
+    if (!SimPathValid([pathData bytes], [pathData length])) {
+        NSLog(@"PathCache: %@.%s is not a valid compiled path", name, SIM_PATH_EXT);
+        return nil;
+    }
+
+    const SimPathHeader *header = (const SimPathHeader*)[pathData bytes];
+    const uint8_t *commands = SimPathCommands([pathData bytes]);
+    const float *points = SimPathPoints([pathData bytes]);
+
+    UIBezierPath *tBezier = [UIBezierPath bezierPath];
+
+    for (uint32_t i = 0; i < header->numCommands; i++) {
+        switch (commands[i]) {
+            case pcMove:
+                [tBezier moveToPoint:CGPointMake(points[0], points[1])];
+                break;
+            case pcLine:
+                [tBezier addLineToPoint:CGPointMake(points[0], points[1])];
+                break;
+            case pcCubic:
+                [tBezier addCurveToPoint:CGPointMake(points[4], points[5])
+                           controlPoint1:CGPointMake(points[0], points[1])
+                           controlPoint2:CGPointMake(points[2], points[3])];
+                break;
+            case pcClose:
+                [tBezier closePath];
+                break;
+        }
+        points += SimPathCommandPoints(commands[i]) * 2;
+    }
+
+    return tBezier;
+}
+
+@end
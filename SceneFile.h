@@ -0,0 +1,43 @@
+//
+//  SceneFile.h
+//  Papercut
+//
+//  A story's property tables read from a .pcs file (written by
+//    SimCore's scenec, see SimCore/SimSceneFormat.h) instead of the
+//    tables compiled into Variables.h.  The file is memory-mapped and
+//    used in place: each row is read straight out of the mapped columns
+//    into the struct ObjManager already passes Paper by value, with
+//    every string pointing into the mapping.  Opening another story is
+//    a mmap and a header check, nothing is parsed or copied up front.
+//
+//  Rows are numbered as in Variables.h, row 0 being the border / dummy
+//    row.  A row past the end of its table reads as all zeroes.
+//
+
+#import <Foundation/Foundation.h>
+#import "Variables.h"
+#import "SimCore/SimSceneFormat.h"
+
+@interface SceneFile : NSObject {
+
+}
+
+@property (nonatomic, retain, readonly) NSData *data;       // the mapped file
+@property (nonatomic, retain, readonly) NSString *name;     // the story's name, as scenec wrote it
+
++ (SceneFile*) sceneNamed:(NSString*)name;                  // name.pcs from the bundle, nil if missing or invalid
+
+- (id)initWithContentsOfFile:(NSString*)path;
+
+- (int)numRows:(SimSceneTableID)table;                      // including row 0
+- (int)rowForObjID:(int)objID;                              // props row, -1 if there's no such object
+
+- (PaperProps)propsRow:(int)row;
+- (PaperPropsAnim)animRow:(int)row;
+- (PaperPropsTouchspot)touchRow:(int)row;
+- (PaperGroups)groupsRow:(int)row;
+- (PaperRandom)randomRow:(int)row;
+- (PaperPropsSounds)soundsRow:(int)row;
+- (PaperWorldTimers)timersRow:(int)row;
+
+@end
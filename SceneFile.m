@@ -0,0 +1,118 @@
+//
+//  SceneFile.m
+//  Papercut
+//
+//  A story's property tables, mapped from a .pcs file and read in place.
+//
+
+#import "SceneFile.h"
+#import "SimCore/SimSceneSchema.h"
+
+@interface SceneFile () {
+    const SimSceneTable *tables[scNumTables];       // into data, NULL if the file doesn't have one
+}
+
+@property (nonatomic, retain, readwrite) NSData *data;
+@property (nonatomic, retain, readwrite) NSString *name;
+
+- (void)gatherRow:(int)row ofTable:(SimSceneTableID)table into:(void*)out;
+
+@end
+
+@implementation SceneFile
+
+@synthesize data, name;
+
++ (SceneFile*) sceneNamed:(NSString*)sceneName {
+
+    NSString *sceneFile = [[NSBundle mainBundle] pathForResource:sceneName ofType:@SIM_SCENE_EXT];
+    if (!sceneFile) { return nil; }
+
+    return [[SceneFile alloc] initWithContentsOfFile:sceneFile];
+}
+
+- (id)initWithContentsOfFile:(NSString*)path {
+    self = [super init];
+    if(nil != self)
+    {
+        // mapped, the rows are read straight out of the file
+        data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:nil];
+        if (!SimSceneValid([data bytes], [data length])) {
+            NSLog(@"SceneFile: %@ is not a valid scene file", path);
+            return nil;
+        }
+
+        for (int i = 0; i < scNumTables; i++) {
+            tables[i] = SimSceneFindTable([data bytes], i);
+        }
+
+        name = [NSString stringWithUTF8String:SimSceneName([data bytes])];
+    }
+    return self;
+}
+
+- (int)numRows:(SimSceneTableID)table {
+    return (tables[table]) ? (int)tables[table]->numRows : 0;
+}
+
+- (int)rowForObjID:(int)objID {
+    return SimSceneRowForObjID([data bytes], tables[scRows], objID);
+}
+
+- (void)gatherRow:(int)row ofTable:(SimSceneTableID)table into:(void*)out {
+
+    int numFields;
+    size_t rowSize;
+    SimSceneSchema(table, &numFields, &rowSize);
+
+    if ((tables[table] == NULL) || (row < 0)) {
+        memset(out, 0, rowSize);
+        return;
+    }
+
+    SimSceneGatherRow([data bytes], tables[table], (uint32_t)row, out);
+}
+
+- (PaperProps)propsRow:(int)row {
+    PaperProps prp;
+    [self gatherRow:row ofTable:scProps into:&prp];
+    return prp;
+}
+
+- (PaperPropsAnim)animRow:(int)row {
+    PaperPropsAnim prpAnim;
+    [self gatherRow:row ofTable:scAnim into:&prpAnim];
+    return prpAnim;
+}
+
+- (PaperPropsTouchspot)touchRow:(int)row {
+    PaperPropsTouchspot prpTouch;
+    [self gatherRow:row ofTable:scTouch into:&prpTouch];
+    return prpTouch;
+}
+
+- (PaperGroups)groupsRow:(int)row {
+    PaperGroups prpGroup;
+    [self gatherRow:row ofTable:scGroups into:&prpGroup];
+    return prpGroup;
+}
+
+- (PaperRandom)randomRow:(int)row {
+    PaperRandom prpRandom;
+    [self gatherRow:row ofTable:scRandom into:&prpRandom];
+    return prpRandom;
+}
+
+- (PaperPropsSounds)soundsRow:(int)row {
+    PaperPropsSounds prpSound;
+    [self gatherRow:row ofTable:scSounds into:&prpSound];
+    return prpSound;
+}
+
+- (PaperWorldTimers)timersRow:(int)row {
+    PaperWorldTimers prpTimer;
+    [self gatherRow:row ofTable:scTimers into:&prpTimer];
+    return prpTimer;
+}
+
+@end
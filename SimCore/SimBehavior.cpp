@@ -0,0 +1,945 @@
+//
+//  SimBehavior.cpp
+//  Papercut
+//
+//  Headless counterpart of Behavior.  Encapsulates all movement / steering
+//    behaviors for an object and calculates the final force applied to the
+//    object's position each frame, exactly as Behavior does.
+//
+//  Portions of this class were derived from the SteeringBehaviors class
+//    written by Mat Buckland (c) 2002, found in the book "Programming Game AI by Example".
+//    More info at ai-junkie.com.
+//
+
+#include "SimBehavior.h"
+#include "SimPaper.h"
+#include "SimWorld.h"
+
+SimBehavior::SimBehavior()
+    : velX(0.0), velY(0.0), pSelf(NULL), world(NULL), iFlags(0),
+      decelType(Decel_None), flip(1), flipX(NO), bobAmp(0.0), bobOffset(0.0),
+      spawnCount(0), spawnCountCheck(0), bSpeed(0.0), bKillOnArrive(NO), bFlocking(NO),
+      rVelMax(0.0), rVelMin(0.0), fixedDir(NO), animFrameDur(0.0), autoReverse(NO),
+      rotateAngle(0.0), rotateAngleMemory(0.0), angledPath(NO), viewCheckType(vcNone),
+      peekTime(0.0), sinkAngle(0.0), sinkAngleInterval(0.0),
+      timerMask(0), timerWheel(NULL), weightSeparation(1.0), weightAlignment(0.5), weightCohesion(0.1) {
+}
+
+void SimBehavior::turnOn(BehaviorType bt, int targetID) {
+
+    if (isOn(bt)) { return; }
+
+    SimHandle target;
+    if (targetID > 0) {
+        SimPaper *pTarget = world->getObject(targetID);
+        if (pTarget != NULL) { target = pTarget->handle; }
+    }
+
+    switch (bt) {
+        case btSeek:    SeekOn(target);     break;
+        case btFlee:    FleeOn(target);     break;
+        default:                            break;
+    }
+}
+
+void SimBehavior::turnOnFlocking() {
+    turnOn(btSeparation);
+    turnOn(btAlignment);
+    turnOn(btCohesion);
+}
+
+void SimBehavior::BobOn(CGFloat bAmp, CGFloat bOffset) {
+    iFlags |= btBob;
+    bobAmp = bAmp;
+    bobOffset = bOffset;
+}
+
+void SimBehavior::SeekOn(SimHandle target) {
+    turnOn(btSeek);
+    pTarget1 = target;
+}
+
+void SimBehavior::FleeOn(SimHandle target) {
+    turnOn(btFlee);
+    pTarget1 = target;
+}
+
+int SimBehavior::timerSlot(BehaviorType bt) {
+    int slot = 0;
+    while ((slot < SIM_NUM_BEHAVIORS) && (bt != (1 << slot))) { slot++; }
+    return slot;
+}
+
+BOOL SimBehavior::onWheel(BehaviorType bt) {
+    // toroid only counts down off screen and axisflip only while moving,
+    //   so those two are updated by hand every frame
+    return ((bt != btToroid) && (bt != btAxisflip));
+}
+
+void SimBehavior::addTimer(const SimTimer &objTimer, BehaviorType bt) {
+
+    int slot = timerSlot(bt);
+    if (slot >= SIM_NUM_BEHAVIORS) { return; }
+
+    SimTimer &bTimer = timers[slot];
+    bTimer = objTimer;
+    timerMask |= bt;
+
+    if ((timerWheel != NULL) && (onWheel(bt))) { bTimer.attach(timerWheel); }
+}
+
+SimTimer* SimBehavior::timer(BehaviorType bt) {
+    if ((bt == btNone) || ((timerMask & bt) != bt)) { return NULL; }
+    return &timers[timerSlot(bt)];
+}
+
+const SimTimer* SimBehavior::timer(BehaviorType bt) const {
+    if ((bt == btNone) || ((timerMask & bt) != bt)) { return NULL; }
+    return &timers[timerSlot(bt)];
+}
+
+void SimBehavior::attachTimers(SimTimerWheel *wheel) {
+
+    timerWheel = wheel;
+
+    for (int slot = 0; slot < SIM_NUM_BEHAVIORS; slot++) {
+        BehaviorType bt = (BehaviorType)(1 << slot);
+        if (((timerMask & bt) == bt) && (onWheel(bt))) { timers[slot].attach(timerWheel); }
+    }
+}
+
+void SimBehavior::turnTimer(BehaviorType bt, BOOL isOn) {
+    SimTimer *bTimer = timer(bt);
+    if (bTimer == NULL) { return; }
+    if (isOn)   { bTimer->turnTimerOn(); }
+    else        { bTimer->turnTimerOff(); }
+}
+
+void SimBehavior::updateTimers(CGFloat interval) {
+
+    SimTimer *bTimer = timer(btToroid);
+    if ((bTimer != NULL) && (bTimer->isTimerOn())) {
+        // only update toroid if view off screen
+        if (viewCheck(vcCompletelyOffScreen)) { bTimer->timerUpdate(interval); }
+    }
+
+    bTimer = timer(btAxisflip);
+    if ((bTimer != NULL) && (bTimer->isTimerOn())) {
+        // only update axisflip if object moving
+        if (vel.length() != 0.0) { bTimer->timerUpdate(interval); }
+    }
+}
+
+void SimBehavior::accumulateForce(SimVector force) {
+    SimIntegrator::accumulateForce(vRunning, force);
+}
+
+void SimBehavior::calculateForce(CGFloat frameTime, CGFloat elapsedTime, SimVector pos) {
+
+    // Prioritized calculations - once it hits MAX_FORCE in accumulateForce,
+    //   additional forces are ignored
+
+    SimMessenger &messenger = world->messenger;
+    SimTimer *fTimer;
+    SimPaper *fPiece;
+    SimPaper *target = world->getObject(pTarget1);
+
+    int fObjID              = pSelf->objID;
+    int fDir                = pSelf->dir;
+    int fSpawnID            = pSelf->spawnID;
+    PaperType fPaperType    = pSelf->paperType;
+
+    // reset running force
+    beginForce();
+    SimVector newForce;
+    SimVector currPos = pos;
+
+
+// WAITING
+// if this is on, it freezes the object
+if (isOn(btWait)) {
+    fTimer = timer(btWait);
+    if ((fTimer != NULL) && (fTimer->timerComplete())) {
+
+        // reset Wait timer and turn it off
+        fTimer->timerReset();
+        fTimer->turnTimerOff();
+        turnOff(btWait);
+
+        // special handling
+        if (fObjID == 33) {
+            pSelf->alpha = 1.0;     // unhide image
+            turnOn(btPeek);
+            turnTimer(btPeek, YES);
+
+            if (world->leftTopHalf(pSelf)) {
+                pSelf->orientation = -1;
+            }
+        }
+
+    }
+}
+
+
+// ONLY PROCESS BEHAVIOR IF WAIT IS OFF
+else {
+
+    // CLEANER FISH CHECK
+    if ((fObjID == 25) && (!world->isStateOn(osCleaning)))  {
+        if (viewCheck(vcCompletelyOffScreen)) {
+            // kill object if off-screen
+            pSelf->remove = YES;
+        }
+    }
+
+
+    // NON-FORCE BEHAVIOR PROCESSING
+
+    updateFlipAnim();
+
+    // ___ PEEK
+    if (isOn(btPeek)) {
+        fTimer = timer(btPeek);
+        CGFloat fraction = 0.0;
+
+        if (fTimer != NULL) {
+            if (fTimer->timerComplete()) {
+                vel.x *= -1;
+            }
+            fraction = fTimer->intervalFraction();
+        }
+
+        rotateAngle = atanf(fraction * 0.5) * fDir;
+        if (world->leftTopHalf(pSelf)) {
+            rotateAngle *= -1;
+        }
+    }
+
+
+    // FORCE PROCESSING
+
+    // ___ FLEE
+    if ((isOn(btFlee)) && (target != NULL)) {
+
+        SimVector targetPos(world->pieceState.center(target));
+        newForce = currPos;
+        newForce.sub(targetPos);
+
+        // only flee if target is closer than the panic distance
+        if (newForce.length() < (BUFFER_DISTANCE + 40)) {
+            newForce.normalize();
+            if (bSpeed == 0.0) { newForce.mult(MAX_FORCE); }
+            else               { newForce.mult(bSpeed); }
+            newForce.sub(vel);
+
+            accumulateForce(newForce);
+            vel.add(newForce);
+
+            // find the rotation angle to the target in radians
+            rotateAngle = atan2f((targetPos.y - currPos.y), (targetPos.x - currPos.x));
+
+            if (fDir == -1) {
+                rotateAngle += M_PI;
+            }
+
+            // set the memory angle
+            rotateAngleMemory = rotateAngle;
+
+        }
+        newForce.zero();
+    }
+
+    // [ FLOCKING ]
+    if ((isOn(btSeparation)) || (isOn(btAlignment)) || (isOn(btCohesion))) {
+
+        // ___ FIND NEIGHBORS
+        const std::vector<SimPaper*> &neighbors = world->findNeighbors(pSelf);
+
+        // now process each individual flocking behavior
+
+        // ___ SEPARATION
+        if (isOn(btSeparation)) {
+
+            for (size_t i = 0; i < neighbors.size(); i++) {
+
+                fPiece = neighbors[i];
+
+                SimVector sDist = currPos - SimVector(world->pieceState.center(fPiece));
+
+                CGFloat lDist = sDist.length();
+                newForce += sDist.normalize() / lDist;
+            }
+
+            newForce.mult(weightSeparation);
+            accumulateForce(newForce);
+            newForce.zero();
+        }
+
+        // ___ ALIGNMENT
+        if (isOn(btAlignment)) {
+
+            int nCount = (int)neighbors.size();
+
+            for (size_t i = 0; i < neighbors.size(); i++) {
+                newForce.add(world->pieceState.velocity(neighbors[i]));
+            }
+
+            // only process if one or more neighbors
+            if (nCount > 0) {
+
+                newForce.div((float)nCount);
+                newForce.sub(vel);
+
+                newForce.mult(weightAlignment);
+                accumulateForce(newForce);
+                newForce.zero();
+            }
+        }
+
+        // ___ COHESION
+        if (isOn(btCohesion)) {
+
+            int nCount = (int)neighbors.size();
+            SimVector mCenter;
+
+            for (size_t i = 0; i < neighbors.size(); i++) {
+                mCenter.add(SimVector(world->pieceState.center(neighbors[i])));
+            }
+
+            // only process if one or more neighbors
+            if (nCount > 0) {
+
+                mCenter.div((float)nCount);
+
+                // find the seek velocity to the center of mass and
+                //   normalize it to lessen the magnitude
+                newForce.add(calculateSeekVelocity(mCenter));
+                newForce.normalize();
+
+                newForce.mult(weightAlignment);
+                //accumulateForce(newForce);
+                newForce.zero();
+            }
+        }
+
+        // just in case
+        newForce.zero();
+    }
+
+
+    // ___ DRIFT, BOB & DECEL
+    updateDrift();
+    if (SimIntegrator::integrateCommon(vRunning, vel, forceParams(elapsedTime))) {
+        pSelf->stopAnimating();
+    }
+
+    // ___ SINK
+    if (isOn(btSink)) {
+        fTimer = timer(btSink);
+        BOOL sinkTimerOn       = (fTimer != NULL) && (fTimer->isTimerOn());
+        BOOL sinkTimerComplete = (fTimer != NULL) && (fTimer->timerComplete());
+        CGFloat sinkInterval   = (fTimer != NULL) ? fTimer->interval() : 0.0;
+        sinkAngleInterval = sinkAngle / (sinkInterval / world->fps);
+
+        // if the timer is off, it's still floating down
+        if (!sinkTimerOn) {
+
+            if (rotateAngleMemory <= sinkAngle) {
+                rotateAngleMemory += sinkAngleInterval;
+            }
+
+            rotateAngle = rotateAngleMemory;
+
+            if (!viewCheck(vcOnScreenWithinHalfBorder)) {
+                // if it starts to go below the border, stop it,
+                //   disable touch and start timer
+                vel.zero();
+                turnOff(btBob);
+                if (fTimer != NULL) { fTimer->turnTimerOn(); }
+            }
+        }
+
+        // if timer is on, rotate object as necessary
+        if ((sinkTimerOn) && (!sinkTimerComplete)) {
+            rotateAngle = rotateAngleMemory;
+        }
+
+        // if the timer is on and complete, start to sink it slowly
+        if (sinkTimerComplete) {
+            vel.y = 0.1;
+        }
+
+        // once the view is off screen, kill it
+        if (viewCheck(vcCompletelyOffScreen)) {
+            pSelf->remove = YES;
+            world->objects.clearTagAll(otShake);
+        }
+    }
+
+    // ___ SEEK
+    if ((isOn(btSeek)) && (target != NULL)) {
+        newForce = SimVector(world->pieceState.center(target));
+        fTimer = timer(btSeek);
+
+        SimVector targetPos = newForce;
+
+        newForce.sub(currPos);
+
+        // only seek if the delay timer is off
+        if ((fTimer == NULL) || (!fTimer->isTimerOn())) {
+
+            // catch instances where the target is almost at the buffer distance
+            if ((newForce.length() > BUFFER_DISTANCE) && (newForce.length() < BUFFER_DISTANCE * 2.5)) {
+
+                // CLEANER FISH / MURENE eating animation - freeze target and fire animation early
+                if ((fObjID == 25) || (fObjID == 44)) {
+                    target->behavior.turnOffAll();
+                    target->behavior.vel.zero();
+                    pSelf->startAnimating();
+                }
+            }
+
+            // for Murene, if it gets close to the midpoint of the screen,
+            //   kill the seek/flee and retreat
+            else if ((fObjID == 44) && (currPos.x > 350)) {
+
+                turnOff(btSeek);                                                // turn off seek
+                messenger.queueObject(target->spawnID, btFlee, NO, 0);          // turn off flee for target
+
+                // set new velocity
+                vel.x *= -0.5;
+                vel.y = 0.0;
+            }
+
+            // seek as normal if still far away
+            else if (newForce.length() > BUFFER_DISTANCE) {
+
+                // only seek if target is farther away than buffer distance
+                newForce.normalize();
+                if (bSpeed == 0.0) { newForce.mult(MAX_FORCE); }
+                else               { newForce.mult(bSpeed); }
+                newForce.sub(vel);
+
+                accumulateForce(newForce);
+                vel.add(newForce);
+
+                // find the rotation angle to the target in radians
+                rotateAngle = atan2f((targetPos.y - currPos.y), (targetPos.x - currPos.x));
+
+                if (fDir == -1) {
+                    rotateAngle += M_PI;
+                }
+            }
+
+            // otherwise we have reached the target
+            else {
+
+                // CLEANER FISH
+                if (fObjID == 25) {
+                    messenger.queueObject(target->spawnID, mtSpawn, NO, 0);     // kill current target
+                    world->removeFromCleanQueue(target->handle);                // remove from queue_clean
+                    turnOff(btSeek);                                            // turn off seek
+
+                    // the queue can run dry before the seek delay ends
+                    if (!world->queue_clean.empty()) {
+                        SimHandle newTarget = world->queue_clean[0];
+                        SeekOn(newTarget);
+                        if (fTimer != NULL) { fTimer->turnTimerOn(); }          // turn on seek delay timer
+
+                        SimPaper *tPaper = world->getObject(newTarget);        // get the object that should flee
+                        if (tPaper != NULL) { tPaper->behavior.FleeOn(pSelf->handle); }
+                    }
+                }
+
+                // MURENE
+                if (fObjID == 44) {
+                    messenger.queueObject(target->spawnID, mtSpawn, NO, 0);     // kill current target
+                    world->removeFromCleanQueue(target->handle);                // remove from queue_clean
+                    turnOff(btSeek);                                            // turn off seek
+
+                    // set new velocity
+                    vel.x *= -0.5;
+                    vel.y = 0.0;
+                }
+            }
+            newForce.zero();
+        }
+
+        // if the seek delay timer is complete, handle
+        else if (fTimer->timerComplete()) {
+
+            if ((int)world->queue_clean.size() <= world->cleanMin) {
+                // cleaner fish should exit screen
+                turnOff(btSeek);
+                world->turnOffState(osCleaning);
+            }
+            fTimer->timerReset();
+            fTimer->randomizeInterval(&pSelf->random);
+            fTimer->turnTimerOff();
+        }
+    }
+
+    // ___ TOROID (RESPAWNING)
+    if (isOn(btToroid)) {
+
+        fTimer = timer(btToroid);
+
+        if ((fTimer != NULL) && (fTimer->timerComplete())) {
+
+            // reset timer
+            fTimer->timerReset();
+
+            // change the appropriate center point based on the flip axis,
+            //    border and image halfsize are used to ensure the image
+            //    always remains in view
+            int xSpawnOffset = world->borderWidth + pSelf->halfSize.x;
+            int ySpawnOffset = world->borderWidth + pSelf->halfSize.y;
+
+            // since toroid resets the position, clear out any previous running force
+            //   as it won't apply during this update step
+            vRunning.zero();
+
+            // calculate new center point
+            if (flipX) {
+                if (pSelf->posSpawn.x < 0)  { vRunning.x = -xSpawnOffset; }
+                else                        { vRunning.x = xSpawnOffset + world->viewWidth; }
+
+                if (fObjID == 28) {  // DIVER should stay near the top
+                    vRunning.y = (SimRandomNext(&pSelf->random) % (150 - ySpawnOffset)) + ySpawnOffset;
+                }
+                else {
+                    vRunning.y = (SimRandomNext(&pSelf->random) % (world->viewHeight - (ySpawnOffset * 2))) + ySpawnOffset;
+                }
+            }
+            else {
+                if (pSelf->posSpawn.y < 0) {
+                    vRunning.y = -ySpawnOffset;
+                    if (fPaperType == Paper_Vector) { vRunning.y -= 20.0; }
+                }
+                else { vRunning.y = ySpawnOffset + world->viewHeight; }
+                vRunning.x = (SimRandomNext(&pSelf->random) % (world->viewWidth - (xSpawnOffset * 2))) + xSpawnOffset;
+            }
+
+            // if path is angled, create new velocity and rotate angle
+            if (angledPath) {
+                int bAngle = 1;
+                if (SimRandomNextFloat(&pSelf->random) > 0.5) { bAngle = -1; }
+
+                if (flipX) {
+                    vel.y = SimRandomNextRange(&pSelf->random, bSeekOffset.x, bSeekOffset.y);
+                    velY = vel.y * bAngle;
+                }
+                else {
+                    vel.x = SimRandomNextRange(&pSelf->random, bSeekOffset.x, bSeekOffset.y);
+                    velX = vel.x * bAngle;
+                }
+            }
+
+            // if toroid on a vector, hide it so we don't see it move
+            //  across the screen to the new position
+            if (fPaperType == Paper_Vector) {
+                pSelf->alpha = 0.0;
+            }
+
+            // set the difference between new point and old point to the force
+            vRunning.sub(pos);
+
+            // increment spawn count or kill object if respawn limit is reached
+            if (spawnCount != 0) {
+                if (spawnCountCheck < spawnCount) {
+                    spawnCountCheck++;
+                }
+                else {
+                    messenger.queueObject(fSpawnID, mtSpawn, NO, 0);
+                }
+            }
+        }
+
+        // set the rotate angle if on an angled path
+        toroidRotate(fDir);
+    }
+
+    // OFF-SCREEN CHECK
+    //  for things that need to happen after behavior updates
+    if (viewCheck(vcCompletelyOffScreen)) {
+
+        // PEEK RESET
+        //  set a new position, orientation and turn on peek timer
+        if ((fObjID == 33) && (!isOn(btPeek)) && (peekTime > 0.0)) {
+
+            // overwrite running force since we're changing the position
+            vRunning.zero();
+
+            // set new position based on which side of the screen it's on
+            if (world->leftTopHalf(pSelf)) {    // left side
+                vRunning.x = -pSelf->childSpawn.x;
+                vel.x = -velX;
+                pSelf->orientation = 1;
+            }
+            else {  // right side
+                vRunning.x = world->viewWidth + pSelf->childSpawn.x;
+                vel.x = velX;
+                pSelf->orientation = -1;
+            }
+
+            int ySpawnOffset = world->borderWidth + (2 * pSelf->halfSize.y);
+            vRunning.y = (SimRandomNext(&pSelf->random) % (world->viewHeight - (ySpawnOffset * 2))) + ySpawnOffset;
+            vRunning.sub(pos);
+
+            // reset velocity
+            vel.y = velY;
+
+            // turn on Wait behavior and timer
+            turnOn(btWait);
+            turnTimer(btWait, YES);
+            pSelf->alpha = 0.0;     // hide image
+        }
+    }
+
+    vRunning.mult(frameTime * 60);
+
+}   // end Wait
+
+}
+
+void SimBehavior::beginForce() {
+
+    // reset running force
+    vRunning.zero();
+    rotateAngle = 0.0;
+
+    // reinstate the end rotation for fleeing fish that are frozen
+    if ((rotateAngleMemory != 0.0) && (areAllBehaviorsOff())) {
+        rotateAngle = rotateAngleMemory;
+    }
+}
+
+void SimBehavior::updateFlipAnim() {
+
+    SimTimer *fTimer;
+
+    // ___ FLIP
+    if (isOn(btAxisflip)) {
+        fTimer = timer(btAxisflip);
+        if (fTimer != NULL) {
+            if (fTimer->timerComplete()) {
+                fTimer->timerReset();
+
+                flip = -flip;     // switch flip direction
+            }
+            else if (vel.length() != 0.0) { fTimer->timeCheck += world->fps; }   // INCREMENT
+        }
+    }
+
+    // ___ ANIM
+    if (isOn(btAnimframe)) {
+        fTimer = timer(btAnimframe);
+        if ((fTimer != NULL) && (fTimer->timerComplete())) {
+            fTimer->timerReset();
+            pSelf->startAnimating();
+            pSelf->frameAnimCompleteIn = animFrameDur;
+        }
+    }
+}
+
+void SimBehavior::updateDrift() {
+
+    // everything drift does besides adding vel to the running force,
+    //   which is left to the integrator
+    if (!isOn(btDrift)) { return; }
+
+    SimTimer *fTimer = timer(btRandvel);
+
+    // check for randomized velocity first
+    if ((isOn(btRandvel)) && (fTimer != NULL) && (fTimer->timerComplete())) {
+
+        // reset time check
+        fTimer->timerReset();
+        vel.zero();
+
+        // randomly choose a velocity
+        CGFloat randVel = SimRandomNextRange(&pSelf->random, rVelMax, rVelMin);
+        if (!pSelf->isAnimating()) { pSelf->startAnimating(); }
+
+        // randomly choose a direction and apply to vel based on flipX
+        int rDir = 1;
+        if (SimRandomNextFloat(&pSelf->random) > 0.5) { rDir = -1; }
+        pSelf->dir = rDir;
+
+        // determine new force
+        if (flipX)   { vel.x = randVel * rDir; }
+        else         { vel.y = randVel * rDir; }
+
+        // randomize the interval
+        fTimer->randomizeInterval(&pSelf->random);
+    }
+
+    // adjust for accelerometer
+#ifdef ACCEL_ON
+    if ((pSelf->moveType == Move_Touch) && (pSelf->bounded) && (world->optInteract)) {
+        if (fabsf(world->accelX) > TILT_THRESHOLD) {     // only move if tilted far enough
+
+            // Only add vel if under the tilt cap
+            if (fabsf(vel.x) < TILT_FORCE_CAP) {
+                vel.x += ((world->accelX / 1.5) / pSelf->mass);
+            }
+
+            pSelf->startAnimating();
+        }
+    }
+#endif
+
+    // animate toroid, non-animframe timer object if moving
+    //   just in case
+    if ((vel.lengthSquared() > 0.0) &&
+        (!pSelf->isAnimating()) &&
+        (isOn(btToroid)) &&
+        (!isOn(btAnimframe))) {
+        pSelf->startAnimating();
+    }
+
+    // set the rotate angle if on an angled path from peek
+    if ((angledPath) && (!isOn(btPeek)) && (!isOn(btToroid))) {
+        rotateAngle = atanf(vel.y / vel.x);
+    }
+
+    // check for drift back removal (only Murene for now)
+    if (pSelf->objID == 44) {
+        if (viewCheck(viewCheckType)) {
+            world->turnOffState(osMurene);
+            vel.zero();
+        }
+    }
+}
+
+SimForceParams SimBehavior::forceParams(CGFloat elapsedTime) const {
+
+    SimForceParams params;
+    params.flags = ifNone;
+    params.bobOff = 0.0;
+    params.decelMod = 0.0;
+
+    if (isOn(btDrift))  { params.flags |= ifDrift; }
+    if (flipX)          { params.flags |= ifFlipX; }
+    if (angledPath)     { params.flags |= ifAngled; }
+
+    if (isOn(btBob)) {
+        params.flags |= ifBob;
+        params.bobOff = cosf(elapsedTime + bobOffset) / bobAmp;
+    }
+
+    if (isOn(btDecel)) {
+        params.flags |= ifDecel;
+        params.decelMod = -(0.1 / decelType);
+        if (decelType == Decel_Stop) { params.flags |= ifDecelStop; }
+    }
+
+    return params;
+}
+
+void SimBehavior::toroidRotate(int fDir) {
+
+    if (!angledPath) { return; }
+
+    if (flipX) {    // horizontal
+        rotateAngle = atanf(velY / velX);
+        if (fDir == -1) {
+            rotateAngle += M_PI;
+        }
+    }
+    else {          // vertical
+        rotateAngle = -atanf(velX / velY);
+    }
+}
+
+BOOL SimBehavior::canBatchForce() const {
+
+    // only drift, bob and decel plus the timers that ride along with them,
+    //   anything that looks at other pieces or the world goes through calculateForce
+    const int batchFlags = btDrift | btRandvel | btBob | btDecel | btAnimframe | btAxisflip | btToroid;
+
+    if ((iFlags & ~batchFlags) != 0) { return NO; }
+
+    // cleaner fish, moray eel and peek have special cases mixed into the shared blocks
+    int fObjID = pSelf->objID;
+    if ((fObjID == 25) || (fObjID == 33) || (fObjID == 44)) { return NO; }
+
+    // a toroid respawn this frame replaces the running force outright
+    if (isOn(btToroid)) {
+        const SimTimer *tTimer = timer(btToroid);
+        if ((tTimer != NULL) && (tTimer->timerComplete())) { return NO; }
+    }
+
+    return YES;
+}
+
+void SimBehavior::prepareForce() {
+
+    // everything calculateForce does for a batchable piece up to the common forces,
+    //   plus the toroid rotate angle that comes after them but doesn't depend on them
+    int fDir = pSelf->dir;
+
+    beginForce();
+    updateFlipAnim();
+    updateDrift();
+
+    if (isOn(btToroid)) { toroidRotate(fDir); }
+}
+
+BOOL SimBehavior::prepareIsLocal() const {
+
+    // an animframe timer that completes is reset on the behavior wheel,
+    //   and a randvel one draws a new velocity as well
+    const SimTimer *pTimer;
+
+    if ((isOn(btAnimframe)) && ((pTimer = timer(btAnimframe)) != NULL) && (pTimer->timerComplete())) { return NO; }
+
+    if ((isOn(btDrift)) && (isOn(btRandvel)) &&
+        ((pTimer = timer(btRandvel)) != NULL) && (pTimer->timerComplete())) { return NO; }
+
+    return YES;
+}
+
+// used for Flocking, to calc the Seek velocity whether it's seeking or not
+SimVector SimBehavior::calculateSeekVelocity(SimVector centerOfMass) const {
+
+    SimVector newVel = centerOfMass - SimVector(pSelf->center);
+
+    newVel.normalize();
+    if (bSpeed == 0.0) { newVel.mult(MAX_FORCE); }
+    else               { newVel.mult(bSpeed); }
+    newVel.sub(vel);
+
+    return newVel;
+}
+
+BOOL SimBehavior::viewCheck(ViewCheckType vcType) const {
+    return viewCheck(vcType, SimPoint());
+}
+
+BOOL SimBehavior::viewCheck(ViewCheckType vcType, SimPoint point) const {
+
+    BOOL checkResult = NO;
+    SimRect screenRect;
+
+    CGFloat worldWidth = world->viewWidth;
+    CGFloat worldHeight = world->viewHeight;
+    CGFloat worldBorder = world->borderWidth;
+
+    SimPoint pCenter = (point.isZero()) ? pSelf->getCenterPoint() : point;
+
+    switch (vcType) {
+
+        case vcCompletelyOnScreen:
+            screenRect = SimRect(bHalfSize.x, bHalfSize.y,
+                                 worldWidth - (2 * bHalfSize.x),
+                                 worldHeight - (2 * bHalfSize.y));
+            if (screenRect.contains(pCenter)) { checkResult = YES; }
+            break;
+
+        case vcCenterOnScreen:
+            screenRect = SimRect(0, 0, worldWidth, worldHeight);
+            if (screenRect.contains(pCenter)) { checkResult = YES; }
+            break;
+
+        case vcOnScreenWithinBorder:
+            screenRect = SimRect(worldBorder, worldBorder,
+                                 worldWidth - (2 * worldBorder),
+                                 worldHeight - (2 * worldBorder));
+            if (screenRect.contains(pCenter)) { checkResult = YES; }
+            break;
+
+        case vcOnScreenWithinHalfBorder:
+            screenRect = SimRect(worldBorder - 10, worldBorder - 10,
+                                 worldWidth - (2 * (worldBorder + 3)),
+                                 worldHeight - (2 * (worldBorder + 2)));
+            if (screenRect.contains(pCenter)) { checkResult = YES; }
+            break;
+
+        case vcCompletelyOffScreen:
+            screenRect = SimRect(-bHalfSize.x, -bHalfSize.y,
+                                 worldWidth + (2 * bHalfSize.x),
+                                 worldHeight + (2 * bHalfSize.y));
+            if (!screenRect.contains(pCenter)) { checkResult = YES; }
+            break;
+
+        case vcWithinBoundedBox:  // note that this Rect doesn't extend below the ground
+            screenRect = SimRect(-2 * bHalfSize.x, -2 * bHalfSize.y,
+                                 worldWidth + (4 * bHalfSize.x),
+                                 worldHeight + bHalfSize.y);
+            if (screenRect.contains(pCenter)) { checkResult = YES; }
+            break;
+
+        case vcKeepOnGround:
+            screenRect = SimRect(0, worldHeight * 0.5,
+                                 worldWidth, worldHeight);
+            if (screenRect.contains(pCenter)) { checkResult = YES; }
+            break;
+
+        case vcNone:
+        default:
+            break;
+    }
+
+    return checkResult;
+}
+
+AxisType SimBehavior::axisHitCheck(ViewCheckType vcType) const {
+
+    AxisType axisResult = yAxis;
+    SimPoint pCenter = pSelf->getCenterPoint();
+
+    CGFloat worldHeight = world->viewHeight;
+    CGFloat worldBorder = world->borderWidth;
+
+    switch (vcType) {
+
+        case vcCompletelyOnScreen:
+            if ((pCenter.y < bHalfSize.y) ||
+                (pCenter.y > (worldHeight - bHalfSize.y))) {
+                axisResult = xAxis;
+            }
+            break;
+
+        case vcCenterOnScreen:
+            if ((pCenter.y < 0) ||
+                (pCenter.y > worldHeight)) {
+                axisResult = xAxis;
+            }
+            break;
+
+        case vcOnScreenWithinBorder:
+            if ((pCenter.y < worldBorder) ||
+                (pCenter.y > (worldHeight - worldBorder))) {
+                axisResult = xAxis;
+            }
+            break;
+
+        case vcCompletelyOffScreen:
+            if ((pCenter.y < -bHalfSize.y) ||
+                (pCenter.y > (worldHeight + bHalfSize.y))) {
+                axisResult = xAxis;
+            }
+            break;
+
+        case vcWithinBoundedBox:
+            if ((pCenter.y < -bHalfSize.y) ||
+                (pCenter.y > (worldHeight - bHalfSize.y))) {
+                axisResult = xAxis;
+            }
+            break;
+
+        case vcKeepOnGround:
+            if ((pCenter.y < (worldHeight * 0.5)) ||
+                (pCenter.y > worldHeight)) {
+                axisResult = xAxis;
+            }
+            break;
+
+        case vcNone:
+        default:
+            break;
+    }
+
+    return axisResult;
+}
@@ -0,0 +1,128 @@
+//
+//  SimBehavior.h
+//  Papercut
+//
+//  Headless counterpart of Behavior.  Encapsulates all movement / steering
+//    behaviors for an object and calculates the final force applied to the
+//    object's position each frame, exactly as Behavior does.
+//
+//  Targets are held as store handles and looked up through the world each
+//    frame, so a piece that has been removed simply stops being a target.
+//    Other pieces' centers and velocities are read from the world's
+//    pieceState, as they were when the tick's walk started.
+//
+
+#ifndef SIMCORE_SIMBEHAVIOR_H
+#define SIMCORE_SIMBEHAVIOR_H
+
+#include "SimTypes.h"
+#include "SimTimer.h"
+#include "SimObjectStore.h"
+#include "SimIntegrator.h"
+
+class SimPaper;
+class SimWorld;
+class SimTimerWheel;
+
+// one slot per BehaviorType bit, up to btTilt
+#define SIM_NUM_BEHAVIORS   18
+
+class SimBehavior {
+public:
+    SimVector       vel;            // object's current velocity (drift)
+    CGFloat         velX;           // original starting velocity
+    CGFloat         velY;
+
+    SimVector       vRunning;       // tracks running force for a single update loop
+
+    SimPaper        *pSelf;         // Paper piece that owns the instance
+    SimWorld        *world;         // world the owner lives in
+    SimHandle       pTarget1;       // target for seek, flee, etc
+
+    int             iFlags;         // holds flags that determine behavior
+
+    DecelType       decelType;
+    int             flip;
+    BOOL            flipX;          // YES = flip about X axis, NO = Y axis, i.e. the axis it FACES / travels along
+    CGFloat         bobAmp;         // bob amplitude, higher = less bob
+    CGFloat         bobOffset;      // offset so objects bob out of sync
+
+    int             spawnCount;     // # of times to respawn, 0 = infinite
+    int             spawnCountCheck;// current # of times respawned
+
+    CGFloat         bSpeed;         // max speed for things like flee, seek
+    BOOL            bKillOnArrive;  // destroy object when seek/arrive conditions met
+    SimPoint        bSeekOffset;    // offset from center for seek
+    BOOL            bFlocking;
+
+    CGFloat         rVelMax;        // range of random vel along current trajectory
+    CGFloat         rVelMin;
+    BOOL            fixedDir;       // YES = don't change directions while moving
+
+    CGFloat         animFrameDur;   // duration of frame animation
+    BOOL            autoReverse;
+    CGFloat         rotateAngle;
+    CGFloat         rotateAngleMemory;
+    BOOL            angledPath;
+    ViewCheckType   viewCheckType;
+    CGFloat         peekTime;
+    CGFloat         sinkAngle;
+    CGFloat         sinkAngleInterval;
+
+    SimTimer        timers[SIM_NUM_BEHAVIORS];  // by BehaviorType bit, held inline so a piece owns no heap memory
+    int             timerMask;      // BehaviorType bits that have a timer in timers
+    SimTimerWheel   *timerWheel;    // wheel the timers run on once the piece is in the world
+
+    CGFloat         weightSeparation;
+    CGFloat         weightAlignment;
+    CGFloat         weightCohesion;
+
+    SimPoint        bHalfSize;
+
+    SimBehavior();
+
+    BOOL isOn(BehaviorType bt) const    { return ((iFlags & bt) == bt); }
+    void turnOn(BehaviorType bt)        { if (!isOn(bt)) { iFlags |= bt; } }
+    void turnOn(BehaviorType bt, int targetID);
+    void turnOnFlocking();
+    void turnOff(BehaviorType bt)       { if (isOn(bt)) { iFlags ^= bt; } }
+    void turnOffAll()                   { iFlags = 0; }
+    BOOL areAllBehaviorsOff() const     { return (iFlags == 0); }
+
+    void BobOn(CGFloat bAmp, CGFloat bOffset);
+    void SeekOn(SimHandle target);
+    void FleeOn(SimHandle target);
+
+    void addTimer(const SimTimer &objTimer, BehaviorType bt);
+    SimTimer* timer(BehaviorType bt);                           // NULL if the behavior has no timer
+    const SimTimer* timer(BehaviorType bt) const;
+    void attachTimers(SimTimerWheel *wheel);
+    void updateTimers(CGFloat interval);                        // the timers that aren't on the wheel
+    void turnTimer(BehaviorType bt, BOOL isOn);
+
+    void accumulateForce(SimVector force);
+    void calculateForce(CGFloat frameTime, CGFloat elapsedTime, SimVector pos);
+    SimVector calculateSeekVelocity(SimVector centerOfMass) const;
+
+    // batched update: pieces that only drift, bob and decel run calculateForce
+    //   in two halves, prepareForce per piece and the common forces in a batch
+    BOOL canBatchForce() const;
+    void prepareForce();
+    BOOL prepareIsLocal() const;    // NO if prepareForce draws random numbers or resets a wheel timer
+    SimForceParams forceParams(CGFloat elapsedTime) const;
+
+    BOOL viewCheck(ViewCheckType vcType) const;
+    BOOL viewCheck(ViewCheckType vcType, SimPoint point) const;
+    AxisType axisHitCheck(ViewCheckType vcType) const;
+
+private:
+    static int timerSlot(BehaviorType bt);
+    static BOOL onWheel(BehaviorType bt);
+
+    void beginForce();
+    void updateFlipAnim();
+    void updateDrift();
+    void toroidRotate(int fDir);
+};
+
+#endif
@@ -0,0 +1,59 @@
+//
+//  SimBroadphase.cpp
+//  Papercut
+//
+//  Sort-and-sweep broadphase for the collision pass.
+//
+
+#include <algorithm>
+
+#include "SimBroadphase.h"
+
+void SimBroadphase::clear() {
+    boxes.clear();
+    pairs.clear();
+}
+
+void SimBroadphase::add(uint32_t boxID, const SimRect &box) {
+
+    // empty boxes never intersect anything
+    if ((box.width <= 0.0) || (box.height <= 0.0)) { return; }
+
+    Box newBox;
+    newBox.minX = box.x;
+    newBox.maxX = box.maxX();
+    newBox.minY = box.y;
+    newBox.maxY = box.maxY();
+    newBox.boxID = boxID;
+    boxes.push_back(newBox);
+}
+
+const std::vector<SimCollisionPair>& SimBroadphase::findPairs() {
+
+    pairs.clear();
+    std::sort(boxes.begin(), boxes.end(), boxBefore);
+
+    // every box only has to look ahead until the next one starts past its right edge
+    for (size_t i = 0; i < boxes.size(); i++) {
+
+        const Box &box1 = boxes[i];
+
+        for (size_t j = i + 1; j < boxes.size(); j++) {
+
+            const Box &box2 = boxes[j];
+            if (box2.minX >= box1.maxX) { break; }
+
+            // same test as SimRect::intersects
+            if ((box1.minY < box2.maxY) && (box2.minY < box1.maxY)) {
+                SimCollisionPair pair;
+                pair.a = std::min(box1.boxID, box2.boxID);
+                pair.b = std::max(box1.boxID, box2.boxID);
+                pairs.push_back(pair);
+            }
+        }
+    }
+
+    std::sort(pairs.begin(), pairs.end(), pairBefore);
+
+    return pairs;
+}
@@ -0,0 +1,52 @@
+//
+//  SimBroadphase.h
+//  Papercut
+//
+//  Sort-and-sweep broadphase for the collision pass.  Boxes are added
+//    once per frame, sorted along x, and swept to find every pair whose
+//    boxes overlap on both axes.  Each overlapping pair comes out once,
+//    lower id first, so the world can resolve it a single time.
+//
+
+#ifndef SIMCORE_SIMBROADPHASE_H
+#define SIMCORE_SIMBROADPHASE_H
+
+#include <vector>
+
+#include "SimTypes.h"
+
+typedef struct {
+    uint32_t    a;      // lower id
+    uint32_t    b;
+} SimCollisionPair;
+
+class SimBroadphase {
+public:
+    void clear();
+    void reserve(size_t numBoxes)   { boxes.reserve(numBoxes); pairs.reserve(numBoxes); }
+    void add(uint32_t boxID, const SimRect &box);
+
+    // sweep the boxes added since the last clear, pairs come out sorted by id
+    const std::vector<SimCollisionPair>& findPairs();
+
+    size_t size() const     { return boxes.size(); }
+
+private:
+    typedef struct {
+        CGFloat     minX;
+        CGFloat     maxX;
+        CGFloat     minY;
+        CGFloat     maxY;
+        uint32_t    boxID;
+    } Box;
+
+    std::vector<Box>                boxes;
+    std::vector<SimCollisionPair>   pairs;
+
+    static bool boxBefore(const Box &b1, const Box &b2)     { return (b1.minX < b2.minX); }
+    static bool pairBefore(const SimCollisionPair &p1, const SimCollisionPair &p2) {
+        return ((p1.a < p2.a) || ((p1.a == p2.a) && (p1.b < p2.b)));
+    }
+};
+
+#endif
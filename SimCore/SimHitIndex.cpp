@@ -0,0 +1,170 @@
+//
+//  SimHitIndex.cpp
+//  Papercut
+//
+//  Grid over the view used to hit-test touches.
+//
+
+#include <algorithm>
+
+#include "SimHitIndex.h"
+#include "SimPaper.h"
+
+#define HIT_CELL_SIZE   128.0
+
+// pieces the user can grab, plus animated pieces that can be killed (i.e. balloon fish)
+static BOOL isTouchable(const SimPaper *piece) {
+    if ((piece->moveType != Move_Static) && (piece->moveType != Move_Anim)) { return YES; }
+    return ((piece->killOnTouch) && (piece->moveType == Move_Anim)) ? YES : NO;
+}
+
+// YES if piece1 draws above piece2
+static BOOL isAbove(const SimPaper *piece1, const SimPaper *piece2) {
+    if (piece1->zPos != piece2->zPos) { return (piece1->zPos > piece2->zPos) ? YES : NO; }
+    return (piece1->viewOrder > piece2->viewOrder) ? YES : NO;
+}
+
+SimHitIndex::SimHitIndex() : built(NO), cellSize(HIT_CELL_SIZE), cols(1), rows(1) {
+}
+
+void SimHitIndex::cellRange(const SimRect &frame, int &minCol, int &maxCol, int &minRow, int &maxRow) const {
+
+    // anything off the view lands in the border cells
+    minCol = std::max(0, std::min(cols - 1, (int)floorf(frame.x / cellSize)));
+    maxCol = std::max(0, std::min(cols - 1, (int)floorf(frame.maxX() / cellSize)));
+    minRow = std::max(0, std::min(rows - 1, (int)floorf(frame.y / cellSize)));
+    maxRow = std::max(0, std::min(rows - 1, (int)floorf(frame.maxY() / cellSize)));
+}
+
+void SimHitIndex::setSlotEntry(const SimPaper *piece, int32_t entry) {
+    if (piece->handle.index >= slotEntry.size()) { slotEntry.resize(piece->handle.index + 1, -1); }
+    slotEntry[piece->handle.index] = entry;
+}
+
+void SimHitIndex::build(const SimObjectStore &objects, int width, int height) {
+
+    cols = std::max(1, (int)ceilf(width / cellSize));
+    rows = std::max(1, (int)ceilf(height / cellSize));
+
+    entries.resize(objects.size());
+    loose.clear();
+    slotEntry.assign(slotEntry.size(), -1);
+
+    // count how many cells each frame covers
+    cellStart.assign((cols * rows) + 1, 0);
+    for (size_t i = 0; i < objects.size(); i++) {
+
+        SimPaper *eachPiece = objects[i];
+        entries[i].frame = eachPiece->frame();
+        entries[i].piece = eachPiece;
+        setSlotEntry(eachPiece, (int32_t)i);
+
+        int minCol, maxCol, minRow, maxRow;
+        cellRange(entries[i].frame, minCol, maxCol, minRow, maxRow);
+        for (int r = minRow; r <= maxRow; r++) {
+            for (int c = minCol; c <= maxCol; c++) {
+                cellStart[(r * cols) + c + 1]++;
+            }
+        }
+    }
+
+    for (int c = 0; c < (cols * rows); c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    // fill each cell, the cursor for a cell ends up at the next one's start
+    cellItems.resize(cellStart[cols * rows]);
+    for (size_t i = 0; i < entries.size(); i++) {
+
+        int minCol, maxCol, minRow, maxRow;
+        cellRange(entries[i].frame, minCol, maxCol, minRow, maxRow);
+        for (int r = minRow; r <= maxRow; r++) {
+            for (int c = minCol; c <= maxCol; c++) {
+                cellItems[cellStart[(r * cols) + c]++] = (uint32_t)i;
+            }
+        }
+    }
+
+    for (int c = (cols * rows); c > 0; c--) {
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+
+    built = YES;
+}
+
+void SimHitIndex::clear() {
+    entries.clear();
+    cellItems.clear();
+    loose.clear();
+    slotEntry.clear();
+    built = NO;
+}
+
+void SimHitIndex::add(SimPaper *piece) {
+
+    if (!built) { return; }
+
+    Entry newEntry;
+    newEntry.frame = piece->frame();
+    newEntry.piece = piece;
+    entries.push_back(newEntry);
+
+    loose.push_back((uint32_t)(entries.size() - 1));
+    setSlotEntry(piece, (int32_t)(entries.size() - 1));
+}
+
+void SimHitIndex::update(SimPaper *piece) {
+
+    if (!built) { return; }
+
+    remove(piece);
+    add(piece);
+}
+
+void SimHitIndex::remove(const SimPaper *piece) {
+
+    if ((!built) || (piece->handle.index >= slotEntry.size())) { return; }
+
+    int32_t entry = slotEntry[piece->handle.index];
+    if ((entry >= 0) && (entries[entry].piece == piece)) {
+        entries[entry].piece = NULL;
+    }
+    slotEntry[piece->handle.index] = -1;
+}
+
+void SimHitIndex::testEntry(uint32_t e, SimPoint touchPos, SimPaper *&best) const {
+
+    const Entry &entry = entries[e];
+    if ((entry.piece == NULL) || (!entry.frame.contains(touchPos)) || (!isTouchable(entry.piece))) { return; }
+
+    if ((best == NULL) || (isAbove(entry.piece, best))) {
+        best = entry.piece;
+    }
+}
+
+SimPaper* SimHitIndex::hitTest(SimPoint touchPos) const {
+
+    SimPaper *best = NULL;
+    if (!built) { return NULL; }
+
+    int col = std::max(0, std::min(cols - 1, (int)floorf(touchPos.x / cellSize)));
+    int row = std::max(0, std::min(rows - 1, (int)floorf(touchPos.y / cellSize)));
+    int cell = (row * cols) + col;
+
+    for (uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+        testEntry(cellItems[i], touchPos, best);
+    }
+
+    for (size_t i = 0; i < loose.size(); i++) {
+        testEntry(loose[i], touchPos, best);
+    }
+
+    return best;
+}
+
+void SimHitIndex::hitTest(const SimPoint *touchPos, size_t count, SimPaper **touched) const {
+    for (size_t i = 0; i < count; i++) {
+        touched[i] = hitTest(touchPos[i]);
+    }
+}
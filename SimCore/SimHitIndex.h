@@ -0,0 +1,68 @@
+//
+//  SimHitIndex.h
+//  Papercut
+//
+//  Grid over the view used to hit-test touches.  Every piece's frame is
+//    binned into the cells it covers, so a touch only looks at the pieces
+//    in its own cell, and the top-most one by layer zPosition (then by
+//    subview order) wins instead of whichever the walk found first.
+//
+//  The world rebuilds the grid lazily the first time it's queried after
+//    a frame.  Between frames single pieces can be re-binned as they are
+//    dragged, added or removed; those go in a short loose list instead of
+//    touching the packed cells.
+//
+
+#ifndef SIMCORE_SIMHITINDEX_H
+#define SIMCORE_SIMHITINDEX_H
+
+#include <vector>
+
+#include "SimTypes.h"
+#include "SimObjectStore.h"
+
+class SimPaper;
+
+class SimHitIndex {
+public:
+    SimHitIndex();
+
+    void build(const SimObjectStore &objects, int width, int height);
+    void clear();
+
+    BOOL isBuilt() const    { return built; }
+
+    // between builds, keep single pieces current
+    void add(SimPaper *piece);
+    void update(SimPaper *piece);
+    void remove(const SimPaper *piece);
+
+    // top-most touchable piece containing the point, NULL if none
+    SimPaper* hitTest(SimPoint touchPos) const;
+
+    // resolve a batch of coalesced touches at once, touched gets one entry per point
+    void hitTest(const SimPoint *touchPos, size_t count, SimPaper **touched) const;
+
+private:
+    typedef struct {
+        SimRect     frame;
+        SimPaper    *piece;     // NULL once removed or re-binned
+    } Entry;
+
+    BOOL                    built;
+    CGFloat                 cellSize;
+    int                     cols;
+    int                     rows;
+
+    std::vector<Entry>      entries;
+    std::vector<uint32_t>   cellStart;      // first cellItems index of each cell, +1 sentinel
+    std::vector<uint32_t>   cellItems;      // entry indexes sorted by cell
+    std::vector<uint32_t>   loose;          // entries added since the build
+    std::vector<int32_t>    slotEntry;      // store slot -> entry, -1 = none
+
+    void cellRange(const SimRect &frame, int &minCol, int &maxCol, int &minRow, int &maxRow) const;
+    void setSlotEntry(const SimPaper *piece, int32_t entry);
+    void testEntry(uint32_t e, SimPoint touchPos, SimPaper *&best) const;
+};
+
+#endif
@@ -0,0 +1,354 @@
+//
+//  SimIntegrator.cpp
+//  Papercut
+//
+//  Batched drift / bob / decel integration with a SIMD kernel and a
+//    scalar fallback.
+//
+
+#include "SimIntegrator.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SIM_SIMD_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SIM_SIMD_NEON
+#endif
+
+#define SIM_LANES   4
+
+// ___ SCALAR
+
+void SimIntegrator::accumulateForce(SimVector &vRunning, SimVector force) {
+
+    // Builds the final force we'll apply to the object based on each behavior enabled
+
+    CGFloat forceRemaining = MAX_FORCE - vRunning.length();
+
+    if (forceRemaining <= 0.0) { return; }    // if we've hit max magnitude, then don't add any more
+
+    CGFloat forceToAdd = force.length();
+
+    if (forceToAdd < forceRemaining)    { vRunning.add(force); }                                // add full force if possible
+    else                                { vRunning.add(force.normalize().mult(forceRemaining)); } // otherwise scale force down to fit
+}
+
+BOOL SimIntegrator::integrateCommon(SimVector &vRunning, SimVector &vel, const SimForceParams &params) {
+
+    SimVector newForce;
+    BOOL flipX = (params.flags & ifFlipX) ? YES : NO;
+    BOOL angledPath = (params.flags & ifAngled) ? YES : NO;
+
+    // ___ DRIFT
+    if (params.flags & ifDrift) {
+        accumulateForce(vRunning, vel);
+    }
+
+    // ___ BOB
+    if (params.flags & ifBob) {
+
+        if (!flipX) { newForce.x += params.bobOff; }
+        if ((vel.y <= MIN_FORCE) && (flipX))   { newForce.y += params.bobOff; }
+
+        accumulateForce(vRunning, newForce);
+        newForce.zero();
+    }
+
+    // ___ DECEL
+    if (params.flags & ifDecel) {
+
+        // only decelerate if moving fast enough
+        if (vRunning.length() > MIN_FORCE) {
+
+            CGFloat decelMod = params.decelMod;
+
+            if (flipX) {    // primary movement on X-axis
+                if (vRunning.x > MIN_FORCE)         { newForce.x += decelMod; }
+                else if (vRunning.x < -MIN_FORCE)   { newForce.x -= decelMod; }
+
+                if (angledPath) {   // if path angled, decel y the same
+                    if (vRunning.y > MIN_FORCE)         { newForce.y += decelMod; }
+                    else if (vRunning.y < -MIN_FORCE)   { newForce.y -= decelMod; }
+                }
+                else {
+                    if (vRunning.y > MIN_FORCE)         { newForce.y += (decelMod * 2); }
+                    else if (vRunning.y < -MIN_FORCE)   { newForce.y -= (decelMod * 2); }
+                    else {
+                        newForce.y = 0.0;
+                        vel.y = 0.0;
+                    }
+                }
+            }
+            else {    // primary movement on Y-axis
+                if (vRunning.y > MIN_FORCE)         { newForce.y += decelMod; }
+                else if (vRunning.y < -MIN_FORCE)   { newForce.y -= decelMod; }
+
+                if (angledPath) {   // if path angled, decel x the same
+                    if (vRunning.x > MIN_FORCE)         { newForce.x += decelMod; }
+                    else if (vRunning.x < -MIN_FORCE)   { newForce.x -= decelMod; }
+                }
+                else {
+                    if (vRunning.x > MIN_FORCE)         { newForce.x += (decelMod * 2); }
+                    else if (vRunning.x < -MIN_FORCE)   { newForce.x -= (decelMod * 2); }
+                    else {
+                        newForce.x = 0.0;
+                        vel.x = 0.0;
+                    }
+                }
+            }
+
+            // add to cumulative force and adjust velocity, or stop
+            //   if needed
+            accumulateForce(vRunning, newForce);
+            vel.add(newForce);
+        }
+
+        else if (params.flags & ifDecelStop) {
+            vel.x = 0.0;
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+// ___ BATCH
+
+void SimIntegrator::clear() {
+    count = 0;
+}
+
+void SimIntegrator::reserve(size_t numPieces) {
+
+    size_t padded = ((numPieces + SIM_LANES - 1) / SIM_LANES) * SIM_LANES;
+
+    runX.reserve(padded);       runY.reserve(padded);
+    velX.reserve(padded);       velY.reserve(padded);
+    bobOff.reserve(padded);     decelMod.reserve(padded);
+    flags.reserve(padded);      stopAnim.reserve(padded);
+}
+
+size_t SimIntegrator::add(const SimVector &vRunning, const SimVector &vel, const SimForceParams &params) {
+
+    // keep every array a whole number of lanes long, new lanes start as padding
+    if (count == runX.size()) {
+        size_t padded = runX.size() + SIM_LANES;
+        runX.resize(padded, 0.0);       runY.resize(padded, 0.0);
+        velX.resize(padded, 0.0);       velY.resize(padded, 0.0);
+        bobOff.resize(padded, 0.0);     decelMod.resize(padded, 0.0);
+        flags.resize(padded, 0);        stopAnim.resize(padded, 0);
+    }
+
+    runX[count] = vRunning.x;           runY[count] = vRunning.y;
+    velX[count] = vel.x;                velY[count] = vel.y;
+    bobOff[count] = params.bobOff;      decelMod[count] = params.decelMod;
+    flags[count] = params.flags;
+
+    return count++;
+}
+
+void SimIntegrator::integrateScalar(size_t first, CGFloat frameScale) {
+
+    for (size_t i = first; i < count; i++) {
+
+        SimVector vRunning(runX[i], runY[i]);
+        SimVector vel(velX[i], velY[i]);
+
+        SimForceParams params;
+        params.flags = flags[i];
+        params.bobOff = bobOff[i];
+        params.decelMod = decelMod[i];
+
+        stopAnim[i] = integrateCommon(vRunning, vel, params);
+        vRunning.mult(frameScale);
+
+        runX[i] = vRunning.x;           runY[i] = vRunning.y;
+        velX[i] = vel.x;                velY[i] = vel.y;
+    }
+}
+
+// ___ SIMD
+//  one kernel body written against a handful of 4-lane helpers, every
+//  lane computes every branch and the masks pick which results stick
+
+#if defined(SIM_SIMD_SSE2)
+
+typedef __m128  SimF4;
+typedef __m128  SimM4;
+
+static inline SimF4 f4Load(const float *p)              { return _mm_loadu_ps(p); }
+static inline void  f4Store(float *p, SimF4 a)          { _mm_storeu_ps(p, a); }
+static inline SimF4 f4Set(float s)                      { return _mm_set1_ps(s); }
+static inline SimF4 f4Add(SimF4 a, SimF4 b)             { return _mm_add_ps(a, b); }
+static inline SimF4 f4Sub(SimF4 a, SimF4 b)             { return _mm_sub_ps(a, b); }
+static inline SimF4 f4Mul(SimF4 a, SimF4 b)             { return _mm_mul_ps(a, b); }
+static inline SimF4 f4Div(SimF4 a, SimF4 b)             { return _mm_div_ps(a, b); }
+static inline SimF4 f4Sqrt(SimF4 a)                     { return _mm_sqrt_ps(a); }
+static inline SimM4 f4Gt(SimF4 a, SimF4 b)              { return _mm_cmpgt_ps(a, b); }
+static inline SimM4 f4Lt(SimF4 a, SimF4 b)              { return _mm_cmplt_ps(a, b); }
+static inline SimM4 f4Le(SimF4 a, SimF4 b)              { return _mm_cmple_ps(a, b); }
+static inline SimM4 m4And(SimM4 a, SimM4 b)             { return _mm_and_ps(a, b); }
+static inline SimM4 m4Or(SimM4 a, SimM4 b)              { return _mm_or_ps(a, b); }
+static inline SimM4 m4AndNot(SimM4 a, SimM4 b)          { return _mm_andnot_ps(b, a); }    // a & ~b
+static inline SimM4 m4Not(SimM4 a)                      { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+static inline SimF4 f4Select(SimM4 m, SimF4 a, SimF4 b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+static inline SimM4 m4Flag(const int32_t *p, int32_t flag) {
+    __m128i bits = _mm_set1_epi32(flag);
+    __m128i f = _mm_loadu_si128((const __m128i *)p);
+    return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(f, bits), bits));
+}
+
+static inline void m4Store(int32_t *p, SimM4 m) {
+    _mm_storeu_si128((__m128i *)p, _mm_srli_epi32(_mm_castps_si128(m), 31));
+}
+
+#elif defined(SIM_SIMD_NEON)
+
+typedef float32x4_t SimF4;
+typedef uint32x4_t  SimM4;
+
+static inline SimF4 f4Load(const float *p)              { return vld1q_f32(p); }
+static inline void  f4Store(float *p, SimF4 a)          { vst1q_f32(p, a); }
+static inline SimF4 f4Set(float s)                      { return vdupq_n_f32(s); }
+static inline SimF4 f4Add(SimF4 a, SimF4 b)             { return vaddq_f32(a, b); }
+static inline SimF4 f4Sub(SimF4 a, SimF4 b)             { return vsubq_f32(a, b); }
+static inline SimF4 f4Mul(SimF4 a, SimF4 b)             { return vmulq_f32(a, b); }
+static inline SimF4 f4Div(SimF4 a, SimF4 b)             { return vdivq_f32(a, b); }
+static inline SimF4 f4Sqrt(SimF4 a)                     { return vsqrtq_f32(a); }
+static inline SimM4 f4Gt(SimF4 a, SimF4 b)              { return vcgtq_f32(a, b); }
+static inline SimM4 f4Lt(SimF4 a, SimF4 b)              { return vcltq_f32(a, b); }
+static inline SimM4 f4Le(SimF4 a, SimF4 b)              { return vcleq_f32(a, b); }
+static inline SimM4 m4And(SimM4 a, SimM4 b)             { return vandq_u32(a, b); }
+static inline SimM4 m4Or(SimM4 a, SimM4 b)              { return vorrq_u32(a, b); }
+static inline SimM4 m4AndNot(SimM4 a, SimM4 b)          { return vbicq_u32(a, b); }        // a & ~b
+static inline SimM4 m4Not(SimM4 a)                      { return vmvnq_u32(a); }
+static inline SimF4 f4Select(SimM4 m, SimF4 a, SimF4 b) { return vbslq_f32(m, a, b); }
+
+static inline SimM4 m4Flag(const int32_t *p, int32_t flag) {
+    return vtstq_s32(vld1q_s32(p), vdupq_n_s32(flag));
+}
+
+static inline void m4Store(int32_t *p, SimM4 m) {
+    vst1q_s32(p, vreinterpretq_s32_u32(vshrq_n_u32(m, 31)));
+}
+
+#endif
+
+#if defined(SIM_SIMD_SSE2) || defined(SIM_SIMD_NEON)
+
+// accumulateForce on the lanes in mask
+static inline void f4Accumulate(SimF4 &rx, SimF4 &ry, SimF4 fx, SimF4 fy, SimM4 mask) {
+
+    SimF4 remaining = f4Sub(f4Set(MAX_FORCE), f4Sqrt(f4Add(f4Mul(rx, rx), f4Mul(ry, ry))));
+    SimM4 active = m4AndNot(mask, f4Le(remaining, f4Set(0.0)));
+
+    SimF4 toAdd = f4Sqrt(f4Add(f4Mul(fx, fx), f4Mul(fy, fy)));
+    SimM4 full = f4Lt(toAdd, remaining);
+
+    // scaled down lanes always have a non-zero length, see the scalar normalize
+    SimF4 addX = f4Select(full, fx, f4Mul(f4Div(fx, toAdd), remaining));
+    SimF4 addY = f4Select(full, fy, f4Mul(f4Div(fy, toAdd), remaining));
+
+    rx = f4Select(active, f4Add(rx, addX), rx);
+    ry = f4Select(active, f4Add(ry, addY), ry);
+}
+
+// decel step for one axis: +mod above MIN_FORCE, -mod below -MIN_FORCE, else 0
+static inline SimF4 f4DecelStep(SimF4 r, SimF4 mod, SimM4 &still) {
+
+    SimF4 zero = f4Set(0.0);
+    SimM4 above = f4Gt(r, f4Set(MIN_FORCE));
+    SimM4 below = m4AndNot(f4Lt(r, f4Set(-MIN_FORCE)), above);
+
+    still = m4Not(m4Or(above, below));
+    return f4Select(above, f4Add(zero, mod), f4Select(below, f4Sub(zero, mod), zero));
+}
+
+#endif
+
+void SimIntegrator::integrate(CGFloat frameScale) {
+
+    size_t first = 0;
+
+#if defined(SIM_SIMD_SSE2) || defined(SIM_SIMD_NEON)
+
+    SimF4 scale = f4Set(frameScale);
+    SimF4 zero = f4Set(0.0);
+
+    // lanes past count in the last group are left over from earlier frames,
+    //   they get integrated but nobody reads them back
+    size_t lanes = ((count + SIM_LANES - 1) / SIM_LANES) * SIM_LANES;
+
+    for (; first < lanes; first += SIM_LANES) {
+
+        SimF4 rx = f4Load(&runX[first]);
+        SimF4 ry = f4Load(&runY[first]);
+        SimF4 vx = f4Load(&velX[first]);
+        SimF4 vy = f4Load(&velY[first]);
+
+        const int32_t *f = &flags[first];
+        SimM4 flipX = m4Flag(f, ifFlipX);
+        SimM4 angled = m4Flag(f, ifAngled);
+
+        // ___ DRIFT
+        f4Accumulate(rx, ry, vx, vy, m4Flag(f, ifDrift));
+
+        // ___ BOB
+        SimF4 bob = f4Load(&bobOff[first]);
+        SimF4 bobX = f4Select(flipX, zero, f4Add(zero, bob));
+        SimF4 bobY = f4Select(m4And(flipX, f4Le(vy, f4Set(MIN_FORCE))), f4Add(zero, bob), zero);
+        f4Accumulate(rx, ry, bobX, bobY, m4Flag(f, ifBob));
+
+        // ___ DECEL
+        SimM4 decel = m4Flag(f, ifDecel);
+        SimM4 moving = f4Gt(f4Sqrt(f4Add(f4Mul(rx, rx), f4Mul(ry, ry))), f4Set(MIN_FORCE));
+        SimM4 slowing = m4And(decel, moving);
+
+        // the off axis steps twice as hard unless the path is angled
+        SimF4 mod = f4Load(&decelMod[first]);
+        SimF4 offMod = f4Select(angled, mod, f4Add(mod, mod));
+        SimF4 modX = f4Select(flipX, mod, offMod);
+        SimF4 modY = f4Select(flipX, offMod, mod);
+
+        SimM4 stillX, stillY;
+        SimF4 nx = f4DecelStep(rx, modX, stillX);
+        SimF4 ny = f4DecelStep(ry, modY, stillY);
+
+        // a still off axis stops its velocity
+        SimM4 stopX = m4And(slowing, m4AndNot(m4AndNot(stillX, flipX), angled));
+        SimM4 stopY = m4And(slowing, m4AndNot(m4And(stillY, flipX), angled));
+        vx = f4Select(stopX, zero, vx);
+        vy = f4Select(stopY, zero, vy);
+
+        f4Accumulate(rx, ry, nx, ny, slowing);
+        vx = f4Select(slowing, f4Add(vx, nx), vx);
+        vy = f4Select(slowing, f4Add(vy, ny), vy);
+
+        // Decel_Stop once too slow
+        SimM4 stopped = m4And(m4AndNot(decel, moving), m4Flag(f, ifDecelStop));
+        vx = f4Select(stopped, zero, vx);
+
+        // final frame time scale
+        f4Store(&runX[first], f4Mul(rx, scale));
+        f4Store(&runY[first], f4Mul(ry, scale));
+        f4Store(&velX[first], vx);
+        f4Store(&velY[first], vy);
+        m4Store(&stopAnim[first], stopped);
+    }
+
+#endif
+
+    integrateScalar(first, frameScale);
+}
+
+const char* SimIntegrator::kernelName() {
+#if defined(SIM_SIMD_SSE2)
+    return "sse2";
+#elif defined(SIM_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
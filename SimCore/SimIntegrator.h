@@ -0,0 +1,84 @@
+//
+//  SimIntegrator.h
+//  Papercut
+//
+//  The drift, bob and decel forces from calculateForce, plus the final
+//    frame time scale, run over packed arrays for a batch of pieces.
+//    Most of the scene (bubbles, Move_Auto fish) only ever uses these,
+//    so the world gathers them after their per-piece setup and runs
+//    the whole batch through one SIMD kernel (SSE2 on x86, NEON on
+//    arm64) instead of one piece at a time.
+//
+//  The kernel does exactly the same float operations in the same order
+//    as the scalar code, so batched pieces end up where calculateForce
+//    would have put them.  integrateCommon is that scalar code, and is
+//    what calculateForce itself calls.
+//
+
+#ifndef SIMCORE_SIMINTEGRATOR_H
+#define SIMCORE_SIMINTEGRATOR_H
+
+#include <vector>
+
+#include "SimTypes.h"
+
+// which of the common forces apply to a piece
+typedef enum {
+    ifNone          = 0x00,
+    ifDrift         = 0x01,     // accumulate vel
+    ifBob           = 0x02,
+    ifDecel         = 0x04,
+    ifFlipX         = 0x08,     // primary movement on X-axis
+    ifAngled        = 0x10,     // angled path, decel both axes the same
+    ifDecelStop     = 0x20      // decelType == Decel_Stop
+} IntegrateFlag;
+
+// everything the common forces need besides vRunning and vel
+typedef struct {
+    int         flags;          // IntegrateFlag bits
+    CGFloat     bobOff;         // this frame's bob offset
+    CGFloat     decelMod;       // per-frame decel step
+} SimForceParams;
+
+class SimIntegrator {
+public:
+    // scalar drift / bob / decel, returns YES if the piece should stop animating
+    static BOOL integrateCommon(SimVector &vRunning, SimVector &vel, const SimForceParams &params);
+
+    // adds a force to vRunning without going past MAX_FORCE
+    static void accumulateForce(SimVector &vRunning, SimVector force);
+
+    // name of the kernel compiled in, for reporting
+    static const char* kernelName();
+
+    SimIntegrator() : count(0) {}
+
+    void clear();
+    void reserve(size_t numPieces);
+    size_t add(const SimVector &vRunning, const SimVector &vel, const SimForceParams &params);
+    size_t size() const     { return count; }
+
+    // run the common forces and the frame time scale over the whole batch
+    void integrate(CGFloat frameScale);
+
+    SimVector running(size_t i) const   { return SimVector(runX[i], runY[i]); }
+    SimVector velocity(size_t i) const  { return SimVector(velX[i], velY[i]); }
+    BOOL stopAnimating(size_t i) const  { return (stopAnim[i] != 0) ? YES : NO; }
+
+private:
+    size_t                  count;
+
+    // padded out to a whole number of SIMD lanes, padding has no flags
+    std::vector<float>      runX;
+    std::vector<float>      runY;
+    std::vector<float>      velX;
+    std::vector<float>      velY;
+    std::vector<float>      bobOff;
+    std::vector<float>      decelMod;
+    std::vector<int32_t>    flags;
+    std::vector<int32_t>    stopAnim;
+
+    void integrateScalar(size_t first, CGFloat frameScale);
+};
+
+#endif
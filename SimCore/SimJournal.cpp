@@ -0,0 +1,218 @@
+//
+//  SimJournal.cpp
+//  Papercut
+//
+//  Input journal recording, file format and decoding.
+//
+
+#include <string.h>
+#include <vector>
+
+#include "SimJournal.h"
+
+// event bytes a new journal has room for before it grows, a few minutes of frames
+#define SIM_JOURNAL_RESERVE     (64 * 1024)
+
+// header on disk: magic, version, view size, seed, scene name, event bytes
+#define SIM_JOURNAL_HEADER_SIZE (4 + 2 + 2 + 2 + 8 + SIM_JOURNAL_NAME_LENGTH + 4)
+
+struct SimJournal {
+    char                    sceneName[SIM_JOURNAL_NAME_LENGTH];
+    uint64_t                seed;
+    int                     viewWidth;
+    int                     viewHeight;
+    size_t                  frames;
+    std::vector<uint8_t>    events;
+};
+
+// floats / values each event carries after its type byte
+static const int eventFloats[sjNumEvents] = { 0, 0, 2, 4, 4, 0, 1, 3 };
+
+// ___ ENCODING
+
+static void putBytes(std::vector<uint8_t> &data, uint64_t value, int length) {
+    for (int i = 0; i < length; i++) { data.push_back((uint8_t)(value >> (8 * i))); }
+}
+
+static uint64_t getBytes(const uint8_t *data, int length) {
+    uint64_t value = 0;
+    for (int i = 0; i < length; i++) { value |= (uint64_t)data[i] << (8 * i); }
+    return value;
+}
+
+static void putFloat(std::vector<uint8_t> &data, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putBytes(data, bits, 4);
+}
+
+static float getFloat(const uint8_t *data) {
+    uint32_t bits = (uint32_t)getBytes(data, 4);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void record(SimJournal *journal, SimJournalEventType type, float a, float b, float c, float d) {
+
+    if (journal == NULL) { return; }
+
+    const float values[4] = { a, b, c, d };
+    journal->events.push_back((uint8_t)type);
+    for (int i = 0; i < eventFloats[type]; i++) { putFloat(journal->events, values[i]); }
+}
+
+// ___ RECORDING
+
+SimJournal* SimJournalCreate(const char *sceneName, uint64_t seed, int viewWidth, int viewHeight) {
+
+    SimJournal *journal = new SimJournal;
+    memset(journal->sceneName, 0, sizeof(journal->sceneName));
+    if (sceneName) { strncpy(journal->sceneName, sceneName, SIM_JOURNAL_NAME_LENGTH - 1); }
+    journal->seed = seed;
+    journal->viewWidth = viewWidth;
+    journal->viewHeight = viewHeight;
+    journal->frames = 0;
+    journal->events.reserve(SIM_JOURNAL_RESERVE);
+
+    return journal;
+}
+
+void SimJournalDestroy(SimJournal *journal) {
+    delete journal;
+}
+
+void SimJournalFrame(SimJournal *journal, double timestamp) {
+
+    if (journal == NULL) { return; }
+
+    uint64_t bits;
+    memcpy(&bits, &timestamp, sizeof(bits));
+    journal->events.push_back((uint8_t)sjFrame);
+    putBytes(journal->events, bits, 8);
+    journal->frames++;
+}
+
+void SimJournalTouchBegan(SimJournal *journal, float x, float y) {
+    record(journal, sjTouchBegan, x, y, 0.0f, 0.0f);
+}
+
+void SimJournalTouchMoved(SimJournal *journal, float beginX, float beginY, float x, float y) {
+    record(journal, sjTouchMoved, beginX, beginY, x, y);
+}
+
+void SimJournalTouchEnded(SimJournal *journal, float firstX, float firstY, float lastX, float lastY) {
+    record(journal, sjTouchEnded, firstX, firstY, lastX, lastY);
+}
+
+void SimJournalShake(SimJournal *journal) {
+    record(journal, sjShake, 0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+void SimJournalAccelerate(SimJournal *journal, float x) {
+    record(journal, sjAccelerate, x, 0.0f, 0.0f, 0.0f);
+}
+
+void SimJournalPinch(SimJournal *journal, float x, float y, float scale) {
+    record(journal, sjPinch, x, y, scale, 0.0f);
+}
+
+// ___ FILES
+
+int SimJournalWrite(const SimJournal *journal, FILE *file) {
+
+    if ((journal == NULL) || (file == NULL)) { return -1; }
+
+    std::vector<uint8_t> header;
+    header.reserve(SIM_JOURNAL_HEADER_SIZE);
+    putBytes(header, SIM_JOURNAL_MAGIC, 4);
+    putBytes(header, SIM_JOURNAL_VERSION, 2);
+    putBytes(header, (uint16_t)journal->viewWidth, 2);
+    putBytes(header, (uint16_t)journal->viewHeight, 2);
+    putBytes(header, journal->seed, 8);
+    header.insert(header.end(), journal->sceneName, journal->sceneName + SIM_JOURNAL_NAME_LENGTH);
+    putBytes(header, (uint32_t)journal->events.size(), 4);
+
+    if (fwrite(&header[0], 1, header.size(), file) != header.size()) { return -1; }
+    if ((!journal->events.empty()) &&
+        (fwrite(&journal->events[0], 1, journal->events.size(), file) != journal->events.size())) { return -1; }
+
+    return (ferror(file)) ? -1 : 0;
+}
+
+SimJournal* SimJournalRead(FILE *file) {
+
+    if (file == NULL) { return NULL; }
+
+    uint8_t header[SIM_JOURNAL_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)) { return NULL; }
+
+    const uint8_t *h = header;
+    if (getBytes(h, 4) != SIM_JOURNAL_MAGIC)        { return NULL; }
+    if (getBytes(h + 4, 2) != SIM_JOURNAL_VERSION)  { return NULL; }
+
+    SimJournal *journal = new SimJournal;
+    journal->viewWidth = (int)getBytes(h + 6, 2);
+    journal->viewHeight = (int)getBytes(h + 8, 2);
+    journal->seed = getBytes(h + 10, 8);
+    memcpy(journal->sceneName, h + 18, SIM_JOURNAL_NAME_LENGTH);
+    journal->sceneName[SIM_JOURNAL_NAME_LENGTH - 1] = '\0';
+    journal->frames = 0;
+
+    size_t length = (size_t)getBytes(h + 18 + SIM_JOURNAL_NAME_LENGTH, 4);
+    journal->events.resize(length);
+    if ((length > 0) && (fread(&journal->events[0], 1, length, file) != length)) {
+        delete journal;
+        return NULL;
+    }
+
+    // every event has to decode, and the frames are counted on the way
+    SimJournalEvent event;
+    size_t offset = 0;
+    while (offset < length) {
+        offset = SimJournalNext(journal, offset, &event);
+        if (offset == 0) {
+            delete journal;
+            return NULL;
+        }
+        if (event.type == sjFrame) { journal->frames++; }
+    }
+
+    return journal;
+}
+
+// ___ READING
+
+const char* SimJournalSceneName(const SimJournal *journal)  { return journal->sceneName; }
+uint64_t SimJournalSeed(const SimJournal *journal)          { return journal->seed; }
+int SimJournalViewWidth(const SimJournal *journal)          { return journal->viewWidth; }
+int SimJournalViewHeight(const SimJournal *journal)         { return journal->viewHeight; }
+size_t SimJournalSize(const SimJournal *journal)            { return journal->events.size(); }
+size_t SimJournalFrames(const SimJournal *journal)          { return journal->frames; }
+
+size_t SimJournalNext(const SimJournal *journal, size_t offset, SimJournalEvent *event) {
+
+    const std::vector<uint8_t> &events = journal->events;
+    if (offset >= events.size()) { return 0; }
+
+    uint8_t type = events[offset];
+    if ((type < sjFrame) || (type >= sjNumEvents)) { return 0; }
+
+    size_t length = 1 + ((type == sjFrame) ? 8 : (4 * eventFloats[type]));
+    if (offset + length > events.size()) { return 0; }
+
+    const uint8_t *data = &events[offset + 1];
+    memset(event, 0, sizeof(*event));
+    event->type = (SimJournalEventType)type;
+
+    if (type == sjFrame) {
+        uint64_t bits = getBytes(data, 8);
+        memcpy(&event->timestamp, &bits, sizeof(bits));
+    }
+    else {
+        float *values[4] = { &event->x, &event->y, &event->x2, &event->y2 };
+        for (int i = 0; i < eventFloats[type]; i++) { *values[i] = getFloat(data + (4 * i)); }
+    }
+
+    return offset + length;
+}
@@ -0,0 +1,97 @@
+//
+//  SimJournal.h
+//  Papercut
+//
+//  Input journal for reproducing a session.  Everything that reaches the
+//    simulation from outside (touches, pinches, shakes, the accelerometer)
+//    is logged with the display frame it arrived before, along with every
+//    frame's timestamp and the seed SimRandom was started from.  Replaying
+//    the journal into a world loaded with the same scene (SimWorld::replay)
+//    steps through the same frames with the same input and the same random
+//    numbers, as fast as it can go, so a slow session can be run again
+//    under the profiler.
+//
+//  The journal is kept in memory while recording and written out in one
+//    go.  On disk it's a small header and then one record per event: a
+//    type byte and its values, little-endian, a frame timestamp as a
+//    double and everything else as floats.  A chime swipe isn't an event
+//    of its own, it's replayed by the touch that ended it.
+//
+//  A plain C interface, so the view controller can record with it as
+//    well as SimWorld.  Every recording call takes a NULL journal and
+//    does nothing.
+//
+
+#ifndef SIMCORE_SIMJOURNAL_H
+#define SIMCORE_SIMJOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define SIM_JOURNAL_MAGIC       0x4a435050u     // "PPCJ"
+#define SIM_JOURNAL_VERSION     2               // 2: pieces draw from streams of their own
+#define SIM_JOURNAL_NAME_LENGTH 32              // scene name, NUL padded
+
+typedef enum {
+    sjFrame = 1,        // timestamp
+    sjTouchBegan,       // x, y
+    sjTouchMoved,       // x, y = where it was, x2, y2 = where it is
+    sjTouchEnded,       // x, y = first touch, x2, y2 = last touch
+    sjShake,
+    sjAccelerate,       // x
+    sjPinch,            // x, y, scale in x2
+    sjNumEvents
+} SimJournalEventType;
+
+// one event, decoded
+typedef struct {
+    SimJournalEventType type;
+    double              timestamp;
+    float               x;
+    float               y;
+    float               x2;
+    float               y2;
+} SimJournalEvent;
+
+typedef struct SimJournal SimJournal;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// an empty journal to record into
+SimJournal* SimJournalCreate(const char *sceneName, uint64_t seed, int viewWidth, int viewHeight);
+void SimJournalDestroy(SimJournal *journal);
+
+// recording
+void SimJournalFrame(SimJournal *journal, double timestamp);
+void SimJournalTouchBegan(SimJournal *journal, float x, float y);
+void SimJournalTouchMoved(SimJournal *journal, float beginX, float beginY, float x, float y);
+void SimJournalTouchEnded(SimJournal *journal, float firstX, float firstY, float lastX, float lastY);
+void SimJournalShake(SimJournal *journal);
+void SimJournalAccelerate(SimJournal *journal, float x);
+void SimJournalPinch(SimJournal *journal, float x, float y, float scale);
+
+// 0 on success
+int SimJournalWrite(const SimJournal *journal, FILE *file);
+
+// a journal written by SimJournalWrite, NULL if the file isn't one
+SimJournal* SimJournalRead(FILE *file);
+
+const char* SimJournalSceneName(const SimJournal *journal);
+uint64_t SimJournalSeed(const SimJournal *journal);
+int SimJournalViewWidth(const SimJournal *journal);
+int SimJournalViewHeight(const SimJournal *journal);
+size_t SimJournalSize(const SimJournal *journal);       // bytes of events
+size_t SimJournalFrames(const SimJournal *journal);
+
+// decodes the event at offset (0 = the first) and returns the offset just
+//   past it, 0 when there's no whole event there
+size_t SimJournalNext(const SimJournal *journal, size_t offset, SimJournalEvent *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+//
+//  SimMessageQueue.cpp
+//  Papercut
+//
+//  Fixed size multi-producer / single-consumer ring of SimMessages.
+//
+
+#include "SimMessageQueue.h"
+
+// positions wrap with a mask, so round the ring up to a power of two
+static size_t ringSize(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) { size <<= 1; }
+    return size;
+}
+
+SimMessageQueue::SimMessageQueue(size_t capacity)
+    : cells(ringSize(capacity)), mask(ringSize(capacity) - 1), enqueuePos(0), dequeuePos(0), overflowCount(0) {
+    reset();
+}
+
+void SimMessageQueue::reset() {
+
+    // cell i is free for the producer that claims position i
+    for (size_t i = 0; i < cells.size(); i++) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    enqueuePos.store(0, std::memory_order_relaxed);
+    dequeuePos = 0;
+    overflowCount.store(0, std::memory_order_relaxed);
+}
+
+BOOL SimMessageQueue::push(const SimMessage &message) {
+
+    Cell *cell;
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+    for (;;) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            // the cell is free for this lap, try to claim the position
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+        }
+        else if (diff < 0) {
+            // the consumer hasn't freed it since the last lap, the ring is full
+            overflowCount.fetch_add(1, std::memory_order_relaxed);
+            return NO;
+        }
+        else {
+            // another producer got there first
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->message = message;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    return YES;
+}
+
+BOOL SimMessageQueue::pop(SimMessage &message) {
+
+    Cell *cell = &cells[dequeuePos & mask];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+
+    // empty, or the producer that claimed this position is still writing it
+    if ((intptr_t)seq - (intptr_t)(dequeuePos + 1) < 0) { return NO; }
+
+    message = cell->message;
+    cell->sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+    dequeuePos++;
+
+    return YES;
+}
+
+// ___ C INTERFACE
+
+struct SimMessageRing {
+    SimMessageQueue     queue;
+
+    explicit SimMessageRing(size_t capacity) : queue(capacity) {}
+};
+
+SimMessageRing* SimMessageRingCreate(size_t capacity) {
+    return new SimMessageRing(capacity);
+}
+
+void SimMessageRingDestroy(SimMessageRing *ring) {
+    delete ring;
+}
+
+int SimMessageRingPush(SimMessageRing *ring, const SimMessagePost *message) {
+
+    SimMessage simMessage;
+    simMessage.spawnID = message->spawnID;
+    simMessage.mType = (MessageType)message->mType;
+    simMessage.bType = (BehaviorType)message->bType;
+    simMessage.turnOn = message->turnOn ? YES : NO;
+    simMessage.targetSpawnID = message->targetSpawnID;
+    simMessage.point = SimPoint(message->x, message->y);
+    simMessage.wasSpawned = message->wasSpawned ? YES : NO;
+
+    return ring->queue.push(simMessage) ? 1 : 0;
+}
+
+int SimMessageRingPop(SimMessageRing *ring, SimMessagePost *message) {
+
+    SimMessage simMessage;
+    if (!ring->queue.pop(simMessage)) { return 0; }
+
+    message->spawnID = simMessage.spawnID;
+    message->mType = simMessage.mType;
+    message->bType = simMessage.bType;
+    message->turnOn = simMessage.turnOn;
+    message->targetSpawnID = simMessage.targetSpawnID;
+    message->x = simMessage.point.x;
+    message->y = simMessage.point.y;
+    message->wasSpawned = simMessage.wasSpawned;
+
+    return 1;
+}
+
+size_t SimMessageRingPosted(const SimMessageRing *ring) {
+    return ring->queue.posted();
+}
+
+size_t SimMessageRingTaken(const SimMessageRing *ring) {
+    return ring->queue.taken();
+}
+
+long SimMessageRingOverflow(const SimMessageRing *ring) {
+    return ring->queue.overflow();
+}
@@ -0,0 +1,113 @@
+//
+//  SimMessageQueue.h
+//  Papercut
+//
+//  Fixed size ring of SimMessages for the messenger.  Any number of
+//    threads can post without locks or allocation, one thread (the
+//    world, after the walk) takes them off in the order they were
+//    posted.  When the ring is full a post is dropped and counted
+//    rather than blocking or growing.
+//
+//  Each cell carries a sequence number that says whose turn it is: a
+//    producer claims the next position with a compare-and-swap, writes
+//    the message and bumps the sequence to hand the cell to the
+//    consumer, which bumps it again a lap later to hand it back.
+//
+//  SimMessageRing is the same ring behind a plain C interface, so the
+//    app's Messenger can queue through it too.
+//
+
+#ifndef SIMCORE_SIMMESSAGEQUEUE_H
+#define SIMCORE_SIMMESSAGEQUEUE_H
+
+#include <stddef.h>
+
+// messages the ring holds between two processQueue calls, rounded up to a power of two
+#define SIM_MESSAGE_CAPACITY    1024
+
+// a message as the app queues it, the enums and flags as ints and the point as floats
+typedef struct {
+    int         spawnID;
+    int         mType;          // MessageType
+    int         bType;          // BehaviorType
+    int         turnOn;
+    int         targetSpawnID;
+    float       x;
+    float       y;
+    int         wasSpawned;
+} SimMessagePost;
+
+typedef struct SimMessageRing SimMessageRing;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SimMessageRing* SimMessageRingCreate(size_t capacity);
+void SimMessageRingDestroy(SimMessageRing *ring);
+
+// any thread, 0 if the ring was full and the message was dropped
+int SimMessageRingPush(SimMessageRing *ring, const SimMessagePost *message);
+
+// consumer only, 0 when there's nothing (finished) to take
+int SimMessageRingPop(SimMessageRing *ring, SimMessagePost *message);
+size_t SimMessageRingPosted(const SimMessageRing *ring);
+size_t SimMessageRingTaken(const SimMessageRing *ring);
+long SimMessageRingOverflow(const SimMessageRing *ring);
+
+#ifdef __cplusplus
+}
+
+#include <atomic>
+#include <vector>
+
+#include "SimTypes.h"
+
+typedef struct {
+    int             spawnID;
+    MessageType     mType;
+    BehaviorType    bType;
+    BOOL            turnOn;
+    int             targetSpawnID;
+    SimPoint        point;
+    BOOL            wasSpawned;
+} SimMessage;
+
+class SimMessageQueue {
+public:
+    explicit SimMessageQueue(size_t capacity = SIM_MESSAGE_CAPACITY);
+
+    // any thread, NO if the ring was full and the message was dropped
+    BOOL push(const SimMessage &message);
+
+    // consumer only
+    BOOL pop(SimMessage &message);
+    size_t posted() const       { return enqueuePos.load(std::memory_order_acquire); }
+    size_t taken() const        { return dequeuePos; }
+
+    size_t capacity() const     { return cells.size(); }
+    long   overflow() const     { return overflowCount.load(std::memory_order_relaxed); }
+
+    // only while nobody is posting
+    void   reset();
+
+private:
+    struct Cell {
+        std::atomic<size_t>     sequence;
+        SimMessage              message;
+    };
+
+    std::vector<Cell>       cells;
+    size_t                  mask;
+
+    std::atomic<size_t>     enqueuePos;     // next position a producer will claim
+    size_t                  dequeuePos;     // next position the consumer will read
+    std::atomic<long>       overflowCount;  // posts dropped because the ring was full
+
+    SimMessageQueue(const SimMessageQueue&);
+    SimMessageQueue& operator=(const SimMessageQueue&);
+};
+
+#endif
+
+#endif
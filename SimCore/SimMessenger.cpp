@@ -0,0 +1,108 @@
+//
+//  SimMessenger.cpp
+//  Papercut
+//
+//  Headless counterpart of Messenger.  Queues messages during the update
+//    and applies them once the object loop is done:
+//    - Spawn/kill object
+//    - Turn behavior on/off
+//    - Start/stop frame animation
+//
+
+#include "SimMessenger.h"
+#include "SimWorld.h"
+#include "SimPaper.h"
+
+void SimMessenger::queueObject(int spawnID, BehaviorType bType, BOOL on, int targetID) {
+    queueObject(spawnID, mtBehavior, bType, on, targetID, SimPoint(), NO);
+}
+
+void SimMessenger::queueObject(int spawnID, MessageType mType, BOOL on, int targetID, BOOL wSpawn) {
+    queueObject(spawnID, mType, btNone, on, targetID, SimPoint(), wSpawn);
+}
+
+void SimMessenger::queueObject(int spawnID, MessageType mType, BehaviorType bType, BOOL on,
+                               int targetID, SimPoint point, BOOL wSpawn) {
+
+    SimMessage newMessage;
+    newMessage.spawnID = spawnID;
+    newMessage.mType = mType;
+    newMessage.bType = bType;
+    newMessage.turnOn = on;
+    newMessage.targetSpawnID = targetID;
+    newMessage.point = point;
+    newMessage.wasSpawned = wSpawn;
+
+    queue.push(newMessage);
+}
+
+int SimMessenger::processQueue(SimWorld &world) {
+
+    int processed = 0;
+    size_t last = queue.posted();
+    SimMessage theMessage;
+
+    while ((queue.taken() < last) && (queue.pop(theMessage))) {
+
+        int msSpawnID   = theMessage.spawnID;
+        int msTargetID  = theMessage.targetSpawnID;
+        SimPoint msPoint = theMessage.point;
+        BOOL msSpawned  = theMessage.wasSpawned;
+
+        // get Paper object for message
+        SimPaper *mPaper = NULL;
+        if (msSpawnID > 0) { mPaper = world.getObject(msSpawnID); }
+
+        switch (theMessage.mType) {
+
+            // turning on / off behaviors
+            case mtBehavior:
+                if (mPaper == NULL) { break; }
+                if (theMessage.turnOn)  { mPaper->behavior.turnOn(theMessage.bType, msTargetID); }
+                else                    { mPaper->behavior.turnOff(theMessage.bType); }
+                break;
+
+            // spawning / killing objects
+            case mtSpawn:
+                if (theMessage.turnOn) {
+
+                    // only spawn if max objects not reached
+                    if (!world.maxObjectsReached()) {
+
+                        SimPaper *tPaper;
+                        if (mPaper != NULL) {
+                            tPaper = world.spawnPiece(mPaper, msSpawnID, msTargetID, msSpawned, msPoint);
+                        }
+                        else if (msSpawnID == 0) {
+                            tPaper = world.spawnPiece(NULL, msTargetID, 0, msSpawned, msPoint);
+                        }
+                        else {
+                            tPaper = world.spawnPiece(NULL, msSpawnID, 0, msSpawned, msPoint);
+                        }
+
+                        world.addToView(tPaper);
+                    }
+
+                }
+                else if (mPaper != NULL) {
+                    // kill object
+                    mPaper->remove = YES;
+                }
+                break;
+
+            // turning on / off animations
+            case mtAnimate:
+                if (mPaper == NULL) { break; }
+                if (theMessage.turnOn)  { mPaper->startAnimating(); }
+                else                    { mPaper->stopAnimating(); }
+                break;
+
+            default:
+                break;
+        }
+
+        processed++;
+    }
+
+    return processed;
+}
@@ -0,0 +1,40 @@
+//
+//  SimMessenger.h
+//  Papercut
+//
+//  Headless counterpart of Messenger.  Queues messages during the update
+//    and applies them once the object loop is done:
+//    - Spawn/kill object
+//    - Turn behavior on/off
+//    - Start/stop frame animation
+//
+//  Messages are applied strictly in the order they were queued.  The
+//    queue is a preallocated lock-free ring, so queueing never allocates
+//    and is safe from any thread.
+//
+
+#ifndef SIMCORE_SIMMESSENGER_H
+#define SIMCORE_SIMMESSENGER_H
+
+#include "SimTypes.h"
+#include "SimMessageQueue.h"
+
+class SimWorld;
+
+class SimMessenger {
+public:
+    SimMessageQueue queue;
+
+    void queueObject(int spawnID, BehaviorType bType, BOOL on, int targetID);
+    void queueObject(int spawnID, MessageType mType, BOOL on, int targetID, BOOL wSpawn = NO);
+    void queueObject(int spawnID, MessageType mType, BehaviorType bType, BOOL on,
+                     int targetID, SimPoint point, BOOL wSpawn);
+
+    // applies everything queued before the call, messages queued while it runs
+    //   wait for the next one; returns the # of messages applied
+    int  processQueue(SimWorld &world);
+    long overflow() const   { return queue.overflow(); }    // messages dropped on a full queue
+    void reset()            { queue.reset(); }
+};
+
+#endif
@@ -0,0 +1,153 @@
+//
+//  SimNeighborGrid.cpp
+//  Papercut
+//
+//  Uniform spatial hash used for the flocking neighbor queries.
+//
+
+#include "SimNeighborGrid.h"
+#include "SimPaper.h"
+
+// more cells than this in one query and it's cheaper to scan everything
+#define GRID_MAX_QUERY_CELLS 16
+
+SimNeighborGrid::SimNeighborGrid() : invCellSize(1.0), bucketMask(0) {
+    bucketStart.assign(2, 0);
+}
+
+uint32_t SimNeighborGrid::bucketFor(int cx, int cy) const {
+    // large primes spread neighboring cells across the table
+    uint32_t h = ((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u);
+    return h & bucketMask;
+}
+
+uint32_t SimNeighborGrid::bucketFor(SimPoint point) const {
+    return bucketFor((int)floorf(point.x * invCellSize), (int)floorf(point.y * invCellSize));
+}
+
+void SimNeighborGrid::build(const std::vector<SimPaper*> &pieces, const std::vector<SimPoint> &centers, CGFloat cellSize) {
+
+    invCellSize = 1.0 / cellSize;
+
+    // about two buckets per piece keeps collisions rare
+    uint32_t numBuckets = 1;
+    while (numBuckets < (pieces.size() * 2)) { numBuckets <<= 1; }
+    bucketMask = numBuckets - 1;
+
+    bucketStart.assign(numBuckets + 1, 0);
+    itemBucket.resize(pieces.size());
+    items.resize(pieces.size());
+    itemCenter.resize(pieces.size());
+
+    // count pieces per bucket
+    for (size_t i = 0; i < pieces.size(); i++) {
+        uint32_t bucket = bucketFor(centers[i]);
+        itemBucket[i] = bucket;
+        bucketStart[bucket + 1]++;
+    }
+
+    // prefix sum, bucketStart[b + 1] is now the end of bucket b
+    for (uint32_t b = 0; b < numBuckets; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    // scatter, walking backwards keeps each bucket in queue order
+    for (size_t i = pieces.size(); i > 0; i--) {
+        uint32_t bucket = itemBucket[i - 1];
+        uint32_t item = --bucketStart[bucket + 1];
+        items[item] = pieces[i - 1];
+        itemCenter[item] = centers[i - 1];
+    }
+
+    // the scatter left bucket b's start in slot b + 1, so shift down
+    for (uint32_t b = 0; b < numBuckets; b++) {
+        bucketStart[b] = bucketStart[b + 1];
+    }
+    bucketStart[numBuckets] = (uint32_t)pieces.size();
+}
+
+void SimNeighborGrid::clear() {
+    items.clear();
+    itemCenter.clear();
+    bucketMask = 0;
+    bucketStart.assign(2, 0);
+}
+
+void SimNeighborGrid::reserve(size_t numPieces) {
+
+    uint32_t numBuckets = 1;
+    while (numBuckets < (numPieces * 2)) { numBuckets <<= 1; }
+
+    bucketStart.reserve(numBuckets + 1);
+    items.reserve(numPieces);
+    itemCenter.reserve(numPieces);
+    itemBucket.reserve(numPieces);
+}
+
+void SimNeighborGrid::remove(const SimPaper *piece) {
+
+    for (size_t i = 0; i < items.size(); i++) {
+        if (items[i] == piece) {
+            items[i] = NULL;
+            return;
+        }
+    }
+}
+
+void SimNeighborGrid::scanBucket(uint32_t bucket, SimPoint point, CGFloat radiusSq, const SimPaper *exclude,
+                                 std::vector<SimPaper*> &neighbors) const {
+
+    for (uint32_t i = bucketStart[bucket]; i < bucketStart[bucket + 1]; i++) {
+
+        SimPaper *nPiece = items[i];
+        if ((nPiece == NULL) || (nPiece == exclude)) { continue; }
+
+        CGFloat dx = itemCenter[i].x - point.x;
+        CGFloat dy = itemCenter[i].y - point.y;
+        if (((dx * dx) + (dy * dy)) < radiusSq) {
+            neighbors.push_back(nPiece);
+        }
+    }
+}
+
+void SimNeighborGrid::query(SimPoint point, CGFloat radius, const SimPaper *exclude,
+                            std::vector<SimPaper*> &neighbors) const {
+
+    if (items.empty()) { return; }
+
+    CGFloat radiusSq = radius * radius;
+
+    int minX = (int)floorf((point.x - radius) * invCellSize);
+    int maxX = (int)floorf((point.x + radius) * invCellSize);
+    int minY = (int)floorf((point.y - radius) * invCellSize);
+    int maxY = (int)floorf((point.y + radius) * invCellSize);
+
+    int numCells = (maxX - minX + 1) * (maxY - minY + 1);
+    if ((numCells > GRID_MAX_QUERY_CELLS) || ((uint32_t)numCells > bucketMask)) {
+        scanBucket(0, point, radiusSq, exclude, neighbors);
+        for (uint32_t b = 1; b <= bucketMask; b++) {
+            scanBucket(b, point, radiusSq, exclude, neighbors);
+        }
+        return;
+    }
+
+    // two cells can hash to the same bucket, only walk each bucket once
+    uint32_t visited[GRID_MAX_QUERY_CELLS];
+    int numVisited = 0;
+
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+
+            uint32_t bucket = bucketFor(cx, cy);
+
+            BOOL seen = NO;
+            for (int v = 0; v < numVisited; v++) {
+                if (visited[v] == bucket) { seen = YES; break; }
+            }
+            if (seen) { continue; }
+            visited[numVisited++] = bucket;
+
+            scanBucket(bucket, point, radiusSq, exclude, neighbors);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+//
+//  SimNeighborGrid.h
+//  Papercut
+//
+//  Uniform spatial hash used for the flocking neighbor queries.  Built
+//    once per frame from the pieces in queue_clean, then queried for all
+//    pieces within a fixed radius of a point, so finding neighbors looks
+//    at a handful of cells instead of the whole queue.
+//
+//  Cells are laid out with a counting sort into flat arrays, so after
+//    the first few frames a rebuild doesn't allocate.  Each piece is
+//    filed under the center it was built with, the world's published
+//    center for the tick, and distances are tested against that too, so
+//    pieces moving during the walk don't change who their neighbors are.
+//
+
+#ifndef SIMCORE_SIMNEIGHBORGRID_H
+#define SIMCORE_SIMNEIGHBORGRID_H
+
+#include <vector>
+
+#include "SimTypes.h"
+
+class SimPaper;
+
+class SimNeighborGrid {
+public:
+    SimNeighborGrid();
+
+    // cellSize should be about the query radius, centers[i] is where pieces[i] is filed
+    void build(const std::vector<SimPaper*> &pieces, const std::vector<SimPoint> &centers, CGFloat cellSize);
+    void clear();
+    void reserve(size_t numPieces);
+
+    // drop a piece that left the queue since the build
+    void remove(const SimPaper *piece);
+
+    // appends every piece other than exclude whose filed center lies
+    //   strictly within radius of point
+    void query(SimPoint point, CGFloat radius, const SimPaper *exclude,
+               std::vector<SimPaper*> &neighbors) const;
+
+    size_t size() const     { return items.size(); }
+
+private:
+    CGFloat                 invCellSize;
+    uint32_t                bucketMask;     // bucket count - 1, power of two
+
+    std::vector<uint32_t>   bucketStart;    // first item of each bucket, +1 sentinel
+    std::vector<SimPaper*>  items;          // pieces sorted by bucket, NULL once removed
+    std::vector<SimPoint>   itemCenter;     // center each item was filed under
+    std::vector<uint32_t>   itemBucket;     // scratch for the counting sort
+
+    uint32_t bucketFor(int cx, int cy) const;
+    uint32_t bucketFor(SimPoint point) const;
+    void scanBucket(uint32_t bucket, SimPoint point, CGFloat radiusSq, const SimPaper *exclude,
+                    std::vector<SimPaper*> &neighbors) const;
+};
+
+#endif
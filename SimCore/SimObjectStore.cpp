@@ -0,0 +1,214 @@
+//
+//  SimObjectStore.cpp
+//  Papercut
+//
+//  Slot map that owns the list of live Paper pieces for the world.
+//    Erasing swaps the last packed piece into the hole, so adds and
+//    removes are O(1) and the packed array never has gaps.
+//
+
+#include <string.h>
+
+#include "SimObjectStore.h"
+
+SimObjectStore::SimObjectStore() {
+    memset(tagCounts, 0, sizeof(tagCounts));
+}
+
+SimHandle SimObjectStore::insert(SimPaper *paperPiece, int spawnID) {
+
+    uint32_t slotIndex;
+    if (!freeSlots.empty()) {
+        slotIndex = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        Slot newSlot;
+        newSlot.generation = 1;
+        slots.push_back(newSlot);
+        slotIndex = (uint32_t)(slots.size() - 1);
+
+        // grow the free list and ID table with the slots so erase never has to allocate
+        if (freeSlots.capacity() < slots.capacity()) { freeSlots.reserve(slots.capacity()); }
+        if (idTable.size() < (slots.size() * 2)) { idRehash(slots.capacity() * 2); }
+    }
+
+    Slot &slot = slots[slotIndex];
+    slot.dense = (uint32_t)dense.size();
+    slot.spawnID = spawnID;
+
+    dense.push_back(paperPiece);
+    denseSlot.push_back(slotIndex);
+    denseTags.push_back(otNone);
+
+    if (spawnID >= 0) { idInsert(spawnID, slotIndex); }
+
+    return SimHandle(slotIndex, slot.generation);
+}
+
+void SimObjectStore::erase(SimHandle h) {
+
+    const Slot *live = liveSlot(h);
+    if (live == NULL) { return; }
+
+    Slot &slot = slots[h.index];
+    uint32_t hole = slot.dense;
+    uint32_t last = (uint32_t)(dense.size() - 1);
+
+    for (int t = 0; t < SIM_NUM_TAGS; t++) {
+        if (denseTags[hole] & (1 << t)) { tagCounts[t]--; }
+    }
+
+    // move the last packed piece into the hole
+    if (hole != last) {
+        dense[hole] = dense[last];
+        denseSlot[hole] = denseSlot[last];
+        denseTags[hole] = denseTags[last];
+        slots[denseSlot[hole]].dense = hole;
+    }
+    dense.pop_back();
+    denseSlot.pop_back();
+    denseTags.pop_back();
+
+    if (slot.spawnID >= 0) { idErase(slot.spawnID, h.index); }
+
+    slot.generation++;
+    if (slot.generation == 0) { slot.generation = 1; }     // never hand out the null generation
+    freeSlots.push_back(h.index);
+}
+
+void SimObjectStore::clear() {
+
+    // keep the slots so handles from before the clear stay stale
+    for (size_t i = 0; i < slots.size(); i++) {
+        slots[i].generation++;
+        if (slots[i].generation == 0) { slots[i].generation = 1; }
+    }
+
+    freeSlots.clear();
+    for (size_t i = slots.size(); i > 0; i--) { freeSlots.push_back((uint32_t)(i - 1)); }
+
+    dense.clear();
+    denseSlot.clear();
+    denseTags.clear();
+    for (size_t i = 0; i < idTable.size(); i++) { idTable[i].spawnID = -1; }
+    memset(tagCounts, 0, sizeof(tagCounts));
+}
+
+const SimObjectStore::Slot* SimObjectStore::liveSlot(SimHandle h) const {
+
+    if ((h.isNull()) || (h.index >= slots.size())) { return NULL; }
+
+    const Slot &slot = slots[h.index];
+    if (slot.generation != h.generation) { return NULL; }
+    if ((slot.dense >= denseSlot.size()) || (denseSlot[slot.dense] != h.index)) { return NULL; }
+
+    return &slot;
+}
+
+SimPaper* SimObjectStore::get(SimHandle h) const {
+    const Slot *slot = liveSlot(h);
+    return (slot == NULL) ? NULL : dense[slot->dense];
+}
+
+SimPaper* SimObjectStore::find(int spawnID) const {
+
+    if ((spawnID < 0) || (idTable.empty())) { return NULL; }
+
+    size_t mask = idTable.size() - 1;
+    for (size_t i = idHome(spawnID); idTable[i].spawnID >= 0; i = (i + 1) & mask) {
+        if (idTable[i].spawnID == spawnID) { return dense[slots[idTable[i].slot].dense]; }
+    }
+    return NULL;
+}
+
+// ___ ID TABLE
+//  linear probing; spawn IDs mostly count up, and multiplying by an odd
+//    constant keeps a run of them on distinct buckets
+
+size_t SimObjectStore::idHome(int spawnID) const {
+    return ((uint32_t)spawnID * 2654435761u) & (idTable.size() - 1);
+}
+
+void SimObjectStore::idInsert(int spawnID, uint32_t slotIndex) {
+
+    size_t mask = idTable.size() - 1;
+    size_t i = idHome(spawnID);
+    while ((idTable[i].spawnID >= 0) && (idTable[i].spawnID != spawnID)) { i = (i + 1) & mask; }
+
+    idTable[i].spawnID = spawnID;
+    idTable[i].slot = slotIndex;
+}
+
+void SimObjectStore::idErase(int spawnID, uint32_t slotIndex) {
+
+    if (idTable.empty()) { return; }
+
+    size_t mask = idTable.size() - 1;
+    size_t i = idHome(spawnID);
+    while (idTable[i].spawnID != spawnID) {
+        if (idTable[i].spawnID < 0) { return; }
+        i = (i + 1) & mask;
+    }
+    if (idTable[i].slot != slotIndex) { return; }      // the ID has moved on to another piece
+
+    // shift the rest of the run back over the hole so no probe stops short
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask; idTable[j].spawnID >= 0; j = (j + 1) & mask) {
+        size_t home = idHome(idTable[j].spawnID);
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            idTable[hole] = idTable[j];
+            hole = j;
+        }
+    }
+    idTable[hole].spawnID = -1;
+}
+
+void SimObjectStore::idRehash(size_t capacity) {
+
+    size_t size = 16;
+    while (size < capacity) { size <<= 1; }
+
+    std::vector<IDEntry> old;
+    old.swap(idTable);
+
+    IDEntry empty = { -1, 0 };
+    idTable.assign(size, empty);
+    for (size_t i = 0; i < old.size(); i++) {
+        if (old[i].spawnID >= 0) { idInsert(old[i].spawnID, old[i].slot); }
+    }
+}
+
+int SimObjectStore::tagIndex(ObjTag tag) {
+    int t = 0;
+    while ((t < SIM_NUM_TAGS) && (tag != (1 << t))) { t++; }
+    return t;
+}
+
+void SimObjectStore::setTag(SimHandle h, ObjTag tag) {
+    const Slot *slot = liveSlot(h);
+    if ((slot == NULL) || (denseTags[slot->dense] & tag)) { return; }
+    denseTags[slot->dense] |= tag;
+    tagCounts[tagIndex(tag)]++;
+}
+
+void SimObjectStore::clearTag(SimHandle h, ObjTag tag) {
+    const Slot *slot = liveSlot(h);
+    if ((slot == NULL) || (!(denseTags[slot->dense] & tag))) { return; }
+    denseTags[slot->dense] &= ~tag;
+    tagCounts[tagIndex(tag)]--;
+}
+
+void SimObjectStore::clearTagAll(ObjTag tag) {
+    for (size_t i = 0; i < denseTags.size(); i++) { denseTags[i] &= ~tag; }
+    tagCounts[tagIndex(tag)] = 0;
+}
+
+BOOL SimObjectStore::hasTag(SimHandle h, ObjTag tag) const {
+    const Slot *slot = liveSlot(h);
+    return ((slot != NULL) && ((denseTags[slot->dense] & tag) == tag)) ? YES : NO;
+}
+
+int SimObjectStore::tagCount(ObjTag tag) const {
+    return tagCounts[tagIndex(tag)];
+}
@@ -0,0 +1,105 @@
+//
+//  SimObjectStore.h
+//  Papercut
+//
+//  Slot map that owns the list of live Paper pieces for the world.
+//    Pieces are packed into one contiguous array so the update loop is a
+//    linear walk, and are referenced from outside through generation
+//    checked handles that go stale (instead of dangling) once a piece
+//    is removed.  Collision / pinch / shake / wiggle membership is kept
+//    as tag bits next to each piece rather than in separate dictionaries.
+//
+
+#ifndef SIMCORE_SIMOBJECTSTORE_H
+#define SIMCORE_SIMOBJECTSTORE_H
+
+#include <vector>
+
+#include "SimTypes.h"
+
+class SimPaper;
+
+// stable reference to a piece in the store, generation 0 = null
+struct SimHandle {
+    uint32_t index;
+    uint32_t generation;
+
+    SimHandle() : index(0), generation(0) {}
+    SimHandle(uint32_t i, uint32_t g) : index(i), generation(g) {}
+
+    bool isNull() const                         { return (generation == 0); }
+    bool operator==(const SimHandle &h) const   { return ((index == h.index) && (generation == h.generation)); }
+    bool operator!=(const SimHandle &h) const   { return !(*this == h); }
+};
+
+// secondary views of the store
+typedef enum {
+    otNone          = 0x00000,
+    otCollision     = 0x00001,  // objects_coll
+    otPinch         = 0x00002,  // objects_pinch
+    otShake         = 0x00004,  // objects_shake
+    otWiggle        = 0x00008,  // objects_wiggle
+    otView          = 0x00010,  // queue_view
+    otClean         = 0x00020,  // member of queue_clean
+    otLinked        = 0x00040   // moved or changed by another piece during the walk
+} ObjTag;
+
+#define SIM_NUM_TAGS    7
+
+class SimObjectStore {
+public:
+    SimObjectStore();
+
+    SimHandle insert(SimPaper *paperPiece, int spawnID);
+    void      erase(SimHandle h);
+    void      clear();
+
+    SimPaper* get(SimHandle h) const;           // NULL if the handle is stale
+    SimPaper* find(int spawnID) const;          // NULL if no live piece has the ID
+
+    // dense iteration, order changes when pieces are erased
+    size_t    size() const                      { return dense.size(); }
+    bool      empty() const                     { return dense.empty(); }
+    SimPaper* operator[](size_t i) const        { return dense[i]; }
+    size_t    slotCount() const                 { return slots.size(); }   // every handle index is below this
+
+    // tag views
+    void      setTag(SimHandle h, ObjTag tag);
+    void      clearTag(SimHandle h, ObjTag tag);
+    void      clearTagAll(ObjTag tag);
+    BOOL      hasTag(SimHandle h, ObjTag tag) const;
+    BOOL      hasTagAt(size_t i, ObjTag tag) const  { return ((denseTags[i] & tag) == tag); }
+    int       tagCount(ObjTag tag) const;
+
+private:
+    struct Slot {
+        uint32_t    dense;          // index into the packed arrays while live
+        uint32_t    generation;     // bumped on erase so old handles go stale
+        int         spawnID;
+    };
+
+    std::vector<Slot>       slots;
+    std::vector<uint32_t>   freeSlots;
+
+    std::vector<SimPaper*>  dense;      // packed pieces
+    std::vector<uint32_t>   denseSlot;  // slot owning each packed piece
+    std::vector<int>        denseTags;  // ObjTag bits for each packed piece
+
+    // spawnID -> slot, open addressed and sized to the slots, not the IDs
+    struct IDEntry {
+        int         spawnID;        // -1 = empty
+        uint32_t    slot;
+    };
+    std::vector<IDEntry>    idTable;    // power of two, never more than half full
+    int                     tagCounts[SIM_NUM_TAGS];
+
+    static int tagIndex(ObjTag tag);
+    const Slot* liveSlot(SimHandle h) const;
+
+    size_t idHome(int spawnID) const;
+    void   idInsert(int spawnID, uint32_t slotIndex);
+    void   idErase(int spawnID, uint32_t slotIndex);
+    void   idRehash(size_t capacity);
+};
+
+#endif
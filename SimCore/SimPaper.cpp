@@ -0,0 +1,529 @@
+//
+//  SimPaper.cpp
+//  Papercut
+//
+//  Headless counterpart of Paper.  Holds the same per-object properties
+//    built from PaperProps, minus the UIKit view.  Core Animation work is
+//    reduced to the state the simulation actually observes: whether frame
+//    animation is running, when frameAnimComplete fires and when a layer
+//    animation would call animationDidStop.
+//
+
+#include "SimPaper.h"
+#include "SimWorld.h"
+#include "SimPathSampler.h"
+
+SimPaper::SimPaper(const PaperProps &prp, const PaperPropsAnim &prpAnim,
+                   const PaperPropsTouchspot &prpTouch, const SimPaper *parentPaper, SimWorld *world) {
+
+    double   tRand;
+    CGFloat  tRandVel;
+
+    behavior.world = world;
+    random = world->newPieceStream();
+
+    // PAPER INITIALIZATION ________________________
+
+    switch (prp.paperType) {
+
+        case Paper_Image:
+        {
+            // set center here to avoid conflict with anchorPoint for svg images
+            if (parentPaper == NULL) { center = SimPoint(prp.spawnX, prp.spawnY); }
+            else {
+                // use dir to account for flipped parent images
+                center = SimPoint(parentPaper->center.x + (parentPaper->dir * parentPaper->childSpawn.x),
+                                  parentPaper->center.y + parentPaper->childSpawn.y);
+            }
+            break;
+        }
+
+        case Paper_Vector:
+        default:
+            break;
+
+    }
+
+    // PROPERTIES _________________________________
+
+    // defaults / pre-calcs
+    spawnID         = 0;
+    flip            = 1;
+    tsRand          = 0;
+    animated        = NO;
+    remove          = NO;
+    manageRemove    = NO;
+    transformEnabled= NO;
+    alpha           = 1.0;
+    zPos            = 0;
+    viewOrder       = 0;
+    hasPrevPosition = NO;
+
+    // no image to measure, so take the size from the table when it has one
+    halfSize = SimPoint(((prp.imageSizeWidth > 0.0) ? prp.imageSizeWidth : SIM_DEFAULT_IMAGE_SIZE) / 2,
+                        ((prp.imageSizeHeight > 0.0) ? prp.imageSizeHeight : SIM_DEFAULT_IMAGE_SIZE) / 2);
+
+    // properties based on PaperProps
+    objID               = prp.objID;
+    bounded             = prp.bounded;
+    collision           = prp.collision;
+    mass                = prp.mass;
+    dir                 = 1;
+    orientation         = prp.orientation;
+    randSpawn           = prp.randSpawn;
+    posSpawn            = SimPoint(prp.spawnX, prp.spawnY);
+    if (prp.zPos != 0)  { zPos = prp.zPos; }
+    moveType            = prp.moveType;
+    paperType           = prp.paperType;
+    bindType            = prp.bindType;
+    bob                 = prp.bob;
+    flipX               = prp.flipX;
+    flipTime            = prp.flipTime;
+    childImage          = prp.childImage;
+    childSpawn          = SimPoint(prp.childSpawnX, prp.childSpawnY);
+    groupID             = prp.groupID;
+    pinch               = prp.pinch;
+    pinchMax            = prp.pinchMax;
+    pinchMin            = prp.pinchMin;
+    scaleStart          = prp.scaleStart;
+    killOnTouch         = prp.killOnTouch;
+    spawnByShake        = prp.spawnByShake;
+    killTime            = prp.killTime;
+    movePath            = prp.movePath;
+    pathTime            = prp.pathTime;
+    numPaths            = prp.numPaths;
+    removeOnClean       = prp.removeOnClean;
+    wiggleTime          = prp.wiggleTime;
+    wiggleAngle         = prp.wiggleAngle;
+    objLimit            = prp.objLimit;
+    frames              = 0;
+    frameDur            = prp.frameDur;
+    frameRepeat         = 0;
+
+    // headless animation state
+    animating           = NO;
+    frameAnimRemaining  = 0.0;
+    frameAnimCompleteIn = -1.0;
+    layerAnimEndIn      = -1.0;
+    fadeOutIn           = -1.0;
+    wiggleRemaining     = 0.0;
+    pathIndex           = 0;
+    pathSampler         = NULL;
+    pathElapsed         = 0.0;
+    pathRepeat          = 0;
+
+    // INFO BUTTON
+    if (objID == 45) {
+        alpha = 0.8;
+    }
+
+    // randomize some properties a little so multiples of the
+    //   same vertical objects don't all bob/sway in sync or have the same velocity
+
+    float tDraws[3];
+    SimRandomFillRange(&random, tDraws, 3, 0.0f, 1.0f);
+
+    tRand = floorf(tDraws[0] * 0.6f);
+    bobAmp              = prp.bobAmp + tRand;
+
+    tRand = floorf(tDraws[1] * 1.7f);
+    bobOffset           = prp.bobOffset + tRand;
+
+    // don't randomize velocity for shaken objects
+    if (spawnByShake) {
+        behavior.vel = SimVector(prp.velX, prp.velY);
+    }
+    else {
+        tRand = floorf(tDraws[2] * 1.5f);
+        if (prp.velY > 0.0) {
+            tRandVel = prp.velY + tRand;
+        }
+        else if (prp.velY < 0.0) {
+            tRandVel = prp.velY - tRand;
+        }
+        else {
+            tRandVel = 0.0;
+        }
+        behavior.vel = SimVector(prp.velX, tRandVel);
+    }
+
+
+    // BEHAVIOR _______________________________
+    behavior.pSelf          = this;
+    behavior.velX           = prp.velX;
+    behavior.velY           = prp.velY;
+    behavior.flipX          = prp.flipX;
+    behavior.bSpeed         = prp.bSpeed;
+    behavior.bKillOnArrive  = prp.bKillOnArrive;
+    behavior.bSeekOffset    = SimPoint(prp.bSeekOffsetX, prp.bSeekOffsetY);
+    behavior.rVelMax        = prp.rVelMax;
+    behavior.rVelMin        = prp.rVelMin;
+    behavior.spawnCount     = prp.spawnCount;
+    behavior.spawnCountCheck= 0.0;
+    behavior.animFrameDur   = prp.frameDur;
+    behavior.autoReverse    = prp.autoReverse;
+    behavior.decelType      = prp.decelType;
+    behavior.angledPath     = prp.angledPath;
+    behavior.viewCheckType  = prp.vcType;
+    behavior.peekTime       = prp.peekTime;
+    behavior.bFlocking      = prp.bFlocking;
+    behavior.sinkAngle      = DEGREES_TO_RADIANS(prp.sinkAngle);
+    behavior.sinkAngleInterval  = 0.0;
+    behavior.fixedDir       = prp.fixedDir;
+    behavior.bHalfSize      = halfSize;         // used to optimize variable accessing in Behavior
+
+
+    // ___ flip
+    if ((prp.flipTime > 0) && (prp.frames == 0)) {
+        behavior.addTimer(SimTimer(btAxisflip, prp.flipTime, 0.0, 0.0), btAxisflip);
+        behavior.turnOn(btAxisflip);
+    }
+
+    // ___ bob
+    if (prp.bob) { behavior.BobOn(prp.bobAmp, prp.bobOffset); }
+
+    // ___ drift
+    if ((prp.moveType == Move_Auto) || (prp.moveType == Move_Touch)) { behavior.turnOn(btDrift); }
+
+    // ___ decel
+    if (prp.decelType != Decel_None) { behavior.turnOn(btDecel); }
+
+    // ___ seek
+    if (prp.seekDelay > 0.0) {
+        // add an inert timer for later activation
+        behavior.addTimer(SimTimer(btSeek, prp.seekDelay, NO, NO, prp.rVelTimeMax, prp.rVelTimeMin), btSeek);
+    }
+
+    // ___ randvel
+    if (prp.rVelOn) {
+        CGFloat brVelTime = SimRandomNextRange(&random, prp.rVelTimeMax, prp.rVelTimeMin);
+        behavior.addTimer(SimTimer(btRandvel, brVelTime, prp.rVelTimeMax, prp.rVelTimeMin), btRandvel);
+        behavior.turnOn(btRandvel);
+    }
+
+    // ___ toroid
+    if (prp.spawnTime > 0.0) {
+        behavior.addTimer(SimTimer(btToroid, prp.spawnTime, 0.0, 0.0), btToroid);
+        behavior.turnOn(btToroid);
+    }
+
+    // ___ sink
+    if (prp.spawnByShake) {
+        behavior.addTimer(SimTimer(btSink, prp.killTime, NO, NO, 0.0, 0.0), btSink);
+    }
+
+    // ___ peek
+    if (prp.peekTime > 0.0) {
+        behavior.addTimer(SimTimer(btPeek, prp.peekTime, YES, YES, 0.0, 0.0), btPeek);
+        behavior.turnOn(btPeek);
+
+        // also add a Wait timer for later
+        behavior.addTimer(SimTimer(btWait, prp.peekTime, NO, NO, 0.0, 0.0), btWait);
+    }
+
+    // ___ flocking
+    if (prp.bFlocking) {
+        behavior.turnOnFlocking();
+    }
+
+    // ___ tilt timer
+    if ((prp.moveType == Move_Touch) && (prp.bounded)) {
+        behavior.addTimer(SimTimer(btTilt, 2.0, NO, NO, 0.0, 0.0), btTilt);
+    }
+
+
+    // TOUCHSPOT ______________________________
+    if (prp.tsID > 0) {
+        touchSpot = SimRect(prpTouch.tsX, prpTouch.tsY, prpTouch.tsWd, prpTouch.tsHt);
+        tsRand = prpTouch.objID;
+    }
+
+    // ANIMATION ______________________________
+    //   only the timing of each Core Animation is kept; a repeat count of 0
+    //   is a single pass and FLT_MAX never ends
+
+    switch (paperType) {
+
+        case Paper_Image:
+        {
+
+            // custom animation properties - angle/position (i.e. weeds, big fish)
+            if ((prp.animID > 0) && (prp.frames == 0)) {
+                animated = YES;
+
+                CGFloat groupRepeat = (prpAnim.repeat > 0.0) ? prpAnim.repeat : 1.0;
+                if (groupRepeat < FLT_MAX) {
+                    layerAnimEndIn = prpAnim.duration * groupRepeat;
+                }
+            }
+
+#ifdef FRAMES_ON
+
+            // setup frame animation
+            if (prp.frames > 0) {
+
+                animated = YES;
+
+                // turn on behavior and create timer
+                if (prp.animTime > 0.0) {
+                    behavior.addTimer(SimTimer(btAnimframe, prp.animTime, 0.0, 0.0), btAnimframe);
+                    behavior.turnOn(btAnimframe);
+                }
+
+                frames      = prp.frames;
+                frameRepeat = prp.animID;
+
+                if (((behavior.vel.lengthSquared() > 0.0) && (prp.animTime == 0.0)) || (movePath)) {
+                    startAnimating();
+                    frameAnimCompleteIn = behavior.animFrameDur;
+                }
+
+            }
+
+#endif
+
+            // if image should move along a path
+            if (movePath) {
+
+                animated = YES;
+
+                // same pick as the renderer, the simulation follows the path itself
+                pathIndex = (numPaths > 0) ? (int)SimRandomNextUniform(&random, numPaths) + 1 : 0;
+                pathSampler = world->pathSampler(objID, prp.imagePath, pathIndex);
+                pathRepeat = prp.animID;
+
+                if ((pathSampler) && (!pathSampler->isEmpty())) {
+                    center = pathSampler->sample(0.0, &pathTangent);
+                }
+
+                if (prp.animID != 0) {
+                    CGFloat pathEnd = pathTime * prp.animID;
+                    if ((layerAnimEndIn < 0.0) || (pathEnd < layerAnimEndIn)) { layerAnimEndIn = pathEnd; }
+                }
+            }
+
+            break;
+        }
+
+        case Paper_Vector:
+        {
+            SimPoint newCenter;
+            CGFloat imageScale = (parentPaper != NULL) ? fabsf(parentPaper->transform.a) : 0.0;
+
+            if (parentPaper == NULL) {
+                newCenter = SimPoint(prp.spawnX, prp.spawnY);
+            }
+            else {
+                CGFloat scaleSpawnX, scaleSpawnY;
+                scaleSpawnY = parentPaper->childSpawn.y * imageScale;
+
+                if (parentPaper->dir == parentPaper->orientation) {
+                    scaleSpawnX = ((parentPaper->dir * parentPaper->childSpawn.x) - 35) * imageScale;
+                }
+                else {
+                    scaleSpawnX = (parentPaper->dir * parentPaper->childSpawn.x) * imageScale;
+                }
+                newCenter = SimPoint(parentPaper->center.x + scaleSpawnX,
+                                     parentPaper->center.y + scaleSpawnY);
+            }
+
+            shapePosition = newCenter;
+
+            // path morph between the two svg shapes
+            if (prp.animID >= 0) {
+                CGFloat morphEnd = prp.frameDur * ((prp.animID > 0) ? prp.animID : 1);
+                if (behavior.autoReverse) { morphEnd *= 2; }
+                layerAnimEndIn = morphEnd;
+            }
+
+            // also scale the animation if spawned from a parent
+            //   i.e. small note to normal-sized fish
+            if ((parentPaper != NULL) && ((layerAnimEndIn < 0.0) || (prp.frameDur < layerAnimEndIn))) {
+                layerAnimEndIn = prp.frameDur;
+            }
+
+            // Movement along a curved path (notefish)
+            if (prp.crvXOffMin != 0.0) {
+
+                CGFloat curveXOffset = SimRandomNextRange(&random, prp.crvXOffMin, prp.crvXOffMax);
+                CGFloat curveYOffset = SimRandomNextRange(&random, prp.crvYOffMin, prp.crvYOffMax);
+                CGFloat curveCOffset = SimRandomNextRange(&random, prp.crvCOffMin, prp.crvCOffMax);
+                (void)curveXOffset;
+                (void)curveCOffset;
+
+                curvePoint = SimPoint(newCenter.x, newCenter.y - curveYOffset);
+
+                if ((layerAnimEndIn < 0.0) || (prp.frameDur < layerAnimEndIn)) {
+                    layerAnimEndIn = prp.frameDur;
+                }
+            }
+
+            break;
+        }
+
+        default:
+            break;
+
+    }
+
+}
+
+void SimPaper::startAnimating() {
+
+    // UIImageView does nothing without animationImages
+    if (frames == 0) { return; }
+
+    animating = YES;
+    frameAnimRemaining = (frameRepeat == 0) ? FLT_MAX : (frameDur * frameRepeat);
+}
+
+void SimPaper::advanceAnimations(CGFloat interval) {
+
+    if ((animating) && (frameAnimRemaining < FLT_MAX)) {
+        frameAnimRemaining -= interval;
+        if (frameAnimRemaining <= 0.0) { animating = NO; }
+    }
+
+    if (frameAnimCompleteIn >= 0.0) {
+        frameAnimCompleteIn -= interval;
+        if (frameAnimCompleteIn < 0.0) { frameAnimComplete(); }
+    }
+
+    if (layerAnimEndIn >= 0.0) {
+        layerAnimEndIn -= interval;
+        if (layerAnimEndIn < 0.0) { animationDidStop(); }
+    }
+
+    // the wiggle animation has this piece as its delegate too
+    if (wiggleRemaining > 0.0) {
+        wiggleRemaining -= interval;
+        if (wiggleRemaining <= 0.0) {
+            wiggleRemaining = 0.0;
+            animationDidStop();
+        }
+    }
+
+    if (fadeOutIn >= 0.0) {
+        fadeOutIn -= interval;
+        alpha = (fadeOutIn > 0.0) ? (fadeOutIn / 0.2) : 0.0;
+        if (fadeOutIn < 0.0) { remove = YES; }
+    }
+}
+
+CGFloat SimPaper::pathFraction() const {
+
+    if (pathTime <= 0.0) { return 0.0; }
+
+    // fillMode forwards, a finished path leaves the piece at the end
+    if ((pathRepeat > 0) && (pathElapsed >= (pathTime * pathRepeat))) { return 1.0; }
+
+    return fmodf(pathElapsed, pathTime) / pathTime;
+}
+
+void SimPaper::animationDidStop() {
+
+    // remove paper if animation completes - only for temp spawned objects (objID > 99)
+    if (spawnID > 99) {
+        remove = YES;   // this removes the object from the world dictionary in the main timer
+    }
+
+    // touchspot objects should go away after one animation loop
+    switch (spawnID) {
+
+        case 15:
+        case 35:
+        case 36:
+        case 37:
+            remove = YES;
+            break;
+
+        default:
+            break;
+
+    }
+
+}
+
+void SimPaper::frameAnimComplete() {
+
+    SimMessenger &messenger = behavior.world->messenger;
+
+    // SQUID - Accelerate and spawn bubbles
+    if (objID == 30) {
+        behavior.vel.x = behavior.velX;
+        behavior.vel.y = behavior.velY;
+        SimPoint cPoint = center;
+
+        // only spawn bubbles if squid is on screen
+        if (!behavior.viewCheck(vcCompletelyOffScreen)) {
+            messenger.queueObject(9, mtSpawn, btNone, YES, 0, SimPoint(cPoint.x+55, cPoint.y-15), YES);
+            messenger.queueObject(6, mtSpawn, btNone, YES, 0, SimPoint(cPoint.x+25, cPoint.y+10), YES);
+            messenger.queueObject(39, mtSpawn, btNone, YES, 0, SimPoint(cPoint.x+40, cPoint.y), YES);
+        }
+
+    }
+
+    // DIVER - Accelerate and spawn bubble
+    if (objID == 28) {
+        behavior.vel.x = behavior.velX;
+        behavior.vel.y = behavior.velY;
+        SimPoint cPoint = center;
+
+        // only spawn bubbles if diver is on screen
+        if (!behavior.viewCheck(vcCompletelyOffScreen)) {
+            messenger.queueObject(46, mtSpawn, btNone, YES, 0, SimPoint(cPoint.x-84, cPoint.y-33), YES);
+        }
+
+    }
+
+}
+
+void SimPaper::applyForce(SimVector force) {
+
+    if (paperType == Paper_Image) {
+        center = force.point();
+    }
+    else if (paperType == Paper_Vector) {
+        shapePosition = force.point();
+    }
+
+}
+
+SimPoint SimPaper::getCenterPoint() const {
+
+    if (paperType == Paper_Vector) { return shapePosition; }
+    return center;
+
+}
+
+void SimPaper::updateRender(CGFloat alpha) {
+
+    SimPoint current = getCenterPoint();
+
+    if (!hasPrevPosition) {
+        renderPosition = current;
+        return;
+    }
+
+    CGFloat dx = current.x - prevPosition.x;
+    CGFloat dy = current.y - prevPosition.y;
+
+    if (((dx * dx) + (dy * dy)) > (SIM_RENDER_SNAP * SIM_RENDER_SNAP)) {
+        renderPosition = current;
+    }
+    else {
+        renderPosition = SimPoint(prevPosition.x + (dx * alpha), prevPosition.y + (dy * alpha));
+    }
+}
+
+SimRect SimPaper::frame() const {
+
+    // vector pieces draw into a sublayer, the view itself has no size
+    if (paperType == Paper_Vector) { return SimRect(center.x, center.y, 0.0, 0.0); }
+
+    CGFloat fWidth  = (fabsf(transform.a) * halfSize.x * 2) + (fabsf(transform.c) * halfSize.y * 2);
+    CGFloat fHeight = (fabsf(transform.b) * halfSize.x * 2) + (fabsf(transform.d) * halfSize.y * 2);
+
+    return SimRect(center.x - (fWidth * 0.5), center.y - (fHeight * 0.5), fWidth, fHeight);
+
+}
@@ -0,0 +1,140 @@
+//
+//  SimPaper.h
+//  Papercut
+//
+//  Headless counterpart of Paper.  Holds the same per-object properties
+//    built from PaperProps, minus the UIKit view.  Core Animation work is
+//    reduced to the state the simulation actually observes: whether frame
+//    animation is running, when frameAnimComplete fires and when a layer
+//    animation would call animationDidStop.
+//
+
+#ifndef SIMCORE_SIMPAPER_H
+#define SIMCORE_SIMPAPER_H
+
+#include "SimTypes.h"
+#include "SimBehavior.h"
+#include "SimObjectStore.h"
+
+class SimWorld;
+class SimPathSampler;
+
+// a piece that moves further than this in one tick has jumped (toroid
+//   respawn, peek reset) and is drawn at its new position straight away
+#define SIM_RENDER_SNAP     RENDER_SNAP
+
+class SimPaper {
+public:
+    int         objID;          // unique identifier for object
+    int         spawnID;        // unique key in the world
+    SimHandle   handle;         // slot in the world's object store
+
+    SimPoint    posSpawn;       // spawning position
+    SimPoint    center;         // UIView center
+    SimPoint    shapePosition;  // animShape.position for Paper_Vector pieces
+    SimPoint    prevPosition;   // getCenterPoint at the start of the last tick
+    BOOL        hasPrevPosition;// NO until the piece has been through a tick
+    SimPoint    renderPosition; // where the piece is drawn, between prevPosition and now
+    BOOL        bounded;        // YES = object should not leave screen
+    BOOL        collision;      // YES = collision enabled for object
+    CGFloat     mass;           // used for collisions
+    BOOL        transformEnabled;   // flag to track when a transform should trigger
+    SimTransform transform;     // UIView transform
+    CGFloat     alpha;
+    int         zPos;           // layer z position
+    int         viewOrder;      // order it was added as a subview, later is on top
+
+    SimPoint        halfSize;       // x = half width, y = half height
+    int             dir;            // image direction
+    int             orientation;
+    MovementType    moveType;       // movement type
+    PaperType       paperType;      // Paper type
+    BindType        bindType;
+    BOOL            remove;         // YES = remove image from the world
+    BOOL            removeOnClean;  // YES = image should be removed during Manage: Clean
+    BOOL            manageRemove;   // YES = image is being removed during Manage: Clean
+
+    BOOL            pinch;          // YES = can be resized by pinch/zoom
+    CGFloat         pinchMax;       // pinch scale limits
+    CGFloat         pinchMin;
+    CGFloat         scaleStart;     // initial starting scale upon app launch
+
+    BOOL        bob;            // should the image bob?
+    CGFloat     bobAmp;         // bob amplitude, higher = less bob
+    CGFloat     bobOffset;      // offset so the objects bob out of sync
+
+    int         flip;           // indicates current flip direction
+    BOOL        flipX;          // YES = flip about X axis, NO = Y axis
+    CGFloat     flipTime;       // time between image flips; 0 = no flip
+
+    BOOL        randSpawn;      // YES = spawns randomly on X axis if flipX = NO, Y axis otherwise
+    BOOL        spawnByShake;   // YES = can spawn by shaking device
+    CGFloat     killTime;
+
+    int         childImage;     // array row of child image, 0 = no child
+    SimPoint    childSpawn;     // spawn offset of child/group (compared to center of touched object)
+
+    BOOL        animated;       // indicates layer-tree animated
+    SimRect     touchSpot;      // image-specific touchspot for spawning objects
+    int         tsRand;         // touchspot spawns random image from this row in PaperRandom
+    int         groupID;        // reference to group of images that moves with this Master
+    BOOL        killOnTouch;
+
+    int         frames;         // # of frames in the frame animation
+    CGFloat     frameDur;
+    int         frameRepeat;    // UIImageView animationRepeatCount, 0 = forever
+
+    BOOL        movePath;
+    CGFloat     pathTime;
+    int         numPaths;
+
+    int         pathIndex;      // which of numPaths it follows, 0 = the only one
+    const SimPathSampler *pathSampler;  // path being followed, NULL if there's no path to load
+    CGFloat     pathElapsed;    // time along the path so far
+    int         pathRepeat;     // movePathAnim repeatCount, 0 = forever
+    SimVector   pathTangent;    // direction of travel along the path
+
+    CGFloat     wiggleTime;
+    CGFloat     wiggleAngle;
+
+    BOOL        objLimit;       // counts towards max object limit
+
+    SimPoint    curvePoint;     // final position of animated path curve
+
+    SimBehavior behavior;
+    SimRandomStream random;     // this piece's own random numbers, for it and its behavior
+
+    // headless animation state, in seconds (< 0 = not pending)
+    BOOL        animating;          // UIImageView isAnimating
+    CGFloat     frameAnimRemaining; // time left in the current frame animation run
+    CGFloat     frameAnimCompleteIn;// pending performSelector:@selector(frameAnimComplete)
+    CGFloat     layerAnimEndIn;     // first layer animation to call animationDidStop
+    CGFloat     fadeOutIn;          // killPiece fade before remove
+    CGFloat     wiggleRemaining;
+
+    SimPaper(const PaperProps &prp, const PaperPropsAnim &prpAnim,
+             const PaperPropsTouchspot &prpTouch, const SimPaper *parentPaper, SimWorld *world);
+
+    void startAnimating();
+    void stopAnimating()        { animating = NO; }
+    BOOL isAnimating() const    { return animating; }
+
+    void advanceAnimations(CGFloat interval);   // run any Core Animation callbacks that are due
+    CGFloat pathFraction() const;               // how far along the path the piece should be, by length
+    void animationDidStop();
+    void frameAnimComplete();
+
+    void applyForce(SimVector force);
+    SimPoint getCenterPoint() const;
+    void markPrevPosition()         { prevPosition = getCenterPoint(); hasPrevPosition = YES; }
+    void updateRender(CGFloat alpha);
+    void setCenter(SimPoint point)  { center = point; }
+    SimRect frame() const;          // bounding box of the transformed view
+    void wiggle()                   { wiggleRemaining = wiggleTime; }
+
+private:
+    SimPaper(const SimPaper&);
+    SimPaper& operator=(const SimPaper&);
+};
+
+#endif
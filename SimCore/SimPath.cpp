@@ -0,0 +1,285 @@
+//
+//  SimPath.cpp
+//  Papercut
+//
+//  Paths in the compact SimPathFormat, and the SVG path parser that
+//    builds them.
+//
+
+#include "SimPath.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+// ___ SIMPATH
+
+BOOL SimPath::attach(const void *data, size_t length) {
+
+    if (!SimPathValid(data, length)) {
+        header = NULL;
+        commands = NULL;
+        points = NULL;
+        return NO;
+    }
+
+    header = (const SimPathHeader*)data;
+    commands = SimPathCommands(data);
+    points = SimPathPoints(data);
+    return YES;
+}
+
+// ___ BUILDER
+
+void SimPathBuilder::clear() {
+    commands.clear();
+    points.clear();
+}
+
+void SimPathBuilder::addPoint(SimPoint p) {
+    points.push_back(p.x);
+    points.push_back(p.y);
+}
+
+void SimPathBuilder::moveTo(SimPoint p) {
+    commands.push_back(pcMove);
+    addPoint(p);
+}
+
+void SimPathBuilder::lineTo(SimPoint p) {
+    commands.push_back(pcLine);
+    addPoint(p);
+}
+
+void SimPathBuilder::cubicTo(SimPoint c1, SimPoint c2, SimPoint p) {
+    commands.push_back(pcCubic);
+    addPoint(c1);
+    addPoint(c2);
+    addPoint(p);
+}
+
+void SimPathBuilder::close() {
+    commands.push_back(pcClose);
+}
+
+void SimPathBuilder::serialize(std::vector<uint8_t> &out) const {
+
+    SimPathHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic        = SIM_PATH_MAGIC;
+    header.version      = SIM_PATH_VERSION;
+    header.numCommands  = (uint32_t)commands.size();
+    header.numPoints    = (uint32_t)(points.size() / 2);
+
+    // bounds of every point, the same box CGPathGetBoundingBox gives
+    if (!points.empty()) {
+        float minX = points[0], maxX = points[0];
+        float minY = points[1], maxY = points[1];
+        for (size_t i = 2; i < points.size(); i += 2) {
+            minX = fminf(minX, points[i]);      maxX = fmaxf(maxX, points[i]);
+            minY = fminf(minY, points[i + 1]);  maxY = fmaxf(maxY, points[i + 1]);
+        }
+        header.bounds[0] = minX;
+        header.bounds[1] = minY;
+        header.bounds[2] = maxX - minX;
+        header.bounds[3] = maxY - minY;
+    }
+
+    out.assign(SimPathFileSize(&header), 0);
+    memcpy(&out[0], &header, sizeof(header));
+    if (!commands.empty()) {
+        memcpy(&out[sizeof(header)], &commands[0], commands.size());
+    }
+    if (!points.empty()) {
+        memcpy(&out[sizeof(header) + SimPathCommandBytes(header.numCommands)], &points[0], points.size() * sizeof(float));
+    }
+}
+
+// ___ SVG PARSING
+
+static void skipSeparators(const char *&c) {
+    while ((*c == ' ') || (*c == ',') || (*c == '\t') || (*c == '\n') || (*c == '\r')) { c++; }
+}
+
+static BOOL readNumber(const char *&c, CGFloat &value) {
+    skipSeparators(c);
+    char *end;
+    value = strtof(c, &end);
+    if (end == c) { return NO; }
+    c = end;
+    return YES;
+}
+
+static BOOL readPoint(const char *&c, SimPoint &p) {
+    return (readNumber(c, p.x) && readNumber(c, p.y)) ? YES : NO;
+}
+
+BOOL SimPathBuilder::parseSVGData(const char *d) {
+
+    const char *c = d;
+    char command = 0;
+
+    SimPoint current, start;        // pen and start of the subpath
+    SimPoint lastControl;           // reflected by S and T
+    char lastCommand = 0;
+
+    while (true) {
+
+        skipSeparators(c);
+        if (*c == '\0') { break; }
+
+        // a number where a command should be repeats the last one,
+        //   except a moveto carries on as a lineto
+        if (((*c >= 'A') && (*c <= 'Z')) || ((*c >= 'a') && (*c <= 'z'))) {
+            command = *c++;
+        }
+        else if (command == 'M')    { command = 'L'; }
+        else if (command == 'm')    { command = 'l'; }
+        else if ((command == 0) || (command == 'Z') || (command == 'z')) { return NO; }
+
+        BOOL relative = ((command >= 'a') && (command <= 'z')) ? YES : NO;
+        SimPoint origin = (relative) ? current : SimPoint();
+        SimPoint p, c1, c2, q;
+        CGFloat value;
+
+        switch (command) {
+
+            case 'M': case 'm':
+                if (!readPoint(c, p)) { return NO; }
+                current = SimPoint(origin.x + p.x, origin.y + p.y);
+                start = current;
+                moveTo(current);
+                break;
+
+            case 'L': case 'l':
+                if (!readPoint(c, p)) { return NO; }
+                current = SimPoint(origin.x + p.x, origin.y + p.y);
+                lineTo(current);
+                break;
+
+            case 'H': case 'h':
+                if (!readNumber(c, value)) { return NO; }
+                current.x = origin.x + value;
+                lineTo(current);
+                break;
+
+            case 'V': case 'v':
+                if (!readNumber(c, value)) { return NO; }
+                current.y = ((relative) ? current.y : 0.0) + value;
+                lineTo(current);
+                break;
+
+            case 'C': case 'c':
+                if (!readPoint(c, c1) || !readPoint(c, c2) || !readPoint(c, p)) { return NO; }
+                c1 = SimPoint(origin.x + c1.x, origin.y + c1.y);
+                c2 = SimPoint(origin.x + c2.x, origin.y + c2.y);
+                current = SimPoint(origin.x + p.x, origin.y + p.y);
+                cubicTo(c1, c2, current);
+                lastControl = c2;
+                break;
+
+            case 'S': case 's':
+                if (!readPoint(c, c2) || !readPoint(c, p)) { return NO; }
+                c1 = current;
+                if ((lastCommand != 0) && (strchr("CcSs", lastCommand))) {
+                    c1 = SimPoint((2 * current.x) - lastControl.x, (2 * current.y) - lastControl.y);
+                }
+                c2 = SimPoint(origin.x + c2.x, origin.y + c2.y);
+                p = SimPoint(origin.x + p.x, origin.y + p.y);
+                cubicTo(c1, c2, p);
+                current = p;
+                lastControl = c2;
+                break;
+
+            case 'Q': case 'q':
+            case 'T': case 't':
+            {
+                if ((command == 'Q') || (command == 'q')) {
+                    if (!readPoint(c, q)) { return NO; }
+                    q = SimPoint(origin.x + q.x, origin.y + q.y);
+                }
+                else {
+                    q = current;
+                    if ((lastCommand != 0) && (strchr("QqTt", lastCommand))) {
+                        q = SimPoint((2 * current.x) - lastControl.x, (2 * current.y) - lastControl.y);
+                    }
+                }
+                if (!readPoint(c, p)) { return NO; }
+                p = SimPoint(origin.x + p.x, origin.y + p.y);
+
+                // raise the quadratic to the cubic that traces the same curve
+                c1 = SimPoint(current.x + ((2.0 / 3.0) * (q.x - current.x)), current.y + ((2.0 / 3.0) * (q.y - current.y)));
+                c2 = SimPoint(p.x + ((2.0 / 3.0) * (q.x - p.x)), p.y + ((2.0 / 3.0) * (q.y - p.y)));
+                cubicTo(c1, c2, p);
+                current = p;
+                lastControl = q;
+                break;
+            }
+
+            case 'A': case 'a':
+            {
+                // the art has no arcs and PocketSVG never drew them,
+                //   step over the radii and flags and go straight there
+                CGFloat arc[5];
+                for (int i = 0; i < 5; i++) {
+                    if (!readNumber(c, arc[i])) { return NO; }
+                }
+                if (!readPoint(c, p)) { return NO; }
+                current = SimPoint(origin.x + p.x, origin.y + p.y);
+                lineTo(current);
+                break;
+            }
+
+            case 'Z': case 'z':
+                close();
+                current = start;
+                break;
+
+            default:
+                return NO;
+        }
+
+        lastCommand = command;
+    }
+
+    return (commands.empty()) ? NO : YES;
+}
+
+BOOL SimPathBuilder::parseSVGFile(const char *filename) {
+
+    FILE *file = fopen(filename, "rb");
+    if (!file) { return NO; }
+
+    std::string svg;
+    char buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        svg.append(buffer, got);
+    }
+    fclose(file);
+
+    // the d attribute of the first path element
+    size_t element = svg.find("<path");
+    if (element == std::string::npos) { return NO; }
+
+    size_t elementEnd = svg.find('>', element);
+    size_t attr = element;
+    while (true) {
+        attr = svg.find("d=", attr + 1);
+        if ((attr == std::string::npos) || (attr > elementEnd)) { return NO; }
+
+        // whole attribute name only, not the end of id= or similar
+        char before = svg[attr - 1];
+        if ((before == ' ') || (before == '\t') || (before == '\n') || (before == '\r')) { break; }
+    }
+
+    char quote = svg[attr + 2];
+    if ((quote != '"') && (quote != '\'')) { return NO; }
+
+    size_t dStart = attr + 3;
+    size_t dEnd = svg.find(quote, dStart);
+    if (dEnd == std::string::npos) { return NO; }
+
+    clear();
+    return parseSVGData(svg.substr(dStart, dEnd - dStart).c_str());
+}
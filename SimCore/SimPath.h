@@ -0,0 +1,68 @@
+//
+//  SimPath.h
+//  Papercut
+//
+//  Paths in the compact SimPathFormat.  SimPath is a read-only view onto
+//    one, either memory-mapped from a .pcp file or held in memory.
+//    SimPathBuilder turns SVG path data into one, the way PocketSVG
+//    turns it into a UIBezierPath, and is what svgpathc runs at build
+//    time.
+//
+
+#ifndef SIMCORE_SIMPATH_H
+#define SIMCORE_SIMPATH_H
+
+#include <vector>
+
+#include "SimTypes.h"
+#include "SimPathFormat.h"
+
+struct SimPath {
+    const SimPathHeader *header;
+    const uint8_t       *commands;
+    const float         *points;        // x,y pairs
+
+    SimPath() : header(NULL), commands(NULL), points(NULL) {}
+
+    // point the view at a path in SimPathFormat, NO if it isn't valid
+    BOOL attach(const void *data, size_t length);
+
+    BOOL isValid() const            { return (header != NULL); }
+    uint32_t numCommands() const    { return (header) ? header->numCommands : 0; }
+    uint32_t numPoints() const      { return (header) ? header->numPoints : 0; }
+    SimPoint point(uint32_t i) const { return SimPoint(points[i * 2], points[(i * 2) + 1]); }
+
+    SimRect bounds() const {
+        if (!header) { return SimRect(); }
+        return SimRect(header->bounds[0], header->bounds[1], header->bounds[2], header->bounds[3]);
+    }
+};
+
+class SimPathBuilder {
+public:
+    void clear();
+
+    void moveTo(SimPoint p);
+    void lineTo(SimPoint p);
+    void cubicTo(SimPoint c1, SimPoint c2, SimPoint p);
+    void close();
+
+    // the d attribute of an SVG path, NO on a malformed one
+    BOOL parseSVGData(const char *d);
+
+    // the first <path> in an SVG file, as PocketSVG reads it
+    BOOL parseSVGFile(const char *filename);
+
+    size_t numCommands() const  { return commands.size(); }
+
+    // the whole path in SimPathFormat, ready to write out or attach to
+    void serialize(std::vector<uint8_t> &out) const;
+
+private:
+    std::vector<uint8_t>    commands;
+    std::vector<float>      points;
+
+    void addPoint(SimPoint p);
+};
+
+#endif
@@ -0,0 +1,87 @@
+//
+//  SimPathCache.cpp
+//  Papercut
+//
+//  Every path a scene uses, memory-mapped or parsed once by name.
+//
+
+#include "SimPathCache.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+SimPathCache::SimPathCache() : mapped(0), parsed(0) {
+}
+
+SimPathCache::~SimPathCache() {
+    clear();
+}
+
+void SimPathCache::clear() {
+
+    for (std::map<std::string, Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+        if (it->second.map) { munmap(it->second.map, it->second.mapLength); }
+    }
+    entries.clear();
+    mapped = 0;
+    parsed = 0;
+}
+
+BOOL SimPathCache::mapFile(const std::string &filename, Entry &entry) {
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) { return NO; }
+
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (info.st_size < (off_t)sizeof(SimPathHeader))) {
+        close(fd);
+        return NO;
+    }
+
+    void *map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) { return NO; }
+
+    // used in place, a bad file is left alone and the .svg is tried instead
+    if (!entry.path.attach(map, (size_t)info.st_size)) {
+        munmap(map, (size_t)info.st_size);
+        return NO;
+    }
+
+    entry.map = map;
+    entry.mapLength = (size_t)info.st_size;
+    return YES;
+}
+
+const SimPath* SimPathCache::path(const char *name) {
+
+    std::map<std::string, Entry>::iterator it = entries.find(name);
+    if (it != entries.end()) {
+        return (it->second.path.isValid()) ? &it->second.path : NULL;
+    }
+
+    Entry &entry = entries[name];
+    entry.map = NULL;
+    entry.mapLength = 0;
+
+    std::string base = searchPath.empty() ? std::string(name) : (searchPath + "/" + name);
+
+    // compiled at build time by svgpathc
+    if (mapFile(base + "." SIM_PATH_EXT, entry)) {
+        mapped++;
+        return &entry.path;
+    }
+
+    // no compiled path, parse the SVG this once
+    SimPathBuilder builder;
+    if (builder.parseSVGFile((base + ".svg").c_str())) {
+        builder.serialize(entry.data);
+        entry.path.attach(&entry.data[0], entry.data.size());
+        parsed++;
+        return &entry.path;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,57 @@
+//
+//  SimPathCache.h
+//  Papercut
+//
+//  Every path a scene uses, by the same name Paper hands PocketSVG
+//    ("P_fish2", "weed", "weed2").  The first look-up memory-maps the
+//    name's .pcp from the search directory, or parses its .svg once if
+//    there is no compiled one, and every later look-up gets the same
+//    geometry back with no file or XML work at all.
+//
+
+#ifndef SIMCORE_SIMPATHCACHE_H
+#define SIMCORE_SIMPATHCACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SimPath.h"
+
+class SimPathCache {
+public:
+    SimPathCache();
+    ~SimPathCache();
+
+    // directory holding the .pcp / .svg files
+    void setSearchPath(const char *dir)     { searchPath = (dir) ? dir : ""; }
+
+    // NULL if the name has neither a compiled path nor an SVG
+    const SimPath* path(const char *name);
+
+    void clear();
+
+    size_t numMapped() const    { return mapped; }
+    size_t numParsed() const    { return parsed; }
+
+private:
+    typedef struct {
+        SimPath                 path;
+        void                    *map;       // mmap of the .pcp, NULL if parsed
+        size_t                  mapLength;
+        std::vector<uint8_t>    data;       // parsed from the .svg
+    } Entry;
+
+    std::string                     searchPath;
+    std::map<std::string, Entry>    entries;    // misses too, so a missing file is only looked for once
+    size_t                          mapped;
+    size_t                          parsed;
+
+    BOOL mapFile(const std::string &filename, Entry &entry);
+
+    // mappings can't be copied
+    SimPathCache(const SimPathCache&);
+    SimPathCache& operator=(const SimPathCache&);
+};
+
+#endif
@@ -0,0 +1,88 @@
+//
+//  SimPathFormat.h
+//  Papercut
+//
+//  Compact binary form of an SVG path, written at build time by
+//    svgpathc and read in place (memory-mapped) by the app's PathCache
+//    and SimCore's SimPathCache, so spawning a path mover or a vector
+//    piece never parses XML.
+//
+//  A .pcp file is the header, then one byte per command padded out to
+//    a multiple of 4, then the points as x,y float pairs:
+//
+//      SimPathHeader                       32 bytes
+//      uint8_t  commands[numCommands]      SimPathCommand, zero padded
+//      float    points[numPoints * 2]
+//
+//  Everything is little-endian, the same as every device and desktop
+//    the app builds for.  Plain C so the Objective-C side can include it.
+//
+
+#ifndef SIMCORE_SIMPATHFORMAT_H
+#define SIMCORE_SIMPATHFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_PATH_MAGIC      0x54504350      // "PCPT"
+#define SIM_PATH_VERSION    1
+#define SIM_PATH_EXT        "pcp"
+
+// every segment is reduced to these, H/V/S/Q/T become lines and cubics
+typedef enum {
+    pcMove      = 0,        // 1 point
+    pcLine      = 1,        // 1 point
+    pcCubic     = 2,        // control 1, control 2, end
+    pcClose     = 3         // no points
+} SimPathCommand;
+
+typedef struct {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    flags;          // none yet
+    uint32_t    numCommands;
+    uint32_t    numPoints;
+    float       bounds[4];      // x, y, width, height of every point, controls included
+} SimPathHeader;
+
+static inline int SimPathCommandPoints(uint8_t command) {
+    return (command == pcCubic) ? 3 : ((command == pcClose) ? 0 : 1);
+}
+
+static inline size_t SimPathCommandBytes(uint32_t numCommands) {
+    return ((size_t)numCommands + 3) & ~(size_t)3;
+}
+
+static inline size_t SimPathFileSize(const SimPathHeader *header) {
+    return sizeof(SimPathHeader) + SimPathCommandBytes(header->numCommands) + ((size_t)header->numPoints * 2 * sizeof(float));
+}
+
+static inline const uint8_t* SimPathCommands(const void *data) {
+    return (const uint8_t*)data + sizeof(SimPathHeader);
+}
+
+static inline const float* SimPathPoints(const void *data) {
+    const SimPathHeader *header = (const SimPathHeader*)data;
+    return (const float*)((const uint8_t*)data + sizeof(SimPathHeader) + SimPathCommandBytes(header->numCommands));
+}
+
+// checks a file's header, size and that the commands account for every point
+static inline int SimPathValid(const void *data, size_t length) {
+
+    if ((data == NULL) || (length < sizeof(SimPathHeader))) { return 0; }
+
+    const SimPathHeader *header = (const SimPathHeader*)data;
+    if ((header->magic != SIM_PATH_MAGIC) || (header->version != SIM_PATH_VERSION)) { return 0; }
+    if (length < SimPathFileSize(header)) { return 0; }
+
+    const uint8_t *commands = SimPathCommands(data);
+    uint32_t points = 0;
+    for (uint32_t i = 0; i < header->numCommands; i++) {
+        if (commands[i] > pcClose) { return 0; }
+        points += SimPathCommandPoints(commands[i]);
+    }
+
+    return (points == header->numPoints) ? 1 : 0;
+}
+
+#endif
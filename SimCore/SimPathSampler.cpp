@@ -0,0 +1,134 @@
+//
+//  SimPathSampler.cpp
+//  Papercut
+//
+//  A path flattened once into an arc length table and sampled by
+//    fraction of its length.
+//
+
+#include "SimPathSampler.h"
+
+#include <algorithm>
+
+void SimPathSampler::clear() {
+    xs.clear();
+    ys.clear();
+    lengths.clear();
+    totalLength = 0.0;
+}
+
+void SimPathSampler::addVertex(SimPoint p, BOOL jump) {
+
+    // a moveto in the middle of a path is a jump, it adds no length
+    CGFloat run = 0.0;
+    if ((!lengths.empty()) && (!jump)) {
+        CGFloat dx = p.x - xs.back();
+        CGFloat dy = p.y - ys.back();
+        run = sqrtf((dx * dx) + (dy * dy));
+    }
+
+    xs.push_back(p.x);
+    ys.push_back(p.y);
+    lengths.push_back((lengths.empty()) ? 0.0 : (lengths.back() + run));
+}
+
+void SimPathSampler::addCubic(SimPoint p0, SimPoint c1, SimPoint c2, SimPoint p3) {
+
+    // enough straight pieces to stay within SIM_PATH_FLATNESS of the
+    //   curve, from how far the control polygon bends (Wang's formula)
+    CGFloat ddx = fmaxf(fabsf(p0.x - (2 * c1.x) + c2.x), fabsf(c1.x - (2 * c2.x) + p3.x));
+    CGFloat ddy = fmaxf(fabsf(p0.y - (2 * c1.y) + c2.y), fabsf(c1.y - (2 * c2.y) + p3.y));
+    CGFloat bend = sqrtf((ddx * ddx) + (ddy * ddy));
+
+    int segments = (int)ceilf(sqrtf((0.75 * bend) / SIM_PATH_FLATNESS));
+    segments = std::max(1, std::min(segments, SIM_PATH_MAX_SEGMENTS));
+
+    for (int i = 1; i <= segments; i++) {
+        CGFloat t = (CGFloat)i / segments;
+        CGFloat mt = 1.0 - t;
+        CGFloat a = mt * mt * mt;
+        CGFloat b = 3 * mt * mt * t;
+        CGFloat c = 3 * mt * t * t;
+        CGFloat d = t * t * t;
+        addVertex(SimPoint((a * p0.x) + (b * c1.x) + (c * c2.x) + (d * p3.x),
+                           (a * p0.y) + (b * c1.y) + (c * c2.y) + (d * p3.y)), NO);
+    }
+}
+
+void SimPathSampler::build(const SimPath &path) {
+
+    clear();
+    if (!path.isValid()) { return; }
+
+    SimPoint current, start;
+    uint32_t pt = 0;
+
+    for (uint32_t i = 0; i < path.numCommands(); i++) {
+        switch (path.commands[i]) {
+
+            case pcMove:
+                current = path.point(pt++);
+                start = current;
+                addVertex(current, YES);
+                break;
+
+            case pcLine:
+                current = path.point(pt++);
+                addVertex(current, NO);
+                break;
+
+            case pcCubic:
+            {
+                SimPoint c1 = path.point(pt++);
+                SimPoint c2 = path.point(pt++);
+                SimPoint p3 = path.point(pt++);
+                addCubic(current, c1, c2, p3);
+                current = p3;
+                break;
+            }
+
+            case pcClose:
+                current = start;
+                addVertex(current, NO);
+                break;
+        }
+    }
+
+    totalLength = (lengths.empty()) ? 0.0 : lengths.back();
+}
+
+SimPoint SimPathSampler::sample(CGFloat fraction, SimVector *tangent) const {
+
+    if (lengths.empty()) {
+        if (tangent) { *tangent = SimVector(); }
+        return SimPoint();
+    }
+
+    CGFloat target = fminf(fmaxf(fraction, 0.0), 1.0) * totalLength;
+
+    // first vertex past the target, the piece is on the run leading up to it
+    size_t hi = std::upper_bound(lengths.begin(), lengths.end(), target) - lengths.begin();
+    if (hi >= lengths.size()) { hi = lengths.size() - 1; }
+    if (hi == 0) { hi = std::min((size_t)1, lengths.size() - 1); }
+    size_t lo = (hi > 0) ? hi - 1 : 0;
+
+    // a jump has no length, so skip back to the last run that has some
+    while ((lo > 0) && (lengths[hi] == lengths[lo])) { hi--; lo--; }
+
+    CGFloat run = lengths[hi] - lengths[lo];
+    CGFloat t = (run > 0.0) ? ((target - lengths[lo]) / run) : 0.0;
+    t = fminf(fmaxf(t, 0.0), 1.0);
+
+    if (tangent) {
+        *tangent = SimVector(xs[hi] - xs[lo], ys[hi] - ys[lo]);
+        tangent->normalize();
+    }
+
+    return SimPoint(xs[lo] + ((xs[hi] - xs[lo]) * t), ys[lo] + ((ys[hi] - ys[lo]) * t));
+}
+
+void SimPathSampler::sample(const CGFloat *fractions, size_t count, SimPoint *positions, SimVector *tangents) const {
+    for (size_t i = 0; i < count; i++) {
+        positions[i] = sample(fractions[i], (tangents) ? &tangents[i] : NULL);
+    }
+}
@@ -0,0 +1,52 @@
+//
+//  SimPathSampler.h
+//  Papercut
+//
+//  A path mover's path, flattened once into a polyline with the arc
+//    length to every vertex.  Sampling by fraction of the total length
+//    is a binary search, so it moves at the even pace
+//    kCAAnimationCubicPaced gives the on-screen animation, and the
+//    simulation knows where every path mover is and which way it's
+//    heading without asking a presentationLayer.
+//
+
+#ifndef SIMCORE_SIMPATHSAMPLER_H
+#define SIMCORE_SIMPATHSAMPLER_H
+
+#include <vector>
+
+#include "SimTypes.h"
+#include "SimPath.h"
+
+#define SIM_PATH_FLATNESS       0.25    // furthest the polyline strays from a curve, in points
+#define SIM_PATH_MAX_SEGMENTS   256     // most pieces one curve is cut into
+
+class SimPathSampler {
+public:
+    SimPathSampler() : totalLength(0.0) {}
+
+    void build(const SimPath &path);
+    void clear();
+
+    BOOL isEmpty() const        { return (lengths.size() < 2) ? YES : NO; }
+    CGFloat length() const      { return totalLength; }
+    size_t numVertices() const  { return lengths.size(); }
+
+    // position fraction (0..1) of the way along by length, and the unit
+    //   direction of travel there if tangent isn't NULL
+    SimPoint sample(CGFloat fraction, SimVector *tangent) const;
+
+    // the same for a batch of fractions along this path
+    void sample(const CGFloat *fractions, size_t count, SimPoint *positions, SimVector *tangents) const;
+
+private:
+    std::vector<float>  xs;
+    std::vector<float>  ys;
+    std::vector<float>  lengths;    // arc length from the start to each vertex
+    CGFloat             totalLength;
+
+    void addVertex(SimPoint p, BOOL jump);
+    void addCubic(SimPoint p0, SimPoint c1, SimPoint c2, SimPoint p3);
+};
+
+#endif
@@ -0,0 +1,249 @@
+//
+//  SimProfiler.cpp
+//  Papercut
+//
+//  Lock-free ring of phase timings with Chrome trace and CSV export.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "SimProfiler.h"
+
+// a slot's sequence is odd while its event is being written,
+//   and 2 * (index + 1) once event holds ring index index
+struct SimProfileSlot {
+    std::atomic<uint64_t>   sequence;
+    SimProfileEvent         event;
+};
+
+struct SimProfiler {
+    SimProfileSlot          *slots;
+    uint64_t                mask;           // capacity - 1, power of two
+    double                  historySeconds;
+    std::atomic<uint64_t>   head;           // ring index of the next event
+    std::atomic<uint32_t>   frame;
+};
+
+static const char *phaseNames[spNumPhases] = {
+    "frame", "move", "gather", "bounds", "collision", "transform",
+    "force", "world timers", "cleaning", "messages", "view insert", "remove"
+};
+
+// ___ RECORDING
+
+SimProfiler* SimProfilerCreate(double historySeconds) {
+
+    if (historySeconds <= 0.0) { return NULL; }
+
+    uint64_t capacity = 1;
+    while (capacity < (uint64_t)(historySeconds * SIM_PROFILE_EVENTS_PER_SECOND)) { capacity <<= 1; }
+
+    SimProfiler *profiler = new SimProfiler;
+    profiler->slots = new SimProfileSlot[capacity];
+    for (uint64_t i = 0; i < capacity; i++) { profiler->slots[i].sequence.store(0, std::memory_order_relaxed); }
+    profiler->mask = capacity - 1;
+    profiler->historySeconds = historySeconds;
+    profiler->head.store(0);
+    profiler->frame.store(0);
+
+    return profiler;
+}
+
+void SimProfilerDestroy(SimProfiler *profiler) {
+    if (profiler == NULL) { return; }
+    delete [] profiler->slots;
+    delete profiler;
+}
+
+uint64_t SimProfileNow(void) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* SimProfilePhaseName(SimProfilePhase phase) {
+    return ((phase >= 0) && (phase < spNumPhases)) ? phaseNames[phase] : "unknown";
+}
+
+uint64_t SimProfileStart(const SimProfiler *profiler) {
+    return (profiler) ? SimProfileNow() : 0;
+}
+
+void SimProfilerNextFrame(SimProfiler *profiler) {
+    if (profiler == NULL) { return; }
+    profiler->frame.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SimProfilerRecord(SimProfiler *profiler, SimProfilePhase phase, int thread, uint64_t start, uint64_t end) {
+
+    if (profiler == NULL) { return; }
+
+    uint64_t index = profiler->head.fetch_add(1, std::memory_order_relaxed);
+    SimProfileSlot &slot = profiler->slots[index & profiler->mask];
+
+    slot.sequence.store((2 * index) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.event.start = start;
+    slot.event.end = end;
+    slot.event.frame = profiler->frame.load(std::memory_order_relaxed);
+    slot.event.phase = (uint16_t)phase;
+    slot.event.thread = (uint16_t)thread;
+
+    slot.sequence.store(2 * (index + 1), std::memory_order_release);
+}
+
+void SimProfileSpanAdd(SimProfileSpan *span, uint64_t start, uint64_t end) {
+    if (span->first == 0) { span->first = start; }
+    span->total += end - start;
+}
+
+void SimProfileSpanStop(const SimProfiler *profiler, SimProfileSpan *span, uint64_t start) {
+    if (profiler) { SimProfileSpanAdd(span, start, SimProfileNow()); }
+}
+
+void SimProfilerRecordSpan(SimProfiler *profiler, SimProfilePhase phase, int thread, SimProfileSpan *span) {
+
+    if ((profiler) && (span->first != 0)) {
+        SimProfilerRecord(profiler, phase, thread, span->first, span->first + span->total);
+    }
+
+    span->first = 0;
+    span->total = 0;
+}
+
+// ___ READING
+
+size_t SimProfilerCapacity(const SimProfiler *profiler) {
+    return (profiler) ? (size_t)(profiler->mask + 1) : 0;
+}
+
+size_t SimProfilerSnapshot(SimProfiler *profiler, SimProfileEvent *events, size_t maxEvents) {
+
+    if (profiler == NULL) { return 0; }
+
+    uint64_t head = profiler->head.load(std::memory_order_acquire);
+    uint64_t capacity = profiler->mask + 1;
+    uint64_t oldest = (head > capacity) ? (head - capacity) : 0;
+    uint64_t cutoff = SimProfileNow() - (uint64_t)(profiler->historySeconds * 1.0e9);
+
+    size_t count = 0;
+    for (uint64_t index = oldest; (index < head) && (count < maxEvents); index++) {
+
+        SimProfileSlot &slot = profiler->slots[index & profiler->mask];
+
+        // a slot still being written, or already lapped by a newer event, is skipped
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != (2 * (index + 1))) { continue; }
+
+        SimProfileEvent event = slot.event;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) { continue; }
+
+        if (event.end < cutoff) { continue; }
+        events[count++] = event;
+    }
+
+    return count;
+}
+
+static void snapshot(SimProfiler *profiler, std::vector<SimProfileEvent> &events) {
+    events.resize(SimProfilerCapacity(profiler));
+    events.resize(SimProfilerSnapshot(profiler, events.empty() ? NULL : &events[0], events.size()));
+}
+
+// ___ EXPORT
+
+int SimProfilerWriteTrace(SimProfiler *profiler, FILE *file) {
+
+    if ((profiler == NULL) || (file == NULL)) { return -1; }
+
+    std::vector<SimProfileEvent> events;
+    snapshot(profiler, events);
+
+    // timestamps in microseconds from the oldest event
+    uint64_t origin = UINT64_MAX;
+    for (size_t i = 0; i < events.size(); i++) { origin = std::min(origin, events[i].start); }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    for (size_t i = 0; i < events.size(); i++) {
+        const SimProfileEvent &e = events[i];
+        fprintf(file, "{\"name\":\"%s\",\"cat\":\"papercut\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                      "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}%s\n",
+                SimProfilePhaseName((SimProfilePhase)e.phase), (unsigned)e.thread,
+                (e.start - origin) / 1000.0, (e.end - e.start) / 1000.0, (unsigned)e.frame,
+                (i + 1 < events.size()) ? "," : "");
+    }
+
+    fprintf(file, "]}\n");
+
+    return (ferror(file)) ? -1 : 0;
+}
+
+static bool frameBefore(const SimProfileEvent &a, const SimProfileEvent &b) {
+    return (a.frame < b.frame);
+}
+
+int SimProfilerWriteCSV(SimProfiler *profiler, FILE *file) {
+
+    if ((profiler == NULL) || (file == NULL)) { return -1; }
+
+    std::vector<SimProfileEvent> events;
+    snapshot(profiler, events);
+    std::stable_sort(events.begin(), events.end(), frameBefore);
+
+    // per phase: frames it ran in, total, worst frame, and its time
+    //   in the frames that went over budget
+    int     frames[spNumPhases]     = { 0 };
+    double  totalMs[spNumPhases]    = { 0.0 };
+    double  maxMs[spNumPhases]      = { 0.0 };
+    double  slowMs[spNumPhases]     = { 0.0 };
+    int     slowFrames = 0;
+
+    size_t first = 0;
+    while (first < events.size()) {
+
+        // every phase's time in this frame, summed over threads
+        double frameMs[spNumPhases] = { 0.0 };
+        bool ran[spNumPhases] = { false };
+
+        size_t last = first;
+        while ((last < events.size()) && (events[last].frame == events[first].frame)) {
+            const SimProfileEvent &e = events[last];
+            if (e.phase < spNumPhases) {
+                frameMs[e.phase] += (e.end - e.start) / 1.0e6;
+                ran[e.phase] = true;
+            }
+            last++;
+        }
+
+        bool slow = (frameMs[spFrame] > SIM_PROFILE_BUDGET_MS);
+        if (slow) { slowFrames++; }
+
+        for (int p = 0; p < spNumPhases; p++) {
+            if (!ran[p]) { continue; }
+            frames[p]++;
+            totalMs[p] += frameMs[p];
+            maxMs[p] = std::max(maxMs[p], frameMs[p]);
+            if (slow) { slowMs[p] += frameMs[p]; }
+        }
+
+        first = last;
+    }
+
+    fprintf(file, "phase,frames,total ms,mean ms,max ms,mean ms over budget\n");
+
+    for (int p = 0; p < spNumPhases; p++) {
+        fprintf(file, "%s,%d,%.4f,%.4f,%.4f,%.4f\n",
+                phaseNames[p], frames[p], totalMs[p],
+                (frames[p] > 0) ? (totalMs[p] / frames[p]) : 0.0,
+                maxMs[p],
+                (slowFrames > 0) ? (slowMs[p] / slowFrames) : 0.0);
+    }
+
+    return (ferror(file)) ? -1 : 0;
+}
@@ -0,0 +1,121 @@
+//
+//  SimProfiler.h
+//  Papercut
+//
+//  Per-phase frame profiler.  Each phase of a frame (the walk, bounds,
+//    collisions, transforms, forces, world timers, cleaning, messages,
+//    view inserts, removal) is timed and recorded as an event in a ring
+//    buffer big enough for the last few seconds, which can be written
+//    out as a Chrome trace (chrome://tracing, Perfetto) or summed up per
+//    phase as CSV, to see which phase blew the frame budget.
+//
+//  Recording is lock-free and safe from any thread: a writer claims a
+//    slot with one atomic add, and the exporters skip any slot that is
+//    being rewritten while they read it.  Phases that are timed piece
+//    by piece (bounds, transform, force) are added up in a
+//    SimProfileSpan and recorded once, as an event that starts with the
+//    first piece and lasts the sum.
+//
+//  A plain C interface, so the view controller's loop can use it as
+//    well as SimWorld.  Every call takes a NULL profiler and does
+//    nothing, so leaving one unattached turns profiling off.
+//
+
+#ifndef SIMCORE_SIMPROFILER_H
+#define SIMCORE_SIMPROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// seconds of history kept unless asked otherwise, and event room per second of it
+#define SIM_PROFILE_HISTORY             10.0
+#define SIM_PROFILE_EVENTS_PER_SECOND   4096
+
+// a display frame at 60 Hz
+#define SIM_PROFILE_BUDGET_MS           (1000.0 / 60.0)
+
+typedef enum {
+    spFrame,            // a whole display frame
+    spMove,             // the walk over every piece
+    spGather,           // one chunk of the walk, on whichever thread ran it
+    spBounds,           // Bind_OnEnter / keepInBounds
+    spCollision,
+    spTransform,        // direction and image transform
+    spForce,            // calculateForce and the force batch
+    spWorldTimers,
+    spCleaning,
+    spMessages,
+    spViewInsert,
+    spRemove,
+    spNumPhases
+} SimProfilePhase;
+
+typedef struct {
+    uint64_t    start;          // SimProfileNow
+    uint64_t    end;
+    uint32_t    frame;
+    uint16_t    phase;          // SimProfilePhase
+    uint16_t    thread;         // 0 = the thread stepping the world
+} SimProfileEvent;
+
+// many short timings of one phase, recorded as a single event
+typedef struct {
+    uint64_t    first;          // start of the first timing, 0 = nothing yet
+    uint64_t    total;
+} SimProfileSpan;
+
+typedef struct SimProfiler SimProfiler;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SimProfiler* SimProfilerCreate(double historySeconds);
+void SimProfilerDestroy(SimProfiler *profiler);
+
+uint64_t SimProfileNow(void);                                   // nanoseconds, monotonic
+const char* SimProfilePhaseName(SimProfilePhase phase);
+
+// 0 without a profiler, so a phase that isn't profiled never reads the clock
+uint64_t SimProfileStart(const SimProfiler *profiler);
+
+// starts the next frame, events are tagged with it until the one after
+void SimProfilerNextFrame(SimProfiler *profiler);
+
+void SimProfilerRecord(SimProfiler *profiler, SimProfilePhase phase, int thread, uint64_t start, uint64_t end);
+
+void SimProfileSpanAdd(SimProfileSpan *span, uint64_t start, uint64_t end);
+void SimProfileSpanStop(const SimProfiler *profiler, SimProfileSpan *span, uint64_t start);   // adds start..now when profiling
+void SimProfilerRecordSpan(SimProfiler *profiler, SimProfilePhase phase, int thread, SimProfileSpan *span);  // and clears it
+
+// the events of the last historySeconds, oldest first, returns how many were copied
+size_t SimProfilerSnapshot(SimProfiler *profiler, SimProfileEvent *events, size_t maxEvents);
+size_t SimProfilerCapacity(const SimProfiler *profiler);
+
+// 0 on success
+int SimProfilerWriteTrace(SimProfiler *profiler, FILE *file);   // Chrome trace event JSON
+int SimProfilerWriteCSV(SimProfiler *profiler, FILE *file);     // one row per phase
+
+#ifdef __cplusplus
+}
+
+// times the enclosing scope as one event
+class SimProfileScope {
+public:
+    SimProfileScope(SimProfiler *p, SimProfilePhase ph, int th = 0)
+        : profiler(p), phase(ph), thread(th), start(SimProfileStart(p)) {}
+    ~SimProfileScope()  { if (profiler) { SimProfilerRecord(profiler, phase, thread, start, SimProfileNow()); } }
+
+private:
+    SimProfiler         *profiler;
+    SimProfilePhase     phase;
+    int                 thread;
+    uint64_t            start;
+
+    SimProfileScope(const SimProfileScope&);
+    SimProfileScope& operator=(const SimProfileScope&);
+};
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+//
+//  SimRandom.cpp
+//  Papercut
+//
+//  Counter-based splitmix64 streams behind SimRandom.
+//
+
+#include <stdlib.h>
+
+#include "SimRandom.h"
+
+#define SIM_RANDOM_GAMMA    0x9e3779b97f4a7c15ULL   // splitmix64's step
+#define SIM_RANDOM_STREAM   0xda942042e4dd58b5ULL   // spreads stream IDs across keys
+
+static uint64_t randomSeed = 0;
+static SimRandomStream sharedStream = { 0, 0 };
+
+static inline uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// the nth number of the stream keyed by key, n from 1
+static inline uint32_t draw(uint64_t key, uint64_t n) {
+    return (uint32_t)(mix(key + (n * SIM_RANDOM_GAMMA)) >> 32);
+}
+
+// the top 24 bits, as many as a float holds
+static inline float unitFloat(uint32_t value) {
+    return (float)(value >> 8) * (1.0f / 16777216.0f);
+}
+
+// ___ SEED
+
+void SimRandomSeed(uint64_t seed) {
+    randomSeed = seed;
+    sharedStream.key = seed;
+    sharedStream.counter = 0;
+}
+
+uint64_t SimRandomCurrentSeed(void) {
+    return randomSeed;
+}
+
+uint64_t SimRandomNewSeed(void) {
+    return ((uint64_t)arc4random() << 32) | arc4random();
+}
+
+// ___ SHARED STREAM
+
+SimRandomStream* SimRandomShared(void) {
+    return &sharedStream;
+}
+
+uint32_t SimRandom(void) {
+    return SimRandomNext(&sharedStream);
+}
+
+uint32_t SimRandomUniform(uint32_t upperBound) {
+    return SimRandomNextUniform(&sharedStream, upperBound);
+}
+
+float SimRandomRange(float from, float to) {
+    return SimRandomNextRange(&sharedStream, from, to);
+}
+
+// ___ STREAMS
+
+SimRandomStream SimRandomStreamFor(uint64_t streamID) {
+    SimRandomStream stream;
+    stream.key = mix(randomSeed ^ mix((streamID + 1) * SIM_RANDOM_STREAM));
+    stream.counter = 0;
+    return stream;
+}
+
+uint32_t SimRandomNext(SimRandomStream *stream) {
+    return draw(stream->key, ++stream->counter);
+}
+
+uint32_t SimRandomNextUniform(SimRandomStream *stream, uint32_t upperBound) {
+
+    if (upperBound < 2) { return 0; }
+
+    // reject the low values that would make the modulo uneven
+    uint32_t minimum = (uint32_t)(-upperBound) % upperBound;
+    uint32_t r;
+    do { r = SimRandomNext(stream); } while (r < minimum);
+
+    return r % upperBound;
+}
+
+float SimRandomNextFloat(SimRandomStream *stream) {
+    return unitFloat(SimRandomNext(stream));
+}
+
+float SimRandomNextRange(SimRandomStream *stream, float from, float to) {
+    return from + (SimRandomNextFloat(stream) * (to - from));
+}
+
+// ___ BULK
+//  no number depends on the one before it, so these loops vectorize
+
+void SimRandomFill(SimRandomStream *stream, uint32_t *values, size_t count) {
+
+    const uint64_t key = stream->key;
+    const uint64_t first = stream->counter + 1;
+
+    for (size_t i = 0; i < count; i++) { values[i] = draw(key, first + i); }
+    stream->counter += count;
+}
+
+void SimRandomFillRange(SimRandomStream *stream, float *values, size_t count, float from, float to) {
+
+    const uint64_t key = stream->key;
+    const uint64_t first = stream->counter + 1;
+    const float span = to - from;
+
+    for (size_t i = 0; i < count; i++) { values[i] = from + (unitFloat(draw(key, first + i)) * span); }
+    stream->counter += count;
+}
@@ -0,0 +1,63 @@
+//
+//  SimRandom.h
+//  Papercut
+//
+//  Seedable stand-in for arc4random.  SimCore draws every random number
+//    from here, so a run started from the same seed with the same input
+//    plays out exactly the same, which is what lets a journal
+//    (SimJournal.h) be replayed.  A plain C interface, so the app can
+//    pick the seed it records and draw from it too.
+//
+//  Numbers come in streams.  A stream is a key and a counter, and its nth
+//    number is a hash of the two (splitmix64), so drawing is a couple of
+//    multiplies with no shared state: each piece keeps a stream of its own
+//    and whichever thread steps the piece can draw from it, and a run of
+//    numbers can be filled into a buffer in one loop for a batch kernel.
+//    Every stream's key comes from the global seed.
+//
+//  The world's own draws (spawn picks, sounds, world timers) come from
+//    the shared stream, which is only drawn from on the thread stepping
+//    the world.
+//
+
+#ifndef SIMCORE_SIMRANDOM_H
+#define SIMCORE_SIMRANDOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t    key;
+    uint64_t    counter;        // numbers drawn so far
+} SimRandomStream;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void SimRandomSeed(uint64_t seed);      // rekeys the shared stream, and every stream made after
+uint64_t SimRandomCurrentSeed(void);    // the last seed given
+uint64_t SimRandomNewSeed(void);        // a fresh seed from the system, for a run that isn't a replay
+
+// the shared stream
+SimRandomStream* SimRandomShared(void);
+uint32_t SimRandom(void);                       // arc4random
+uint32_t SimRandomUniform(uint32_t upperBound); // arc4random_uniform, 0 .. upperBound - 1
+float SimRandomRange(float from, float to);     // RAND_NUM, from .. to
+
+// a stream of its own, streamID picks which one under the current seed
+SimRandomStream SimRandomStreamFor(uint64_t streamID);
+uint32_t SimRandomNext(SimRandomStream *stream);
+uint32_t SimRandomNextUniform(SimRandomStream *stream, uint32_t upperBound);
+float SimRandomNextFloat(SimRandomStream *stream);                      // 0 .. 1
+float SimRandomNextRange(SimRandomStream *stream, float from, float to);
+
+// the stream's next count numbers, the same ones drawing them one by one would give
+void SimRandomFill(SimRandomStream *stream, uint32_t *values, size_t count);
+void SimRandomFillRange(SimRandomStream *stream, float *values, size_t count, float from, float to);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
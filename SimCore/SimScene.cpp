@@ -0,0 +1,33 @@
+//
+//  SimScene.cpp
+//  Papercut
+//
+//  Every scene SimCore knows, checked at compile time (see SimScene.h).
+//
+
+#include "SimScene.h"
+
+#include <string.h>
+
+SIM_SCENE(simMermaidsScene, paperMermaidsTable, paperMermaidsAnimations, paperMermaidsTouchspots,
+          paperMermaidsGroups, paperMermaidsRandom, paperMermaidsSounds, paperMemmaidsTimers)
+
+typedef struct {
+    const char      *name;
+    SimSceneTables  (*scene)();
+} SimBuiltInScene;
+
+static const SimBuiltInScene builtInScenes[] = {
+    { "mermaids",   simMermaidsScene },
+};
+
+BOOL simBuiltInScene(const char *name, SimSceneTables *scene) {
+
+    for (size_t i = 0; i < sizeof(builtInScenes) / sizeof(builtInScenes[0]); i++) {
+        if (strcmp(builtInScenes[i].name, name) == 0) {
+            *scene = builtInScenes[i].scene();
+            return YES;
+        }
+    }
+    return NO;
+}
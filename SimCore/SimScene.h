@@ -0,0 +1,203 @@
+//
+//  SimScene.h
+//  Papercut
+//
+//  A scene's property tables (see Variables.h), sized and checked at
+//    compile time.  The app finds its row counts in row 0 (bobAmp of
+//    the border row, the first touchspot's objID, the first timer's
+//    objTargetID, the first sound's soundID) and looks pieces up as
+//    props[objID]; SimCore takes the counts from the arrays themselves
+//    and looks pieces up through an objID -> row map built by the
+//    compiler, so the weeds (objIDs 50-55, 70-75) land on their own
+//    rows.
+//
+//  SIM_SCENE checks everything the tables point at with static_assert:
+//    row 0 counts, unique objIDs, and every animID, tsID, groupID,
+//    childImage, touchspot, random, group and timer reference.  A bad
+//    table stops the build instead of reading past the end of an array.
+//
+
+#ifndef SIMCORE_SIMSCENE_H
+#define SIMCORE_SIMSCENE_H
+
+#include "SimTypes.h"
+
+#define SIM_GROUP_MAX_SUBS  10      // objIDSub01 .. objIDSub10
+
+// property tables for one scene, with their sizes
+typedef struct {
+    const PaperProps            *props;
+    const PaperPropsAnim        *anim;
+    const PaperPropsTouchspot   *touch;
+    const PaperGroups           *groups;
+    const PaperRandom           *random;
+    const PaperPropsSounds      *sounds;
+    const PaperWorldTimers      *timers;
+
+    int     numProps;           // rows, including the dummy / border row 0
+    int     numAnim;
+    int     numTouch;
+    int     numGroups;
+    int     numRandom;
+    int     numSounds;
+    int     numTimers;
+
+    const int16_t   *objRows;   // props row of each objID, -1 = no such object
+    int             numObjIDs;  // highest objID + 1
+
+    // props row of an objID, -1 if there isn't one
+    int row(int objID) const    { return ((objID >= 0) && (objID < numObjIDs)) ? objRows[objID] : -1; }
+
+    // the animation row a piece is built with, animID is a repeat count
+    //   or -1 for some pieces, those get the default row
+    const PaperPropsAnim& animFor(const PaperProps &prp) const {
+        return anim[((prp.animID > 0) && (prp.animID < numAnim)) ? prp.animID : 0];
+    }
+} SimSceneTables;
+
+// ___ COMPILE-TIME CHECKS
+
+template <typename T, size_t N>
+constexpr int simTableRows(const T (&)[N]) { return (int)N; }
+
+// props row with the objID, -1 if none (row 0 is the border, never a piece)
+constexpr int simObjRow(const PaperProps *p, int n, int objID, int i = 1) {
+    return (i >= n) ? -1 : ((p[i].objID == objID) ? i : simObjRow(p, n, objID, i + 1));
+}
+
+// an objID reference is either 0 (none) or a real object
+constexpr bool simObjRef(const PaperProps *p, int n, int objID) {
+    return (objID == 0) || (simObjRow(p, n, objID) >= 0);
+}
+
+constexpr int simMaxObjID(const PaperProps *p, int n, int i = 1, int best = 0) {
+    return (i >= n) ? best : simMaxObjID(p, n, i + 1, (p[i].objID > best) ? p[i].objID : best);
+}
+
+constexpr bool simUniqueObjIDs(const PaperProps *p, int n, int i = 1) {
+    return (i >= n) || ((p[i].objID > 0) && (simObjRow(p, n, p[i].objID, i + 1) < 0) && simUniqueObjIDs(p, n, i + 1));
+}
+
+constexpr bool simPropsRefsValid(const PaperProps *p, int n, int numAnim, int numTouch, int numGroups, int i = 1) {
+    return (i >= n) ||
+           ((p[i].animID >= -1) && (p[i].animID < numAnim) &&
+            (p[i].tsID >= 0) && (p[i].tsID < numTouch) &&
+            (p[i].groupID >= 0) && (p[i].groupID < numGroups) &&
+            simObjRef(p, n, p[i].childImage) &&
+            simPropsRefsValid(p, n, numAnim, numTouch, numGroups, i + 1));
+}
+
+constexpr bool simAnimRowsValid(const PaperPropsAnim *a, int n, int i = 0) {
+    return (i >= n) || ((a[i].animID == i) && simAnimRowsValid(a, n, i + 1));
+}
+
+// random touchspots point at a PaperRandom row, the rest at an object
+constexpr bool simTouchRowsValid(const PaperPropsTouchspot *t, int n, const PaperProps *p, int numProps, int numRandom, int i = 1) {
+    return (i >= n) ||
+           ((t[i].tsID == i) &&
+            ((t[i].random) ? ((t[i].objID > 0) && (t[i].objID < numRandom)) : simObjRef(p, numProps, t[i].objID)) &&
+            simTouchRowsValid(t, n, p, numProps, numRandom, i + 1));
+}
+
+constexpr int simGroupSub(const PaperGroups &g, int sub) {
+    return (sub == 0) ? g.objIDSub01 : (sub == 1) ? g.objIDSub02 : (sub == 2) ? g.objIDSub03 :
+           (sub == 3) ? g.objIDSub04 : (sub == 4) ? g.objIDSub05 : (sub == 5) ? g.objIDSub06 :
+           (sub == 6) ? g.objIDSub07 : (sub == 7) ? g.objIDSub08 : (sub == 8) ? g.objIDSub09 : g.objIDSub10;
+}
+
+constexpr bool simGroupSubsValid(const PaperGroups &g, const PaperProps *p, int numProps, int sub = 0) {
+    return (sub >= g.numSubs) ||
+           ((simObjRow(p, numProps, simGroupSub(g, sub)) >= 0) && simGroupSubsValid(g, p, numProps, sub + 1));
+}
+
+constexpr bool simGroupRowsValid(const PaperGroups *g, int n, const PaperProps *p, int numProps, int i = 1) {
+    return (i >= n) ||
+           ((g[i].groupID == i) &&
+            (simObjRow(p, numProps, g[i].objIDMaster) >= 0) &&
+            (g[i].numSubs >= 0) && (g[i].numSubs <= SIM_GROUP_MAX_SUBS) &&
+            simGroupSubsValid(g[i], p, numProps) &&
+            simGroupRowsValid(g, n, p, numProps, i + 1));
+}
+
+constexpr bool simRandomRowsValid(const PaperRandom *r, int n, const PaperProps *p, int numProps, int i = 1) {
+    return (i >= n) ||
+           (simObjRef(p, numProps, r[i].rObjID01) && simObjRef(p, numProps, r[i].rObjID02) &&
+            simObjRef(p, numProps, r[i].rObjID03) && simObjRef(p, numProps, r[i].rObjID04) &&
+            simObjRef(p, numProps, r[i].rObjID05) &&
+            simRandomRowsValid(r, n, p, numProps, i + 1));
+}
+
+constexpr bool simTimerRowsValid(const PaperWorldTimers *t, int n, const PaperProps *p, int numProps, int i = 1) {
+    return (i >= n) || (simObjRef(p, numProps, t[i].objTargetID) && simTimerRowsValid(t, n, p, numProps, i + 1));
+}
+
+// ___ OBJID -> ROW MAP
+
+template <int... I> struct SimIndices {};
+template <int N, int... I> struct SimMakeIndices : SimMakeIndices<N - 1, N - 1, I...> {};
+template <int... I> struct SimMakeIndices<0, I...> { typedef SimIndices<I...> type; };
+
+template <int N>
+struct SimRowMap {
+    int16_t rows[N];
+};
+
+template <int N, int... I>
+constexpr SimRowMap<N> simMakeRowMap(const PaperProps *p, int n, SimIndices<I...>) {
+    return SimRowMap<N>{ { (int16_t)simObjRow(p, n, I)... } };
+}
+
+// ___ SCENE DEFINITION
+
+// checks the tables, builds the row map and defines SimSceneTables name()
+#define SIM_SCENE(name, propsTable, animTable, touchTable, groupsTable, randomTable, soundsTable, timersTable)                     \
+    static_assert(propsTable[0].bobAmp == simTableRows(propsTable) - 1,                                                            \
+                  #propsTable ": bobAmp in row 0 must be the number of objects");                                                  \
+    static_assert(simUniqueObjIDs(propsTable, simTableRows(propsTable)),                                                           \
+                  #propsTable ": objIDs must be positive and unique");                                                             \
+    static_assert(simPropsRefsValid(propsTable, simTableRows(propsTable), simTableRows(animTable),                                 \
+                                    simTableRows(touchTable), simTableRows(groupsTable)),                                          \
+                  #propsTable ": an animID, tsID, groupID or childImage points past its table");                                   \
+    static_assert(simAnimRowsValid(animTable, simTableRows(animTable)),                                                            \
+                  #animTable ": animID must match the row");                                                                       \
+    static_assert(touchTable[0].objID == simTableRows(touchTable) - 1,                                                             \
+                  #touchTable ": objID in row 0 must be the number of touchspots");                                                \
+    static_assert(simTouchRowsValid(touchTable, simTableRows(touchTable), propsTable, simTableRows(propsTable),                    \
+                                    simTableRows(randomTable)),                                                                    \
+                  #touchTable ": tsID must match the row and objID must be an object or random row");                              \
+    static_assert(simGroupRowsValid(groupsTable, simTableRows(groupsTable), propsTable, simTableRows(propsTable)),                 \
+                  #groupsTable ": groupID must match the row and every master and sub must be an object");                         \
+    static_assert(simRandomRowsValid(randomTable, simTableRows(randomTable), propsTable, simTableRows(propsTable)),                \
+                  #randomTable ": every entry must be 0 or an object");                                                            \
+    static_assert(soundsTable[0].soundID == simTableRows(soundsTable) - 1,                                                         \
+                  #soundsTable ": soundID in row 0 must be the number of sounds");                                                 \
+    static_assert(timersTable[0].objTargetID == simTableRows(timersTable) - 1,                                                     \
+                  #timersTable ": objTargetID in row 0 must be the number of timers");                                             \
+    static_assert(simTimerRowsValid(timersTable, simTableRows(timersTable), propsTable, simTableRows(propsTable)),                 \
+                  #timersTable ": objTargetID must be 0 or an object");                                                            \
+                                                                                                                                   \
+    static constexpr SimRowMap<simMaxObjID(propsTable, simTableRows(propsTable)) + 1> name##Rows =                                 \
+        simMakeRowMap<simMaxObjID(propsTable, simTableRows(propsTable)) + 1>(                                                      \
+            propsTable, simTableRows(propsTable), SimMakeIndices<simMaxObjID(propsTable, simTableRows(propsTable)) + 1>::type());  \
+                                                                                                                                   \
+    SimSceneTables name() {                                                                                                        \
+        SimSceneTables scene;                                                                                                      \
+        scene.props     = propsTable;   scene.numProps  = simTableRows(propsTable);                                                \
+        scene.anim      = animTable;    scene.numAnim   = simTableRows(animTable);                                                 \
+        scene.touch     = touchTable;   scene.numTouch  = simTableRows(touchTable);                                                \
+        scene.groups    = groupsTable;  scene.numGroups = simTableRows(groupsTable);                                               \
+        scene.random    = randomTable;  scene.numRandom = simTableRows(randomTable);                                               \
+        scene.sounds    = soundsTable;  scene.numSounds = simTableRows(soundsTable);                                               \
+        scene.timers    = timersTable;  scene.numTimers = simTableRows(timersTable);                                               \
+        scene.objRows   = name##Rows.rows;                                                                                         \
+        scene.numObjIDs = simMaxObjID(propsTable, simTableRows(propsTable)) + 1;                                                   \
+        return scene;                                                                                                              \
+    }
+
+// every scene SimCore knows, defined in SimScene.cpp
+SimSceneTables simMermaidsScene();
+
+// a built-in scene by the name its .pcs file goes by ("mermaids"), NO if there isn't one
+BOOL simBuiltInScene(const char *name, SimSceneTables *scene);
+
+#endif
@@ -0,0 +1,272 @@
+//
+//  SimSceneFile.cpp
+//  Papercut
+//
+//  .pcs scene files, mapped and read in place, and written from the
+//    built-in tables.
+//
+
+#include "SimSceneFile.h"
+#include "SimSceneSchema.h"
+
+#include <map>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+SimSceneFile::SimSceneFile() : map(NULL), mapLength(0), sceneName("") {
+    scene = SimSceneTables();
+}
+
+SimSceneFile::~SimSceneFile() {
+    clear();
+}
+
+void SimSceneFile::clear() {
+
+    if (map) { munmap(map, mapLength); }
+    map = NULL;
+    mapLength = 0;
+    sceneName = "";
+    scene = SimSceneTables();
+
+    props.clear();
+    anim.clear();
+    touch.clear();
+    groups.clear();
+    random.clear();
+    sounds.clear();
+    timers.clear();
+    objRows.clear();
+}
+
+BOOL SimSceneFile::load(const char *filename) {
+
+    clear();
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) { return NO; }
+
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (info.st_size < (off_t)sizeof(SimSceneHeader))) {
+        close(fd);
+        return NO;
+    }
+
+    void *fileMap = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (fileMap == MAP_FAILED) { return NO; }
+
+    map = fileMap;
+    mapLength = (size_t)info.st_size;
+
+    if ((!SimSceneValid(map, mapLength)) || (!gatherTables()) || (!tablesValid())) {
+        clear();
+        return NO;
+    }
+
+    sceneName = SimSceneName(map);
+    return YES;
+}
+
+// one table's rows out of the mapping, NO if the file doesn't have it
+template <typename T>
+static BOOL gatherTable(const void *data, uint16_t tableID, std::vector<T> &rows, const T **table, int *numRows) {
+
+    const SimSceneTable *fileTable = SimSceneFindTable(data, tableID);
+    if ((fileTable == NULL) || (fileTable->numRows == 0)) { return NO; }
+
+    rows.resize(fileTable->numRows);
+    for (uint32_t i = 0; i < fileTable->numRows; i++) {
+        SimSceneGatherRow(data, fileTable, i, &rows[i]);
+    }
+
+    *table = &rows[0];
+    *numRows = (int)rows.size();
+    return YES;
+}
+
+BOOL SimSceneFile::gatherTables() {
+
+    if (!gatherTable(map, scProps, props, &scene.props, &scene.numProps))      { return NO; }
+    if (!gatherTable(map, scAnim, anim, &scene.anim, &scene.numAnim))          { return NO; }
+    if (!gatherTable(map, scTouch, touch, &scene.touch, &scene.numTouch))      { return NO; }
+    if (!gatherTable(map, scGroups, groups, &scene.groups, &scene.numGroups))  { return NO; }
+    if (!gatherTable(map, scRandom, random, &scene.random, &scene.numRandom))  { return NO; }
+    if (!gatherTable(map, scSounds, sounds, &scene.sounds, &scene.numSounds))  { return NO; }
+    if (!gatherTable(map, scTimers, timers, &scene.timers, &scene.numTimers))  { return NO; }
+
+    // the objID -> row map, checked against the props it indexes
+    const SimSceneTable *rows = SimSceneFindTable(map, scRows);
+    if ((rows == NULL) || (rows->numRows == 0)) { return NO; }
+
+    objRows.resize(rows->numRows);
+    for (uint32_t objID = 0; objID < rows->numRows; objID++) {
+        int row = SimSceneRowForObjID(map, rows, (int)objID);
+        if ((row != -1) && ((row < 1) || (row >= scene.numProps) || (scene.props[row].objID != (int)objID))) { return NO; }
+        objRows[objID] = (int16_t)row;
+    }
+
+    scene.objRows = &objRows[0];
+    scene.numObjIDs = (int)objRows.size();
+    return YES;
+}
+
+// the checks SIM_SCENE makes at compile time, made on the loaded rows
+BOOL SimSceneFile::tablesValid() const {
+
+    return (simUniqueObjIDs(scene.props, scene.numProps) &&
+            simPropsRefsValid(scene.props, scene.numProps, scene.numAnim, scene.numTouch, scene.numGroups) &&
+            simAnimRowsValid(scene.anim, scene.numAnim) &&
+            simTouchRowsValid(scene.touch, scene.numTouch, scene.props, scene.numProps, scene.numRandom) &&
+            simGroupRowsValid(scene.groups, scene.numGroups, scene.props, scene.numProps) &&
+            simRandomRowsValid(scene.random, scene.numRandom, scene.props, scene.numProps) &&
+            simTimerRowsValid(scene.timers, scene.numTimers, scene.props, scene.numProps)) ? YES : NO;
+}
+
+// ___ WRITING
+
+typedef struct {
+    uint16_t        tableID;
+    const void      *rows;          // NULL for scRows
+    size_t          rowSize;
+    int             numRows;
+    const SimSceneField *fields;
+    int             numFields;
+} SimSceneWriteTable;
+
+static void putBytes(std::vector<uint8_t> &data, size_t offset, const void *bytes, size_t length) {
+    memcpy(&data[offset], bytes, length);
+}
+
+void SimSceneFile::serialize(const SimSceneTables &sceneTables, const char *name, std::vector<uint8_t> &data) {
+
+    // the strings, each one once, the name first
+    std::string strings;
+    std::map<std::string, uint32_t> stringOffsets;
+    strings.append(name).push_back('\0');
+    stringOffsets[name] = 0;
+
+    SimSceneWriteTable tables[scNumTables];
+    const void *tableRows[scRows] = { sceneTables.props, sceneTables.anim, sceneTables.touch, sceneTables.groups,
+                                      sceneTables.random, sceneTables.sounds, sceneTables.timers };
+    int tableCounts[scRows] = { sceneTables.numProps, sceneTables.numAnim, sceneTables.numTouch, sceneTables.numGroups,
+                                sceneTables.numRandom, sceneTables.numSounds, sceneTables.numTimers };
+
+    for (uint16_t t = 0; t < scRows; t++) {
+        tables[t].tableID = t;
+        tables[t].rows = tableRows[t];
+        tables[t].numRows = tableCounts[t];
+        tables[t].fields = SimSceneSchema(t, &tables[t].numFields, &tables[t].rowSize);
+    }
+
+    tables[scRows].tableID = scRows;
+    tables[scRows].rows = NULL;
+    tables[scRows].rowSize = 0;
+    tables[scRows].numRows = sceneTables.numObjIDs;
+    tables[scRows].fields = NULL;
+    tables[scRows].numFields = 1;
+
+    // lay out the columns of every table after the table list
+    size_t size = sizeof(SimSceneHeader) + (scNumTables * sizeof(SimSceneTable));
+    size_t columnsOffset[scNumTables];
+    size_t dataOffset[scNumTables];
+
+    for (int t = 0; t < scNumTables; t++) {
+        columnsOffset[t] = size;
+        size += tables[t].numFields * sizeof(SimSceneColumn);
+        dataOffset[t] = size;
+        for (int f = 0; f < tables[t].numFields; f++) {
+            uint16_t type = (tables[t].fields) ? tables[t].fields[f].type : (uint16_t)sfInt;
+            size += SimSceneColumnBytes(type, tables[t].numRows);
+        }
+    }
+
+    data.assign(size, 0);
+
+    for (int t = 0; t < scNumTables; t++) {
+
+        SimSceneTable fileTable = { tables[t].tableID, (uint16_t)tables[t].numFields, (uint32_t)tables[t].numRows,
+                                    (uint32_t)columnsOffset[t], 0 };
+        putBytes(data, sizeof(SimSceneHeader) + (t * sizeof(SimSceneTable)), &fileTable, sizeof(fileTable));
+
+        size_t offset = dataOffset[t];
+        for (int f = 0; f < tables[t].numFields; f++) {
+
+            uint16_t type = (tables[t].fields) ? tables[t].fields[f].type : (uint16_t)sfInt;
+            SimSceneColumn column = { (uint16_t)f, type, (uint32_t)offset };
+            putBytes(data, columnsOffset[t] + (f * sizeof(SimSceneColumn)), &column, sizeof(column));
+
+            for (int r = 0; r < tables[t].numRows; r++) {
+
+                size_t cell = offset + (r * SimSceneFieldBytes(type));
+
+                // scRows has the one column, the props row of each objID
+                if (tables[t].fields == NULL) {
+                    int32_t value = sceneTables.objRows[r];
+                    putBytes(data, cell, &value, sizeof(value));
+                    continue;
+                }
+
+                const uint8_t *src = (const uint8_t*)tables[t].rows + (r * tables[t].rowSize) + tables[t].fields[f].offset;
+
+                switch (type) {
+                    case sfInt: {
+                        int value;
+                        memcpy(&value, src, sizeof(value));
+                        int32_t stored = value;
+                        putBytes(data, cell, &stored, sizeof(stored));
+                        break;
+                    }
+                    case sfFloat: {
+                        CGFloat value;
+                        memcpy(&value, src, sizeof(value));
+                        float stored = value;
+                        putBytes(data, cell, &stored, sizeof(stored));
+                        break;
+                    }
+                    case sfBool: {
+                        BOOL value;
+                        memcpy(&value, src, sizeof(value));
+                        data[cell] = (value) ? 1 : 0;
+                        break;
+                    }
+                    case sfString: {
+                        const char *value;
+                        memcpy(&value, src, sizeof(value));
+                        uint32_t stored = SIM_SCENE_NO_STRING;
+                        if (value) {
+                            std::map<std::string, uint32_t>::iterator it = stringOffsets.find(value);
+                            if (it == stringOffsets.end()) {
+                                it = stringOffsets.insert(std::make_pair(std::string(value), (uint32_t)strings.size())).first;
+                                strings.append(value).push_back('\0');
+                            }
+                            stored = it->second;
+                        }
+                        putBytes(data, cell, &stored, sizeof(stored));
+                        break;
+                    }
+                }
+            }
+
+            offset += SimSceneColumnBytes(type, tables[t].numRows);
+        }
+    }
+
+    // the strings go on the end
+    SimSceneHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SIM_SCENE_MAGIC;
+    header.version = SIM_SCENE_VERSION;
+    header.numTables = scNumTables;
+    header.nameOffset = 0;
+    header.stringsOffset = (uint32_t)data.size();
+    header.stringsSize = (uint32_t)strings.size();
+    header.fileSize = (uint32_t)(data.size() + strings.size());
+
+    data.insert(data.end(), strings.begin(), strings.end());
+    putBytes(data, 0, &header, sizeof(header));
+}
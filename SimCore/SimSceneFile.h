@@ -0,0 +1,66 @@
+//
+//  SimSceneFile.h
+//  Papercut
+//
+//  A story's property tables loaded from a .pcs file (SimSceneFormat.h)
+//    instead of compiled in.  The file is memory-mapped, checked the way
+//    SIM_SCENE checks the built-in tables, and gathered once into the
+//    row structs SimWorld steps from, with every string pointing into
+//    the mapping.  The file has to stay loaded while a world uses its
+//    tables.
+//
+//  serialize() is the other direction, scenec uses it to write the
+//    built-in scenes out as .pcs files.
+//
+
+#ifndef SIMCORE_SIMSCENEFILE_H
+#define SIMCORE_SIMSCENEFILE_H
+
+#include <vector>
+
+#include "SimTypes.h"
+#include "SimScene.h"
+#include "SimSceneFormat.h"
+
+class SimSceneFile {
+public:
+    SimSceneFile();
+    ~SimSceneFile();
+
+    // NO if the file is missing, isn't a valid .pcs, or its tables point
+    //   at rows that aren't there
+    BOOL load(const char *filename);
+    void clear();
+
+    BOOL isLoaded() const                   { return (map) ? YES : NO; }
+    const char* name() const                { return sceneName; }
+    size_t fileSize() const                 { return mapLength; }
+    const SimSceneTables& tables() const    { return scene; }
+
+    // a scene's tables in SimSceneFormat, named name
+    static void serialize(const SimSceneTables &sceneTables, const char *name, std::vector<uint8_t> &data);
+
+private:
+    void            *map;
+    size_t          mapLength;
+    const char      *sceneName;
+    SimSceneTables  scene;
+
+    std::vector<PaperProps>             props;
+    std::vector<PaperPropsAnim>         anim;
+    std::vector<PaperPropsTouchspot>    touch;
+    std::vector<PaperGroups>            groups;
+    std::vector<PaperRandom>            random;
+    std::vector<PaperPropsSounds>       sounds;
+    std::vector<PaperWorldTimers>       timers;
+    std::vector<int16_t>                objRows;
+
+    BOOL gatherTables();
+    BOOL tablesValid() const;
+
+    // mappings can't be copied
+    SimSceneFile(const SimSceneFile&);
+    SimSceneFile& operator=(const SimSceneFile&);
+};
+
+#endif
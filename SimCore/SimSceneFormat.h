@@ -0,0 +1,163 @@
+//
+//  SimSceneFormat.h
+//  Papercut
+//
+//  Binary form of a story's property tables, written by scenec from the
+//    tables in Variables.h and read in place (memory-mapped) by the
+//    app's SceneFile and SimCore's SimSceneFile, so a story can ship as
+//    a data file instead of being compiled in, and loading one is a
+//    mmap and a header check.
+//
+//  A .pcs file is columnar: every table is a list of columns, one per
+//    field, each holding that field for every row.  Columns are
+//    identified by their field's index in the table's schema
+//    (SimSceneSchema.h), so a newer build reads an older file with the
+//    fields it's missing as zero; SIM_SCENE_VERSION only changes when
+//    this layout does.
+//
+//      SimSceneHeader                      32 bytes
+//      SimSceneTable    tables[numTables]
+//      for each table:
+//          SimSceneColumn   columns[numColumns]
+//          column data      numRows values each, zero padded to 4 bytes
+//      char             strings[stringsSize], NUL terminated
+//
+//  Ints, floats and string offsets are 4 bytes a row, BOOLs 1 byte.
+//    Everything is little-endian, the same as every device and desktop
+//    the app builds for.  Plain C so the Objective-C side can include it.
+//
+
+#ifndef SIMCORE_SIMSCENEFORMAT_H
+#define SIMCORE_SIMSCENEFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_SCENE_MAGIC         0x43534350      // "PCSC"
+#define SIM_SCENE_VERSION       1
+#define SIM_SCENE_EXT           "pcs"
+#define SIM_SCENE_NO_STRING     0xFFFFFFFF      // a NULL string
+
+// the tables of a story, scRows maps objID -> props row (-1 = none)
+typedef enum {
+    scProps     = 0,
+    scAnim      = 1,
+    scTouch     = 2,
+    scGroups    = 3,
+    scRandom    = 4,
+    scSounds    = 5,
+    scTimers    = 6,
+    scRows      = 7,
+    scNumTables = 8
+} SimSceneTableID;
+
+typedef enum {
+    sfInt       = 0,        // int and the enums, int32_t
+    sfFloat     = 1,        // CGFloat, float
+    sfBool      = 2,        // BOOL, uint8_t
+    sfString    = 3         // const char*, uint32_t offset into the strings
+} SimSceneFieldType;
+
+typedef struct {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    numTables;
+    uint32_t    fileSize;
+    uint32_t    nameOffset;     // the story's name, in the strings
+    uint32_t    stringsOffset;
+    uint32_t    stringsSize;
+    uint32_t    reserved[2];
+} SimSceneHeader;
+
+typedef struct {
+    uint16_t    tableID;        // SimSceneTableID
+    uint16_t    numColumns;
+    uint32_t    numRows;        // including row 0, the border / dummy row
+    uint32_t    columnsOffset;  // SimSceneColumn[numColumns]
+    uint32_t    reserved;
+} SimSceneTable;
+
+typedef struct {
+    uint16_t    field;          // index into the table's schema
+    uint16_t    type;           // SimSceneFieldType
+    uint32_t    dataOffset;
+} SimSceneColumn;
+
+static inline size_t SimSceneFieldBytes(uint16_t type) {
+    return (type == sfBool) ? 1 : 4;
+}
+
+static inline size_t SimSceneColumnBytes(uint16_t type, uint32_t numRows) {
+    return ((SimSceneFieldBytes(type) * numRows) + 3) & ~(size_t)3;
+}
+
+static inline const SimSceneTable* SimSceneTableList(const void *data) {
+    return (const SimSceneTable*)((const uint8_t*)data + sizeof(SimSceneHeader));
+}
+
+static inline const SimSceneColumn* SimSceneColumns(const void *data, const SimSceneTable *table) {
+    return (const SimSceneColumn*)((const uint8_t*)data + table->columnsOffset);
+}
+
+static inline const void* SimSceneColumnData(const void *data, const SimSceneColumn *column) {
+    return (const uint8_t*)data + column->dataOffset;
+}
+
+static inline const char* SimSceneStrings(const void *data) {
+    return (const char*)data + ((const SimSceneHeader*)data)->stringsOffset;
+}
+
+static inline const char* SimSceneName(const void *data) {
+    return SimSceneStrings(data) + ((const SimSceneHeader*)data)->nameOffset;
+}
+
+// NULL if the file has no such table
+static inline const SimSceneTable* SimSceneFindTable(const void *data, uint16_t tableID) {
+    const SimSceneHeader *header = (const SimSceneHeader*)data;
+    const SimSceneTable *tables = SimSceneTableList(data);
+    for (uint16_t i = 0; i < header->numTables; i++) {
+        if (tables[i].tableID == tableID) { return &tables[i]; }
+    }
+    return NULL;
+}
+
+// checks the header and that every table, column and string is inside the file
+static inline int SimSceneValid(const void *data, size_t length) {
+
+    if ((data == NULL) || (length < sizeof(SimSceneHeader))) { return 0; }
+
+    const SimSceneHeader *header = (const SimSceneHeader*)data;
+    if ((header->magic != SIM_SCENE_MAGIC) || (header->version != SIM_SCENE_VERSION)) { return 0; }
+    if ((header->fileSize > length) || (header->stringsSize == 0)) { return 0; }
+    if ((size_t)header->stringsOffset + header->stringsSize > header->fileSize) { return 0; }
+    if (header->nameOffset >= header->stringsSize) { return 0; }
+    if (sizeof(SimSceneHeader) + ((size_t)header->numTables * sizeof(SimSceneTable)) > header->fileSize) { return 0; }
+
+    const char *strings = SimSceneStrings(data);
+    if (strings[header->stringsSize - 1] != '\0') { return 0; }
+
+    const SimSceneTable *tables = SimSceneTableList(data);
+    for (uint16_t t = 0; t < header->numTables; t++) {
+
+        if ((tables[t].columnsOffset & 3) ||
+            ((size_t)tables[t].columnsOffset + ((size_t)tables[t].numColumns * sizeof(SimSceneColumn)) > header->fileSize)) { return 0; }
+
+        const SimSceneColumn *columns = SimSceneColumns(data, &tables[t]);
+        for (uint16_t c = 0; c < tables[t].numColumns; c++) {
+
+            if ((columns[c].type > sfString) || (columns[c].dataOffset & 3)) { return 0; }
+            if ((size_t)columns[c].dataOffset + SimSceneColumnBytes(columns[c].type, tables[t].numRows) > header->fileSize) { return 0; }
+
+            if (columns[c].type == sfString) {
+                const uint32_t *offsets = (const uint32_t*)SimSceneColumnData(data, &columns[c]);
+                for (uint32_t r = 0; r < tables[t].numRows; r++) {
+                    if ((offsets[r] != SIM_SCENE_NO_STRING) && (offsets[r] >= header->stringsSize)) { return 0; }
+                }
+            }
+        }
+    }
+
+    return 1;
+}
+
+#endif
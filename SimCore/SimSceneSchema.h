@@ -0,0 +1,257 @@
+//
+//  SimSceneSchema.h
+//  Papercut
+//
+//  Which field of which table struct every .pcs column holds.  A field's
+//    index in these lists is its column's id in the file, so fields may
+//    only ever be added to the end of a list.  Plain C; include it after
+//    Variables.h (SimTypes.h in SimCore) so the structs are defined.
+//
+
+#ifndef SIMCORE_SIMSCENESCHEMA_H
+#define SIMCORE_SIMSCENESCHEMA_H
+
+#include <string.h>
+
+#include "SimSceneFormat.h"
+
+typedef struct {
+    uint16_t    type;           // SimSceneFieldType
+    uint16_t    offset;         // offsetof the field in its struct
+    const char  *name;
+} SimSceneField;
+
+#define SIM_SCENE_FIELD(type, structType, field)    { type, (uint16_t)offsetof(structType, field), #field }
+
+static const SimSceneField simScenePropsFields[] = {
+    SIM_SCENE_FIELD(sfInt,     PaperProps, objID),
+    SIM_SCENE_FIELD(sfString,  PaperProps, imagePath),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, bounded),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, randSpawn),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, spawnX),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, spawnY),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, zPos),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, moveType),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, velX),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, velY),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, decel),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, decelTime),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, bob),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, bobAmp),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, bobOffset),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, flipX),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, flipTime),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, spawnTime),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, init),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, childImage),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, childSpawnX),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, childSpawnY),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, animID),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, collision),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, mass),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, tsID),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, groupID),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, frames),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, frameDur),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, orientation),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, pinch),
+    SIM_SCENE_FIELD(sfString,  PaperProps, imageType),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, imageSizeWidth),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, imageSizeHeight),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, paperType),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, killOnTouch),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, pinchMax),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, pinchMin),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, rVelOn),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, rVelTimeMax),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, rVelTimeMin),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, rVelMax),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, rVelMin),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, bindType),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, spawnByShake),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, killTime),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, bSpeed),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, bKillOnArrive),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, bSeekOffsetX),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, bSeekOffsetY),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, animTime),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, decelType),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, spawnCount),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, autoReverse),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, seekDelay),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, angledPath),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, vcType),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, movePath),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, pathTime),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, peekTime),
+    SIM_SCENE_FIELD(sfInt,     PaperProps, numPaths),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, bFlocking),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, sinkAngle),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, removeOnClean),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, wiggleTime),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, wiggleAngle),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, scaleStart),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, fixedDir),
+    SIM_SCENE_FIELD(sfBool,    PaperProps, objLimit),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, crvXOffMin),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, crvXOffMax),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, crvYOffMin),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, crvYOffMax),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, crvCOffMin),
+    SIM_SCENE_FIELD(sfFloat,   PaperProps, crvCOffMax),
+};
+
+static const SimSceneField simSceneAnimFields[] = {
+    SIM_SCENE_FIELD(sfInt,     PaperPropsAnim, animID),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, anchorX),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, anchorY),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, duration),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, repeat),
+    SIM_SCENE_FIELD(sfInt,     PaperPropsAnim, numAngles),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, angle01),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, angle02),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, angle03),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, angle04),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, angle05),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, angle06),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, angle07),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, angle08),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, angle09),
+    SIM_SCENE_FIELD(sfInt,     PaperPropsAnim, numPoints),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, point01x),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, point01y),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, point02x),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, point02y),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, point03x),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, point03y),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, point04x),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, point04y),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, point05x),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsAnim, point05y),
+};
+
+static const SimSceneField simSceneTouchFields[] = {
+    SIM_SCENE_FIELD(sfInt,     PaperPropsTouchspot, tsID),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsTouchspot, tsX),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsTouchspot, tsY),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsTouchspot, tsWd),
+    SIM_SCENE_FIELD(sfFloat,   PaperPropsTouchspot, tsHt),
+    SIM_SCENE_FIELD(sfInt,     PaperPropsTouchspot, objID),
+    SIM_SCENE_FIELD(sfBool,    PaperPropsTouchspot, random),
+};
+
+static const SimSceneField simSceneGroupsFields[] = {
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, groupID),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDMaster),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, numSubs),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDSub01),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDSub02),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDSub03),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDSub04),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDSub05),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDSub06),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDSub07),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDSub08),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDSub09),
+    SIM_SCENE_FIELD(sfInt,     PaperGroups, objIDSub10),
+};
+
+static const SimSceneField simSceneRandomFields[] = {
+    SIM_SCENE_FIELD(sfInt,     PaperRandom, rObjID01),
+    SIM_SCENE_FIELD(sfInt,     PaperRandom, rObjID02),
+    SIM_SCENE_FIELD(sfInt,     PaperRandom, rObjID03),
+    SIM_SCENE_FIELD(sfInt,     PaperRandom, rObjID04),
+    SIM_SCENE_FIELD(sfInt,     PaperRandom, rObjID05),
+};
+
+static const SimSceneField simSceneSoundsFields[] = {
+    SIM_SCENE_FIELD(sfInt,     PaperPropsSounds, soundID),
+    SIM_SCENE_FIELD(sfString,  PaperPropsSounds, soundPath),
+    SIM_SCENE_FIELD(sfString,  PaperPropsSounds, fileType),
+};
+
+static const SimSceneField simSceneTimersFields[] = {
+    SIM_SCENE_FIELD(sfInt,     PaperWorldTimers, mType),
+    SIM_SCENE_FIELD(sfInt,     PaperWorldTimers, wTimer),
+    SIM_SCENE_FIELD(sfInt,     PaperWorldTimers, objTargetID),
+    SIM_SCENE_FIELD(sfFloat,   PaperWorldTimers, wtInterval),
+    SIM_SCENE_FIELD(sfFloat,   PaperWorldTimers, wtIntervalMax),
+    SIM_SCENE_FIELD(sfFloat,   PaperWorldTimers, wtIntervalMin),
+};
+// the fields of a table and the size of the struct a row fills, NULL for scRows
+static inline const SimSceneField* SimSceneSchema(uint16_t tableID, int *numFields, size_t *rowSize) {
+
+#define SIM_SCENE_SCHEMA(fields, structType)    \
+    *numFields = (int)(sizeof(fields) / sizeof(fields[0])); *rowSize = sizeof(structType); return fields;
+
+    switch (tableID) {
+        case scProps:   SIM_SCENE_SCHEMA(simScenePropsFields, PaperProps)
+        case scAnim:    SIM_SCENE_SCHEMA(simSceneAnimFields, PaperPropsAnim)
+        case scTouch:   SIM_SCENE_SCHEMA(simSceneTouchFields, PaperPropsTouchspot)
+        case scGroups:  SIM_SCENE_SCHEMA(simSceneGroupsFields, PaperGroups)
+        case scRandom:  SIM_SCENE_SCHEMA(simSceneRandomFields, PaperRandom)
+        case scSounds:  SIM_SCENE_SCHEMA(simSceneSoundsFields, PaperPropsSounds)
+        case scTimers:  SIM_SCENE_SCHEMA(simSceneTimersFields, PaperWorldTimers)
+    }
+
+#undef SIM_SCENE_SCHEMA
+
+    *numFields = 0;
+    *rowSize = 0;
+    return NULL;
+}
+
+// fills out (a PaperProps, PaperPropsAnim, ...) with one row of a mapped
+//   table, strings pointing into the file; fields the file doesn't have,
+//   or has with another type, are left zero
+static inline void SimSceneGatherRow(const void *data, const SimSceneTable *table, uint32_t row, void *out) {
+
+    int numFields;
+    size_t rowSize;
+    const SimSceneField *fields = SimSceneSchema(table->tableID, &numFields, &rowSize);
+    if (fields == NULL) { return; }
+
+    memset(out, 0, rowSize);
+    if (row >= table->numRows) { return; }
+
+    const SimSceneColumn *columns = SimSceneColumns(data, table);
+    for (uint16_t c = 0; c < table->numColumns; c++) {
+
+        if ((columns[c].field >= numFields) || (fields[columns[c].field].type != columns[c].type)) { continue; }
+
+        const void *values = SimSceneColumnData(data, &columns[c]);
+        uint8_t *dst = (uint8_t*)out + fields[columns[c].field].offset;
+
+        switch (columns[c].type) {
+            case sfInt: {
+                int value = ((const int32_t*)values)[row];
+                memcpy(dst, &value, sizeof(value));
+                break;
+            }
+            case sfFloat: {
+                CGFloat value = ((const float*)values)[row];
+                memcpy(dst, &value, sizeof(value));
+                break;
+            }
+            case sfBool: {
+                BOOL value = (((const uint8_t*)values)[row]) ? YES : NO;
+                memcpy(dst, &value, sizeof(value));
+                break;
+            }
+            case sfString: {
+                uint32_t offset = ((const uint32_t*)values)[row];
+                const char *value = (offset == SIM_SCENE_NO_STRING) ? NULL : (SimSceneStrings(data) + offset);
+                memcpy(dst, &value, sizeof(value));
+                break;
+            }
+        }
+    }
+}
+
+// props row of an objID from the scRows table, -1 if there isn't one
+static inline int SimSceneRowForObjID(const void *data, const SimSceneTable *rows, int objID) {
+    if ((rows == NULL) || (rows->numColumns == 0) || (objID < 0) || ((uint32_t)objID >= rows->numRows)) { return -1; }
+    return ((const int32_t*)SimSceneColumnData(data, SimSceneColumns(data, rows)))[objID];
+}
+
+#endif
@@ -0,0 +1,59 @@
+//
+//  SimStateBuffer.cpp
+//  Papercut
+//
+//  Double-buffered snapshot of every piece's center and velocity.
+//
+
+#include "SimStateBuffer.h"
+#include "SimPaper.h"
+
+void SimStateBuffer::reserve(size_t numSlots) {
+    buffers[0].reserve(numSlots);
+    buffers[1].reserve(numSlots);
+}
+
+void SimStateBuffer::clear() {
+    buffers[0].clear();
+    buffers[1].clear();
+    front = 0;
+}
+
+void SimStateBuffer::publish(const SimObjectStore &objects) {
+
+    std::vector<SimPieceState> &back = buffers[front ^ 1];
+
+    // new slots start out never published, and a reused slot's
+    //   generation has moved on, so nothing has to be cleared
+    SimPieceState empty;
+    empty.generation = 0;
+    back.resize(objects.slotCount(), empty);
+
+    for (size_t i = 0; i < objects.size(); i++) {
+        const SimPaper *sPiece = objects[i];
+        SimPieceState &sState = back[sPiece->handle.index];
+        sState.center = sPiece->center;
+        sState.vel = sPiece->behavior.vel;
+        sState.generation = sPiece->handle.generation;
+    }
+
+    front ^= 1;
+}
+
+const SimPieceState* SimStateBuffer::lookup(const std::vector<SimPieceState> &buffer, SimHandle h) {
+
+    if ((h.isNull()) || (h.index >= buffer.size())) { return NULL; }
+
+    const SimPieceState *sState = &buffer[h.index];
+    return (sState->generation == h.generation) ? sState : NULL;
+}
+
+SimPoint SimStateBuffer::center(const SimPaper *piece) const {
+    const SimPieceState *sState = current(piece->handle);
+    return (sState) ? sState->center : piece->center;
+}
+
+SimVector SimStateBuffer::velocity(const SimPaper *piece) const {
+    const SimPieceState *sState = current(piece->handle);
+    return (sState) ? sState->vel : piece->behavior.vel;
+}
@@ -0,0 +1,60 @@
+//
+//  SimStateBuffer.h
+//  Papercut
+//
+//  What the pieces see of each other during a tick.  Seek, flee and
+//    flocking look at other pieces' centers and velocities while those
+//    pieces are being moved by the same walk, so before the walk starts
+//    the world publishes every live piece into the back buffer and swaps
+//    it to the front.  Everything that reads another piece reads the
+//    front, the pieces themselves take the new values, and a piece sees
+//    the same world wherever it falls in the walk or whichever thread
+//    runs it.
+//
+//  Entries are kept by store slot, so they stay put when the packed
+//    order changes.  The old front is kept as the previous tick.
+//
+
+#ifndef SIMCORE_SIMSTATEBUFFER_H
+#define SIMCORE_SIMSTATEBUFFER_H
+
+#include <vector>
+
+#include "SimTypes.h"
+#include "SimObjectStore.h"
+
+class SimPaper;
+
+// one piece as the rest of the world sees it for a tick
+typedef struct {
+    SimPoint    center;
+    SimVector   vel;
+    uint32_t    generation;     // of the handle it was published for, 0 = never published
+} SimPieceState;
+
+class SimStateBuffer {
+public:
+    SimStateBuffer() : front(0) {}
+
+    void reserve(size_t numSlots);
+    void clear();
+
+    // every live piece into the back buffer, which then becomes the front
+    void publish(const SimObjectStore &objects);
+
+    // as of the last publish, NULL if the piece wasn't live then
+    const SimPieceState* current(SimHandle h) const     { return lookup(buffers[front], h); }
+    const SimPieceState* previous(SimHandle h) const    { return lookup(buffers[front ^ 1], h); }
+
+    // as of the last publish, a piece spawned since then reads live
+    SimPoint center(const SimPaper *piece) const;
+    SimVector velocity(const SimPaper *piece) const;
+
+private:
+    std::vector<SimPieceState>  buffers[2];
+    int                         front;
+
+    static const SimPieceState* lookup(const std::vector<SimPieceState> &buffer, SimHandle h);
+};
+
+#endif
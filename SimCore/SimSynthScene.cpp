@@ -0,0 +1,171 @@
+//
+//  SimSynthScene.cpp
+//  Papercut
+//
+//  Synthetic scenes at any population, built from the Mermaids rows.
+//
+
+#include "SimSynthScene.h"
+#include "SimWorld.h"
+#include "SimPaper.h"
+
+// the Mermaids rows each kind is made from
+#define SYNTH_DRIFTER       13      // Fish03
+#define SYNTH_FLOCKER       19      // NoteFh01
+#define SYNTH_PATH_MOVER    34      // Star
+#define SYNTH_TIMER         3       // Fish01
+#define SYNTH_GROUP         2       // school of small fish, master and two subs
+
+#define SYNTH_GROUP_SIZE    3
+
+SimSynthMix simDefaultSynthMix() {
+    SimSynthMix mix;
+    mix.drifters = 35;
+    mix.flockers = 20;
+    mix.pathMovers = 15;
+    mix.groups = 15;
+    mix.timers = 15;
+    return mix;
+}
+
+SimSynthScene::SimSynthScene()
+    : targetPopulation(0),
+      drifterID(0), flockerID(0), pathMoverID(0), timerID(0),
+      numDrifters(0), numFlockers(0), numPathMovers(0), numTimers(0) {
+    scene = SimSceneTables();
+}
+
+static SimPoint randomPoint() {
+    return SimPoint(SimRandomUniform(SIM_VIEW_WIDTH), SimRandomUniform(SIM_VIEW_HEIGHT));
+}
+
+BOOL SimSynthScene::build(int population, const SimSynthMix &mix) {
+
+    const SimSceneTables backdrop = simMermaidsScene();
+
+    props.assign(backdrop.props, backdrop.props + backdrop.numProps);
+    groups.assign(backdrop.groups, backdrop.groups + backdrop.numGroups);
+
+    int backdropPieces = 0;
+    for (int i = 1; i < backdrop.numProps; i++) {
+        if (backdrop.props[i].init) { backdropPieces++; }
+    }
+
+    // split what the backdrop doesn't cover between the kinds,
+    //   the drifters take whatever doesn't divide evenly
+    int synthPieces = (population > backdropPieces) ? (population - backdropPieces) : 0;
+    int shares = mix.drifters + mix.flockers + mix.pathMovers + mix.groups + mix.timers;
+    if (shares <= 0) { return NO; }
+
+    int numGroupRows = ((synthPieces * mix.groups) / shares) / SYNTH_GROUP_SIZE;
+    numFlockers = (synthPieces * mix.flockers) / shares;
+    numPathMovers = (synthPieces * mix.pathMovers) / shares;
+    numTimers = (synthPieces * mix.timers) / shares;
+    numDrifters = synthPieces - numFlockers - numPathMovers - numTimers - (numGroupRows * SYNTH_GROUP_SIZE);
+
+    // new objIDs start past the backdrop's, spawn-only rows first
+    int nextID = backdrop.numObjIDs;
+
+    const int spawnRows[4] = { SYNTH_DRIFTER, SYNTH_FLOCKER, SYNTH_PATH_MOVER, SYNTH_TIMER };
+    int *spawnIDs[4] = { &drifterID, &flockerID, &pathMoverID, &timerID };
+
+    for (int k = 0; k < 4; k++) {
+        PaperProps prp = backdrop.props[backdrop.row(spawnRows[k])];
+        prp.objID = nextID++;
+        prp.init = NO;
+        prp.objLimit = NO;
+        props.push_back(prp);
+        *spawnIDs[k] = prp.objID;
+    }
+
+    // each group is a master and its subs, built where the scene loads
+    const PaperGroups &groupRow = backdrop.groups[SYNTH_GROUP];
+    const int groupMembers[SYNTH_GROUP_SIZE] = { groupRow.objIDMaster, groupRow.objIDSub01, groupRow.objIDSub02 };
+
+    for (int g = 0; g < numGroupRows; g++) {
+
+        PaperGroups grp = groupRow;
+        grp.groupID = (int)groups.size();
+
+        SimPoint spawnPos = randomPoint();
+        int memberIDs[SYNTH_GROUP_SIZE];
+
+        for (int m = 0; m < SYNTH_GROUP_SIZE; m++) {
+            PaperProps prp = backdrop.props[backdrop.row(groupMembers[m])];
+            prp.objID = nextID++;
+            prp.init = YES;
+            prp.objLimit = NO;
+            prp.randSpawn = NO;
+            prp.spawnX = (int)spawnPos.x;
+            prp.spawnY = (int)spawnPos.y;
+            prp.groupID = (m == 0) ? grp.groupID : 0;
+            props.push_back(prp);
+            memberIDs[m] = prp.objID;
+        }
+
+        grp.objIDMaster = memberIDs[0];
+        grp.objIDSub01 = memberIDs[1];
+        grp.objIDSub02 = memberIDs[2];
+        groups.push_back(grp);
+    }
+
+    // objIDs are kept in int16_t rows
+    if (nextID > INT16_MAX) { return NO; }
+
+    props[0].bobAmp = (CGFloat)(props.size() - 1);
+
+    objRows.assign(nextID, -1);
+    for (size_t i = 1; i < props.size(); i++) { objRows[props[i].objID] = (int16_t)i; }
+
+    scene = backdrop;
+    scene.props = &props[0];
+    scene.numProps = (int)props.size();
+    scene.groups = &groups[0];
+    scene.numGroups = (int)groups.size();
+    scene.objRows = &objRows[0];
+    scene.numObjIDs = (int)objRows.size();
+
+    targetPopulation = backdropPieces + synthPieces;
+
+    return tablesValid();
+}
+
+int SimSynthScene::populate(SimWorld &world) const {
+
+    // the group rows are objIDs, and so spawnIDs, past the counter
+    if (world.spawnID < scene.numObjIDs) { world.spawnID = scene.numObjIDs; }
+
+    const int spawnIDs[4] = { drifterID, flockerID, pathMoverID, timerID };
+    const int counts[4] = { numDrifters, numFlockers, numPathMovers, numTimers };
+    int spawned = 0;
+
+    // every spawn point up front, one fill per axis
+    size_t total = (size_t)(numDrifters + numFlockers + numPathMovers + numTimers);
+    std::vector<float> spawnX(total + 1), spawnY(total + 1);
+    SimRandomFillRange(SimRandomShared(), &spawnX[0], total, 0.0f, SIM_VIEW_WIDTH);
+    SimRandomFillRange(SimRandomShared(), &spawnY[0], total, 0.0f, SIM_VIEW_HEIGHT);
+
+    for (int k = 0; k < 4; k++) {
+        for (int i = 0; i < counts[k]; i++) {
+
+            SimPaper *sPaper = world.spawnPiece(spawnIDs[k], SimPoint(spawnX[spawned], spawnY[spawned]));
+            world.addToView(sPaper);
+
+            if (sPaper->collision) { world.addObj(sPaper, otCollision); }
+
+            // note fish only flock once they're waiting to be cleaned
+            if (spawnIDs[k] == flockerID) { world.addToCleanQueue(sPaper->handle); }
+
+            spawned++;
+        }
+    }
+
+    return spawned;
+}
+
+BOOL SimSynthScene::tablesValid() const {
+
+    return (simUniqueObjIDs(scene.props, scene.numProps) &&
+            simPropsRefsValid(scene.props, scene.numProps, scene.numAnim, scene.numTouch, scene.numGroups) &&
+            simGroupRowsValid(scene.groups, scene.numGroups, scene.props, scene.numProps)) ? YES : NO;
+}
@@ -0,0 +1,74 @@
+//
+//  SimSynthScene.h
+//  Papercut
+//
+//  Synthetic scenes for the benchmark suite.  Builds property tables at
+//    any population: the Mermaids scene as the backdrop (SimWorld still
+//    reaches for its cleaner, murene and note fish by objID), plus rows
+//    generated from its pieces for each kind of mover, filled out to the
+//    population asked for, well past MAX_OBJECTS.
+//
+//  Groups need their own rows, since updateGroup finds the subs by
+//    objID, so each group gets a master and two subs built at load.
+//    Every other kind gets one spawn-only row, and populate() spawns the
+//    copies once the world has loaded the tables.  The tables are
+//    checked the way SimSceneFile checks a .pcs.
+//
+
+#ifndef SIMCORE_SIMSYNTHSCENE_H
+#define SIMCORE_SIMSYNTHSCENE_H
+
+#include <vector>
+
+#include "SimTypes.h"
+#include "SimScene.h"
+
+class SimWorld;
+
+// share of the synthetic pieces each kind gets, in percent
+typedef struct {
+    int     drifters;       // Move_Auto fish, bobbing, flipping and respawning
+    int     flockers;       // note fish in the clean queue, flocking
+    int     pathMovers;     // following an SVG path, when there's a path directory
+    int     groups;         // a master moving two subs
+    int     timers;         // random velocity and flip timers
+} SimSynthMix;
+
+SimSynthMix simDefaultSynthMix();
+
+class SimSynthScene {
+public:
+    SimSynthScene();
+
+    // population pieces in all once populated, the backdrop's included;
+    //   NO if the tables it builds don't check out
+    BOOL build(int population, const SimSynthMix &mix);
+
+    const SimSceneTables& tables() const    { return scene; }
+    int population() const                  { return targetPopulation; }
+
+    // spawns the copies after SimWorld::loadScene, returns how many
+    int populate(SimWorld &world) const;
+
+private:
+    SimSceneTables  scene;
+    int             targetPopulation;
+
+    // spawn-only rows and how many copies of each populate() spawns
+    int     drifterID;
+    int     flockerID;
+    int     pathMoverID;
+    int     timerID;
+    int     numDrifters;
+    int     numFlockers;
+    int     numPathMovers;
+    int     numTimers;
+
+    std::vector<PaperProps>     props;
+    std::vector<PaperGroups>    groups;
+    std::vector<int16_t>        objRows;
+
+    BOOL tablesValid() const;
+};
+
+#endif
@@ -0,0 +1,246 @@
+//
+//  SimTimer.cpp
+//  Papercut
+//
+//  Headless counterpart of Timer.  Same discrete / repeatable timer
+//    semantics (including autoreverse for Peek), used for both
+//    behavior and world timers in the simulation core.
+//
+
+#include "SimTimer.h"
+#include "SimTimerWheel.h"
+
+SimTimer::SimTimer()
+    : bType(btNone), wtType(wtNone), wtMessageType(mtNone), wtTargetID(0),
+      timeInterval(0.0), timeCheck(0.0), timeIntervalMax(0.0), timeIntervalMin(0.0),
+      timerOn(NO), timerReverse(NO), reversing(NO),
+      wheel(NULL), wheelNode(-1), syncTick(0), fired(NO), turning(NO) {
+}
+
+SimTimer::SimTimer(BehaviorType tType, CGFloat tInterval, CGFloat tIntervalMax, CGFloat tIntervalMin)
+    : bType(tType), wtType(wtNone), wtMessageType(mtNone), wtTargetID(0),
+      timeInterval(tInterval), timeCheck(0.0), timeIntervalMax(tIntervalMax), timeIntervalMin(tIntervalMin),
+      timerOn(YES), timerReverse(NO), reversing(NO),
+      wheel(NULL), wheelNode(-1), syncTick(0), fired(NO), turning(NO) {
+}
+
+SimTimer::SimTimer(BehaviorType tType, CGFloat tInterval, BOOL isOn, BOOL reverses,
+                   CGFloat tIntervalMax, CGFloat tIntervalMin)
+    : bType(tType), wtType(wtNone), wtMessageType(mtNone), wtTargetID(0),
+      timeInterval(tInterval), timeCheck(0.0), timeIntervalMax(tIntervalMax), timeIntervalMin(tIntervalMin),
+      timerOn(isOn), timerReverse(reverses), reversing(NO),
+      wheel(NULL), wheelNode(-1), syncTick(0), fired(NO), turning(NO) {
+}
+
+// copies never carry the wheel with them, the copy is a hand-updated
+//   timer holding the same state until it's attached somewhere
+SimTimer::SimTimer(const SimTimer &other)
+    : bType(other.bType), wtType(other.wtType), wtMessageType(other.wtMessageType), wtTargetID(other.wtTargetID),
+      timeInterval(other.timeInterval), timeCheck(other.currentCheck()),
+      timeIntervalMax(other.timeIntervalMax), timeIntervalMin(other.timeIntervalMin),
+      timerOn(other.timerOn), timerReverse(other.timerReverse), reversing(other.reversing),
+      wheel(NULL), wheelNode(-1), syncTick(0), fired(NO), turning(NO) {
+}
+
+SimTimer& SimTimer::operator=(const SimTimer &other) {
+
+    if (this == &other) { return *this; }
+
+    detach();
+
+    bType           = other.bType;
+    wtType          = other.wtType;
+    wtMessageType   = other.wtMessageType;
+    wtTargetID      = other.wtTargetID;
+    timeInterval    = other.timeInterval;
+    timeCheck       = other.currentCheck();
+    timeIntervalMax = other.timeIntervalMax;
+    timeIntervalMin = other.timeIntervalMin;
+    timerOn         = other.timerOn;
+    timerReverse    = other.timerReverse;
+    reversing       = other.reversing;
+
+    return *this;
+}
+
+SimTimer::~SimTimer() {
+    detach();
+}
+
+SimTimer SimTimer::worldTimer(WorldTimer wType, MessageType wtmType, int wTarget,
+                              CGFloat tInterval, CGFloat tIntervalMax, CGFloat tIntervalMin) {
+    SimTimer wTimer(btNone, tInterval, tIntervalMax, tIntervalMin);
+    wTimer.wtType        = wType;
+    wTimer.wtMessageType = wtmType;
+    wTimer.wtTargetID    = wTarget;
+    return wTimer;
+}
+
+void SimTimer::randomizeInterval(SimRandomStream *stream) {
+    sync();
+    timeInterval = SimRandomNextRange(stream, timeIntervalMax, timeIntervalMin);
+    reschedule();
+}
+
+BOOL SimTimer::timerComplete() const {
+    if (wheel != NULL) { return fired; }
+    return completeAt(timeCheck);
+}
+
+BOOL SimTimer::completeAt(CGFloat check) const {
+
+    // for reverse timers
+    if (timerReverse) {
+        return (((reversing) && (check < 0.0)) ||
+                ((!reversing) && (check > timeInterval)));
+    }
+
+    // for normal timers
+    return (check > timeInterval);
+}
+
+void SimTimer::timerReset() {
+    timeCheck = 0.0;
+    reversing = NO;
+    reschedule();
+}
+
+void SimTimer::turnTimerOn() {
+    if (timerOn) { return; }
+    timerOn = YES;
+    reschedule();
+}
+
+void SimTimer::turnTimerOff() {
+    if (!timerOn) { return; }
+    sync();
+    timerOn = NO;
+    reschedule();
+}
+
+void SimTimer::timerUpdate(CGFloat interval) {
+
+    if (wheel != NULL) { return; }      // the wheel keeps time for attached timers
+
+    // if a reverse timer, switch directions as needed
+    if (timerReverse) {
+        if (((reversing) && (timeCheck < 0.0)) ||
+            ((!reversing) && (timeCheck > timeInterval))) {
+            reversing = !reversing;
+        }
+    }
+
+    if (reversing)  { timeCheck -= interval; }
+    else            { timeCheck += interval; }
+}
+
+// ___ TIMING WHEEL
+
+CGFloat SimTimer::checkAfter(uint32_t ticks) const {
+
+    // timeCheck as it will be the given number of ticks past syncTick
+    if (ticks == 0) { return timeCheck; }
+
+    double moved = (double)ticks * wheel->step();
+    return (CGFloat)((reversing) ? (timeCheck - moved) : (timeCheck + moved));
+}
+
+CGFloat SimTimer::currentCheck() const {
+    if ((wheel == NULL) || (!timerOn)) { return timeCheck; }
+    return checkAfter(wheel->now() - syncTick);
+}
+
+void SimTimer::sync() {
+    if ((wheel == NULL) || (!timerOn)) { return; }
+    timeCheck = checkAfter(wheel->now() - syncTick);
+    syncTick = wheel->now();
+}
+
+void SimTimer::reschedule() {
+
+    // timeCheck is current whenever this is called
+    if (wheel == NULL) { return; }
+
+    if (wheelNode >= 0) {
+        wheel->cancel(wheelNode);
+        wheelNode = -1;
+    }
+
+    syncTick = wheel->now();
+    fired = completeAt(timeCheck);
+    turning = NO;
+
+    if ((!timerOn) || (wheel->step() <= 0.0)) { return; }
+
+    // an autoreverse timer turns around the tick after it completes
+    if (fired) {
+        if (timerReverse) {
+            turning = YES;
+            wheelNode = wheel->schedule(this, syncTick + 1);
+        }
+        return;
+    }
+
+    // first tick the check goes past the interval (or under 0 reversing),
+    //   estimated and then walked to the exact tick checkAfter gives
+    double distance = (reversing) ? timeCheck : (timeInterval - timeCheck);
+    if (!(distance >= 0.0)) { return; }
+
+    double estimate = floor(distance / wheel->step()) + 1.0;
+    if (estimate > (double)0x7fffffff) { estimate = (double)0x7fffffff; }
+
+    uint32_t ticks = (uint32_t)estimate;
+    while ((ticks > 1) && (completeAt(checkAfter(ticks - 1)))) { ticks--; }
+    while (!completeAt(checkAfter(ticks))) { ticks++; }
+
+    wheelNode = wheel->schedule(this, syncTick + ticks);
+}
+
+void SimTimer::attach(SimTimerWheel *timerWheel) {
+
+    if (timerWheel == wheel) { return; }
+
+    detach();
+    wheel = timerWheel;
+    if (wheel != NULL) { reschedule(); }
+}
+
+void SimTimer::detach() {
+
+    if (wheel == NULL) { return; }
+
+    sync();
+    if (wheelNode >= 0) { wheel->cancel(wheelNode); }
+
+    wheel = NULL;
+    wheelNode = -1;
+    fired = NO;
+    turning = NO;
+}
+
+void SimTimer::wheelExpired() {
+
+    wheelNode = -1;
+
+    if (turning) {
+
+        // Peek style autoreverse, the tick after completing it heads back
+        //   the other way and takes one step
+        uint32_t turnTick = wheel->now() - 1;
+        timeCheck = checkAfter(turnTick - syncTick);
+        syncTick = turnTick;
+        reversing = !reversing;
+
+        sync();
+        reschedule();
+        return;
+    }
+
+    sync();
+    fired = YES;
+
+    if (timerReverse) {
+        turning = YES;
+        wheelNode = wheel->schedule(this, wheel->now() + 1);
+    }
+}
@@ -0,0 +1,83 @@
+//
+//  SimTimer.h
+//  Papercut
+//
+//  Headless counterpart of Timer.  Same discrete / repeatable timer
+//    semantics (including autoreverse for Peek), used for both
+//    behavior and world timers in the simulation core.
+//
+//  A timer attached to a SimTimerWheel isn't updated by hand: it works
+//    out the tick it completes on and waits on the wheel until then, and
+//    timeCheck is only brought up to date when something asks for it.
+//    Timers that only advance under some condition (toroid off screen,
+//    axisflip while moving) stay off the wheel and use timerUpdate.
+//
+
+#ifndef SIMCORE_SIMTIMER_H
+#define SIMCORE_SIMTIMER_H
+
+#include "SimTypes.h"
+
+class SimTimerWheel;
+
+class SimTimer {
+public:
+    BehaviorType    bType;              // type of Behavior Timer
+    WorldTimer      wtType;             // World Timer = type
+    MessageType     wtMessageType;      // World Timer = action to take
+    int             wtTargetID;         // World Timer = target object
+    CGFloat         timeInterval;       // amount of time to wait before triggering timer
+    CGFloat         timeCheck;          // current aggregate time check once timer turned on,
+                                        //   as of syncTick for a wheel timer
+    CGFloat         timeIntervalMax;
+    CGFloat         timeIntervalMin;
+    BOOL            timerOn;
+    BOOL            timerReverse;
+    BOOL            reversing;
+
+    SimTimer();
+    SimTimer(const SimTimer &other);
+    SimTimer& operator=(const SimTimer &other);
+    ~SimTimer();
+
+    // behavior timers
+    SimTimer(BehaviorType tType, CGFloat tInterval, CGFloat tIntervalMax, CGFloat tIntervalMin);
+    SimTimer(BehaviorType tType, CGFloat tInterval, BOOL isOn, BOOL reverses,
+             CGFloat tIntervalMax, CGFloat tIntervalMin);
+
+    // world timers
+    static SimTimer worldTimer(WorldTimer wType, MessageType wtmType, int wTarget,
+                               CGFloat tInterval, CGFloat tIntervalMax, CGFloat tIntervalMin);
+
+    void    randomizeInterval(SimRandomStream *stream);     // the owner's stream
+    BOOL    timerComplete() const;
+    void    timerReset();
+    void    timerUpdate(CGFloat interval);      // hand-updated timers only
+    BOOL    isTimerOn() const       { return timerOn; }
+    void    turnTimerOn();
+    void    turnTimerOff();
+    CGFloat currentCheck() const;
+    CGFloat intervalFraction() const { return currentCheck() / timeInterval; }
+    BOOL    isReversing() const     { return reversing; }
+    CGFloat interval() const        { return timeInterval; }
+
+    // timing wheel
+    void    attach(SimTimerWheel *timerWheel);
+    void    detach();
+    BOOL    isAttached() const      { return (wheel != NULL); }
+    void    wheelExpired();             // called by the wheel on the due tick
+
+private:
+    SimTimerWheel   *wheel;
+    int             wheelNode;          // -1 = not waiting on the wheel
+    uint32_t        syncTick;           // wheel tick timeCheck was last brought up to
+    BOOL            fired;              // complete as of the last wheel event
+    BOOL            turning;            // autoreverse timer waiting on the tick it turns around
+
+    CGFloat checkAfter(uint32_t ticks) const;
+    BOOL    completeAt(CGFloat check) const;
+    void    sync();
+    void    reschedule();
+};
+
+#endif
@@ -0,0 +1,155 @@
+//
+//  SimTimerWheel.cpp
+//  Papercut
+//
+//  Hierarchical timing wheel that drives SimTimers in whole world ticks.
+//
+
+#include "SimTimerWheel.h"
+#include "SimTimer.h"
+
+#define SIM_WHEEL_MASK  (SIM_WHEEL_SLOTS - 1)
+
+SimTimerWheel::SimTimerWheel() : currentTick(0), tickStep(0.0) {
+    clear();
+}
+
+void SimTimerWheel::clear() {
+
+    for (int level = 0; level < SIM_WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < SIM_WHEEL_SLOTS; slot++) {
+            heads[level][slot] = -1;
+        }
+    }
+
+    nodes.clear();
+    freeNodes.clear();
+    expiredTimers.clear();
+    currentTick = 0;
+}
+
+void SimTimerWheel::reserve(size_t numTimers) {
+    nodes.reserve(numTimers);
+    freeNodes.reserve(numTimers);
+    expiredTimers.reserve(numTimers);
+}
+
+int SimTimerWheel::schedule(SimTimer *timer, uint32_t due) {
+
+    int node;
+    if (!freeNodes.empty()) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else {
+        node = (int)nodes.size();
+        nodes.push_back(Node());
+        freeNodes.reserve(nodes.capacity());
+    }
+
+    nodes[node].timer = timer;
+    nodes[node].due = due;
+    link(node);
+
+    return node;
+}
+
+void SimTimerWheel::cancel(int node) {
+
+    if ((node < 0) || (node >= (int)nodes.size()) || (nodes[node].timer == NULL)) { return; }
+
+    unlink(node);
+    nodes[node].timer = NULL;
+    freeNodes.push_back(node);
+}
+
+void SimTimerWheel::link(int node) {
+
+    Node &n = nodes[node];
+    uint32_t delta = n.due - currentTick;
+
+    // the lowest level whose span still reaches the due tick
+    int level = 0;
+    while ((level < SIM_WHEEL_LEVELS - 1) &&
+           (delta >= ((uint32_t)1 << (SIM_WHEEL_BITS * (level + 1))))) {
+        level++;
+    }
+
+    // past the top level's reach, wait in its furthest slot and get
+    //   re-slotted when that comes around
+    uint32_t slotTick = n.due;
+    if ((level == SIM_WHEEL_LEVELS - 1) && (delta >= ((uint32_t)1 << (SIM_WHEEL_BITS * SIM_WHEEL_LEVELS)))) {
+        slotTick = currentTick + (SIM_WHEEL_MASK << (SIM_WHEEL_BITS * level));
+    }
+
+    n.level = level;
+    n.slot = (slotTick >> (SIM_WHEEL_BITS * level)) & SIM_WHEEL_MASK;
+    n.prev = -1;
+    n.next = heads[level][n.slot];
+    if (n.next >= 0) { nodes[n.next].prev = node; }
+    heads[level][n.slot] = node;
+}
+
+void SimTimerWheel::unlink(int node) {
+
+    Node &n = nodes[node];
+
+    if (n.prev >= 0)    { nodes[n.prev].next = n.next; }
+    else                { heads[n.level][n.slot] = n.next; }
+    if (n.next >= 0)    { nodes[n.next].prev = n.prev; }
+
+    n.prev = -1;
+    n.next = -1;
+}
+
+void SimTimerWheel::cascade(int level) {
+
+    // pull the slot that just came around down to the levels below
+    int slot = (currentTick >> (SIM_WHEEL_BITS * level)) & SIM_WHEEL_MASK;
+    int node = heads[level][slot];
+    heads[level][slot] = -1;
+
+    while (node >= 0) {
+        int next = nodes[node].next;
+        link(node);
+        node = next;
+    }
+}
+
+void SimTimerWheel::advance() {
+
+    currentTick++;
+    expiredTimers.clear();
+
+    // when a level wraps, the next slot of the level above is due to be split up,
+    //   the highest one goes first so its timers can land in the lower ones
+    int top = 0;
+    while ((top < SIM_WHEEL_LEVELS - 1) &&
+           ((currentTick & (((uint32_t)1 << (SIM_WHEEL_BITS * (top + 1))) - 1)) == 0)) {
+        top++;
+    }
+    for (int level = top; level >= 1; level--) {
+        cascade(level);
+    }
+
+    // everything left in this tick's slot is due now, the slot is taken
+    //   off first since expiring can put timers straight back on the wheel
+    int slot = currentTick & SIM_WHEEL_MASK;
+    int node = heads[0][slot];
+    heads[0][slot] = -1;
+
+    while (node >= 0) {
+        int next = nodes[node].next;
+        SimTimer *timer = nodes[node].timer;
+
+        nodes[node].timer = NULL;
+        nodes[node].prev = -1;
+        nodes[node].next = -1;
+        freeNodes.push_back(node);
+
+        expiredTimers.push_back(timer);
+        timer->wheelExpired();
+
+        node = next;
+    }
+}
@@ -0,0 +1,68 @@
+//
+//  SimTimerWheel.h
+//  Papercut
+//
+//  Hierarchical timing wheel that drives SimTimers in whole world ticks.
+//    A timer on the wheel sits in a slot until the tick it completes
+//    (or, for autoreverse timers, turns around), so a timer that isn't
+//    due costs nothing per tick.  Four levels of 64 slots cover about
+//    77 hours at 60 ticks a second, anything further out waits in the
+//    top level and is re-slotted as it comes around.
+//
+
+#ifndef SIMCORE_SIMTIMERWHEEL_H
+#define SIMCORE_SIMTIMERWHEEL_H
+
+#include <vector>
+
+#include "SimTypes.h"
+
+class SimTimer;
+
+#define SIM_WHEEL_BITS      6
+#define SIM_WHEEL_SLOTS     (1 << SIM_WHEEL_BITS)
+#define SIM_WHEEL_LEVELS    4
+
+class SimTimerWheel {
+public:
+    SimTimerWheel();
+
+    uint32_t now() const                { return currentTick; }
+    CGFloat  step() const               { return tickStep; }
+    void     setStep(CGFloat interval)  { tickStep = interval; }
+    size_t   pending() const            { return nodes.size() - freeNodes.size(); }
+
+    // node index to hand back to cancel, due must be after now
+    int      schedule(SimTimer *timer, uint32_t due);
+    void     cancel(int node);
+    void     clear();
+    void     reserve(size_t numTimers);
+
+    // move on one tick and let every timer that's due know about it
+    void     advance();
+    const std::vector<SimTimer*>& expired() const   { return expiredTimers; }
+
+private:
+    struct Node {
+        SimTimer    *timer;
+        uint32_t    due;
+        int         prev;
+        int         next;
+        int         level;
+        int         slot;
+    };
+
+    uint32_t                currentTick;
+    CGFloat                 tickStep;           // timer time per tick
+
+    int                     heads[SIM_WHEEL_LEVELS][SIM_WHEEL_SLOTS];  // -1 = empty slot
+    std::vector<Node>       nodes;
+    std::vector<int>        freeNodes;
+    std::vector<SimTimer*>  expiredTimers;      // timers that came due on the last advance
+
+    void link(int node);
+    void unlink(int node);
+    void cascade(int level);
+};
+
+#endif
@@ -0,0 +1,144 @@
+//
+//  SimTypes.h
+//  Papercut
+//
+//  Plain-data types shared by the headless simulation core (SimCore).
+//    Pulls in Variables.h so the core uses the exact same enums, structs
+//    and property tables as the app, and supplies the few Foundation /
+//    CoreGraphics types those tables need when built outside of Xcode.
+//
+
+#ifndef SIMCORE_SIMTYPES_H
+#define SIMCORE_SIMTYPES_H
+
+#include <math.h>
+#include <float.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifndef __OBJC__
+typedef signed char BOOL;
+#define YES ((BOOL)1)
+#define NO  ((BOOL)0)
+typedef float CGFloat;      // matches the 32-bit devices the tables were tuned on
+#endif
+
+#define __unused __attribute__((unused))
+#include "../Variables.h"
+#undef __unused
+
+// HEADLESS DEFAULTS
+#define SIM_DEFAULT_IMAGE_SIZE  120.0   // stand-in for UIImage size when the table doesn't give one
+#define SIM_VIEW_WIDTH          768     // iPad portrait
+#define SIM_VIEW_HEIGHT         1024
+
+// CGPoint stand-in
+struct SimPoint {
+    CGFloat x;
+    CGFloat y;
+
+    SimPoint() : x(0.0), y(0.0) {}
+    SimPoint(CGFloat px, CGFloat py) : x(px), y(py) {}
+
+    bool isZero() const { return ((x == 0.0) && (y == 0.0)); }
+};
+
+// CGRect stand-in, same edge rules as CGRectContainsPoint / CGRectIntersectsRect
+struct SimRect {
+    CGFloat x;
+    CGFloat y;
+    CGFloat width;
+    CGFloat height;
+
+    SimRect() : x(0.0), y(0.0), width(0.0), height(0.0) {}
+    SimRect(CGFloat rx, CGFloat ry, CGFloat rw, CGFloat rh) : x(rx), y(ry), width(rw), height(rh) {}
+
+    CGFloat maxX() const { return x + width; }
+    CGFloat maxY() const { return y + height; }
+    SimPoint center() const { return SimPoint(x + (width * 0.5), y + (height * 0.5)); }
+
+    bool contains(SimPoint p) const {
+        return ((p.x >= x) && (p.x < maxX()) && (p.y >= y) && (p.y < maxY()));
+    }
+
+    bool intersects(const SimRect &r) const {
+        return ((x < r.maxX()) && (r.x < maxX()) && (y < r.maxY()) && (r.y < maxY()));
+    }
+
+    SimRect intersection(const SimRect &r) const {
+        CGFloat ix = fmaxf(x, r.x);
+        CGFloat iy = fmaxf(y, r.y);
+        CGFloat iw = fminf(maxX(), r.maxX()) - ix;
+        CGFloat ih = fminf(maxY(), r.maxY()) - iy;
+        if ((iw <= 0.0) || (ih <= 0.0)) { return SimRect(); }
+        return SimRect(ix, iy, iw, ih);
+    }
+};
+
+// CGAffineTransform stand-in (rotation / scale only, no translation needed)
+struct SimTransform {
+    CGFloat a, b, c, d;
+
+    SimTransform() : a(1.0), b(0.0), c(0.0), d(1.0) {}
+
+    static SimTransform makeRotation(CGFloat angle) {
+        SimTransform t;
+        t.a = cosf(angle);  t.b = sinf(angle);
+        t.c = -sinf(angle); t.d = cosf(angle);
+        return t;
+    }
+
+    SimTransform scale(CGFloat sx, CGFloat sy) const {
+        SimTransform t = *this;
+        t.a *= sx; t.b *= sx;
+        t.c *= sy; t.d *= sy;
+        return t;
+    }
+};
+
+// Value-type counterpart of Vector2D, same method names so the ported
+//   behavior code reads like the Objective-C original.  Lives on the
+//   stack or inside its owner, so vector math never touches the heap
+struct SimVector {
+    CGFloat x;
+    CGFloat y;
+
+    SimVector() : x(0.0), y(0.0) {}
+    SimVector(CGFloat vx, CGFloat vy) : x(vx), y(vy) {}
+    explicit SimVector(SimPoint p) : x(p.x), y(p.y) {}
+
+    SimPoint point() const { return SimPoint(x, y); }
+
+    CGFloat length() const          { return sqrtf((x * x) + (y * y)); }
+    CGFloat lengthSquared() const   { return (x * x) + (y * y); }
+
+    SimVector& zero()                       { x = 0.0; y = 0.0; return *this; }
+    SimVector& add(const SimVector &v)      { x += v.x; y += v.y; return *this; }
+    SimVector& sub(const SimVector &v)      { x -= v.x; y -= v.y; return *this; }
+    SimVector& mult(CGFloat s)              { x *= s; y *= s; return *this; }
+    SimVector& div(CGFloat s)               { x /= s; y /= s; return *this; }
+
+    SimVector& normalize() {
+        CGFloat len = length();
+        if (len > 0.0) { x /= len; y /= len; }
+        return *this;
+    }
+
+    // value operators, for math that doesn't need a named temporary
+    SimVector operator+(const SimVector &v) const   { return SimVector(x + v.x, y + v.y); }
+    SimVector operator-(const SimVector &v) const   { return SimVector(x - v.x, y - v.y); }
+    SimVector operator-() const                     { return SimVector(-x, -y); }
+    SimVector operator*(CGFloat s) const            { return SimVector(x * s, y * s); }
+    SimVector operator/(CGFloat s) const            { return SimVector(x / s, y / s); }
+
+    SimVector& operator+=(const SimVector &v)       { return add(v); }
+    SimVector& operator-=(const SimVector &v)       { return sub(v); }
+    SimVector& operator*=(CGFloat s)                { return mult(s); }
+    SimVector& operator/=(CGFloat s)                { return div(s); }
+
+    CGFloat dot(const SimVector &v) const           { return (x * v.x) + (y * v.y); }
+};
+
+inline SimVector operator*(CGFloat s, const SimVector &v)   { return v * s; }
+
+#endif
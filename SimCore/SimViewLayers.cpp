@@ -0,0 +1,297 @@
+//
+//  SimViewLayers.cpp
+//  Papercut
+//
+//  Per-zPosition draw lists and the radix sort that batches insertion.
+//
+
+#include <string.h>
+
+#include "SimViewLayers.h"
+#include "SimPaper.h"
+
+// ___ SORT
+
+void SimZOrder(const int *zKeys, size_t count, uint32_t *order, uint32_t *scratch) {
+
+    if (count == 0) { return; }
+
+    int minZ = zKeys[0];
+    int maxZ = zKeys[0];
+    for (size_t i = 0; i < count; i++) {
+        order[i] = (uint32_t)i;
+        if (zKeys[i] < minZ) { minZ = zKeys[i]; }
+        if (zKeys[i] > maxZ) { maxZ = zKeys[i]; }
+    }
+
+    // a batch is nearly always one layer
+    if (minZ == maxZ) { return; }
+
+    // least significant byte first over the keys' range, each pass stable
+    uint32_t range = (uint32_t)((int64_t)maxZ - minZ);
+    uint32_t *from = order;
+    uint32_t *to = scratch;
+
+    for (int shift = 0; (shift < 32) && ((range >> shift) != 0); shift += 8) {
+
+        size_t buckets[257];
+        memset(buckets, 0, sizeof(buckets));
+
+        for (size_t i = 0; i < count; i++) {
+            uint32_t digit = ((uint32_t)((int64_t)zKeys[from[i]] - minZ) >> shift) & 0xff;
+            buckets[digit + 1]++;
+        }
+        for (int b = 0; b < 256; b++) { buckets[b + 1] += buckets[b]; }
+
+        for (size_t i = 0; i < count; i++) {
+            uint32_t digit = ((uint32_t)((int64_t)zKeys[from[i]] - minZ) >> shift) & 0xff;
+            to[buckets[digit]++] = from[i];
+        }
+
+        uint32_t *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != order) { memcpy(order, from, count * sizeof(uint32_t)); }
+}
+
+// ___ LAYERS
+
+SimViewLayers::SimViewLayers() : baseZ(0), count(0) {
+}
+
+void SimViewLayers::clear() {
+    layers.clear();
+    links.clear();
+    baseZ = 0;
+    count = 0;
+}
+
+void SimViewLayers::reserve(size_t pieces) {
+    links.reserve(pieces);
+    batchItems.reserve(pieces);
+    batchSlots.reserve(pieces);
+    batchZ.reserve(pieces);
+    inserted.reserve(pieces);
+    order.reserve(pieces);
+    scratch.reserve(pieces);
+}
+
+SimViewLayers::Layer& SimViewLayers::layerFor(int zPos) {
+
+    const Layer empty = { -1, -1 };
+
+    if (layers.empty()) {
+        baseZ = zPos;
+        layers.push_back(empty);
+    }
+    else if (zPos < baseZ) {
+        layers.insert(layers.begin(), (size_t)(baseZ - zPos), empty);
+        baseZ = zPos;
+    }
+    else if ((size_t)(zPos - baseZ) >= layers.size()) {
+        layers.resize((size_t)(zPos - baseZ) + 1, empty);
+    }
+
+    return layers[zPos - baseZ];
+}
+
+BOOL SimViewLayers::containsSlot(uint32_t slot) const {
+    return ((slot < links.size()) && (links[slot].item != NULL)) ? YES : NO;
+}
+
+size_t SimViewLayers::insertItems(void *const *items, const uint32_t *slots, const int *zKeys, size_t num,
+                                  uint32_t *insertedOut) {
+
+    if (num == 0) { return 0; }
+
+    order.resize(num);
+    scratch.resize(num);
+    SimZOrder(zKeys, num, &order[0], &scratch[0]);
+
+    // one run per layer, spliced on top of it
+    size_t added = 0;
+    size_t i = 0;
+    while (i < num) {
+
+        int zPos = zKeys[order[i]];
+        int32_t top = layerFor(zPos).top;
+        int32_t bottom = -1;
+
+        for (; (i < num) && (zKeys[order[i]] == zPos); i++) {
+
+            uint32_t slot = slots[order[i]];
+            if (containsSlot(slot)) { continue; }
+
+            if (slot >= links.size()) {
+                const Link empty = { NULL, -1, -1, 0 };
+                links.resize(slot + 1, empty);
+            }
+
+            Link &link = links[slot];
+            link.item = items[order[i]];
+            link.below = top;
+            link.above = -1;
+            link.zPos = zPos;
+
+            if (top >= 0)   { links[top].above = (int32_t)slot; }
+            if (bottom < 0) { bottom = (int32_t)slot; }
+            top = (int32_t)slot;
+
+            if (insertedOut) { insertedOut[added] = order[i]; }
+            added++;
+            count++;
+        }
+
+        Layer &layer = layers[zPos - baseZ];
+        if ((layer.bottom < 0) && (bottom >= 0)) { layer.bottom = bottom; }
+        layer.top = top;
+    }
+
+    return added;
+}
+
+void SimViewLayers::unlink(uint32_t slot) {
+
+    Link &link = links[slot];
+    Layer &layer = layers[link.zPos - baseZ];
+
+    if (link.below >= 0)    { links[link.below].above = link.above; }
+    else                    { layer.bottom = link.above; }
+    if (link.above >= 0)    { links[link.above].below = link.below; }
+    else                    { layer.top = link.below; }
+
+    link.below = -1;
+    link.above = -1;
+}
+
+void SimViewLayers::removeSlot(uint32_t slot) {
+
+    if (!containsSlot(slot)) { return; }
+
+    unlink(slot);
+    links[slot].item = NULL;
+    count--;
+}
+
+BOOL SimViewLayers::changeSlotZ(uint32_t slot, int zPos) {
+
+    if (!containsSlot(slot)) { return NO; }
+
+    unlink(slot);
+
+    Layer &layer = layerFor(zPos);
+    Link &link = links[slot];
+    link.zPos = zPos;
+    link.below = layer.top;
+
+    if (layer.top >= 0) { links[layer.top].above = (int32_t)slot; }
+    else                { layer.bottom = (int32_t)slot; }
+    layer.top = (int32_t)slot;
+
+    return YES;
+}
+
+void* SimViewLayers::bottomFrom(size_t layer) const {
+
+    for (; layer < layers.size(); layer++) {
+        if (layers[layer].bottom >= 0) { return links[layers[layer].bottom].item; }
+    }
+    return NULL;
+}
+
+void* SimViewLayers::bottomItem() const {
+    return bottomFrom(0);
+}
+
+void* SimViewLayers::itemAbove(uint32_t slot) const {
+
+    if (!containsSlot(slot)) { return NULL; }
+
+    const Link &link = links[slot];
+    if (link.above >= 0) { return links[link.above].item; }
+
+    return bottomFrom((size_t)(link.zPos - baseZ) + 1);
+}
+
+// ___ PIECES
+
+BOOL SimViewLayers::contains(const SimPaper *piece) const {
+    return (containsSlot(piece->handle.index) && (links[piece->handle.index].item == piece)) ? YES : NO;
+}
+
+void SimViewLayers::insert(SimPaper *const *pieces, size_t num, int &viewCount) {
+
+    if (num == 0) { return; }
+
+    batchItems.resize(num);
+    batchSlots.resize(num);
+    batchZ.resize(num);
+    inserted.resize(num);
+    for (size_t i = 0; i < num; i++) {
+        batchItems[i] = pieces[i];
+        batchSlots[i] = pieces[i]->handle.index;
+        batchZ[i] = pieces[i]->zPos;
+    }
+
+    size_t added = insertItems(&batchItems[0], &batchSlots[0], &batchZ[0], num, &inserted[0]);
+    for (size_t i = 0; i < added; i++) { pieces[inserted[i]]->viewOrder = ++viewCount; }
+}
+
+void SimViewLayers::remove(const SimPaper *piece) {
+    if (contains(piece)) { removeSlot(piece->handle.index); }
+}
+
+void SimViewLayers::changeZ(SimPaper *piece, int zPos, int &viewCount) {
+
+    piece->zPos = zPos;
+    if (contains(piece) && changeSlotZ(piece->handle.index, zPos)) { piece->viewOrder = ++viewCount; }
+}
+
+SimPaper* SimViewLayers::bottom() const {
+    return (SimPaper*)bottomItem();
+}
+
+SimPaper* SimViewLayers::above(const SimPaper *piece) const {
+    return contains(piece) ? (SimPaper*)itemAbove(piece->handle.index) : NULL;
+}
+
+// ___ C INTERFACE
+
+struct SimLayerList {
+    SimViewLayers   layers;
+};
+
+SimLayerList* SimLayerListCreate(void) {
+    return new SimLayerList();
+}
+
+void SimLayerListDestroy(SimLayerList *list) {
+    delete list;
+}
+
+void SimLayerListClear(SimLayerList *list) {
+    list->layers.clear();
+}
+
+size_t SimLayerListInsert(SimLayerList *list, void *const *items, const uint32_t *slots, const int *zKeys,
+                          size_t count, uint32_t *inserted) {
+    return list->layers.insertItems(items, slots, zKeys, count, inserted);
+}
+
+void SimLayerListRemove(SimLayerList *list, uint32_t slot) {
+    list->layers.removeSlot(slot);
+}
+
+void SimLayerListChangeZ(SimLayerList *list, uint32_t slot, int zPos) {
+    list->layers.changeSlotZ(slot, zPos);
+}
+
+void* SimLayerListBottom(const SimLayerList *list) {
+    return list->layers.bottomItem();
+}
+
+void* SimLayerListAbove(const SimLayerList *list, uint32_t slot) {
+    return list->layers.itemAbove(slot);
+}
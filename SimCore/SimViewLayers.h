@@ -0,0 +1,126 @@
+//
+//  SimViewLayers.h
+//  Papercut
+//
+//  The view hierarchy as Core Animation draws it: one list per layer
+//    zPosition, back to front, each in the order its pieces were added as
+//    subviews.  New pieces are added a tick's worth at a time: the batch is
+//    radix sorted by zPosition (stably, so arrival order holds within a
+//    layer) and each layer's run is spliced onto the top of that layer in
+//    one go, numbering viewOrder on the way.  A piece that changes layer
+//    is unlinked and goes on top of its new one, both O(1).
+//
+//  Links are kept per slot, next to the pieces rather than in them, the
+//    same as SimHitIndex.  SimCore's slots are store slots; the view
+//    controller has no store, so it hands out its own (any small index it
+//    gives a view and takes back once the view is removed) and goes
+//    through the C interface, where a piece is just a pointer.
+//
+//  SimZOrder is the sort on its own.
+//
+
+#ifndef SIMCORE_SIMVIEWLAYERS_H
+#define SIMCORE_SIMVIEWLAYERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// order[0 .. count - 1] = indexes of zKeys, lowest key first and in the
+//   given order among equal keys; scratch holds count entries
+void SimZOrder(const int *zKeys, size_t count, uint32_t *order, uint32_t *scratch);
+
+typedef struct SimLayerList SimLayerList;
+
+SimLayerList* SimLayerListCreate(void);
+void SimLayerListDestroy(SimLayerList *list);
+void SimLayerListClear(SimLayerList *list);
+
+// adds a batch on top of their layers, skipping any slot already in;
+//   inserted gets the batch indexes that went in, back to front, and
+//   the count is returned
+size_t SimLayerListInsert(SimLayerList *list, void *const *items, const uint32_t *slots, const int *zKeys,
+                          size_t count, uint32_t *inserted);
+void SimLayerListRemove(SimLayerList *list, uint32_t slot);
+
+// moves the item in slot to the top of another layer
+void SimLayerListChangeZ(SimLayerList *list, uint32_t slot, int zPos);
+
+// back to front, NULL past the top-most item
+void* SimLayerListBottom(const SimLayerList *list);
+void* SimLayerListAbove(const SimLayerList *list, uint32_t slot);
+
+#ifdef __cplusplus
+}
+
+#include <vector>
+
+#include "SimTypes.h"
+
+class SimPaper;
+
+class SimViewLayers {
+public:
+    SimViewLayers();
+
+    void clear();
+    void reserve(size_t pieces);
+
+    // adds a tick's new pieces on top of their layers, viewCount numbers them
+    void insert(SimPaper *const *pieces, size_t count, int &viewCount);
+    void remove(const SimPaper *piece);
+
+    // moves a piece to the top of another layer
+    void changeZ(SimPaper *piece, int zPos, int &viewCount);
+
+    BOOL contains(const SimPaper *piece) const;
+    size_t size() const             { return count; }
+
+    // back to front, NULL past the top-most piece
+    SimPaper* bottom() const;
+    SimPaper* above(const SimPaper *piece) const;
+
+    // the same by slot, for the C interface
+    size_t insertItems(void *const *items, const uint32_t *slots, const int *zKeys, size_t count, uint32_t *inserted);
+    void removeSlot(uint32_t slot);
+    BOOL changeSlotZ(uint32_t slot, int zPos);
+    BOOL containsSlot(uint32_t slot) const;
+    void* bottomItem() const;
+    void* itemAbove(uint32_t slot) const;
+
+private:
+    typedef struct {
+        int32_t     bottom;         // slot, -1 = empty
+        int32_t     top;
+    } Layer;
+
+    typedef struct {
+        void        *item;          // NULL = not in a layer
+        int32_t     below;          // slot, -1 at the ends
+        int32_t     above;
+        int         zPos;
+    } Link;
+
+    std::vector<Layer>      layers;         // by zPos - baseZ
+    int                     baseZ;
+    std::vector<Link>       links;          // by slot
+    size_t                  count;
+
+    std::vector<void*>      batchItems;     // scratch for insert
+    std::vector<uint32_t>   batchSlots;
+    std::vector<int>        batchZ;
+    std::vector<uint32_t>   inserted;
+    std::vector<uint32_t>   order;
+    std::vector<uint32_t>   scratch;
+
+    Layer& layerFor(int zPos);
+    void unlink(uint32_t slot);
+    void* bottomFrom(size_t layer) const;
+};
+
+#endif
+
+#endif
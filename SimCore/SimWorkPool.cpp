@@ -0,0 +1,163 @@
+//
+//  SimWorkPool.cpp
+//  Papercut
+//
+//  Fixed pool of worker threads with work stealing over numbered chunks.
+//
+
+#include "SimWorkPool.h"
+
+SimWorkPool::SimWorkPool()
+    : threadCount(1), batch(0), pending(0), quit(false), workFunc(NULL), workContext(NULL) {
+
+    for (int i = 0; i < SIM_MAX_THREADS; i++) {
+        queues[i].next = 0;
+        queues[i].end = 0;
+    }
+}
+
+SimWorkPool::~SimWorkPool() {
+    stop();
+}
+
+int SimWorkPool::hardwareThreads() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return (cores > 0) ? (int)cores : 1;
+}
+
+void SimWorkPool::start(int numThreads) {
+
+    stop();
+
+    if (numThreads <= 0) { numThreads = hardwareThreads(); }
+    if (numThreads > SIM_MAX_THREADS) { numThreads = SIM_MAX_THREADS; }
+    threadCount = numThreads;
+
+    // batch keeps counting across restarts, so new workers start out
+    //   having seen the last one rather than picking up its leftovers
+    uint32_t current;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        quit = false;
+        pending = 0;
+        current = batch;
+    }
+
+    // the caller is thread 0, the workers are the rest
+    workers.reserve(threadCount - 1);
+    for (int i = 1; i < threadCount; i++) {
+        workers.push_back(std::thread(&SimWorkPool::workerLoop, this, i, current));
+    }
+}
+
+void SimWorkPool::stop() {
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        quit = true;
+    }
+    wake.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++) { workers[i].join(); }
+    workers.clear();
+    threadCount = 1;
+}
+
+void SimWorkPool::run(size_t numChunks, SimWorkFunc func, void *context) {
+
+    if (numChunks == 0) { return; }
+
+    // nobody to share with, or nothing worth sharing
+    if ((threadCount == 1) || (numChunks == 1)) {
+        for (size_t i = 0; i < numChunks; i++) { func(context, i, 0); }
+        return;
+    }
+
+    // deal the chunks out in contiguous runs, the first threads
+    //   get one extra when they don't divide evenly
+    size_t perThread = numChunks / threadCount;
+    size_t extra = numChunks % threadCount;
+    size_t first = 0;
+
+    for (int i = 0; i < threadCount; i++) {
+        size_t count = perThread + (((size_t)i < extra) ? 1 : 0);
+        std::lock_guard<std::mutex> guard(queues[i].lock);
+        queues[i].next = first;
+        queues[i].end = first + count;
+        first += count;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        workFunc = func;
+        workContext = context;
+        pending = threadCount - 1;
+        batch++;
+    }
+    wake.notify_all();
+
+    drain(0, func, context);
+
+    // a worker can still be finishing a stolen chunk after the queues run dry
+    std::unique_lock<std::mutex> guard(lock);
+    while (pending > 0) { done.wait(guard); }
+}
+
+void SimWorkPool::workerLoop(int worker, uint32_t seen) {
+
+    SimWorkFunc func;
+    void *context;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            while ((!quit) && (batch == seen)) { wake.wait(guard); }
+            if (quit) { return; }
+            seen = batch;
+
+            // the next run() can't change these until this batch is done,
+            //   but they're only read under the lock all the same
+            func = workFunc;
+            context = workContext;
+        }
+
+        drain(worker, func, context);
+
+        std::lock_guard<std::mutex> guard(lock);
+        pending--;
+        if (pending == 0) { done.notify_one(); }
+    }
+}
+
+void SimWorkPool::drain(int worker, SimWorkFunc func, void *context) {
+
+    size_t chunk;
+    while (takeChunk(worker, &chunk)) {
+        func(context, chunk, worker);
+    }
+}
+
+bool SimWorkPool::takeChunk(int worker, size_t *chunk) {
+
+    // own run first, front to back
+    {
+        SimWorkQueue &own = queues[worker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (own.next < own.end) {
+            *chunk = own.next++;
+            return true;
+        }
+    }
+
+    // then the far end of everyone else's, starting with the next thread over
+    for (int i = 1; i < threadCount; i++) {
+        SimWorkQueue &victim = queues[(worker + i) % threadCount];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.next < victim.end) {
+            *chunk = --victim.end;
+            return true;
+        }
+    }
+
+    return false;
+}
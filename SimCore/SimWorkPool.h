@@ -0,0 +1,80 @@
+//
+//  SimWorkPool.h
+//  Papercut
+//
+//  A small fixed pool of worker threads that runs a batch of numbered
+//    chunks and returns once every one has run.  The chunks are dealt
+//    out in contiguous runs, one per thread, and a thread that finishes
+//    its own run steals chunks off the far end of another's, so one
+//    slow chunk doesn't hold the rest of the pool idle.
+//
+//  The thread calling run() works through chunks too, so a pool of one
+//    thread has no workers and just runs every chunk in order on the
+//    caller.  Which thread ran a chunk is never meant to matter: callers
+//    write each chunk's results somewhere of its own and merge them in
+//    chunk order afterwards.
+//
+
+#ifndef SIMCORE_SIMWORKPOOL_H
+#define SIMCORE_SIMWORKPOOL_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SimTypes.h"
+
+// threads a pool can have, the caller included
+#define SIM_MAX_THREADS     16
+
+// runs one chunk, worker is 0 for the calling thread
+typedef void (*SimWorkFunc)(void *context, size_t chunk, int worker);
+
+class SimWorkPool {
+public:
+    SimWorkPool();
+    ~SimWorkPool();
+
+    // numThreads counts the caller, 0 = one per core
+    void start(int numThreads);
+    void stop();
+    int numThreads() const          { return threadCount; }
+
+    // runs func for every chunk in 0..numChunks-1, returns when they're done
+    void run(size_t numChunks, SimWorkFunc func, void *context);
+
+    static int hardwareThreads();
+
+private:
+    // the chunks still waiting in one thread's run, the owner takes from
+    //   the front and thieves from the back
+    struct SimWorkQueue {
+        std::mutex  lock;
+        size_t      next;
+        size_t      end;
+    };
+
+    SimWorkQueue                queues[SIM_MAX_THREADS];
+    std::vector<std::thread>    workers;
+    int                         threadCount;
+
+    std::mutex                  lock;
+    std::condition_variable     wake;       // a batch is ready, or the pool is stopping
+    std::condition_variable     done;       // the last worker has finished the batch
+    uint32_t                    batch;      // bumped for every run
+    int                         pending;    // workers still in the current batch
+    bool                        quit;
+
+    SimWorkFunc                 workFunc;
+    void                        *workContext;
+
+    void workerLoop(int worker, uint32_t seen);
+    void drain(int worker, SimWorkFunc func, void *context);
+    bool takeChunk(int worker, size_t *chunk);
+
+    SimWorkPool(const SimWorkPool&);
+    SimWorkPool& operator=(const SimWorkPool&);
+};
+
+#endif
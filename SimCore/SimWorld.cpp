@@ -0,0 +1,1886 @@
+//
+//  SimWorld.cpp
+//  Papercut
+//
+//  Headless counterpart of ObjManager plus the update loop from
+//    PapercutPadViewController.  Owns every SimPaper in the scene, the
+//    world timers / states and the messenger, and steps the simulation
+//    one display frame at a time without any UIKit dependency.
+//
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <new>
+
+#include "SimWorld.h"
+#include "SimPaper.h"
+
+SimWorld::SimWorld() {
+
+    spawnID = 100;  // start of counter for dynamically spawned object IDs
+    pieceStreams = 0;
+    viewCount = 0;
+    borderWidth = 0;
+    borderBound = 0;
+    viewWidth = 0;
+    viewHeight = 0;
+    cleanMin = 4;
+    cleanMax = 10;
+    maxNotes = 0;
+    numObjects = 0;
+
+    turnOffAllStates();
+
+    optInteract = YES;
+    optSound = YES;
+    optCollision = COLLISION;
+
+    fps = 0.0;
+    bounceOffset = 0.0;
+    gravityFilter = 0.0;
+    elapsedTime = 0.0;
+    prevTimestamp = 0.0;
+    tickAccumulator = 0.0;
+    renderAlpha = 0.0;
+    accelX = 0.0;
+
+    tables = SimSceneTables();
+
+    stats = SimFrameStats();
+    profiler = NULL;
+    journal = NULL;
+}
+
+SimWorld::~SimWorld() {
+    resetWorld();
+}
+
+void SimWorld::resetWorld() {
+
+    // release every piece, the tag views go with the store
+    for (size_t i = 0; i < objects.size(); i++) {
+        objects[i]->~SimPaper();
+        ::operator delete(objects[i]);
+    }
+    clearPools();
+
+    objects.clear();
+    queue_shake.clear();
+    queue_clean.clear();
+    queue_destroy.clear();
+    queue_view.clear();
+    viewLayers.clear();
+    flockGrid.clear();
+    pieceState.clear();
+    hitIndex.clear();
+    world_timers.clear();
+    behaviorWheel.clear();
+    worldWheel.clear();
+    messenger.reset();
+
+    spawnID = 100;
+    pieceStreams = 0;
+    viewCount = 0;
+    viewWidth = 0;
+    viewHeight = 0;
+    cleanMin = 4;
+    cleanMax = 10;
+    numObjects = 0;
+
+    turnOffAllStates();
+
+    fps = 0.0;
+    bounceOffset = 0.0;
+    gravityFilter = 0.0;
+    elapsedTime = 0.0;
+    prevTimestamp = 0.0;
+    tickAccumulator = 0.0;
+    renderAlpha = 0.0;
+    accelX = 0.0;
+
+    stats = SimFrameStats();
+}
+
+void SimWorld::loadScene(const SimSceneTables &sceneTables, int width, int height) {
+
+    tables = sceneTables;
+
+    fps = 0.0167;
+    behaviorWheel.setStep(fps);
+    worldWheel.setStep(fps);
+    elapsedTime = 0.0;
+    prevTimestamp = 0.0;
+    tickAccumulator = 0.0;
+    renderAlpha = 0.0;
+
+    // Mermaids-specific variables
+    bounceOffset = BOUNCE_OFFSET;
+    gravityFilter = GRAVITY_FILTER;
+    maxNotes = MAX_NOTES;
+
+    viewWidth = width;
+    viewHeight = height;
+
+    // Initialize the scene and border
+    prewarmPools();
+    initScene();
+    initBorder();
+
+    // size the per-frame scratch for a full scene up front so a normal
+    //   frame never has to grow it
+    flockPieces.reserve(MAX_OBJECTS);
+    flockCenters.reserve(MAX_OBJECTS);
+    pieceState.reserve(objects.slotCount() + MAX_OBJECTS);
+    pathPieces.reserve(MAX_OBJECTS);
+    pathFractions.reserve(MAX_OBJECTS);
+    pathPositions.reserve(MAX_OBJECTS);
+    pathTangents.reserve(MAX_OBJECTS);
+    flockNeighbors.reserve(MAX_OBJECTS);
+    flockGrid.reserve(MAX_OBJECTS);
+    collisionBroadphase.reserve(MAX_OBJECTS);
+    collisionPush.reserve(MAX_OBJECTS);
+    collisionHit.reserve(MAX_OBJECTS);
+    forceBatch.reserve(MAX_OBJECTS);
+    behaviorWheel.reserve(MAX_OBJECTS * 4);
+    worldWheel.reserve(tables.numTimers);
+    batchPieces.reserve(MAX_OBJECTS);
+    batchDest.reserve(MAX_OBJECTS);
+    queue_destroy.reserve(MAX_OBJECTS);
+    queue_clean.reserve(MAX_OBJECTS);
+    queue_view.reserve(MAX_OBJECTS);
+    insertPieces.reserve(MAX_OBJECTS);
+    viewLayers.reserve(objects.slotCount() + MAX_OBJECTS);
+
+    walkChunks.resize((objects.size() + MAX_OBJECTS + SIM_WALK_CHUNK - 1) / SIM_WALK_CHUNK);
+    for (size_t c = 0; c < walkChunks.size(); c++) { walkChunks[c].cmds.reserve(SIM_WALK_CHUNK); }
+
+    // Populate additional Paper object managers and add all subviews
+    for (size_t i = 0; i < objects.size(); i++) {
+
+        SimPaper *eachPiece = objects[i];
+
+        // Populate other object managers
+        if (eachPiece->collision) {
+            addObj(eachPiece, otCollision);
+        }
+
+        if (eachPiece->pinch) {
+            addObj(eachPiece, otPinch);
+        }
+
+        if (eachPiece->wiggleTime > 0.0) {
+            addObj(eachPiece, otWiggle);
+        }
+
+        addToView(eachPiece);
+
+        // Adjust the starting scale if necessary
+        if (eachPiece->scaleStart > 0.0) {
+            eachPiece->transform = imageTransform(eachPiece, eachPiece->scaleStart);
+        }
+
+    }
+
+    // the whole scene goes on screen in one pass
+    insertViews();
+}
+
+void SimWorld::initBorder() {
+
+    // set manager border properties
+    borderWidth = tables.props[0].spawnX;
+    borderBound = tables.props[0].spawnY;
+}
+
+// Initalize all Paper objects based on the PaperProps tables
+void SimWorld::initScene() {
+
+    turnOffState(osPaused);
+
+    // loop through each property record, create each Paper piece and add it to the manager
+    //   the first row (index = 0) is always the border row, so start at index = 1
+
+    for (int i = 1; i < tables.numProps; i++) {
+        // if the piece should appear upon view initialization,
+        //    then initialize and add to manager
+        if (tables.props[i].init) {
+            addObj(newPiece(tables.props[i].objID, NULL), NO);
+        }
+
+        // add objID to queue_shake if necessary
+        if (tables.props[i].spawnByShake) {
+            addToShakeQueue(tables.props[i].objID);
+        }
+    }
+
+    // create world timers
+    for (int i = 1; i < tables.numTimers; i++) {
+        WorldTimer timerType = tables.timers[i].wTimer;
+        addWorldTimer(SimTimer::worldTimer(timerType,
+                                           tables.timers[i].mType,
+                                           tables.timers[i].objTargetID,
+                                           tables.timers[i].wtInterval,
+                                           tables.timers[i].wtIntervalMax,
+                                           tables.timers[i].wtIntervalMin), timerType);
+        turnWorldTimer(timerType, YES);
+    }
+}
+
+const SimFrameStats& SimWorld::stepFrame(double timestamp) {
+
+    SimJournalFrame(journal, timestamp);
+
+    int frame = stats.frame + 1;
+    stats = SimFrameStats();
+    stats.frame = frame;
+
+    // skip update if paused
+    if (isStateOn(osPaused)) {
+        stats.numObjects = (int)objects.size();
+        return stats;
+    }
+
+    SimProfilerNextFrame(profiler);
+    SimProfileScope frameScope(profiler, spFrame);
+
+    // the world always advances in fixed steps of fps, a display frame runs
+    //   however many steps of real time have built up since the last one
+    if (prevTimestamp != 0.0) {
+
+        double frameTime = timestamp - prevTimestamp;
+
+        // an inactive stretch counts as a single step, otherwise
+        //   animations jump forward in time
+        if (frameTime > SIM_MAX_FRAME_TIME) {
+            frameTime = fps;
+        }
+
+        tickAccumulator += frameTime;
+    }
+    prevTimestamp = timestamp;
+
+    while ((tickAccumulator >= fps) && (stats.ticks < SIM_MAX_TICKS)) {
+        stepTick(fps);
+        tickAccumulator -= fps;
+        stats.ticks++;
+    }
+
+    // too far behind to catch up, drop the rest rather than spiral
+    if (tickAccumulator >= fps) {
+        tickAccumulator = fmod(tickAccumulator, (double)fps);
+    }
+
+    // draw everything partway between its last two ticks
+    renderAlpha = tickAccumulator / fps;
+    for (size_t i = 0; i < objects.size(); i++) {
+        objects[i]->updateRender(renderAlpha);
+    }
+
+    stats.numObjects = (int)objects.size();
+
+    return stats;
+}
+
+void SimWorld::stepTick(CGFloat frameTime) {
+
+    SimPaper    *eachPiece;
+
+    // track total elapsed time
+    elapsedTime += frameTime;
+
+    // everything is about to move, so the touch index is rebuilt on the next touch
+    hitIndex.clear();
+
+    // run the Core Animation callbacks that would have fired since the last tick,
+    //   and note where each piece starts out for render interpolation
+    for (size_t i = 0; i < objects.size(); i++) {
+        objects[i]->advanceAnimations(frameTime);
+        objects[i]->markPrevPosition();
+    }
+
+    // path movers are where their path says they are before anything looks at them
+    samplePaths(frameTime);
+
+    // behavior timers that come due this tick are flagged before anyone looks at them
+    behaviorWheel.advance();
+
+    // collisions are found up front so each pair is only resolved once
+    if ((optCollision) && (optInteract)) {
+        SimProfileScope collisionScope(profiler, spCollision);
+        findCollisions();
+    }
+
+    // from here on pieces only see each other as they are now,
+    //   however the walk moves them
+    pieceState.publish(objects);
+
+    // flocking pieces look each other up through the grid during the walk
+    buildFlockGrid();
+
+    // pieces that only drift, bob and decel have their forces batched,
+    //   as long as nothing else touches them during the walk
+    markLinked();
+    forceBatch.clear();
+    batchPieces.clear();
+    batchDest.clear();
+
+    SimWalkTiming commitTiming = SimWalkTiming();
+    uint64_t moveStart = SimProfileStart(profiler);
+
+    // ___ GATHER _______________________________
+    //  each piece's own update runs chunk by chunk across the walk pool,
+    //  nothing is added or removed until the walk is done so the packed
+    //  order holds, and whatever reaches past the piece is left as a
+    //  command for the commit
+    size_t numChunks = (objects.size() + SIM_WALK_CHUNK - 1) / SIM_WALK_CHUNK;
+    if (walkChunks.size() < numChunks) { walkChunks.resize(numChunks); }
+
+    if (objects.size() >= SIM_WALK_PARALLEL_MIN) {
+        walkPool.run(numChunks, gatherWork, this);
+    }
+    else {
+        for (size_t c = 0; c < numChunks; c++) { gatherChunk(c, 0); }
+    }
+
+    // ___ COMMIT _______________________________
+    //  the commands chunk by chunk, so everything lands in walk order
+    //  whichever thread gathered it
+    for (size_t c = 0; c < numChunks; c++) {
+
+        const SimWalkChunk &chunk = walkChunks[c];
+        stats.moved += chunk.moved;
+
+        for (size_t i = 0; i < chunk.cmds.size(); i++) {
+
+            const SimWalkCmd &cmd = chunk.cmds[i];
+            eachPiece = objects[cmd.index];
+            SimBehavior &cBehavior = eachPiece->behavior;
+
+            if (cmd.kind == wkMove) {
+                movePiece(cmd.index, frameTime, commitTiming);
+            }
+            else if (cmd.kind == wkForce) {
+                // finally move the stupid thing!
+                uint64_t forceStart = SimProfileStart(profiler);
+                SimVector paperDest = cmd.dest;
+                cBehavior.calculateForce(frameTime, elapsedTime, paperDest);
+                eachPiece->applyForce(paperDest.add(cBehavior.vRunning));
+                SimProfileSpanStop(profiler, &commitTiming.force, forceStart);
+            }
+            else if ((cmd.kind == wkPrepare) || (cmd.kind == wkBatch)) {
+                // batched pieces are moved once the walk is done
+                if (cmd.kind == wkPrepare) { cBehavior.prepareForce(); }
+                forceBatch.add(cBehavior.vRunning, cBehavior.vel, cBehavior.forceParams(elapsedTime));
+                batchPieces.push_back(cmd.index);
+                batchDest.push_back(cmd.dest);
+            }
+
+            // if the piece should be removed from the world, queue it,
+            //   every flagged piece goes at the end of the tick
+            if (eachPiece->remove) { queue_destroy.push_back(eachPiece); }
+        }
+    }
+// end MOVE UPDATE
+
+    // ___ BATCHED MOVE _______________________
+    uint64_t batchStart = SimProfileStart(profiler);
+    forceBatch.integrate(frameTime * 60);
+    commitForceBatch();
+    SimProfileSpanStop(profiler, &commitTiming.force, batchStart);
+
+    if (profiler) {
+        SimProfilerRecord(profiler, spMove, 0, moveStart, SimProfileNow());
+        SimProfilerRecordSpan(profiler, spBounds, 0, &commitTiming.bounds);
+        SimProfilerRecordSpan(profiler, spTransform, 0, &commitTiming.transform);
+        SimProfilerRecordSpan(profiler, spForce, 0, &commitTiming.force);
+    }
+
+    // ___ WORLD TIMERS _______________________
+    // update any world timers and handle completed ones
+    uint64_t phaseStart = SimProfileStart(profiler);
+    updateWorldTimers();
+    processWorldTimers();
+    if (profiler) { SimProfilerRecord(profiler, spWorldTimers, 0, phaseStart, SimProfileNow()); }
+
+    // ___ WORLD CLEANING ________________________
+    // initiate fish cleaning if necessary
+    phaseStart = SimProfileStart(profiler);
+    if (((int)queue_clean.size() >= cleanMax) && (!isStateOn(osCleaning))) {
+
+        turnOnState(osCleaning);
+        SimPaper *sPaper = spawnPiece(25);
+
+        // Add to collision manager if needed
+        if (sPaper->collision) {
+            addObj(sPaper, otCollision);
+        }
+
+        addToView(sPaper);
+
+        // Add seek/flee messages
+        SimPaper *cleanPiece = getObject(queue_clean[0]);
+        if (cleanPiece != NULL) {
+            int cleanID = cleanPiece->spawnID;
+            messenger.queueObject(sPaper->spawnID, btSeek, YES, cleanID);
+            messenger.queueObject(cleanID, btFlee, YES, sPaper->spawnID);
+        }
+
+    }
+    if (profiler) { SimProfilerRecord(profiler, spCleaning, 0, phaseStart, SimProfileNow()); }
+
+    // ___ MESSAGE PROCESSING _________________________
+    phaseStart = SimProfileStart(profiler);
+    stats.messages += messenger.processQueue(*this);
+    if (profiler) { SimProfilerRecord(profiler, spMessages, 0, phaseStart, SimProfileNow()); }
+
+    // ___ REMOVE UPDATE ______________________________
+    // so now that we aren't enumerating, remove every flagged piece
+    //   from the world
+    if (!queue_destroy.empty()) {
+        SimProfileScope removeScope(profiler, spRemove);
+        destroyQueued();
+    }
+
+    // ___ VIEW INSERT ______________________________
+    // everything added this tick, child respawns included, goes on
+    //   screen in one pass
+    if (!queue_view.empty()) {
+        SimProfileScope insertScope(profiler, spViewInsert);
+        insertViews();
+    }
+}
+
+void SimWorld::gatherWork(void *context, size_t chunk, int worker) {
+    ((SimWorld*)context)->gatherChunk(chunk, worker);
+}
+
+// the read-only half of the walk: only ever writes to the chunk's own pieces
+//   (none of which another piece reads or moves during the walk) and to
+//   the chunk's commands
+void SimWorld::gatherChunk(size_t chunk, int worker) {
+
+    SimProfileScope gatherScope(profiler, spGather, worker);
+
+    SimWalkChunk &wChunk = walkChunks[chunk];
+    wChunk.cmds.clear();
+    wChunk.moved = 0;
+
+    size_t first = chunk * SIM_WALK_CHUNK;
+    size_t last = std::min(first + SIM_WALK_CHUNK, objects.size());
+
+    for (size_t p = first; p < last; p++) {
+
+        SimPaper *eachPiece = objects[p];
+        SimWalkCmd cmd;
+        cmd.index = (uint32_t)p;
+
+        // ___ ANIM UPDATE ______________________________
+        //  svg anchored pieces (weeds) only rotate with the accelerometer,
+        //  which is purely visual, so there is nothing to do for Move_Anim
+        if ((eachPiece->moveType != Move_Touch) && (eachPiece->moveType != Move_Auto)) {
+            eachPiece->transformEnabled = YES;
+            if (eachPiece->remove) {
+                cmd.kind = wkRemove;
+                wChunk.cmds.push_back(cmd);
+            }
+            continue;
+        }
+
+        wChunk.moved++;
+
+        // pieces other pieces change partway through the walk, and group
+        //   masters that move their subs, keep their whole update in walk order
+        if ((eachPiece->groupID > 0) ||
+            (objects.hasTagAt(p, otClean)) ||
+            (objects.hasTagAt(p, otLinked))) {
+            cmd.kind = wkMove;
+            wChunk.cmds.push_back(cmd);
+            continue;
+        }
+
+        eachPiece->transformEnabled = YES;
+        SimTransform transformPiece;
+        cmd.dest = SimVector(beginMove(eachPiece, p, &transformPiece, wChunk.timing));
+
+        SimBehavior &gBehavior = eachPiece->behavior;
+
+        if (!gBehavior.canBatchForce()) {
+            cmd.kind = wkForce;
+        }
+        else if (!gBehavior.prepareIsLocal()) {
+            cmd.kind = wkPrepare;
+        }
+        else {
+            uint64_t forceStart = SimProfileStart(profiler);
+            gBehavior.prepareForce();
+            SimProfileSpanStop(profiler, &wChunk.timing.force, forceStart);
+            cmd.kind = wkBatch;
+        }
+
+        wChunk.cmds.push_back(cmd);
+    }
+
+    SimProfilerRecordSpan(profiler, spBounds, worker, &wChunk.timing.bounds);
+    SimProfilerRecordSpan(profiler, spTransform, worker, &wChunk.timing.transform);
+    SimProfilerRecordSpan(profiler, spForce, worker, &wChunk.timing.force);
+}
+
+// everything up to the force itself, which only touches the piece
+SimPoint SimWorld::beginMove(SimPaper *eachPiece, size_t p, SimTransform *transformPiece, SimWalkTiming &timing) {
+
+    // create center point
+    SimPoint paperCenter = eachPiece->getCenterPoint();
+
+    // Update timers
+    eachPiece->behavior.updateTimers(fps);
+
+    uint64_t boundsStart = SimProfileStart(profiler);
+
+    // Handle bounded properties
+    if ((eachPiece->bindType == Bind_Always) || (eachPiece->bindType == Bind_OnEnter)) {
+
+        // change bound property if Bind_OnEnter has entered the view
+        if ((eachPiece->bindType == Bind_OnEnter) && (!eachPiece->bounded)) {
+
+            // turn on Sink behavior if a shake image enters the screen
+            if (eachPiece->behavior.viewCheck(vcOnScreenWithinBorder)) {
+                eachPiece->bounded = YES;
+                if (eachPiece->spawnByShake) { eachPiece->behavior.turnOn(btSink); }
+            }
+
+        }
+
+        if ((eachPiece->bounded) && (!eachPiece->spawnByShake)) {
+            paperCenter = keepInBounds(eachPiece, eachPiece->behavior.viewCheckType);
+        }
+
+    }
+
+    SimProfileSpanStop(profiler, &timing.bounds, boundsStart);
+
+    // collision detection already altered the velocity vectors, now move
+    //   the piece slightly away so the two don't stick to each other
+    if ((optCollision) && (optInteract) && (collisionHit[p])) {
+
+        paperCenter.x += collisionPush[p].x;
+        paperCenter.y += collisionPush[p].y;
+
+        // turn off transform so the objects don't stutter
+        eachPiece->transformEnabled = NO;
+    }
+
+    // determine image direction and transformation matrix
+    //   based on flip info, velocity and rotation angle,
+    //   only transform if piece is within borders to prevent stuttering
+
+    uint64_t transformStart = SimProfileStart(profiler);
+
+    updateDirection(eachPiece);
+    *transformPiece = imageTransform(eachPiece);
+
+    if (eachPiece->paperType == Paper_Image) {
+        if (eachPiece->transformEnabled) {
+            eachPiece->transform = *transformPiece;
+        }
+    }
+
+    SimProfileSpanStop(profiler, &timing.transform, transformStart);
+
+    return paperCenter;
+}
+
+// a wkMove piece's whole update, in walk order
+void SimWorld::movePiece(size_t p, CGFloat frameTime, SimWalkTiming &timing) {
+
+    SimPaper *eachPiece = objects[p];
+    eachPiece->transformEnabled = YES;
+
+    // ___ MOVE UPDATE ______________________________
+    SimTransform transformPiece;
+    SimPoint paperCenter = beginMove(eachPiece, p, &transformPiece, timing);
+    SimVector paperDest(paperCenter);
+
+    // finally move the stupid thing!
+    uint64_t forceStart = SimProfileStart(profiler);
+    eachPiece->behavior.calculateForce(frameTime, elapsedTime, paperDest);
+    eachPiece->applyForce(paperDest.add(eachPiece->behavior.vRunning));
+    SimProfileSpanStop(profiler, &timing.force, forceStart);
+
+    // if the object is a Master of a group,
+    //   move all the group Subs based on their offsets
+    if (eachPiece->groupID > 0) {
+        updateGroup(eachPiece, transformPiece);
+    }
+
+    // __ POSITION SPAWN ____________
+
+    // MURENE Note fish check
+    if (!isWorldTimerOn(wtMurene)) {
+
+        // If the current piece is in the clean queue, and it's not currently
+        //   fleeing, then check further to see if it's in range of Murene
+        if ((objects.hasTagAt(p, otClean)) && (!eachPiece->behavior.isOn(btFlee))) {
+
+            int sID = eachPiece->spawnID;
+
+            SimRect spawnRect(110, 40, 40, 120);
+            int randSpawn = SimRandomNextUniform(&eachPiece->random, 1000)+1;
+            if ((spawnRect.contains(paperCenter)) && (randSpawn <= 30) && (!isStateOn(osMurene))) {
+
+                // turn on World State and Timer
+                turnOnState(osMurene);
+                turnWorldTimer(wtMurene, YES);
+
+                // Add Seek/Flee to Murene and Target Fish
+                messenger.queueObject(44, btSeek, YES, sID);
+                messenger.queueObject(sID, btFlee, YES, 44);
+
+            }
+
+        }
+
+    }
+}
+
+// ___ INPUT
+
+void SimWorld::touchBegan(SimPoint currentPos) {
+
+    SimJournalTouchBegan(journal, currentPos.x, currentPos.y);
+
+    SimPaper *touchPiece = objTouched(currentPos);
+    SimPaper *sPaper;
+
+    if (!optInteract) { return; }
+
+    // don't process touchspots if max objects reached
+    if (!maxObjectsReached()) {
+
+        // spawn an object if a world touchspot is entered
+        for (int i = 1; i < tables.numTouch; i++) {   // this skips the first record in the array intentionally
+
+            if (tables.touch[i].objID > 0) {
+
+                SimRect testTS(tables.touch[i].tsX,
+                               tables.touch[i].tsY,
+                               tables.touch[i].tsWd,
+                               tables.touch[i].tsHt);
+
+                if (testTS.contains(currentPos)) {
+
+                    int childObj = 0;
+                    unsigned int randIndex = SimRandomUniform(5)+1;
+                    // row 2 in objRandom is the random object row for TS
+                    if (randIndex == 1) { childObj = tables.random[2].rObjID01; }
+                    if (randIndex == 2) { childObj = tables.random[2].rObjID02; }
+                    if (randIndex == 3) { childObj = tables.random[2].rObjID03; }
+                    if (randIndex == 4) { childObj = tables.random[2].rObjID04; }
+                    if (randIndex == 5) { childObj = tables.random[2].rObjID05; }
+
+                    // spawn if an actual number is selected
+                    if (childObj != 0) {
+                        if (getObject(childObj) == NULL) {
+                            sPaper = spawnPiece(childObj, NO);
+
+                            // Add to collision manager if needed
+                            if (sPaper->collision) {
+                                addObj(sPaper, otCollision);
+                            }
+
+                            addToView(sPaper);
+                        }
+                    }
+
+                }
+            }
+        }
+
+    }
+
+    // if a touch object is returned, do something
+    if (touchPiece == NULL) { return; }
+
+    // if it should be destroyed on touch
+    if (touchPiece->killOnTouch) {
+        killPiece(touchPiece);
+    }
+
+    // if it's a peeking object
+    if (touchPiece->behavior.isOn(btPeek)) {
+
+        // turn off peek and timer
+        touchPiece->behavior.turnOff(btPeek);
+        SimTimer *fTimer = touchPiece->behavior.timer(btPeek);
+        if (fTimer != NULL) {
+            fTimer->turnTimerOff();
+            fTimer->timerReset();
+        }
+
+        // find a new random velocity
+        int bAngle = 1;
+        if (SimRandomNextFloat(&touchPiece->random) > 0.5) { bAngle = -1; }
+        touchPiece->behavior.vel.y = SimRandomNextRange(&touchPiece->random,
+                                                        touchPiece->behavior.bSeekOffset.x,
+                                                        touchPiece->behavior.bSeekOffset.y);
+        touchPiece->behavior.vel.y *= bAngle;
+
+        int xDir = 1;
+        if (leftTopHalf(touchPiece)) { xDir = -1; }
+        touchPiece->behavior.vel.x = -1.3 * xDir;
+
+    }
+
+    // if moveable: zero velocity, reset decel and update transform
+    if (touchPiece->moveType == Move_Touch) {
+        touchPiece->behavior.vel.zero();
+        touchPiece->stopAnimating();
+        touchPiece->transform = imageTransform(touchPiece);
+        hitIndex.update(touchPiece);
+    }
+
+    // don't spawn children if max objects reached
+    if (maxObjectsReached()) { return; }
+
+    // if touch location should spawn a child object, then do so
+    if (touchPiece->childImage != 0) {
+
+        // check to see if Paper has a Touchspot - if so, only spawn
+        //   the image if the user touched within the Touchspot
+        SimRect sTouch;
+        if (touchSpotRect(touchPiece->spawnID, &sTouch)) {
+
+            // if our touch is inside the new Rect, spawn it
+            if (sTouch.contains(currentPos)) {
+
+                int childObj = 0;
+                if (touchPiece->tsRand == 0) {
+                    childObj = touchPiece->childImage;
+                }
+                else {
+                    // if random spawn, then figure out which object
+                    unsigned int randIndex = SimRandomUniform(5)+1;
+                    const PaperRandom &tsRow = tables.random[touchPiece->tsRand];
+                    if (randIndex == 1) { childObj = tsRow.rObjID01; }
+                    if (randIndex == 2) { childObj = tsRow.rObjID02; }
+                    if (randIndex == 3) { childObj = tsRow.rObjID03; }
+                    if (randIndex == 4) { childObj = tsRow.rObjID04; }
+                    if (randIndex == 5) { childObj = tsRow.rObjID05; }
+                }
+
+                int randSax = SimRandomUniform(4)+1;
+                int randHrn = SimRandomUniform(2)+5;
+
+                if (touchPiece->objID == 5) {
+                    playSound(randSax);
+                }
+                else if (touchPiece->objID == 8) {
+                    playSound(randHrn);
+                }
+
+                if ((int)queue_clean.size() <= maxNotes) {
+                    sPaper = spawnPiece(touchPiece, childObj, YES);
+
+                    // Add to collision manager if needed
+                    if (sPaper->collision) {
+                        addObj(sPaper, otCollision);
+                    }
+
+                    addToView(sPaper);
+                }
+
+            }
+
+        }
+
+        // if no Touchspot, then spawn as normal
+        else {
+
+            sPaper = spawnPiece(touchPiece, YES);
+
+            // Add to collision manager if needed
+            if (sPaper->collision) {
+                addObj(sPaper, otCollision);
+            }
+
+            addToView(sPaper);
+
+        }
+
+    }
+}
+
+void SimWorld::touchMoved(SimPoint beginPos, SimPoint currentPos) {
+
+    SimJournalTouchMoved(journal, beginPos.x, beginPos.y, currentPos.x, currentPos.y);
+
+    if (!optInteract) { return; }
+
+    SimPaper *touchPiece = objTouched(currentPos);
+
+    // as long as view can be seen, allow user to touch it
+    if ((touchPiece == NULL) || (touchPiece->behavior.viewCheck(vcCompletelyOffScreen))) {
+        // do nothing
+    }
+    else if (touchPiece->moveType == Move_Touch) {
+
+        SimPoint paperCenter = touchPiece->center;
+
+        // update the velocity
+        touchPiece->behavior.vel.x = currentPos.x - beginPos.x;
+        if ((touchPiece->behavior.vel.y == 0.0) &&
+            (touchPiece->bindType == Bind_OnEnter) &&
+            (currentPos.y > beginPos.y)) {
+            // do nothing to avoid accidentally moving object into border
+        }
+        else {
+            touchPiece->behavior.vel.y = currentPos.y - beginPos.y;
+        }
+
+        paperCenter.x += touchPiece->behavior.vel.x;
+        paperCenter.y += touchPiece->behavior.vel.y;
+
+        touchPiece->setCenter(paperCenter);
+        touchPiece->startAnimating();
+
+        // if the touched object is the Master of a Group,
+        //   move all the other pieces in the group as well
+        if (touchPiece->groupID > 0) {
+            updateDirection(touchPiece);
+            SimTransform transformPiece = imageTransform(touchPiece);
+            touchPiece->transform = transformPiece;
+            updateGroup(touchPiece, transformPiece);
+
+            // the whole group moved, let the next touch rebuild the index
+            hitIndex.clear();
+        }
+        else {
+            hitIndex.update(touchPiece);
+        }
+
+    }
+}
+
+void SimWorld::touchEnded(SimPoint firstTouch, SimPoint lastTouch) {
+
+    SimJournalTouchEnded(journal, firstTouch.x, firstTouch.y, lastTouch.x, lastTouch.y);
+
+    if (!optInteract) { return; }
+
+    BOOL dirLeft = NO;
+
+    // check for chime swipe only if complete swipe is across bottom of screen
+    if ((firstTouch.y >= 800) && (lastTouch.y >= 800)) {
+
+        CGFloat swipeDeltaX = firstTouch.x - lastTouch.x;
+
+        // only fire chime if greater than minimum swipe length
+        if (fabsf(swipeDeltaX) > MIN_CHIME_DIST) {
+
+            // determine direction of swipe
+            CGFloat leftX, rightX;
+            if (swipeDeltaX > 0) {
+                dirLeft = YES;
+                leftX = lastTouch.x;
+                rightX = firstTouch.x;
+            }
+            else {
+                leftX = firstTouch.x;
+                rightX = lastTouch.x;
+            }
+
+            chimeSwipe(dirLeft, leftX, rightX);
+
+        }
+
+    }
+}
+
+void SimWorld::chimeSwipe(BOOL dirLeft, CGFloat xLeft, CGFloat xRight) {
+
+    for (size_t i = 0; i < objects.size(); i++) {
+
+        if (!objects.hasTagAt(i, otWiggle)) { continue; }
+
+        // wiggle each piece only if it's within the swipe
+        SimPaper *wPiece = objects[i];
+        CGFloat xPoint = wPiece->posSpawn.x + wPiece->halfSize.x;
+        if ((xPoint >= xLeft) && (xPoint <= xRight)) {
+            wPiece->wiggle();
+        }
+
+    }
+
+    // determine sound based on swipe direction
+    int randSound;
+    if (dirLeft) {
+        randSound = SimRandomUniform(2)+20;
+    }
+    else {
+        randSound = SimRandomUniform(2)+22;
+    }
+
+    playSound(randSound);
+}
+
+void SimWorld::shake() {
+
+    SimJournalShake(journal);
+
+    if ((!optInteract) || (objects.tagCount(otShake) > 0) || (queue_shake.empty())) { return; }
+
+    // randomly choose an object in the array
+    unsigned int randIndex = SimRandomUniform((unsigned int)queue_shake.size());
+    int objID = queue_shake[randIndex];
+
+    SimPaper *sPaper = spawnPiece(objID);
+    addObj(sPaper, otShake);
+
+    addToView(sPaper);
+}
+
+void SimWorld::accelerate(CGFloat x) {
+
+    SimJournalAccelerate(journal, x);
+
+#ifdef ACCEL_ON
+    if (optInteract) {
+        accelX = (x * GRAVITY_FILTER) + (accelX * (1.0 - GRAVITY_FILTER));
+    }
+#endif
+}
+
+void SimWorld::pinch(SimPoint touchPos, CGFloat scale) {
+
+    SimJournalPinch(journal, touchPos.x, touchPos.y, scale);
+
+    SimPaper *pinchPiece = objTouched(touchPos);
+    if ((pinchPiece == NULL) || (!objects.hasTag(pinchPiece->handle, otPinch))) { return; }
+
+    // stop the piece so it doesn't move when we pinch it
+    pinchPiece->behavior.vel.zero();
+
+    CGFloat newScale = fabsf(pinchPiece->transform.a) * scale;
+
+    if (newScale < pinchPiece->pinchMin) {
+        newScale = pinchPiece->pinchMin;
+    }
+    if (newScale > pinchPiece->pinchMax) {
+        newScale = pinchPiece->pinchMax;
+    }
+
+    pinchPiece->transform = imageTransform(pinchPiece, newScale);
+}
+
+void SimWorld::replay(const SimJournalEvent &event) {
+
+    switch (event.type) {
+        case sjFrame:       stepFrame(event.timestamp); break;
+        case sjTouchBegan:  touchBegan(SimPoint(event.x, event.y)); break;
+        case sjTouchMoved:  touchMoved(SimPoint(event.x, event.y), SimPoint(event.x2, event.y2)); break;
+        case sjTouchEnded:  touchEnded(SimPoint(event.x, event.y), SimPoint(event.x2, event.y2)); break;
+        case sjShake:       shake(); break;
+        case sjAccelerate:  accelerate(event.x); break;
+        case sjPinch:       pinch(SimPoint(event.x, event.y), event.x2); break;
+        default:            break;
+    }
+}
+
+BOOL SimWorld::touchSpotRect(int pieceID, SimRect *rect) const {
+
+    SimPaper *tPiece = getObject(pieceID);
+    if ((tPiece == NULL) || (tPiece->touchSpot.height <= 0) || (tPiece->touchSpot.width <= 0)) { return NO; }
+
+    // create a new Rect based on current Paper center and the touchSpot
+    //   origin offset / size and the piece direction, scaled in case
+    //   the piece has been pinched
+    CGFloat tsOriginX;
+    CGFloat imageScale = fabsf(tPiece->transform.a);
+
+    if (tPiece->dir == 1) {
+        tsOriginX = tPiece->center.x + (tPiece->touchSpot.x * imageScale);
+    }
+    else {
+        tsOriginX = tPiece->center.x + (-(tPiece->touchSpot.x * imageScale) -
+                                        (tPiece->touchSpot.width * imageScale));
+    }
+
+    *rect = SimRect(tsOriginX,
+                    tPiece->center.y + (tPiece->touchSpot.y * imageScale),
+                    tPiece->touchSpot.width * imageScale,
+                    tPiece->touchSpot.height * imageScale);
+
+    return YES;
+}
+
+// ___ OBJECTS
+
+void SimWorld::addObj(SimPaper *paperPiece, ObjTag tag) {
+    // generic add Paper to any object manager
+    objects.setTag(paperPiece->handle, tag);
+}
+
+void SimWorld::addObj(SimPaper *paperPiece, BOOL spawned) {
+
+    // add paper piece to objects
+    if (spawned) {
+        paperPiece->spawnID = spawnID;
+        spawnID++;
+    }
+    else {
+        paperPiece->spawnID = paperPiece->objID;
+
+        // a fixed ID replaces whatever piece held it before
+        SimPaper *oldPiece = getObject(paperPiece->spawnID);
+        if (oldPiece != NULL) { delObj(oldPiece); }
+    }
+
+    paperPiece->handle = objects.insert(paperPiece, paperPiece->spawnID);
+    hitIndex.add(paperPiece);
+
+    // only moving pieces have their timers run, same as the walk
+    if ((paperPiece->moveType == Move_Touch) || (paperPiece->moveType == Move_Auto)) {
+        paperPiece->behavior.attachTimers(&behaviorWheel);
+    }
+    stats.spawned++;
+
+    // add to the objLimit
+    if (paperPiece->objLimit) { numObjects++; }
+}
+
+void SimWorld::delObj(SimPaper *paperPiece) {
+
+    // delete paper piece from objects
+    if (paperPiece->objLimit) {
+        if (numObjects > 0) { numObjects--; }
+    }
+
+    // dropping it from the store drops it from every tag view too,
+    //   and any handle still pointing at it goes stale
+    if (objects.hasTag(paperPiece->handle, otClean)) { flockGrid.remove(paperPiece); }
+    hitIndex.remove(paperPiece);
+    viewLayers.remove(paperPiece);
+    objects.erase(paperPiece->handle);
+    stats.removed++;
+
+    releasePiece(paperPiece);
+}
+
+// tears down everything queue_destroy collected this tick in one go
+void SimWorld::destroyQueued() {
+
+    // children first: each child spawn reads its removed piece as the
+    //   parent, so nothing is released until they're all out
+    for (size_t i = 0; i < queue_destroy.size(); i++) {
+
+        SimPaper *removePiece = queue_destroy[i];
+
+        // play a sound if needed on remove
+        if (removePiece->objID == 37) {  // BLOWFISH EXPLODE
+            playSound(7);
+        }
+
+        // only do this if not part of an image swap (i.e. note -> notefish)
+        if ((removePiece->childImage <= 0) || (removePiece->manageRemove)) { continue; }
+
+        SimPaper *sPaper;
+
+        if (removePiece->paperType == Paper_Vector) {
+            SimPoint spawnPoint = removePiece->curvePoint;
+
+            sPaper = spawnPiece(removePiece->childImage, spawnPoint);
+
+            if (!sPaper->behavior.viewCheck(vcCenterOnScreen, spawnPoint)) {
+                // immediately remove if fish is off screen
+                sPaper->remove = YES;
+            }
+            else {
+                // add to the clean queue for later removal
+                addToCleanQueue(sPaper->handle);
+            }
+
+        }
+        else {
+            sPaper = spawnPiece(removePiece, YES);
+        }
+
+        // Add to collision manager if needed
+        if (sPaper->collision) {
+            addObj(sPaper, otCollision);
+        }
+
+        addToView(sPaper);
+    }
+
+    // then the pieces themselves, back to their pools
+    BOOL wasQueued = NO;
+    for (size_t i = 0; i < queue_destroy.size(); i++) {
+        SimPaper *removePiece = queue_destroy[i];
+        if (objects.hasTag(removePiece->handle, otClean)) { wasQueued = YES; }
+        delObj(removePiece);
+    }
+    stats.destroyed += (int)queue_destroy.size();
+    queue_destroy.clear();
+
+    // anything still waiting to be cleaned leaves the clean queue in one pass
+    if (wasQueued) {
+        size_t kept = 0;
+        for (size_t i = 0; i < queue_clean.size(); i++) {
+            if (objects.get(queue_clean[i]) != NULL) { queue_clean[kept++] = queue_clean[i]; }
+        }
+        queue_clean.resize(kept);
+    }
+}
+
+// Check if an object was touched by the user,
+//   the top-most touchable piece wins
+SimPaper* SimWorld::objTouched(SimPoint touchPos) {
+
+    if (!hitIndex.isBuilt()) { hitIndex.build(objects, viewWidth, viewHeight); }
+    return hitIndex.hitTest(touchPos);
+}
+
+// same as objTouched for a batch of coalesced touches
+void SimWorld::objsTouched(const std::vector<SimPoint> &touchPos, std::vector<SimPaper*> &touched) {
+
+    touched.resize(touchPos.size());
+    if (touchPos.empty()) { return; }
+
+    if (!hitIndex.isBuilt()) { hitIndex.build(objects, viewWidth, viewHeight); }
+    hitIndex.hitTest(&touchPos[0], touchPos.size(), &touched[0]);
+}
+
+void SimWorld::addToView(SimPaper *paperPiece) {
+    // this queue adds objects to the view at the end of the tick
+    if (objects.hasTag(paperPiece->handle, otView)) { return; }
+    objects.setTag(paperPiece->handle, otView);
+    queue_view.push_back(paperPiece->handle);
+}
+
+// the pieces queued since the last insertion, sorted into their layers;
+//   later subviews draw on top of earlier ones in the same layer
+void SimWorld::insertViews() {
+
+    insertPieces.clear();
+    for (size_t i = 0; i < queue_view.size(); i++) {
+        // removed before it was ever shown
+        SimPaper *viewPiece = getObject(queue_view[i]);
+        if (viewPiece == NULL) { continue; }
+
+        objects.clearTag(queue_view[i], otView);
+        insertPieces.push_back(viewPiece);
+    }
+    queue_view.clear();
+
+    if (insertPieces.empty()) { return; }
+    viewLayers.insert(&insertPieces[0], insertPieces.size(), viewCount);
+    stats.viewInserts += (int)insertPieces.size();
+}
+
+void SimWorld::changeZPosition(SimHandle h, int zPos) {
+
+    // changes the Z Position of an object to prevent
+    //   it from overlapping a menu view controller
+    SimPaper *zPiece = getObject(h);
+    if (zPiece == NULL) { return; }
+
+    viewLayers.changeZ(zPiece, zPos, viewCount);
+}
+
+void SimWorld::addToCleanQueue(SimHandle h) {
+    queue_clean.push_back(h);
+    objects.setTag(h, otClean);
+}
+
+void SimWorld::removeFromCleanQueue(SimHandle h) {
+    queue_clean.erase(std::remove(queue_clean.begin(), queue_clean.end(), h), queue_clean.end());
+    objects.clearTag(h, otClean);
+
+    // stop flocking with it for the rest of the frame too
+    SimPaper *cleanPiece = getObject(h);
+    if (cleanPiece != NULL) { flockGrid.remove(cleanPiece); }
+}
+
+// ___ WORLD TIMERS
+
+void SimWorld::turnWorldTimer(WorldTimer wt, BOOL isOn) {
+    std::unordered_map<int, SimTimer>::iterator it = world_timers.find(wt);
+    if (it == world_timers.end()) { return; }
+    if (isOn)   { it->second.turnTimerOn(); }
+    else        { it->second.turnTimerOff(); }
+}
+
+BOOL SimWorld::isWorldTimerOn(WorldTimer wt) const {
+    std::unordered_map<int, SimTimer>::const_iterator it = world_timers.find(wt);
+    return (it == world_timers.end()) ? NO : it->second.isTimerOn();
+}
+
+void SimWorld::addWorldTimer(const SimTimer &objTimer, WorldTimer wt) {
+    SimTimer &wTimer = world_timers[wt];
+    wTimer = objTimer;
+    wTimer.attach(&worldWheel);
+}
+
+void SimWorld::updateWorldTimers() {
+    worldWheel.advance();
+}
+
+void SimWorld::processWorldTimers() {
+
+    // only the timers that came due this tick
+    const std::vector<SimTimer*> &expired = worldWheel.expired();
+
+    for (size_t i = 0; i < expired.size(); i++) {
+
+        SimTimer &wTimer = *expired[i];
+
+        if (wTimer.timerComplete()) {
+
+            switch (wTimer.wtMessageType) {
+
+                case mtSpawn:
+                    messenger.queueObject(0, wTimer.wtMessageType, YES, wTimer.wtTargetID, YES);
+                    break;
+
+                case mtNone:    // no message type is a simple wait timer
+                    wTimer.turnTimerOff();
+                    break;
+
+                default:
+                    break;
+
+            }
+
+            wTimer.randomizeInterval(SimRandomShared());
+            wTimer.timerReset();
+
+        }
+
+    }
+}
+
+// ___ MOVEMENT
+
+// Collision detection for the whole frame
+//   sweeps every collision enabled piece once and resolves each
+//   overlapping pair a single time, instead of testing every moving
+//   piece against the whole collision manager
+void SimWorld::findCollisions() {
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    collisionBroadphase.clear();
+    for (size_t i = 0; i < objects.size(); i++) {
+        if ((objects.hasTagAt(i, otCollision)) && (objects[i]->collision)) {
+            collisionBroadphase.add((uint32_t)i, objects[i]->frame());
+        }
+    }
+
+    collisionPush.assign(objects.size(), SimPoint());
+    collisionHit.assign(objects.size(), NO);
+
+    const std::vector<SimCollisionPair> &pairs = collisionBroadphase.findPairs();
+    stats.collisionPairs += (int)pairs.size();
+
+    for (size_t i = 0; i < pairs.size(); i++) {
+
+        // the piece that comes first in the update walk gets moved,
+        //   unless only the other one can move
+        uint32_t moveIndex = pairs[i].a;
+        uint32_t colIndex = pairs[i].b;
+
+        SimPaper *movePiece = objects[moveIndex];
+        SimPaper *colPiece = objects[colIndex];
+
+        if (movePiece->objID == colPiece->objID) { continue; }  // exclude collision against itself
+
+        if ((movePiece->moveType != Move_Touch) && (movePiece->moveType != Move_Auto)) {
+            if ((colPiece->moveType != Move_Touch) && (colPiece->moveType != Move_Auto)) { continue; }
+            std::swap(moveIndex, colIndex);
+            std::swap(movePiece, colPiece);
+        }
+
+        // move the main object slightly away based on the intersection's
+        //   height or width to prevent the two from sticking to each other
+        SimRect iRect = movePiece->frame().intersection(colPiece->frame());
+        SimPoint &push = collisionPush[moveIndex];
+        if (iRect.height < iRect.width) {                       // collision vertically
+            if (movePiece->center.y < colPiece->center.y)   { push.y -= iRect.height; }
+            else                                            { push.y += iRect.height; }
+        }
+        else {                                                  // collision horizontally
+            if (movePiece->center.x < colPiece->center.x)   { push.x -= iRect.width; }
+            else                                            { push.x += iRect.width; }
+        }
+        collisionHit[moveIndex] = YES;
+
+        // update the velocity vectors now
+        collidePiece(movePiece, colPiece);
+        stats.collisions++;
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    stats.collisionMs += std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Collision detection and velocity recalc
+void SimWorld::collidePiece(SimPaper *piece1, SimPaper *piece2) {
+
+    // initialize starting vectors and calculate momentum
+    SimVector tVel1 = piece1->behavior.vel * piece1->mass;
+    SimVector tVel2 = piece2->behavior.vel * piece2->mass;
+
+    // calculate the final velocity vector of piece2 after collision
+    CGFloat coefficient = -RESTITUTION;     // coefficient of restitution for a linear collision
+    SimVector iVelSum = tVel1 + tVel2;
+    SimVector eVelSum = (tVel1 - tVel2) * coefficient * piece1->mass - iVelSum;
+
+    CGFloat mDiff = -piece2->mass - piece1->mass;
+    SimVector fVel2 = eVelSum / mDiff;
+
+    // calculate the final velocity vector of piece1 after collision
+    SimVector fVel1 = iVelSum - fVel2;
+
+    // update Paper vectors
+    piece1->behavior.vel = fVel1;
+    piece2->behavior.vel = fVel2;
+}
+
+void SimWorld::updateDirection(SimPaper *imagePiece) {
+
+    const SimBehavior &iBehavior = imagePiece->behavior;
+
+    if (((iBehavior.flipX) && (iBehavior.vel.x < 0.0)) ||
+        ((!(iBehavior.flipX)) && (iBehavior.vel.y < 0.0))) {
+        imagePiece->dir = -1 * imagePiece->orientation;
+    }
+    else if (((iBehavior.flipX) && (iBehavior.vel.x > 0.0)) ||
+             ((!(iBehavior.flipX)) && (iBehavior.vel.y > 0.0))) {
+        imagePiece->dir = 1 * imagePiece->orientation;
+    }
+    else {
+        // do nothing, keep the current direction if stopped
+    }
+}
+
+BOOL SimWorld::leftTopHalf(const SimPaper *imagePiece) const {
+
+    // YES if piece is on the left or top half of screen
+    //   used to adjust the direction of the image
+    SimPoint cPoint = imagePiece->getCenterPoint();
+
+    if (imagePiece->behavior.flipX) {
+        // left vs right
+        return (cPoint.x < (viewWidth * 0.5)) ? YES : NO;
+    }
+    else {
+        // top vs bottom
+        return (cPoint.y < (viewHeight * 0.5)) ? YES : NO;
+    }
+}
+
+SimPoint SimWorld::keepInBounds(SimPaper *pPiece, ViewCheckType vcType) {
+
+    SimPoint cPoint = pPiece->getCenterPoint();
+    SimBehavior &pBehavior = pPiece->behavior;
+
+    // reverse the velocity elements if the image hits the border
+    //   and bounce it away from the border so it doesn't get stuck
+
+    if (!pBehavior.viewCheck(vcType)) {
+
+        pPiece->transformEnabled = NO;
+        if (pBehavior.axisHitCheck(vcType) == yAxis) {
+
+            if (pPiece->collision) {
+                pBehavior.vel.x = -pBehavior.vel.x;
+                if (cPoint.x >= (viewWidth*0.5))    { cPoint.x -= bounceOffset; }
+                else                                { cPoint.x += bounceOffset; }
+            }
+            else {
+                // only bounce if not being tilted (to prevent stutter)
+                if ((pPiece->bindType == Bind_Always) && (fabsf(accelX) < TILT_THRESHOLD)) {
+                    pBehavior.vel.x = (-pBehavior.vel.x)*0.6;
+                    if (cPoint.x >= (viewWidth*0.5))    { cPoint.x -= bounceOffset; }
+                    else                                { cPoint.x += bounceOffset; }
+                }
+                else {
+                    pBehavior.vel.x = 0.0;
+                }
+            }
+
+        }
+        else {
+
+            if (vcType == vcKeepOnGround) {
+                pBehavior.vel.y = 0.0;
+            }
+            else {
+                pBehavior.vel.y = -pBehavior.vel.y;
+                if (cPoint.y >= (viewHeight*0.5))   { cPoint.y -= bounceOffset-2; }
+                else                                { cPoint.y += bounceOffset-2; }
+            }
+
+        }
+
+    }
+
+    return cPoint;
+}
+
+SimTransform SimWorld::imageTransform(SimPaper *imagePiece, CGFloat scale) {
+
+    SimTransform transformPiece;
+    CGFloat currTransSX, currTransSY;
+    int imageDir = imagePiece->dir;
+    const SimBehavior &iBehavior = imagePiece->behavior;
+
+    // don't transform based on direction if Peek is on
+    if ((iBehavior.isOn(btPeek)) || (iBehavior.fixedDir)) {
+        if (leftTopHalf(imagePiece))    { imageDir = imagePiece->orientation; }
+        else                            { imageDir = -imagePiece->orientation; }
+    }
+
+    // create an initial transform based on the rotation angle if necessary
+    if (iBehavior.rotateAngle != 0.0) {
+        transformPiece = SimTransform::makeRotation(iBehavior.rotateAngle);
+    }
+
+    if (scale == 1.0) {
+
+        // handle any peekers explicitly because they don't
+        //   play nice with others
+        if (iBehavior.peekTime > 0.0) {
+            currTransSX = scale;
+            currTransSY = scale;
+        }
+        else if (imagePiece->pinch) {
+            // needed to keep pinched objects the proper size
+            //   while they aren't being pinched
+            currTransSX = imagePiece->transform.a;
+            currTransSY = imagePiece->transform.d;
+        }
+        else {
+            currTransSX = 1.0;
+            currTransSY = 1.0;
+        }
+
+    }
+    else {
+        currTransSX = scale;
+        currTransSY = scale;
+    }
+
+    if (iBehavior.isOn(btAxisflip)) {
+
+        // now flip the piece based on the axis
+        if (iBehavior.flipX) {
+            transformPiece = transformPiece.scale((imageDir * fabsf(currTransSX)),
+                                                  (iBehavior.flip * fabsf(currTransSY)));
+        }
+        else {
+            transformPiece = transformPiece.scale((iBehavior.flip * fabsf(currTransSX)),
+                                                  (imageDir * fabsf(currTransSY)));
+        }
+
+    }
+    else {
+        // if piece doesn't flip, just switch the direction as necessary
+        if (iBehavior.flipX) {
+            transformPiece = transformPiece.scale((imageDir * fabsf(currTransSX)), currTransSY);
+        }
+        else {
+            transformPiece = transformPiece.scale(currTransSX, (imageDir * fabsf(currTransSY)));
+        }
+    }
+
+    return transformPiece;
+}
+
+void SimWorld::updateGroup(SimPaper *mstrPiece, SimTransform mstrTransform) {
+
+    // setup variables
+    SimPaper *gPaper = NULL;
+    SimPoint gPaperCenter;
+    const PaperGroups &gGrp = tables.groups[mstrPiece->groupID];
+    int i = gGrp.numSubs;
+    CGFloat mstrTransSX, mstrTransSY;
+
+    for (int j = 1; j<=i; j++) {
+
+        if (j == 1) { gPaper = getObject(gGrp.objIDSub01); }
+        if (j == 2) { gPaper = getObject(gGrp.objIDSub02); }
+
+        if (gPaper == NULL) { continue; }
+
+        gPaperCenter = mstrPiece->center;
+
+        // use scale values of the transform in case parent object is
+        //   scaled via pinch/zoom, etc, so we can adjust the
+        //   position offsets accordingly
+        mstrTransSX = fabsf(mstrTransform.a) * gPaper->childSpawn.x;
+        mstrTransSY = fabsf(mstrTransform.d) * gPaper->childSpawn.y;
+
+        if (mstrPiece->behavior.flipX) {
+            gPaperCenter.x += mstrTransSX * mstrPiece->dir;
+            gPaperCenter.y += mstrTransSY;
+        }
+        else {
+            gPaperCenter.x += mstrTransSX;
+            gPaperCenter.y += mstrTransSY * mstrPiece->dir;
+        }
+
+        gPaper->transform = mstrTransform;
+        CGFloat mstrVel = mstrPiece->behavior.vel.lengthSquared();
+        if ((!gPaper->isAnimating()) && (mstrVel > 0.0)) {
+            gPaper->startAnimating();
+        }
+        else if ((gPaper->isAnimating()) && (mstrVel == 0.0)) {
+            gPaper->stopAnimating();
+        }
+        gPaper->setCenter(gPaperCenter);
+
+    }
+}
+
+// ___ SPAWNING
+
+SimPaper* SimWorld::newPiece(int objID, const SimPaper *parentPiece) {
+
+    // every objID the tables refer to has a row, SIM_SCENE checks that at compile time
+    int row = tables.row(objID);
+    const PaperProps &prp = tables.props[row];
+
+    // build it in a retired piece's memory if this row has one waiting
+    void *block;
+    if ((row < (int)piecePools.size()) && (!piecePools[row].empty())) {
+        block = piecePools[row].back();
+        piecePools[row].pop_back();
+        stats.recycled++;
+    }
+    else {
+        // more of the row alive than its cap, or one that only loads with the scene
+        block = ::operator new(sizeof(SimPaper));
+        stats.poolAllocs++;
+    }
+
+    return new (block) SimPaper(prp, tables.animFor(prp), tables.touch[prp.tsID], parentPiece, this);
+}
+
+void SimWorld::releasePiece(SimPaper *paperPiece) {
+
+    // the piece is torn down now, its memory waits in the row's pool
+    int row = tables.row(paperPiece->objID);
+    paperPiece->~SimPaper();
+
+    if ((row >= 0) && (row < (int)piecePools.size()) && (piecePools[row].size() < poolCaps[row])) {
+        piecePools[row].push_back(paperPiece);
+    }
+    else {
+        ::operator delete(paperPiece);
+    }
+}
+
+// objIDs spawned by name in the code rather than through the tables: the
+//   squid's and diver's bubbles (SimPaper::frameAnimComplete) and the
+//   cleaning fish
+static const int codeSpawns[] = { 6, 9, 25, 39, 46 };
+
+void SimWorld::prewarmPools() {
+
+    piecePools.resize(tables.numProps);
+    poolCaps.assign(tables.numProps, 0);
+
+    // rows that can come in after the scene loads: the ones that don't load
+    //   with it, and any the tables spawn as children, from touchspots,
+    //   random picks or world timers
+    for (int i = 1; i < tables.numProps; i++) {
+        if (!tables.props[i].init) { markSpawnRow(tables.props[i].objID); }
+        markSpawnRow(tables.props[i].childImage);
+    }
+    for (int i = 1; i < tables.numTouch; i++) {
+        if (!tables.touch[i].random) { markSpawnRow(tables.touch[i].objID); }
+    }
+    for (int i = 1; i < tables.numRandom; i++) {
+        const PaperRandom &rRow = tables.random[i];
+        markSpawnRow(rRow.rObjID01);
+        markSpawnRow(rRow.rObjID02);
+        markSpawnRow(rRow.rObjID03);
+        markSpawnRow(rRow.rObjID04);
+        markSpawnRow(rRow.rObjID05);
+    }
+    for (int i = 1; i < tables.numTimers; i++) {
+        markSpawnRow(tables.timers[i].objTargetID);
+    }
+    for (size_t i = 0; i < sizeof(codeSpawns) / sizeof(codeSpawns[0]); i++) {
+        markSpawnRow(codeSpawns[i]);
+    }
+
+    // each up to its cap, the scene's own copies of a row come out of it too
+    for (int i = 1; i < tables.numProps; i++) {
+
+        std::vector<SimPaper*> &pool = piecePools[i];
+        pool.reserve(poolCaps[i]);
+        while (pool.size() < poolCaps[i]) {
+            pool.push_back((SimPaper*)::operator new(sizeof(SimPaper)));
+        }
+    }
+}
+
+void SimWorld::markSpawnRow(int objID) {
+
+    int row = tables.row(objID);
+    if (row > 0) { poolCaps[row] = SIM_POOL_CAP; }
+}
+
+void SimWorld::clearPools() {
+
+    for (size_t i = 0; i < piecePools.size(); i++) {
+        for (size_t j = 0; j < piecePools[i].size(); j++) {
+            ::operator delete(piecePools[i][j]);
+        }
+    }
+    piecePools.clear();
+    poolCaps.clear();
+}
+
+// Spawning new Paper objects due to user input
+SimPaper* SimWorld::spawnPiece(SimPaper *touchedPiece, BOOL child) {
+    return spawnPiece(touchedPiece, touchedPiece->childImage, child);
+}
+
+// Spawning new Paper objects due to user input
+SimPaper* SimWorld::spawnPiece(SimPaper *touchedPiece, int childImg, BOOL child) {
+
+    SimPaper *sPaper = newPiece(childImg, (child) ? touchedPiece : NULL);
+
+    // add spawned Paper to object manager and return it
+    addObj(sPaper, YES);
+
+    return sPaper;
+}
+
+// MASTER SPAWN METHOD
+SimPaper* SimWorld::spawnPiece(SimPaper *parentPiece, int obj, int child, BOOL spawn, SimPoint pos) {
+
+    int objectID = (child > 0) ? child : obj;
+
+    // initialize the spawn object
+    SimPaper *sPaper = newPiece(objectID, (child > 0) ? parentPiece : NULL);
+
+    if (!pos.isZero()) {
+        sPaper->setCenter(pos);
+    }
+
+    // add spawned Paper to object manager and return it
+    addObj(sPaper, spawn);
+
+    return sPaper;
+}
+
+// Spawning an object explicitly
+SimPaper* SimWorld::spawnPiece(int objID, BOOL spawn) {
+
+    SimPaper *sPaper = newPiece(objID, NULL);
+
+    // add spawned Paper to object manager and return it
+    addObj(sPaper, spawn);
+
+    return sPaper;
+}
+
+// Spawning an object explicitly at a point
+SimPaper* SimWorld::spawnPiece(int objID, SimPoint pos) {
+
+    SimPaper *sPaper = newPiece(objID, NULL);
+    sPaper->setCenter(pos);
+
+    // add spawned Paper to object manager and return it
+    addObj(sPaper, YES);
+
+    return sPaper;
+}
+
+void SimWorld::killPiece(SimPaper *piece) {
+
+    switch (piece->objID) {
+
+        case 6:
+        case 7:
+        case 9:
+        case 10:
+        case 12:
+        case 14:
+        case 35:
+        case 39:
+        case 46: // bubbles / balloon fish
+        {
+            // select a sound
+            int randPop = SimRandomNextUniform(&piece->random, 4)+15;
+            playSound(randPop);
+
+            // fade out, then remove
+            piece->fadeOutIn = 0.2;
+            break;
+        }
+
+        default:
+            break;
+
+    }
+}
+
+// for separation / alignment / cohesion behaviors
+//   hashes the clean queue by position once per frame
+void SimWorld::buildFlockGrid() {
+
+    flockPieces.clear();
+    flockCenters.clear();
+    for (size_t i = 0; i < queue_clean.size(); i++) {
+        SimPaper *nPiece = getObject(queue_clean[i]);
+        if (nPiece != NULL) {
+            flockPieces.push_back(nPiece);
+            flockCenters.push_back(pieceState.center(nPiece));
+        }
+    }
+
+    flockGrid.build(flockPieces, flockCenters, FLOCK_RADIUS);
+}
+
+// determines which objects are closest to a specific object,
+//   the list is only good until the next call
+const std::vector<SimPaper*>& SimWorld::findNeighbors(SimPaper *piece) {
+
+    flockNeighbors.clear();
+    flockGrid.query(pieceState.center(piece), FLOCK_RADIUS, piece, flockNeighbors);
+    return flockNeighbors;
+}
+
+const SimPathSampler* SimWorld::pathSampler(int objID, const char *imagePath, int pathIndex) {
+
+    int key = (objID << 8) | pathIndex;
+    std::unordered_map<int, SimPathSampler>::iterator it = pathSamplers.find(key);
+
+    // first spawn of this path flattens it, a missing one is remembered as empty
+    if (it == pathSamplers.end()) {
+        char name[128];
+        if (pathIndex > 0)  { snprintf(name, sizeof(name), "P_%s%d", imagePath, pathIndex); }
+        else                { snprintf(name, sizeof(name), "P_%s", imagePath); }
+
+        SimPathSampler &sampler = pathSamplers[key];
+        const SimPath *path = pathCache.path(name);
+        if (path) { sampler.build(*path); }
+
+        return (sampler.isEmpty()) ? NULL : &sampler;
+    }
+
+    return (it->second.isEmpty()) ? NULL : &it->second;
+}
+
+void SimWorld::setPathDirectory(const char *dir) {
+
+    pathCache.clear();
+    pathCache.setSearchPath(dir);
+
+    // the samplers came from the old directory, so every path mover
+    //   picks up the same path again from the new one
+    pathSamplers.clear();
+    for (size_t i = 0; i < objects.size(); i++) {
+        SimPaper *pPiece = objects[i];
+        if (!pPiece->movePath) { continue; }
+
+        const PaperProps &prp = tables.props[tables.row(pPiece->objID)];
+        pPiece->pathSampler = pathSampler(pPiece->objID, prp.imagePath, pPiece->pathIndex);
+    }
+}
+
+static bool samplerBefore(const SimPaper *a, const SimPaper *b) {
+    return std::less<const SimPathSampler*>()(a->pathSampler, b->pathSampler);
+}
+
+void SimWorld::samplePaths(CGFloat frameTime) {
+
+    pathPieces.clear();
+    for (size_t i = 0; i < objects.size(); i++) {
+        if (objects[i]->pathSampler) {
+            objects[i]->pathElapsed += frameTime;
+            pathPieces.push_back(objects[i]);
+        }
+    }
+
+    if (pathPieces.empty()) { return; }
+    stats.pathSamples += (int)pathPieces.size();
+
+    // pieces on the same path are sampled together
+    std::sort(pathPieces.begin(), pathPieces.end(), samplerBefore);
+
+    size_t first = 0;
+    while (first < pathPieces.size()) {
+
+        const SimPathSampler *sampler = pathPieces[first]->pathSampler;
+        size_t last = first;
+        while ((last < pathPieces.size()) && (pathPieces[last]->pathSampler == sampler)) { last++; }
+
+        size_t count = last - first;
+        pathFractions.resize(count);
+        pathPositions.resize(count);
+        pathTangents.resize(count);
+
+        for (size_t i = 0; i < count; i++) {
+            pathFractions[i] = pathPieces[first + i]->pathFraction();
+        }
+
+        sampler->sample(&pathFractions[0], count, &pathPositions[0], &pathTangents[0]);
+
+        for (size_t i = 0; i < count; i++) {
+            pathPieces[first + i]->center = pathPositions[i];
+            pathPieces[first + i]->pathTangent = pathTangents[i];
+        }
+
+        first = last;
+    }
+}
+
+void SimWorld::markLinked() {
+
+    // seek targets can be stopped by the seeker and group subs are moved by
+    //   their master partway through the walk, so they have to be moved in
+    //   walk order; flee targets are only looked at, through pieceState
+    objects.clearTagAll(otLinked);
+
+    for (size_t i = 0; i < objects.size(); i++) {
+
+        SimPaper *lPiece = objects[i];
+        SimBehavior &lBehavior = lPiece->behavior;
+
+        if (lBehavior.isOn(btSeek)) {
+            objects.setTag(lBehavior.pTarget1, otLinked);
+        }
+
+        if (lPiece->groupID > 0) {
+            const PaperGroups &lGrp = tables.groups[lPiece->groupID];
+            SimPaper *gPaper;
+            if ((lGrp.numSubs >= 1) && ((gPaper = getObject(lGrp.objIDSub01)) != NULL)) { objects.setTag(gPaper->handle, otLinked); }
+            if ((lGrp.numSubs >= 2) && ((gPaper = getObject(lGrp.objIDSub02)) != NULL)) { objects.setTag(gPaper->handle, otLinked); }
+        }
+    }
+}
+
+void SimWorld::commitForceBatch() {
+
+    // same order as the walk, so anything order dependent comes out the same
+    for (size_t i = 0; i < batchPieces.size(); i++) {
+
+        SimPaper *bPiece = objects[batchPieces[i]];
+        SimBehavior &bBehavior = bPiece->behavior;
+
+        bBehavior.vRunning = forceBatch.running(i);
+        bBehavior.vel = forceBatch.velocity(i);
+        if (forceBatch.stopAnimating(i)) { bPiece->stopAnimating(); }
+
+        bPiece->applyForce(batchDest[i].add(bBehavior.vRunning));
+    }
+
+    stats.batched += (int)batchPieces.size();
+}
@@ -0,0 +1,303 @@
+//
+//  SimWorld.h
+//  Papercut
+//
+//  Headless counterpart of ObjManager plus the update loop from
+//    PapercutPadViewController.  Owns every SimPaper in the scene, the
+//    world timers / states and the messenger, and steps the simulation
+//    one display frame at a time without any UIKit dependency.
+//
+//  Input that normally arrives through the view controller (touches,
+//    shake, accelerometer, chime swipes) is exposed as plain methods so
+//    a driver can script it.
+//
+
+#ifndef SIMCORE_SIMWORLD_H
+#define SIMCORE_SIMWORLD_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "SimTypes.h"
+#include "SimTimer.h"
+#include "SimTimerWheel.h"
+#include "SimMessenger.h"
+#include "SimObjectStore.h"
+#include "SimNeighborGrid.h"
+#include "SimBroadphase.h"
+#include "SimHitIndex.h"
+#include "SimViewLayers.h"
+#include "SimIntegrator.h"
+#include "SimPathCache.h"
+#include "SimPathSampler.h"
+#include "SimScene.h"
+#include "SimStateBuffer.h"
+#include "SimWorkPool.h"
+#include "SimProfiler.h"
+#include "SimJournal.h"
+
+class SimPaper;
+
+// flocking pieces within this distance of each other are neighbors
+#define FLOCK_RADIUS    30.0
+
+// most pieces of one row alive at once, which its pool is built up to when
+//   a scene loads; rows under the object limit can't pass it, and nothing
+//   tighter holds the others
+#define SIM_POOL_CAP            MAX_OBJECTS
+
+// the world steps in fixed ticks of fps, display frames run as many as they need
+#define SIM_MAX_TICKS       MAX_TICKS       // catch-up ticks allowed in one display frame
+#define SIM_MAX_FRAME_TIME  MAX_FRAME_TIME  // a longer gap is an inactive stretch, not dropped frames
+
+// the walk is gathered in chunks of this many packed pieces, and only
+//   split across the walk pool once the world has this many
+#define SIM_WALK_CHUNK          64
+#define SIM_WALK_PARALLEL_MIN   512
+
+// what the commit still has to do for a piece once the gather is done
+typedef enum {
+    wkMove,         // changed by other pieces mid-walk (or a group master), the whole update runs in walk order
+    wkForce,        // set up, calculateForce runs in walk order
+    wkPrepare,      // set up and batchable, but prepareForce has world side effects so it runs in walk order
+    wkBatch,        // set up and prepared, only has to join the force batch
+    wkRemove        // doesn't move, flagged for removal
+} SimWalkKind;
+
+typedef struct {
+    uint32_t    index;      // packed index of the piece
+    SimWalkKind kind;
+    SimVector   dest;       // paperDest, once the piece is set up
+} SimWalkCmd;
+
+// piece by piece phase timings, when profiling
+typedef struct {
+    SimProfileSpan  bounds;
+    SimProfileSpan  transform;
+    SimProfileSpan  force;
+} SimWalkTiming;
+
+// one chunk's commands, in walk order, written only by the thread that gathered it
+typedef struct {
+    std::vector<SimWalkCmd> cmds;
+    int                     moved;
+    SimWalkTiming           timing;
+} SimWalkChunk;
+
+// what happened during a single stepFrame call
+typedef struct {
+    int     frame;
+    int     ticks;          // fixed simulation steps run for the frame
+    int     numObjects;     // objects in the world after the frame
+    int     moved;          // Move_Touch / Move_Auto pieces updated
+    int     spawned;
+    int     recycled;       // spawns that reused a pooled piece instead of allocating
+    int     poolAllocs;     // spawns past their row's pool cap, built in new memory
+    int     removed;
+    int     destroyed;      // flagged pieces torn down by the end-of-tick batch
+    int     messages;       // messages applied by the messenger
+    int     sounds;         // playSound requests
+    int     viewInserts;    // pieces that would be added as subviews
+    int     collisionPairs; // overlapping pairs found by the broadphase
+    int     collisions;     // pairs resolved with collidePiece
+    double  collisionMs;    // time spent finding and resolving collisions
+    int     batched;        // moved pieces whose forces ran through the batch integrator
+    int     pathSamples;    // path movers placed from their path
+} SimFrameStats;
+
+class SimWorld {
+public:
+    SimObjectStore      objects;        // all Paper objects, tagged with the managers they belong to
+    SimTimerWheel       behaviorWheel;  // timers of moving pieces, advanced at the start of each tick
+    SimTimerWheel       worldWheel;     // world_timers, advanced after the walk
+    std::unordered_map<int, SimTimer>   world_timers;   // world-level timers, keyed by WorldTimer
+
+    std::vector<int>    queue_shake;
+    std::vector<SimHandle> queue_clean;
+    std::vector<SimHandle> queue_view;  // added since the last insertion, in the order they came
+    SimViewLayers       viewLayers;     // what's on screen, back to front
+    SimNeighborGrid     flockGrid;      // queue_clean by position, rebuilt every frame
+    SimStateBuffer      pieceState;     // every piece as the others see it during the walk
+
+    SimMessenger        messenger;
+
+    CGFloat             accelX;
+    int                 osFlags;        // world-level flags
+
+    int                 spawnID;        // counter for spawned object IDs
+    uint64_t            pieceStreams;   // random streams handed out, one per piece built
+    int                 borderWidth;    // border width
+    int                 borderBound;    // border bounds
+    int                 viewWidth;
+    int                 viewHeight;
+
+    CGFloat             fps;
+    CGFloat             bounceOffset;
+    CGFloat             gravityFilter;
+    CGFloat             elapsedTime;    // simulated time, advances fps per tick
+    double              prevTimestamp;
+    double              tickAccumulator;// real time not yet simulated
+    CGFloat             renderAlpha;    // how far the display frame is past the last tick, 0..1
+
+    int                 cleanMin;
+    int                 cleanMax;
+    int                 maxNotes;       // max # of note fish allowed at once
+    int                 numObjects;
+
+    BOOL                optInteract;
+    BOOL                optSound;
+    BOOL                optCollision;   // starts as COLLISION
+
+    SimSceneTables      tables;
+    SimFrameStats       stats;          // stats for the frame in progress / last frame
+    SimProfiler         *profiler;      // times each phase when set, not owned
+    SimJournal          *journal;       // records every frame and input when set, not owned
+
+    SimWorld();
+    ~SimWorld();
+
+    // scene setup / teardown
+    void loadScene(const SimSceneTables &sceneTables, int width, int height);   // loadPapercut
+    void initBorder();
+    void initScene();
+    void resetWorld();
+
+    // main update, timestamp in seconds like CADisplayLink.timestamp,
+    //   stats cover every tick run for the frame
+    const SimFrameStats& stepFrame(double timestamp);
+
+    // threads the walk is gathered on, the caller included, 0 = one per core;
+    //   the world steps exactly the same whatever the count
+    void setThreads(int numThreads)     { walkPool.start(numThreads); }
+    int numThreads() const              { return walkPool.numThreads(); }
+
+    // input
+    void touchBegan(SimPoint currentPos);
+    void touchMoved(SimPoint beginPos, SimPoint currentPos);
+    void touchEnded(SimPoint firstTouch, SimPoint lastTouch);
+    void chimeSwipe(BOOL dirLeft, CGFloat xLeft, CGFloat xRight);
+    void shake();
+    void accelerate(CGFloat x);
+    void pinch(SimPoint touchPos, CGFloat scale);           // pinchPaper, scale since the last call
+    BOOL touchSpotRect(int spawnID, SimRect *rect) const;  // current touchspot of a piece, in view coordinates
+
+    // a recorded frame or input, into a world loaded with the journal's
+    //   scene after seeding SimRandom with its seed
+    void replay(const SimJournalEvent &event);
+
+    // world states
+    BOOL isStateOn(ObjState os) const   { return ((osFlags & os) == os); }
+    void turnOnState(ObjState os)       { if (!isStateOn(os)) { osFlags |= os; } }
+    void turnOffState(ObjState os)      { if (isStateOn(os)) { osFlags ^= os; } }
+    void turnOffAllStates()             { osFlags = 0; }
+
+    // objects
+    void addObj(SimPaper *paperPiece, ObjTag tag);
+    void addObj(SimPaper *paperPiece, BOOL spawned);
+    void delObj(SimPaper *paperPiece);
+    SimPaper* getObject(int objID) const        { return objects.find(objID); }
+    SimPaper* getObject(SimHandle h) const      { return objects.get(h); }
+    SimPaper* objTouched(SimPoint touchPos);
+    void objsTouched(const std::vector<SimPoint> &touchPos, std::vector<SimPaper*> &touched);
+
+    void addToView(SimPaper *paperPiece);
+    void changeZPosition(SimHandle h, int zPos);    // to the top of that layer, i.e. a pinch piece under a popup
+    void addToShakeQueue(int objID)     { queue_shake.push_back(objID); }
+    void addToCleanQueue(SimHandle h);
+    void removeFromCleanQueue(SimHandle h);
+
+    // world timers
+    void addWorldTimer(const SimTimer &objTimer, WorldTimer wt);
+    void updateWorldTimers();
+    void turnWorldTimer(WorldTimer wt, BOOL isOn);
+    void processWorldTimers();
+    BOOL isWorldTimerOn(WorldTimer wt) const;
+
+    // movement helpers
+    void collidePiece(SimPaper *piece1, SimPaper *piece2);
+    void updateDirection(SimPaper *imagePiece);
+    SimTransform imageTransform(SimPaper *imagePiece, CGFloat scale = 1.0);
+    BOOL leftTopHalf(const SimPaper *imagePiece) const;
+    SimPoint keepInBounds(SimPaper *pPiece, ViewCheckType vcType);
+    void updateGroup(SimPaper *mstrPiece, SimTransform mstrTransform = SimTransform());
+
+    // spawning
+    SimPaper* spawnPiece(SimPaper *touchedPiece, BOOL child);
+    SimPaper* spawnPiece(SimPaper *touchedPiece, int childImg, BOOL child);
+    SimPaper* spawnPiece(SimPaper *parentPiece, int obj, int child, BOOL spawn, SimPoint pos);
+    SimPaper* spawnPiece(int objID, BOOL spawn = YES);
+    SimPaper* spawnPiece(int objID, SimPoint pos);
+
+    void killPiece(SimPaper *piece);
+    BOOL maxObjectsReached() const      { return (numObjects >= MAX_OBJECTS); }
+    const std::vector<SimPaper*>& findNeighbors(SimPaper *piece);
+
+    void playSound(int sID)             { (void)sID; stats.sounds++; }
+
+    // the next piece's own random numbers, pieces are built in the same
+    //   order every run so each one gets the same stream
+    SimRandomStream newPieceStream()    { return SimRandomStreamFor(pieceStreams++); }
+
+    // path movers, NULL when the path can't be found in the path directory
+    void setPathDirectory(const char *dir);
+    const SimPathSampler* pathSampler(int objID, const char *imagePath, int pathIndex);
+
+private:
+    SimPaper* newPiece(int objID, const SimPaper *parentPiece);
+    void releasePiece(SimPaper *paperPiece);
+    void prewarmPools();
+    void markSpawnRow(int objID);
+    void clearPools();
+    void stepTick(CGFloat frameTime);
+    void gatherChunk(size_t chunk, int worker);
+    static void gatherWork(void *context, size_t chunk, int worker);
+    SimPoint beginMove(SimPaper *eachPiece, size_t p, SimTransform *transformPiece, SimWalkTiming &timing);
+    void movePiece(size_t p, CGFloat frameTime, SimWalkTiming &timing);
+    void insertViews();
+    void buildFlockGrid();
+    void findCollisions();
+    void markLinked();
+    void commitForceBatch();
+    void samplePaths(CGFloat frameTime);
+    void destroyQueued();
+
+    std::vector<SimPaper*>  flockPieces;        // scratch for buildFlockGrid
+    std::vector<SimPoint>   flockCenters;
+    std::vector<SimPaper*>  flockNeighbors;     // scratch for findNeighbors
+
+    SimBroadphase           collisionBroadphase;
+    std::vector<SimPoint>   collisionPush;      // per packed piece, how far to move it apart
+    std::vector<char>       collisionHit;       // per packed piece, YES if it collided this frame
+
+    SimIntegrator           forceBatch;         // drift / bob / decel pieces gathered during the walk
+    std::vector<uint32_t>   batchPieces;        // packed index of each batched piece
+    std::vector<SimVector>  batchDest;          // paperDest of each batched piece
+
+    std::vector<SimPaper*>  queue_destroy;      // flagged for removal during the walk, torn down once it's done
+    std::vector<SimPaper*>  insertPieces;       // scratch for insertViews
+
+    SimWorkPool                 walkPool;       // gathers the walk
+    std::vector<SimWalkChunk>   walkChunks;     // by chunk, merged in order by the commit
+
+    // each path flattened once, by objID and path index
+    SimPathCache                                pathCache;
+    std::unordered_map<int, SimPathSampler>     pathSamplers;
+    std::vector<SimPaper*>                      pathPieces;     // scratch for samplePaths
+    std::vector<CGFloat>                        pathFractions;
+    std::vector<SimPoint>                       pathPositions;
+    std::vector<SimVector>                      pathTangents;
+
+    // retired pieces by props row, already destroyed and waiting to be built
+    //   again in place, so spawning and killing never touch the heap; each
+    //   holds up to poolCaps of its row, 0 for rows that never spawn
+    std::vector<std::vector<SimPaper*> >    piecePools;
+    std::vector<size_t>                     poolCaps;
+
+    SimHitIndex             hitIndex;           // touch hit-testing, rebuilt on demand each frame
+    int                     viewCount;          // subviews added so far
+
+    SimWorld(const SimWorld&);
+    SimWorld& operator=(const SimWorld&);
+};
+
+#endif
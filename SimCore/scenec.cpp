@@ -0,0 +1,83 @@
+//
+//  scenec.cpp
+//  Papercut
+//
+//  Build-time scene converter.  Writes each built-in story's property
+//    tables (Variables.h) out as a .pcs in SimSceneFormat, so the app
+//    can map a story in place instead of compiling it in.  The tables
+//    it writes have already passed SIM_SCENE's checks, and every file is
+//    loaded back and checked again before scenec reports success.
+//    "make scenes" runs it over every built-in story.
+//
+//  usage: scenec [-o DIR] [-v] SCENE ...
+//    -o    directory to write the .pcs files to (default: the current one)
+//    -v    print each scene's row counts and size
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "SimSceneFile.h"
+
+static void usage() {
+    fprintf(stderr, "usage: scenec [-o DIR] [-v] SCENE ...\n");
+}
+
+int main(int argc, char *argv[]) {
+
+    std::string outDir;
+    bool verbose = false;
+    std::vector<const char*> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))     { outDir = argv[++i]; }
+        else if (strcmp(argv[i], "-v") == 0)                    { verbose = true; }
+        else if (argv[i][0] == '-')                             { usage(); return 1; }
+        else                                                    { inputs.push_back(argv[i]); }
+    }
+
+    if (inputs.empty()) { usage(); return 1; }
+
+    int failed = 0;
+    std::vector<uint8_t> data;
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+
+        SimSceneTables scene;
+        if (!simBuiltInScene(inputs[i], &scene)) {
+            fprintf(stderr, "scenec: no built-in scene named %s\n", inputs[i]);
+            failed++;
+            continue;
+        }
+
+        std::string output = (outDir.empty() ? std::string(inputs[i]) : (outDir + "/" + inputs[i])) + "." SIM_SCENE_EXT;
+
+        SimSceneFile::serialize(scene, inputs[i], data);
+
+        FILE *file = fopen(output.c_str(), "wb");
+        if ((!file) || (fwrite(&data[0], 1, data.size(), file) != data.size())) {
+            fprintf(stderr, "scenec: couldn't write %s\n", output.c_str());
+            if (file) { fclose(file); }
+            failed++;
+            continue;
+        }
+        fclose(file);
+
+        SimSceneFile check;
+        if (!check.load(output.c_str())) {
+            fprintf(stderr, "scenec: %s doesn't read back\n", output.c_str());
+            failed++;
+            continue;
+        }
+
+        if (verbose) {
+            printf("%s  %d objects  %d animations  %d touchspots  %d groups  %d sounds  %d timers  %d bytes\n",
+                   output.c_str(), scene.numProps - 1, scene.numAnim - 1, scene.numTouch - 1, scene.numGroups - 1,
+                   scene.numSounds - 1, scene.numTimers - 1, (int)data.size());
+        }
+    }
+
+    return (failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,348 @@
+//
+//  simbench.cpp
+//  Papercut
+//
+//  Command line driver for the headless simulation core.  Loads the
+//    Mermaids tables, steps the world at a fixed display rate and prints
+//    how long each frame took, how many heap allocations it made and how
+//    many pieces went through the batch integrator, along with a summary
+//    at the end.
+//
+//  usage: simbench [-frames N] [-fps N] [-drop N] [-touch N] [-school N] [-collide N] [-paths DIR] [-scene FILE] [-threads N] [-trace FILE] [-csv FILE]
+//                  [-seed N] [-record FILE] [-replay FILE] [-quiet]
+//    -frames   number of frames to step (default 600)
+//    -fps      display rate used for the timestamps (default 60)
+//    -drop     skip every Nth display frame, as if it had been dropped (default 0 = never)
+//    -touch    tap the Mermaid01 touchspot every N frames (default 0 = never)
+//    -school   start with N flocking note fish in the clean queue (default 0)
+//    -collide  turn collisions on and add N extra collidable touch pieces (default off)
+//    -paths    directory of P_*.pcp / P_*.svg paths for the path movers to follow (default none)
+//    -scene    step the story in a .pcs file (see scenec) instead of the built-in Mermaids tables
+//    -threads  threads the walk is gathered on, 0 = one per core (default 1)
+//    -trace    profile each phase and write the last SIM_PROFILE_HISTORY seconds as a Chrome trace
+//    -csv      profile each phase and write a per-phase summary as CSV
+//    -seed     seed for SimRandom (default a fresh one, printed in the summary)
+//    -record   write every frame and input to a journal (SimJournal.h)
+//    -replay   step the frames and input of a journal instead of -frames / -fps / -drop / -touch,
+//              with its seed; give it the -scene, -school and -collide the recording had
+//    -quiet    only print the summary
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <vector>
+
+#include "SimWorld.h"
+#include "SimPaper.h"
+#include "SimSceneFile.h"
+
+// every operator new in the process goes through here so frames can be
+//   checked for heap allocations
+static long allocCount = 0;
+
+void* operator new(size_t size) {
+    allocCount++;
+    void *ptr = malloc((size > 0) ? size : 1);
+    if (ptr == NULL) { throw std::bad_alloc(); }
+    return ptr;
+}
+
+void* operator new[](size_t size)                   { return operator new(size); }
+void operator delete(void *ptr) noexcept            { free(ptr); }
+void operator delete[](void *ptr) noexcept          { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept    { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept  { free(ptr); }
+
+static void usage() {
+    fprintf(stderr, "usage: simbench [-frames N] [-fps N] [-drop N] [-touch N] [-school N] [-collide N] [-paths DIR] [-scene FILE] [-threads N] [-trace FILE] [-csv FILE]\n"
+                    "                [-seed N] [-record FILE] [-replay FILE] [-quiet]\n");
+}
+
+static double percentile(const std::vector<double> &sorted, double pct) {
+    if (sorted.empty()) { return 0.0; }
+    size_t idx = (size_t)((pct / 100.0) * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+int main(int argc, char *argv[]) {
+
+    int numFrames = 600;
+    int displayRate = 60;
+    int dropEvery = 0;
+    int touchEvery = 0;
+    int schoolSize = 0;
+    int numColliders = -1;
+    const char *pathDir = NULL;
+    const char *sceneFile = NULL;
+    int numThreads = 1;
+    const char *traceFile = NULL;
+    const char *csvFile = NULL;
+    uint64_t seed = SimRandomNewSeed();
+    const char *recordFile = NULL;
+    const char *replayFile = NULL;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-frames") == 0) && (i + 1 < argc))         { numFrames = atoi(argv[++i]); }
+        else if ((strcmp(argv[i], "-fps") == 0) && (i + 1 < argc))       { displayRate = atoi(argv[++i]); }
+        else if ((strcmp(argv[i], "-drop") == 0) && (i + 1 < argc))      { dropEvery = atoi(argv[++i]); }
+        else if ((strcmp(argv[i], "-touch") == 0) && (i + 1 < argc))     { touchEvery = atoi(argv[++i]); }
+        else if ((strcmp(argv[i], "-school") == 0) && (i + 1 < argc))    { schoolSize = atoi(argv[++i]); }
+        else if ((strcmp(argv[i], "-collide") == 0) && (i + 1 < argc))   { numColliders = atoi(argv[++i]); }
+        else if ((strcmp(argv[i], "-paths") == 0) && (i + 1 < argc))     { pathDir = argv[++i]; }
+        else if ((strcmp(argv[i], "-scene") == 0) && (i + 1 < argc))     { sceneFile = argv[++i]; }
+        else if ((strcmp(argv[i], "-threads") == 0) && (i + 1 < argc))   { numThreads = atoi(argv[++i]); }
+        else if ((strcmp(argv[i], "-trace") == 0) && (i + 1 < argc))     { traceFile = argv[++i]; }
+        else if ((strcmp(argv[i], "-csv") == 0) && (i + 1 < argc))       { csvFile = argv[++i]; }
+        else if ((strcmp(argv[i], "-seed") == 0) && (i + 1 < argc))      { seed = strtoull(argv[++i], NULL, 10); }
+        else if ((strcmp(argv[i], "-record") == 0) && (i + 1 < argc))    { recordFile = argv[++i]; }
+        else if ((strcmp(argv[i], "-replay") == 0) && (i + 1 < argc))    { replayFile = argv[++i]; }
+        else if (strcmp(argv[i], "-quiet") == 0)                         { quiet = true; }
+        else { usage(); return 1; }
+    }
+
+    if ((numFrames <= 0) || (displayRate <= 0) || (dropEvery < 0) || (schoolSize < 0) || (numThreads < 0)) { usage(); return 1; }
+    if ((replayFile) && ((recordFile) || (touchEvery > 0) || (dropEvery > 0))) { usage(); return 1; }
+
+    // a replay takes its frames, input and seed from the journal
+    SimJournal *replay = NULL;
+    if (replayFile) {
+        FILE *in = fopen(replayFile, "rb");
+        replay = SimJournalRead(in);
+        if (in) { fclose(in); }
+
+        if ((replay == NULL) || (SimJournalFrames(replay) == 0)) {
+            fprintf(stderr, "simbench: %s is not a journal with frames in it\n", replayFile);
+            return 1;
+        }
+        numFrames = (int)SimJournalFrames(replay);
+        seed = SimJournalSeed(replay);
+    }
+
+    // the scene file's tables are read in place, so it outlives the world
+    SimSceneFile scene;
+    SimSceneTables sceneTables = simMermaidsScene();
+    double sceneLoadTime = 0.0;
+
+    if (sceneFile) {
+        std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+        if (!scene.load(sceneFile)) {
+            fprintf(stderr, "simbench: %s is not a valid scene file\n", sceneFile);
+            return 1;
+        }
+        sceneLoadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+        sceneTables = scene.tables();
+    }
+
+    const char *sceneName = (sceneFile) ? scene.name() : "mermaids";
+    if ((replay) && (strcmp(SimJournalSceneName(replay), sceneName) != 0)) {
+        fprintf(stderr, "simbench: %s was recorded in %s, not %s\n", replayFile, SimJournalSceneName(replay), sceneName);
+        return 1;
+    }
+
+    // everything random from here on, loading included, comes from the seed
+    SimRandomSeed(seed);
+
+    SimWorld world;
+    world.setThreads(numThreads);
+
+    SimProfiler *profiler = NULL;
+    if ((traceFile) || (csvFile)) {
+        profiler = SimProfilerCreate(SIM_PROFILE_HISTORY);
+        world.profiler = profiler;
+    }
+    SimJournal *journal = NULL;
+    if (recordFile) {
+        journal = SimJournalCreate(sceneName, seed, SIM_VIEW_WIDTH, SIM_VIEW_HEIGHT);
+        world.journal = journal;
+    }
+
+    if (pathDir) { world.setPathDirectory(pathDir); }
+    world.loadScene(sceneTables,
+                    (replay) ? SimJournalViewWidth(replay) : SIM_VIEW_WIDTH,
+                    (replay) ? SimJournalViewHeight(replay) : SIM_VIEW_HEIGHT);
+
+    // scatter a school of note fish, as if that many notes had been played
+    for (int i = 0; i < schoolSize; i++) {
+        SimPoint fishPos(SimRandomUniform(SIM_VIEW_WIDTH), SimRandomUniform(SIM_VIEW_HEIGHT));
+        SimPaper *fishPiece = world.spawnPiece(19, fishPos);
+        world.addToView(fishPiece);
+        world.addToCleanQueue(fishPiece->handle);
+    }
+
+    // crowd the scene with extra copies of the collidable touch pieces
+    if (numColliders >= 0) {
+        world.optCollision = YES;
+        for (int i = 0; i < numColliders; i++) {
+            SimPoint colPos(SimRandomUniform(SIM_VIEW_WIDTH), SimRandomUniform(SIM_VIEW_HEIGHT));
+            SimPaper *colPiece = world.spawnPiece(2 + (i % 2), colPos);
+            world.addToView(colPiece);
+            if (colPiece->collision) { world.addObj(colPiece, otCollision); }
+        }
+    }
+
+    std::vector<double> frameMs;
+    frameMs.reserve(numFrames);
+    double collideTotal = 0.0;
+    long collideCount = 0;
+    long batchedTotal = 0;
+    long tickTotal = 0;
+    long pathTotal = 0;
+    int dropped = 0;
+    double timestamp = 0.0;
+    long allocTotal = 0;
+    int allocFrames = 0;        // frames that allocated at all
+    int allocQuietFrames = 0;   // ... without spawning or messaging
+    long spawnTotal = 0;
+    long recycledTotal = 0;     // spawns built in a pooled piece
+    long poolAllocTotal = 0;    // spawns past their row's pool cap
+    long destroyTotal = 0;
+    int destroyFrames = 0;      // frames that tore down flagged pieces
+    int destroyMost = 0;        // ... and the most in one frame
+    size_t replayOffset = 0;
+    SimJournalEvent replayEvent;
+
+    for (int i = 0; i < numFrames; i++) {
+
+        // a recorded frame's input, up to its timestamp
+        if (replay) {
+            while ((replayOffset = SimJournalNext(replay, replayOffset, &replayEvent)) != 0) {
+                if (replayEvent.type == sjFrame) { break; }
+                world.replay(replayEvent);
+            }
+            if (replayOffset == 0) { break; }
+            timestamp = replayEvent.timestamp;
+        }
+
+        // tap the middle of the mermaid's touchspot to spawn notes
+        if ((touchEvery > 0) && (i > 0) && ((i % touchEvery) == 0)) {
+            SimRect tsRect;
+            if (world.touchSpotRect(5, &tsRect)) {
+                world.touchBegan(tsRect.center());
+            }
+        }
+
+        // a dropped frame just never gets stepped, the next one sees the gap
+        if (!replay) {
+            timestamp += 1.0 / displayRate;
+            if ((dropEvery > 0) && ((i % dropEvery) == (dropEvery - 1))) {
+                timestamp += 1.0 / displayRate;
+                dropped++;
+            }
+        }
+
+        long allocStart = allocCount;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const SimFrameStats &fStats = world.stepFrame(timestamp);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        long allocs = allocCount - allocStart;
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        frameMs.push_back(ms);
+        collideTotal += fStats.collisionMs;
+        collideCount += fStats.collisions;
+        batchedTotal += fStats.batched;
+        tickTotal += fStats.ticks;
+        pathTotal += fStats.pathSamples;
+        spawnTotal += fStats.spawned;
+        recycledTotal += fStats.recycled;
+        poolAllocTotal += fStats.poolAllocs;
+        destroyTotal += fStats.destroyed;
+        if (fStats.destroyed > 0) {
+            destroyFrames++;
+            destroyMost = std::max(destroyMost, fStats.destroyed);
+        }
+
+        allocTotal += allocs;
+        if (allocs > 0) {
+            allocFrames++;
+            if ((fStats.spawned == 0) && (fStats.messages == 0)) { allocQuietFrames++; }
+        }
+
+        if (!quiet) {
+            printf("frame %5d  %8.4f ms  ticks %d  objects %3d  spawned %2d  removed %d (%d flagged)  messages %d  batched %d  collisions %d/%d %.4f ms  allocs %ld\n",
+                   fStats.frame, ms, fStats.ticks, fStats.numObjects, fStats.spawned, fStats.removed, fStats.destroyed, fStats.messages,
+                   fStats.batched, fStats.collisions, fStats.collisionPairs, fStats.collisionMs, allocs);
+        }
+    }
+
+    std::vector<double> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0.0;
+    for (size_t i = 0; i < frameMs.size(); i++) { total += frameMs[i]; }
+
+    printf("frames %d  objects %d  avg %.4f ms  min %.4f  max %.4f  p50 %.4f  p95 %.4f  p99 %.4f\n",
+           numFrames, (int)world.objects.size(), total / numFrames,
+           sorted.front(), sorted.back(),
+           percentile(sorted, 50.0), percentile(sorted, 95.0), percentile(sorted, 99.0));
+
+    printf("allocations %ld  frames allocating %d  without spawns or messages %d\n",
+           allocTotal, allocFrames, allocQuietFrames);
+
+    printf("spawns %ld  from the piece pool %ld  past the pool cap %ld\n", spawnTotal, recycledTotal, poolAllocTotal);
+
+    printf("flagged pieces torn down %ld  in %d frames  most in one frame %d\n", destroyTotal, destroyFrames, destroyMost);
+
+    printf("messages dropped on a full queue %ld\n", world.messenger.overflow());
+
+    printf("ticks %ld  dropped frames %d  display time %.3f s  simulated time %.3f s\n",
+           tickTotal, dropped, timestamp, world.elapsedTime);
+
+    printf("walk threads %d  seed %llu\n", world.numThreads(), (unsigned long long)seed);
+
+    printf("batch integrator %s  avg %.1f pieces per frame\n",
+           SimIntegrator::kernelName(), (double)batchedTotal / numFrames);
+
+    if (sceneFile) {
+        printf("scene %s  %d bytes mapped  loaded in %.3f ms\n", scene.name(), (int)scene.fileSize(), sceneLoadTime);
+    }
+
+    if (pathDir) {
+        printf("path samples %ld  avg %.1f path movers per frame\n", pathTotal, (double)pathTotal / numFrames);
+    }
+
+    if (world.optCollision) {
+        printf("collisions %ld  avg %.4f ms per frame\n", collideCount, collideTotal / numFrames);
+    }
+
+    if (replay) {
+        printf("replayed %s  %d frames  %d bytes of input\n", replayFile, (int)frameMs.size(), (int)SimJournalSize(replay));
+        SimJournalDestroy(replay);
+    }
+
+    if (journal) {
+        FILE *out = fopen(recordFile, "wb");
+        int result = SimJournalWrite(journal, out);
+        if (out) { fclose(out); }
+
+        if (result != 0) { fprintf(stderr, "simbench: couldn't write %s\n", recordFile); }
+        else             { printf("journal written to %s  %d frames  %d bytes\n", recordFile, (int)SimJournalFrames(journal), (int)SimJournalSize(journal)); }
+
+        world.journal = NULL;
+        SimJournalDestroy(journal);
+    }
+
+    if (profiler) {
+        const char *outFiles[2] = { traceFile, csvFile };
+        for (int f = 0; f < 2; f++) {
+            if (!outFiles[f]) { continue; }
+
+            FILE *out = fopen(outFiles[f], "w");
+            int result = (f == 0) ? SimProfilerWriteTrace(profiler, out) : SimProfilerWriteCSV(profiler, out);
+            if (out) { fclose(out); }
+
+            if (result != 0) { fprintf(stderr, "simbench: couldn't write %s\n", outFiles[f]); }
+            else             { printf("profile written to %s\n", outFiles[f]); }
+        }
+
+        world.profiler = NULL;
+        SimProfilerDestroy(profiler);
+    }
+
+    return 0;
+}
@@ -0,0 +1,394 @@
+//
+//  simsuite.cpp
+//  Papercut
+//
+//  Benchmark suite over synthetic scenes (SimSynthScene).  Steps a scene
+//    at each population from MAX_OBJECTS up to 10,000 pieces and
+//    reports, per population, the frame time percentiles, how many
+//    piece updates a second the world got through, and what each phase
+//    cost per piece (from SimProfiler).  The results can be written as
+//    CSV and compared against a CSV from an earlier run, to see where
+//    the engine stops fitting a frame and to catch regressions.
+//
+//  usage: simsuite [-sizes N,N,...] [-frames N] [-warmup N] [-threads N] [-paths DIR] [-o FILE] [-baseline FILE] [-tolerance PCT]
+//    -sizes        populations to step (default 60,250,1000,2500,5000,10000)
+//    -frames       frames measured at each population (default 600)
+//    -warmup       frames stepped first and not measured (default 60)
+//    -threads      threads the walk is gathered on, 0 = one per core (default 0)
+//    -paths        directory of P_*.pcp / P_*.svg paths for the path movers (default none, they stay put)
+//    -o            write the results as CSV
+//    -baseline     compare against the CSV of an earlier run, exits with 3 if anything regressed
+//    -tolerance    how much slower than the baseline still passes, in percent (default 15)
+//
+//  "make suite" runs it against suite_baseline.csv when there is one,
+//    "make baseline" records a new one.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "SimWorld.h"
+#include "SimSynthScene.h"
+
+#define SUITE_HARVEST_FRAMES    30      // frames between reads of the profiler's ring
+#define SUITE_MAX_COLUMNS       64
+#define SUITE_NOISE_NS          5.0     // phases cheaper than this per piece are below the clock's noise
+
+// results at one population
+typedef struct {
+    int     objects;            // after the last frame
+    int     frames;
+    double  avgMs;
+    double  p50Ms;
+    double  p95Ms;
+    double  p99Ms;
+    double  p999Ms;
+    double  maxMs;
+    int     overBudget;         // frames over SIM_PROFILE_BUDGET_MS
+    double  updatesPerSec;      // piece updates per second of stepping
+    double  phaseNs[spNumPhases];   // per piece update
+} SuiteResult;
+
+static void usage() {
+    fprintf(stderr, "usage: simsuite [-sizes N,N,...] [-frames N] [-warmup N] [-threads N] [-paths DIR] [-o FILE] [-baseline FILE] [-tolerance PCT]\n");
+}
+
+static double percentile(const std::vector<double> &sorted, double pct) {
+    if (sorted.empty()) { return 0.0; }
+    size_t idx = (size_t)((pct / 100.0) * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+// ___ RUNNING
+
+// the profiler's events for frames after lastFrame, added into phaseNs
+static void harvest(SimProfiler *profiler, std::vector<SimProfileEvent> &events, uint32_t firstFrame, uint32_t *lastFrame, double *phaseNs) {
+
+    size_t count = SimProfilerSnapshot(profiler, &events[0], events.size());
+    uint32_t newest = *lastFrame;
+
+    for (size_t i = 0; i < count; i++) {
+        const SimProfileEvent &e = events[i];
+        if ((e.frame <= *lastFrame) || (e.frame < firstFrame) || (e.phase >= spNumPhases)) { continue; }
+        phaseNs[e.phase] += (double)(e.end - e.start);
+        newest = std::max(newest, e.frame);
+    }
+
+    *lastFrame = newest;
+}
+
+static bool runPopulation(int population, int numFrames, int warmup, int numThreads, const char *pathDir, SuiteResult *result) {
+
+    SimSynthScene synth;
+    if (!synth.build(population, simDefaultSynthMix())) {
+        fprintf(stderr, "simsuite: couldn't build a scene of %d pieces\n", population);
+        return false;
+    }
+
+    SimProfiler *profiler = SimProfilerCreate(SIM_PROFILE_HISTORY);
+    std::vector<SimProfileEvent> events(SimProfilerCapacity(profiler));
+
+    SimWorld world;
+    world.setThreads(numThreads);
+    world.profiler = profiler;
+    if (pathDir) { world.setPathDirectory(pathDir); }
+    world.loadScene(synth.tables(), SIM_VIEW_WIDTH, SIM_VIEW_HEIGHT);
+    synth.populate(world);
+
+    std::vector<double> frameMs;
+    frameMs.reserve(numFrames);
+    double phaseNs[spNumPhases] = { 0.0 };
+    double totalMs = 0.0;
+    long pieceTicks = 0;
+    double timestamp = 0.0;
+    uint32_t lastFrame = 0;
+
+    // profiler frames are counted from 1, the measured ones come after the warmup
+    uint32_t firstFrame = (uint32_t)warmup + 1;
+
+    for (int i = 0; i < warmup + numFrames; i++) {
+
+        timestamp += 1.0 / 60.0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const SimFrameStats &fStats = world.stepFrame(timestamp);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        if (i >= warmup) {
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            frameMs.push_back(ms);
+            totalMs += ms;
+            pieceTicks += (long)fStats.numObjects * fStats.ticks;
+        }
+
+        // read the ring well before it wraps
+        if (((i + 1) % SUITE_HARVEST_FRAMES) == 0) {
+            harvest(profiler, events, firstFrame, &lastFrame, phaseNs);
+        }
+    }
+    harvest(profiler, events, firstFrame, &lastFrame, phaseNs);
+
+    std::vector<double> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+
+    result->objects = (int)world.objects.size();
+    result->frames = numFrames;
+    result->avgMs = totalMs / numFrames;
+    result->p50Ms = percentile(sorted, 50.0);
+    result->p95Ms = percentile(sorted, 95.0);
+    result->p99Ms = percentile(sorted, 99.0);
+    result->p999Ms = percentile(sorted, 99.9);
+    result->maxMs = sorted.back();
+    result->overBudget = (int)(sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), SIM_PROFILE_BUDGET_MS));
+    result->updatesPerSec = (totalMs > 0.0) ? (pieceTicks / (totalMs / 1000.0)) : 0.0;
+    for (int p = 0; p < spNumPhases; p++) {
+        result->phaseNs[p] = (pieceTicks > 0) ? (phaseNs[p] / pieceTicks) : 0.0;
+    }
+
+    world.profiler = NULL;
+    SimProfilerDestroy(profiler);
+
+    return true;
+}
+
+// ___ RESULTS FILES
+
+// every column a result has, in the order it's written
+static int resultColumns(const SuiteResult &r, std::vector<std::string> *names, double *values) {
+
+    const char *fixed[] = { "objects", "frames", "avg ms", "p50 ms", "p95 ms", "p99 ms", "p99.9 ms", "max ms",
+                            "over budget", "updates per s" };
+    double fixedValues[] = { (double)r.objects, (double)r.frames, r.avgMs, r.p50Ms, r.p95Ms, r.p99Ms, r.p999Ms, r.maxMs,
+                             (double)r.overBudget, r.updatesPerSec };
+    int n = 0;
+
+    for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++, n++) {
+        if (names) { names->push_back(fixed[i]); }
+        values[n] = fixedValues[i];
+    }
+
+    for (int p = 0; p < spNumPhases; p++, n++) {
+        if (names) { names->push_back(std::string(SimProfilePhaseName((SimProfilePhase)p)) + " ns"); }
+        values[n] = r.phaseNs[p];
+    }
+
+    return n;
+}
+
+static bool writeResults(const char *filename, const std::vector<SuiteResult> &results) {
+
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) { return false; }
+
+    std::vector<std::string> names;
+    double values[SUITE_MAX_COLUMNS];
+    int numColumns = resultColumns(SuiteResult(), &names, values);
+
+    for (int c = 0; c < numColumns; c++) { fprintf(file, "%s%s", (c > 0) ? "," : "", names[c].c_str()); }
+    fprintf(file, "\n");
+
+    for (size_t i = 0; i < results.size(); i++) {
+        resultColumns(results[i], NULL, values);
+        for (int c = 0; c < numColumns; c++) { fprintf(file, "%s%.6g", (c > 0) ? "," : "", values[c]); }
+        fprintf(file, "\n");
+    }
+
+    bool ok = (ferror(file) == 0);
+    fclose(file);
+    return ok;
+}
+
+// a results CSV as its header and rows, columns are matched up by name
+typedef struct {
+    std::vector<std::string>            names;
+    std::vector<std::vector<double> >   rows;
+} SuiteTable;
+
+static void splitLine(char *line, std::vector<std::string> &fields) {
+    fields.clear();
+    line[strcspn(line, "\r\n")] = '\0';
+    for (char *field = strtok(line, ","); field; field = strtok(NULL, ",")) { fields.push_back(field); }
+}
+
+static bool readResults(const char *filename, SuiteTable *table) {
+
+    FILE *file = fopen(filename, "r");
+    if (file == NULL) { return false; }
+
+    char line[4096];
+    std::vector<std::string> fields;
+
+    if (fgets(line, sizeof(line), file)) { splitLine(line, table->names); }
+
+    while (fgets(line, sizeof(line), file)) {
+        splitLine(line, fields);
+        if (fields.size() != table->names.size()) { continue; }
+
+        std::vector<double> row(fields.size());
+        for (size_t c = 0; c < fields.size(); c++) { row[c] = strtod(fields[c].c_str(), NULL); }
+        table->rows.push_back(row);
+    }
+
+    fclose(file);
+    return (!table->names.empty()) && (table->names[0] == "objects");
+}
+
+// ___ BASELINE
+
+// how much worse a result is than the baseline, as a fraction;
+//   throughput is worse when it's lower, everything else when it's higher
+static double slowdown(const std::string &name, double now, double then) {
+    if (then <= 0.0) { return 0.0; }
+    return (name == "updates per s") ? ((then - now) / then) : ((now - then) / then);
+}
+
+// metrics steady enough to fail a run on, the far tail is
+//   written out but moves too much from run to run
+static bool compared(const std::string &name) {
+    return (name != "objects") && (name != "frames") && (name != "over budget") &&
+           (name != "p99.9 ms") && (name != "max ms");
+}
+
+static bool belowNoise(const std::string &name, double now, double then) {
+    bool perPiece = (name.size() > 3) && (name.compare(name.size() - 3, 3, " ns") == 0);
+    return (perPiece) && (now < SUITE_NOISE_NS) && (then < SUITE_NOISE_NS);
+}
+
+static int compareBaseline(const SuiteTable &baseline, const std::vector<SuiteResult> &results, double tolerance) {
+
+    std::vector<std::string> names;
+    double values[SUITE_MAX_COLUMNS];
+    int numColumns = resultColumns(SuiteResult(), &names, values);
+    int regressions = 0;
+
+    printf("\nagainst the baseline, %.0f%% tolerance\n", tolerance * 100.0);
+
+    for (size_t i = 0; i < results.size(); i++) {
+
+        // the baseline row with the nearest population
+        const std::vector<double> *base = NULL;
+        for (size_t b = 0; b < baseline.rows.size(); b++) {
+            if ((!base) || (fabs(baseline.rows[b][0] - results[i].objects) < fabs((*base)[0] - results[i].objects))) {
+                base = &baseline.rows[b];
+            }
+        }
+        if ((!base) || (fabs((*base)[0] - results[i].objects) > 0.1 * results[i].objects)) {
+            printf("  %5d objects  no baseline\n", results[i].objects);
+            continue;
+        }
+
+        resultColumns(results[i], NULL, values);
+
+        for (int c = 0; c < numColumns; c++) {
+
+            if (!compared(names[c])) { continue; }
+
+            std::vector<std::string>::const_iterator it = std::find(baseline.names.begin(), baseline.names.end(), names[c]);
+            if (it == baseline.names.end()) { continue; }
+            double then = (*base)[it - baseline.names.begin()];
+            if (belowNoise(names[c], values[c], then)) { continue; }
+
+            double worse = slowdown(names[c], values[c], then);
+            bool regressed = (worse > tolerance);
+            if (regressed) { regressions++; }
+
+            // only the frame times, and anything that moved past the tolerance either way
+            if ((regressed) || (worse < -tolerance) || (names[c] == "avg ms") || (names[c] == "p99 ms")) {
+                printf("  %5d objects  %-16s %12.4f -> %12.4f  %+6.1f%%%s\n",
+                       results[i].objects, names[c].c_str(), then, values[c],
+                       (then > 0.0) ? (((values[c] - then) / then) * 100.0) : 0.0,
+                       (regressed) ? "  REGRESSED" : "");
+            }
+        }
+    }
+
+    printf("regressions %d\n", regressions);
+    return regressions;
+}
+
+// ___ MAIN
+
+int main(int argc, char *argv[]) {
+
+    std::vector<int> sizes;
+    int numFrames = 600;
+    int warmup = 60;
+    int numThreads = 0;
+    const char *pathDir = NULL;
+    const char *outFile = NULL;
+    const char *baselineFile = NULL;
+    double tolerance = 15.0;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-sizes") == 0) && (i + 1 < argc)) {
+            char *list = argv[++i];
+            for (char *size = strtok(list, ","); size; size = strtok(NULL, ",")) { sizes.push_back(atoi(size)); }
+        }
+        else if ((strcmp(argv[i], "-frames") == 0) && (i + 1 < argc))      { numFrames = atoi(argv[++i]); }
+        else if ((strcmp(argv[i], "-warmup") == 0) && (i + 1 < argc))      { warmup = atoi(argv[++i]); }
+        else if ((strcmp(argv[i], "-threads") == 0) && (i + 1 < argc))     { numThreads = atoi(argv[++i]); }
+        else if ((strcmp(argv[i], "-paths") == 0) && (i + 1 < argc))       { pathDir = argv[++i]; }
+        else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))           { outFile = argv[++i]; }
+        else if ((strcmp(argv[i], "-baseline") == 0) && (i + 1 < argc))    { baselineFile = argv[++i]; }
+        else if ((strcmp(argv[i], "-tolerance") == 0) && (i + 1 < argc))   { tolerance = atof(argv[++i]); }
+        else { usage(); return 1; }
+    }
+
+    if (sizes.empty()) {
+        const int defaultSizes[] = { MAX_OBJECTS, 250, 1000, 2500, 5000, 10000 };
+        sizes.assign(defaultSizes, defaultSizes + sizeof(defaultSizes) / sizeof(defaultSizes[0]));
+    }
+
+    if ((numFrames <= 0) || (warmup < 0) || (numThreads < 0) || (tolerance < 0.0)) { usage(); return 1; }
+    for (size_t i = 0; i < sizes.size(); i++) {
+        if (sizes[i] <= 0) { usage(); return 1; }
+    }
+
+    // read the baseline first, no point running the suite against a bad one
+    SuiteTable baseline;
+    if ((baselineFile) && (!readResults(baselineFile, &baseline))) {
+        fprintf(stderr, "simsuite: %s is not a simsuite results file\n", baselineFile);
+        return 1;
+    }
+
+    std::vector<SuiteResult> results;
+    int fitsFrame = 0;      // largest population whose p99 fits the budget
+
+    printf("%7s %8s %8s %8s %8s %8s %8s %7s %12s  %s\n",
+           "objects", "avg ms", "p50", "p95", "p99", "p99.9", "max", "over", "updates/s", "ns per piece: move bounds transform force");
+
+    for (size_t i = 0; i < sizes.size(); i++) {
+
+        SuiteResult r;
+        if (!runPopulation(sizes[i], numFrames, warmup, numThreads, pathDir, &r)) { return 1; }
+        results.push_back(r);
+
+        if (r.p99Ms <= SIM_PROFILE_BUDGET_MS) { fitsFrame = std::max(fitsFrame, r.objects); }
+
+        printf("%7d %8.4f %8.4f %8.4f %8.4f %8.4f %8.4f %7d %12.0f  %.1f %.1f %.1f %.1f\n",
+               r.objects, r.avgMs, r.p50Ms, r.p95Ms, r.p99Ms, r.p999Ms, r.maxMs, r.overBudget, r.updatesPerSec,
+               r.phaseNs[spMove], r.phaseNs[spBounds], r.phaseNs[spTransform], r.phaseNs[spForce]);
+        fflush(stdout);
+    }
+
+    printf("fits a %.1f ms frame at p99 up to %d objects\n", SIM_PROFILE_BUDGET_MS, fitsFrame);
+
+    if (outFile) {
+        if (!writeResults(outFile, results)) {
+            fprintf(stderr, "simsuite: couldn't write %s\n", outFile);
+            return 1;
+        }
+        printf("results written to %s\n", outFile);
+    }
+
+    if ((baselineFile) && (compareBaseline(baseline, results, tolerance / 100.0) > 0)) {
+        return 3;
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+//
+//  svgpathc.cpp
+//  Papercut
+//
+//  Build-time path compiler.  Reads the first path out of each SVG the
+//    way PocketSVG does and writes it next to (or into -o) as a .pcp in
+//    SimPathFormat, so the app and SimCore can map it in place instead
+//    of parsing XML on every spawn.  "make paths" runs it over the art.
+//
+//  usage: svgpathc [-o DIR] [-v] FILE.svg ...
+//    -o    directory to write the .pcp files to (default: beside each .svg)
+//    -v    print each path's command count and size
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "SimPath.h"
+
+static void usage() {
+    fprintf(stderr, "usage: svgpathc [-o DIR] [-v] FILE.svg ...\n");
+}
+
+int main(int argc, char *argv[]) {
+
+    std::string outDir;
+    bool verbose = false;
+    std::vector<const char*> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))     { outDir = argv[++i]; }
+        else if (strcmp(argv[i], "-v") == 0)                    { verbose = true; }
+        else if (argv[i][0] == '-')                             { usage(); return 1; }
+        else                                                    { inputs.push_back(argv[i]); }
+    }
+
+    if (inputs.empty()) { usage(); return 1; }
+
+    int failed = 0;
+    SimPathBuilder builder;
+    std::vector<uint8_t> data;
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+
+        std::string input = inputs[i];
+        if (!builder.parseSVGFile(input.c_str())) {
+            fprintf(stderr, "svgpathc: no usable path in %s\n", input.c_str());
+            failed++;
+            continue;
+        }
+
+        // same name as the SVG, .svg swapped for .pcp
+        std::string name = input;
+        size_t slash = name.find_last_of('/');
+        size_t dot = name.find_last_of('.');
+        if ((dot != std::string::npos) && ((slash == std::string::npos) || (dot > slash))) { name = name.substr(0, dot); }
+        if (!outDir.empty() && (slash != std::string::npos)) { name = name.substr(slash + 1); }
+        std::string output = (outDir.empty() ? name : (outDir + "/" + name)) + "." SIM_PATH_EXT;
+
+        builder.serialize(data);
+
+        FILE *file = fopen(output.c_str(), "wb");
+        if ((!file) || (fwrite(&data[0], 1, data.size(), file) != data.size())) {
+            fprintf(stderr, "svgpathc: couldn't write %s\n", output.c_str());
+            if (file) { fclose(file); }
+            failed++;
+            continue;
+        }
+        fclose(file);
+
+        if (verbose) {
+            printf("%s  %d commands  %d bytes\n", output.c_str(), (int)builder.numCommands(), (int)data.size());
+        }
+    }
+
+    return (failed > 0) ? 1 : 0;
+}
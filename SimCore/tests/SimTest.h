@@ -0,0 +1,29 @@
+//
+//  SimTest.h
+//  Papercut
+//
+//  Bare check macro for the SimCore tests ("make -C SimCore test").  A
+//    failed check prints where and what, and the test exits non-zero
+//    once it's done.
+//
+
+#ifndef SIMCORE_SIMTEST_H
+#define SIMCORE_SIMTEST_H
+
+#include <stdio.h>
+
+static int simTestFailures = 0;
+
+#define SIM_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            simTestFailures++; \
+        } \
+    } while (0)
+
+// end of main
+#define SIM_TEST_RESULT(name) \
+    (printf("%s: %s\n", (name), (simTestFailures == 0) ? "ok" : "FAILED"), (simTestFailures == 0) ? 0 : 1)
+
+#endif
@@ -0,0 +1,257 @@
+//
+//  test_journal.cpp
+//  Papercut
+//
+//  SimJournal: every event type comes back from a written and read
+//    journal as it went in, truncated files and unknown event types are
+//    refused, and a recorded session replayed into a freshly loaded world
+//    ends up exactly where the recording did, every time.
+//
+
+#include <string.h>
+#include <vector>
+
+#include "../SimJournal.h"
+#include "../SimPaper.h"
+#include "../SimRandom.h"
+#include "../SimWorld.h"
+#include "SimTest.h"
+
+#define SESSION_SEED    2024
+#define SESSION_FRAMES  900
+
+// ___ FILES
+
+static std::vector<uint8_t> written(const SimJournal *journal) {
+
+    std::vector<uint8_t> bytes;
+    FILE *file = tmpfile();
+    if (file == NULL) { return bytes; }
+
+    if (SimJournalWrite(journal, file) == 0) {
+        long size = ftell(file);
+        bytes.resize((size_t)size);
+        rewind(file);
+        if ((size > 0) && (fread(&bytes[0], 1, bytes.size(), file) != bytes.size())) { bytes.clear(); }
+    }
+    fclose(file);
+    return bytes;
+}
+
+static SimJournal* readBytes(const std::vector<uint8_t> &bytes) {
+
+    FILE *file = tmpfile();
+    if (file == NULL) { return NULL; }
+
+    if (!bytes.empty()) { fwrite(&bytes[0], 1, bytes.size(), file); }
+    rewind(file);
+    SimJournal *journal = SimJournalRead(file);
+    fclose(file);
+    return journal;
+}
+
+static void testRoundTrip() {
+
+    SimJournal *journal = SimJournalCreate("mermaids", 0x0123456789abcdefull, 768, 1024);
+
+    const SimJournalEvent events[] = {
+        { sjFrame,       0.0166666666666667, 0, 0, 0, 0 },
+        { sjTouchBegan,  0, 12.5f, -3.25f, 0, 0 },
+        { sjTouchMoved,  0, 12.5f, -3.25f, 400.75f, 999.0f },
+        { sjTouchEnded,  0, 1.0f, 2.0f, 3.0f, 4.0f },
+        { sjShake,       0, 0, 0, 0, 0 },
+        { sjAccelerate,  0, -0.625f, 0, 0, 0 },
+        { sjPinch,       0, 300.0f, 200.0f, 1.125f, 0 },
+        { sjFrame,       12345.678901234, 0, 0, 0, 0 },
+    };
+    const size_t numEvents = sizeof(events) / sizeof(events[0]);
+
+    for (size_t i = 0; i < numEvents; i++) {
+        const SimJournalEvent &e = events[i];
+        switch (e.type) {
+            case sjFrame:       SimJournalFrame(journal, e.timestamp); break;
+            case sjTouchBegan:  SimJournalTouchBegan(journal, e.x, e.y); break;
+            case sjTouchMoved:  SimJournalTouchMoved(journal, e.x, e.y, e.x2, e.y2); break;
+            case sjTouchEnded:  SimJournalTouchEnded(journal, e.x, e.y, e.x2, e.y2); break;
+            case sjShake:       SimJournalShake(journal); break;
+            case sjAccelerate:  SimJournalAccelerate(journal, e.x); break;
+            case sjPinch:       SimJournalPinch(journal, e.x, e.y, e.x2); break;
+            default:            break;
+        }
+    }
+
+    std::vector<uint8_t> bytes = written(journal);
+    SimJournal *read = readBytes(bytes);
+    SIM_CHECK(read != NULL);
+    if (read == NULL) { SimJournalDestroy(journal); return; }
+
+    SIM_CHECK(strcmp(SimJournalSceneName(read), "mermaids") == 0);
+    SIM_CHECK(SimJournalSeed(read) == 0x0123456789abcdefull);
+    SIM_CHECK(SimJournalViewWidth(read) == 768);
+    SIM_CHECK(SimJournalViewHeight(read) == 1024);
+    SIM_CHECK(SimJournalFrames(read) == 2);
+    SIM_CHECK(SimJournalSize(read) == SimJournalSize(journal));
+
+    SimJournalEvent event;
+    size_t offset = 0;
+    for (size_t i = 0; i < numEvents; i++) {
+        offset = SimJournalNext(read, offset, &event);
+        SIM_CHECK(offset != 0);
+        if (offset == 0) { break; }
+
+        const SimJournalEvent &e = events[i];
+        SIM_CHECK(event.type == e.type);
+        if (e.type == sjFrame) { SIM_CHECK(event.timestamp == e.timestamp); }
+        else {
+            SIM_CHECK(event.x == e.x);
+            SIM_CHECK(event.y == e.y);
+            SIM_CHECK(event.x2 == e.x2);
+            SIM_CHECK(event.y2 == e.y2);
+        }
+    }
+    SIM_CHECK(SimJournalNext(read, offset, &event) == 0);
+
+    // cut anywhere short of the whole file, in the header or mid event
+    size_t headerSize = bytes.size() - SimJournalSize(journal);
+    for (size_t cut = 0; cut < bytes.size(); cut++) {
+        std::vector<uint8_t> truncated(bytes.begin(), bytes.begin() + cut);
+        SimJournal *bad = readBytes(truncated);
+        SIM_CHECK(bad == NULL);
+        if (bad) { SimJournalDestroy(bad); }
+    }
+
+    // an event length in the header that stops part way through an event
+    std::vector<uint8_t> shortLength(bytes);
+    uint32_t length = (uint32_t)SimJournalSize(journal) - 2;
+    for (int b = 0; b < 4; b++) { shortLength[headerSize - 4 + b] = (uint8_t)(length >> (8 * b)); }
+    SIM_CHECK(readBytes(shortLength) == NULL);
+
+    // unknown event types, first event and a later one
+    const uint8_t badTypes[] = { 0, (uint8_t)sjNumEvents, 0xff };
+    for (size_t t = 0; t < sizeof(badTypes); t++) {
+        std::vector<uint8_t> badFirst(bytes);
+        badFirst[headerSize] = badTypes[t];
+        SIM_CHECK(readBytes(badFirst) == NULL);
+
+        std::vector<uint8_t> badLater(bytes);
+        badLater[headerSize + 1 + 8] = badTypes[t];    // just past the first frame
+        SIM_CHECK(readBytes(badLater) == NULL);
+    }
+
+    // and not a journal at all
+    std::vector<uint8_t> badMagic(bytes);
+    badMagic[0] ^= 0xff;
+    SIM_CHECK(readBytes(badMagic) == NULL);
+
+    SimJournalDestroy(read);
+    SimJournalDestroy(journal);
+}
+
+// ___ REPLAY
+
+typedef struct {
+    int         objID;
+    int         spawnID;
+    CGFloat     x;
+    CGFloat     y;
+    CGFloat     velX;
+    CGFloat     velY;
+    CGFloat     scale;
+} PieceState;
+
+static std::vector<PieceState> worldState(const SimWorld &world) {
+
+    std::vector<PieceState> state;
+    for (size_t i = 0; i < world.objects.size(); i++) {
+        const SimPaper *piece = world.objects[i];
+        PieceState s = { piece->objID, piece->spawnID, piece->center.x, piece->center.y,
+                         piece->behavior.vel.x, piece->behavior.vel.y, piece->transform.a };
+        state.push_back(s);
+    }
+    return state;
+}
+
+static BOOL sameState(const std::vector<PieceState> &a, const std::vector<PieceState> &b) {
+    return ((a.size() == b.size()) &&
+            ((a.empty()) || (memcmp(&a[0], &b[0], a.size() * sizeof(PieceState)) == 0))) ? YES : NO;
+}
+
+// a made up session: taps on the mermaid, a drag, a shake, tilting and a pinch
+static std::vector<PieceState> record(SimJournal *journal) {
+
+    SimRandomSeed(SESSION_SEED);
+
+    SimWorld world;
+    world.journal = journal;
+    world.loadScene(simMermaidsScene(), SIM_VIEW_WIDTH, SIM_VIEW_HEIGHT);
+
+    double timestamp = 0.0;
+    for (int i = 0; i < SESSION_FRAMES; i++) {
+
+        SimRect tsRect;
+        if (((i % 25) == 0) && (world.touchSpotRect(5, &tsRect))) {
+            world.touchBegan(tsRect.center());
+        }
+        if ((i % 140) == 70) {
+            SimPoint from(200.0 + i % 300, 300.0);
+            SimPoint to(from.x + 150.0, from.y + 40.0);
+            world.touchBegan(from);
+            world.touchMoved(from, to);
+            world.touchEnded(from, to);
+        }
+        if ((i % 300) == 150)   { world.shake(); }
+        if ((i % 60) == 30)     { world.accelerate((CGFloat)((i % 7) - 3) * 0.1); }
+        if ((i % 200) == 100)   { world.pinch(SimPoint(384.0, 512.0), 1.1); }
+
+        // an uneven display clock, with the odd dropped frame
+        timestamp += ((i % 9) == 8) ? (2.0 / 60.0) : (1.0 / 60.0);
+        world.stepFrame(timestamp);
+    }
+
+    return worldState(world);
+}
+
+static std::vector<PieceState> replay(const SimJournal *journal) {
+
+    SimRandomSeed(SimJournalSeed(journal));
+
+    SimWorld world;
+    world.loadScene(simMermaidsScene(), SimJournalViewWidth(journal), SimJournalViewHeight(journal));
+
+    SimJournalEvent event;
+    size_t offset = 0;
+    while ((offset = SimJournalNext(journal, offset, &event)) != 0) {
+        world.replay(event);
+    }
+
+    return worldState(world);
+}
+
+static void testReplay() {
+
+    SimJournal *journal = SimJournalCreate("mermaids", SESSION_SEED, SIM_VIEW_WIDTH, SIM_VIEW_HEIGHT);
+    std::vector<PieceState> recorded = record(journal);
+
+    SimJournal *read = readBytes(written(journal));
+    SIM_CHECK(read != NULL);
+    if (read == NULL) { SimJournalDestroy(journal); return; }
+    SIM_CHECK(SimJournalFrames(read) == SESSION_FRAMES);
+
+    std::vector<PieceState> first = replay(read);
+    std::vector<PieceState> second = replay(read);
+
+    SIM_CHECK(recorded.size() > 0);
+    SIM_CHECK(sameState(first, recorded));
+    SIM_CHECK(sameState(second, first));
+
+    SimJournalDestroy(read);
+    SimJournalDestroy(journal);
+}
+
+int main() {
+
+    testRoundTrip();
+    testReplay();
+
+    return SIM_TEST_RESULT("test_journal");
+}
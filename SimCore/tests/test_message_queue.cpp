@@ -0,0 +1,109 @@
+//
+//  test_message_queue.cpp
+//  Papercut
+//
+//  SimMessageQueue: four producers post as fast as they can while the
+//    consumer drains, every message comes out exactly once and each
+//    producer's messages come out in the order it posted them.  Then a
+//    full ring drops and counts rather than overwriting, and the C
+//    interface round-trips a message.  Meant to be run under
+//    ThreadSanitizer too ("make -C SimCore tsan").
+//
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../SimMessageQueue.h"
+#include "SimTest.h"
+
+#define PRODUCERS   4
+#define POSTS       100000
+
+static void testProducers() {
+
+    SimMessageQueue queue(256);
+    std::atomic<int> started(0);
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.push_back(std::thread([&queue, &started, p] {
+            started++;
+            while (started.load() < PRODUCERS) {}
+
+            for (int i = 0; i < POSTS; i++) {
+                SimMessage message = SimMessage();
+                message.spawnID = p;
+                message.targetSpawnID = i;
+                while (!queue.push(message)) { std::this_thread::yield(); }
+            }
+        }));
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    long taken = 0;
+    SimMessage message;
+
+    while (taken < (long)PRODUCERS * POSTS) {
+        if (!queue.pop(message)) { continue; }
+
+        SIM_CHECK((message.spawnID >= 0) && (message.spawnID < PRODUCERS));
+        if ((message.spawnID < 0) || (message.spawnID >= PRODUCERS)) { break; }
+
+        SIM_CHECK(message.targetSpawnID == next[message.spawnID]);
+        next[message.spawnID] = message.targetSpawnID + 1;
+        taken++;
+    }
+
+    for (size_t p = 0; p < producers.size(); p++) { producers[p].join(); }
+
+    for (int p = 0; p < PRODUCERS; p++) { SIM_CHECK(next[p] == POSTS); }
+    SIM_CHECK(!queue.pop(message));
+    SIM_CHECK(queue.posted() == queue.taken());
+}
+
+static void testOverflow() {
+
+    SimMessageQueue queue(8);
+    SimMessage message = SimMessage();
+
+    for (int i = 0; i < 8; i++) {
+        message.targetSpawnID = i;
+        SIM_CHECK(queue.push(message));
+    }
+    message.targetSpawnID = 8;
+    SIM_CHECK(!queue.push(message));
+    SIM_CHECK(queue.overflow() == 1);
+
+    for (int i = 0; i < 8; i++) {
+        SIM_CHECK(queue.pop(message));
+        SIM_CHECK(message.targetSpawnID == i);
+    }
+    SIM_CHECK(!queue.pop(message));
+}
+
+static void testRing() {
+
+    SimMessageRing *ring = SimMessageRingCreate(4);
+    SimMessagePost post = { 101, mtSpawn, btFlee, 1, 44, 12.5f, -3.0f, 1 };
+    SimMessagePost out;
+
+    SIM_CHECK(SimMessageRingPush(ring, &post));
+    SIM_CHECK(SimMessageRingPosted(ring) == 1);
+    SIM_CHECK(SimMessageRingPop(ring, &out));
+    SIM_CHECK((out.spawnID == 101) && (out.mType == mtSpawn) && (out.bType == btFlee) && (out.turnOn));
+    SIM_CHECK((out.targetSpawnID == 44) && (out.x == 12.5f) && (out.y == -3.0f) && (out.wasSpawned));
+    SIM_CHECK(SimMessageRingTaken(ring) == 1);
+    SIM_CHECK(!SimMessageRingPop(ring, &out));
+
+    SimMessageRingDestroy(ring);
+}
+
+int main() {
+
+    testProducers();
+    testOverflow();
+    testRing();
+
+    return SIM_TEST_RESULT("test_message_queue");
+}
@@ -0,0 +1,116 @@
+//
+//  test_timer_wheel.cpp
+//  Papercut
+//
+//  SimTimerWheel: timers come off the wheel on exactly their due tick
+//    from every level, including past the top level's reach, and a timer
+//    on the wheel completes and (autoreversing) turns around on the same
+//    ticks as one updated by hand.
+//
+
+#include <vector>
+
+#include "../SimTimer.h"
+#include "../SimTimerWheel.h"
+#include "SimTest.h"
+
+#define STEP        0.25        // exact in binary, so the hand timer adds up the same as the wheel multiplies
+#define HAND_TICKS  4000
+
+static void testDueTicks() {
+
+    // either side of every level boundary, and past the top level
+    const uint32_t dues[] = { 1, 2, 63, 64, 65, 127, 128, 4095, 4096, 4097, 5000,
+                              262143, 262144, 262145, 300000, 16777215, 16777216, 16777300 };
+    const size_t numDues = sizeof(dues) / sizeof(dues[0]);
+    const uint32_t start = 37;      // off a slot boundary, so cascades come at odd offsets
+
+    SimTimerWheel wheel;
+    wheel.setStep(STEP);
+    wheel.reserve(numDues * 2);
+
+    for (uint32_t t = 0; t < start; t++) { wheel.advance(); }
+
+    std::vector<SimTimer> timers(numDues * 2);
+    std::vector<int> nodes(numDues * 2);
+    for (size_t i = 0; i < numDues; i++) {
+        nodes[i] = wheel.schedule(&timers[i], start + dues[i]);
+        // a twin for each, cancelled, which must never come due
+        nodes[numDues + i] = wheel.schedule(&timers[numDues + i], start + dues[i]);
+    }
+    for (size_t i = 0; i < numDues; i++) { wheel.cancel(nodes[numDues + i]); }
+
+    SIM_CHECK(wheel.pending() == numDues);
+
+    size_t next = 0;
+    uint32_t last = start + dues[numDues - 1];
+    while (wheel.now() < last) {
+
+        wheel.advance();
+        const std::vector<SimTimer*> &expired = wheel.expired();
+        if (expired.empty()) { continue; }
+
+        SIM_CHECK(next < numDues);
+        if (next >= numDues) { break; }
+
+        SIM_CHECK(wheel.now() == start + dues[next]);
+        SIM_CHECK(expired.size() == 1);
+        SIM_CHECK(expired[0] == &timers[next]);
+        next++;
+    }
+
+    SIM_CHECK(next == numDues);
+    SIM_CHECK(wheel.pending() == 0);
+}
+
+static void compareHand(CGFloat interval, BOOL reverses) {
+
+    SimTimerWheel wheel;
+    wheel.setStep(STEP);
+    wheel.reserve(4);
+
+    SimTimer hand(btPeek, interval, YES, reverses, interval, interval);
+    SimTimer wheeled(btPeek, interval, YES, reverses, interval, interval);
+    wheeled.attach(&wheel);
+
+    int completions = 0;
+    int turns = 0;
+    BOOL wasReversing = NO;
+
+    for (int t = 0; t < HAND_TICKS; t++) {
+
+        hand.timerUpdate(STEP);
+        wheel.advance();
+
+        SIM_CHECK(wheeled.timerComplete() == hand.timerComplete());
+        SIM_CHECK(wheeled.isReversing() == hand.isReversing());
+        if ((wheeled.timerComplete() != hand.timerComplete()) || (wheeled.isReversing() != hand.isReversing())) {
+            fprintf(stderr, "  interval %.2f reverses %d differs at tick %d\n", interval, (int)reverses, t);
+            return;
+        }
+
+        if (hand.timerComplete()) {
+            completions++;
+            // a discrete timer is reset by whoever handles it
+            if (!reverses) { hand.timerReset(); wheeled.timerReset(); }
+        }
+        if (hand.isReversing() != wasReversing) { turns++; }
+        wasReversing = hand.isReversing();
+    }
+
+    SIM_CHECK(completions > 2);
+    if (reverses) { SIM_CHECK(turns > 2); }
+}
+
+int main() {
+
+    testDueTicks();
+
+    const CGFloat intervals[] = { 0.1, 0.25, 1.0, 3.1, 17.6, 63.9 };
+    for (size_t i = 0; i < sizeof(intervals) / sizeof(intervals[0]); i++) {
+        compareHand(intervals[i], NO);
+        compareHand(intervals[i], YES);
+    }
+
+    return SIM_TEST_RESULT("test_timer_wheel");
+}
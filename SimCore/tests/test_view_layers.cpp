@@ -0,0 +1,191 @@
+//
+//  test_view_layers.cpp
+//  Papercut
+//
+//  SimZOrder sorts the same as a stable sort by zPosition, and the layer
+//    lists, walked back to front with bottom/above, stay in the order a
+//    plain list of every insert, remove and changeZ says they should, both
+//    through the C interface and through SimWorld.
+//
+
+#include <algorithm>
+#include <vector>
+
+#include "../SimViewLayers.h"
+#include "../SimPaper.h"
+#include "../SimRandom.h"
+#include "../SimWorld.h"
+#include "SimTest.h"
+
+#define SLOTS       200
+#define OPS         20000
+
+typedef struct {
+    uint32_t    slot;
+    int         zPos;
+} Placed;
+
+static std::vector<Placed> byZ(const std::vector<Placed> &placed) {
+    // placed is in the order each went on top of its layer
+    std::vector<Placed> sorted(placed);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Placed &a, const Placed &b) { return a.zPos < b.zPos; });
+    return sorted;
+}
+
+static void checkOrder(const SimLayerList *list, const std::vector<Placed> &placed, int *items) {
+
+    std::vector<Placed> expected = byZ(placed);
+
+    void *item = SimLayerListBottom(list);
+    for (size_t i = 0; i < expected.size(); i++) {
+        SIM_CHECK(item == &items[expected[i].slot]);
+        if (item != &items[expected[i].slot]) { return; }
+        item = SimLayerListAbove(list, expected[i].slot);
+    }
+    SIM_CHECK(item == NULL);
+}
+
+static void testZOrder() {
+
+    int ranges[] = { 1, 3, 300, 70000, 2000000000 };
+
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+        for (size_t count = 1; count < 600; count += 37) {
+
+            std::vector<int> zKeys(count);
+            for (size_t i = 0; i < count; i++) {
+                zKeys[i] = (int)SimRandomUniform((uint32_t)ranges[r]) - ranges[r] / 2;
+            }
+
+            std::vector<uint32_t> order(count), scratch(count), expected(count);
+            for (size_t i = 0; i < count; i++) { expected[i] = (uint32_t)i; }
+            std::stable_sort(expected.begin(), expected.end(),
+                             [&zKeys](uint32_t a, uint32_t b) { return zKeys[a] < zKeys[b]; });
+
+            SimZOrder(&zKeys[0], count, &order[0], &scratch[0]);
+            SIM_CHECK(order == expected);
+        }
+    }
+}
+
+static void testLayerList() {
+
+    static int items[SLOTS];
+    SimLayerList *list = SimLayerListCreate();
+    std::vector<Placed> placed;
+
+    for (int op = 0; op < OPS; op++) {
+
+        int pick = (int)SimRandomUniform(10);
+        uint32_t slot = (uint32_t)SimRandomUniform(SLOTS);
+        int zPos = (int)SimRandomUniform(21) - 10;
+
+        std::vector<Placed>::iterator at = placed.begin();
+        while ((at != placed.end()) && (at->slot != slot)) { at++; }
+
+        if (pick < 5) {
+            // a batch, with the odd slot already in or repeated
+            void *batchItems[8];
+            uint32_t batchSlots[8], inserted[8];
+            int batchZ[8];
+            size_t num = 1 + (size_t)SimRandomUniform(8);
+
+            for (size_t i = 0; i < num; i++) {
+                batchSlots[i] = (i == 0) ? slot : (uint32_t)SimRandomUniform(SLOTS);
+                batchItems[i] = &items[batchSlots[i]];
+                batchZ[i] = (i == 0) ? zPos : (int)SimRandomUniform(21) - 10;
+            }
+
+            size_t added = SimLayerListInsert(list, batchItems, batchSlots, batchZ, num, inserted);
+
+            // what should have gone in, back to front; of a slot repeated
+            //   in the batch, the first to reach its layer
+            std::vector<uint32_t> sorted, expected;
+            for (size_t i = 0; i < num; i++) { sorted.push_back((uint32_t)i); }
+            std::stable_sort(sorted.begin(), sorted.end(),
+                             [&batchZ](uint32_t a, uint32_t b) { return batchZ[a] < batchZ[b]; });
+
+            std::vector<uint32_t> taken;
+            for (size_t i = 0; i < placed.size(); i++) { taken.push_back(placed[i].slot); }
+            for (size_t i = 0; i < num; i++) {
+                if (std::find(taken.begin(), taken.end(), batchSlots[sorted[i]]) != taken.end()) { continue; }
+                taken.push_back(batchSlots[sorted[i]]);
+                expected.push_back(sorted[i]);
+            }
+
+            SIM_CHECK(added == expected.size());
+            for (size_t i = 0; (i < added) && (i < expected.size()); i++) {
+                SIM_CHECK(inserted[i] == expected[i]);
+                Placed p = { batchSlots[inserted[i]], batchZ[inserted[i]] };
+                placed.push_back(p);
+            }
+        }
+        else if (pick < 7) {
+            SimLayerListRemove(list, slot);
+            if (at != placed.end()) { placed.erase(at); }
+        }
+        else {
+            SimLayerListChangeZ(list, slot, zPos);
+            if (at != placed.end()) {
+                placed.erase(at);
+                Placed p = { slot, zPos };
+                placed.push_back(p);
+            }
+        }
+
+        if ((op % 97) == 0) { checkOrder(list, placed, items); }
+    }
+    checkOrder(list, placed, items);
+
+    SimLayerListClear(list);
+    SIM_CHECK(SimLayerListBottom(list) == NULL);
+    SimLayerListDestroy(list);
+}
+
+static void testWorld() {
+
+    SimWorld world;
+    world.loadScene(simMermaidsScene(), SIM_VIEW_WIDTH, SIM_VIEW_HEIGHT);
+    world.stepFrame(0.0);
+
+    SIM_CHECK(world.viewLayers.size() > 0);
+
+    // each piece above the last, by layer, then by the order it was added
+    std::vector<SimPaper*> drawn;
+    for (SimPaper *piece = world.viewLayers.bottom(); piece; piece = world.viewLayers.above(piece)) {
+        if (!drawn.empty()) {
+            SimPaper *last = drawn.back();
+            SIM_CHECK((last->zPos < piece->zPos) || ((last->zPos == piece->zPos) && (last->viewOrder < piece->viewOrder)));
+        }
+        drawn.push_back(piece);
+    }
+    SIM_CHECK(drawn.size() == world.viewLayers.size());
+    if (drawn.size() < 2) { return; }
+
+    // the bottom piece goes on top of the top layer, then back under everything
+    SimPaper *moved = drawn[0];
+    int topZ = drawn.back()->zPos;
+
+    world.changeZPosition(moved->handle, topZ);
+    SIM_CHECK(moved->zPos == topZ);
+    SIM_CHECK(world.viewLayers.above(drawn.back()) == moved);
+    SIM_CHECK(world.viewLayers.above(moved) == NULL);
+    SIM_CHECK(world.viewLayers.bottom() == drawn[1]);
+
+    world.changeZPosition(moved->handle, drawn[1]->zPos - 1);
+    SIM_CHECK(world.viewLayers.bottom() == moved);
+    SIM_CHECK(world.viewLayers.above(moved) == drawn[1]);
+    SIM_CHECK(world.viewLayers.above(drawn.back()) == NULL);
+    SIM_CHECK(world.viewLayers.size() == drawn.size());
+}
+
+int main() {
+
+    SimRandomSeed(25);
+
+    testZOrder();
+    testLayerList();
+    testWorld();
+
+    return SIM_TEST_RESULT("test_view_layers");
+}
@@ -0,0 +1,67 @@
+//
+//  test_work_pool.cpp
+//  Papercut
+//
+//  SimWorkPool: every chunk of a run() runs exactly once and has finished
+//    by the time run() returns, across pools that are stopped and started
+//    again with different thread counts.  Meant to be run under
+//    ThreadSanitizer too ("make -C SimCore tsan").
+//
+
+#include <atomic>
+#include <thread>
+
+#include "../SimWorkPool.h"
+#include "SimTest.h"
+
+#define CHUNKS      64
+#define RESTARTS    500
+#define RUNS        20
+
+typedef struct {
+    std::atomic<int>    runs[CHUNKS];
+    std::atomic<int>    inFlight;
+} ChunkCounts;
+
+static void countChunk(void *context, size_t chunk, int worker) {
+
+    ChunkCounts *counts = (ChunkCounts*)context;
+    counts->inFlight++;
+
+    // long enough that a run() returning early would catch chunks still going
+    for (volatile int spin = 0; spin < 200; spin++) {}
+    if ((chunk % 7) == 0) { std::this_thread::yield(); }
+
+    counts->runs[chunk]++;
+    counts->inFlight--;
+}
+
+int main() {
+
+    static ChunkCounts counts;
+    SimWorkPool pool;
+
+    for (int restart = 0; restart < RESTARTS; restart++) {
+
+        pool.start(2 + (restart % 4));
+
+        for (int run = 0; run < RUNS; run++) {
+
+            for (int c = 0; c < CHUNKS; c++) { counts.runs[c].store(0); }
+            counts.inFlight.store(0);
+
+            size_t numChunks = CHUNKS - (run % 5);
+            pool.run(numChunks, countChunk, &counts);
+
+            SIM_CHECK(counts.inFlight.load() == 0);
+            for (size_t c = 0; c < CHUNKS; c++) {
+                SIM_CHECK(counts.runs[c].load() == ((c < numChunks) ? 1 : 0));
+            }
+        }
+
+        // every other cycle stops explicitly, the rest restart straight from start()
+        if (restart % 2) { pool.stop(); }
+    }
+
+    return SIM_TEST_RESULT("test_work_pool");
+}
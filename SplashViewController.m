@@ -13,6 +13,8 @@
 #import "Messenger.h"
 #import "UIViewController+MJPopupViewController.h"
 #import "StoryViewController.h"
+#import "SceneFile.h"
+#import "StartupTrace.h"
 
 @interface SplashViewController ()
 
@@ -140,6 +142,10 @@
         // prevent the user from double-tapping the button
         startClick = YES;
         
+        // time from here to the first interactive frame
+        [[StartupTrace theStartupTrace] start];
+        [[StartupTrace theStartupTrace] beginStage:@"splash"];
+        
         [_world playSplashSound:2];
         
         [UIView animateWithDuration:0.1 delay:0 options:UIViewAnimationOptionCurveEaseInOut animations:^{
@@ -176,15 +182,25 @@
                     
                 } completion:^(BOOL finished) {
                     
-                    // Load the Papercut
-                    viewPapercutController = [[PapercutPadViewController alloc]
-                                              initPapercut:paperMermaidsTable
-                                              anim:paperMermaidsAnimations
-                                              touch:paperMermaidsTouchspots
-                                              group:paperMermaidsGroups
-                                              random:paperMermaidsRandom
-                                              sound:paperMermaidsSounds
-                                              timer:paperMemmaidsTimers];
+                    [[StartupTrace theStartupTrace] endStage:@"splash"];
+                    
+                    // Load the Papercut, from its scene file if the bundle has one
+                    [[StartupTrace theStartupTrace] beginStage:@"scene file"];
+                    SceneFile *story = [SceneFile sceneNamed:@"mermaids"];
+                    [[StartupTrace theStartupTrace] endStage:@"scene file"];
+                    if (story) {
+                        viewPapercutController = [[PapercutPadViewController alloc] initPapercutScene:story];
+                    }
+                    else {
+                        viewPapercutController = [[PapercutPadViewController alloc]
+                                                  initPapercut:paperMermaidsTable
+                                                  anim:paperMermaidsAnimations
+                                                  touch:paperMermaidsTouchspots
+                                                  group:paperMermaidsGroups
+                                                  random:paperMermaidsRandom
+                                                  sound:paperMermaidsSounds
+                                                  timer:paperMemmaidsTimers];
+                    }
                     
                     // Fade in the Papercut to make the transition smoother
                     viewPapercutController.view.alpha = 0;
@@ -0,0 +1,66 @@
+//
+//  SpriteCache.h
+//  Papercut
+//
+//  Shares frame animation images between every Paper using the same
+//    imagePath.  Each frame set is decoded once into a single packed
+//    strip, and the frames handed to UIImageView are views into that
+//    strip, so spawning another fish or note fish costs no decoding
+//    and no extra image memory.  Frames keep their own sizes in the
+//    strip, so a frame set of mixed sizes animates as it always did.
+//
+//  Sequences are reference counted by the Papers using them.  Ones
+//    no longer in use stay cached for the next spawn until the cache
+//    goes over its memory budget, then the least recently used are
+//    dropped first.
+//
+//  Still images are decoded once by name as well, so a loading scene
+//    can decode them on a worker instead of the first time they draw.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+#import "Variables.h"
+
+@interface SpriteSequence : NSObject {
+
+}
+
+@property (nonatomic, readonly, retain) NSString *key;
+@property (nonatomic, readonly, retain) NSArray *frameImages;     // ready for setAnimationImages:
+@property (nonatomic, readonly, retain) NSArray *frameRects;      // NSValue CGRect of each strip frame, in pixels from the strip's top left
+@property (nonatomic, readonly) NSUInteger bytes;                 // decoded size of the strip
+@property (assign) int useCount;
+@property (assign) NSUInteger lastUse;
+
+@end
+
+@interface SpriteCache : NSObject {
+
+}
+
+@property (nonatomic, retain) NSMutableDictionary *sequences;
+@property (nonatomic, retain) NSMutableDictionary *stills;    // decoded single images by imagePath
+@property (assign) NSUInteger budget;             // bytes kept for sequences not in use
+@property (assign) NSUInteger totalBytes;
+@property (assign) NSUInteger useClock;
+
++ (id) theSpriteCache;
+
+- (id)init;
+
+// frames 1..numFrames of imagePath, plus the way back down for autoreverse
+- (SpriteSequence*)acquireSequence:(NSString*)imagePath frames:(int)numFrames autoReverse:(BOOL)reverses;
+- (void)releaseSequence:(SpriteSequence*)sequence;
+
+// decodes a sequence into the cache without using it, safe from any
+//   thread, so a scene can decode its frames on workers while it loads
+- (void)preloadSequence:(NSString*)imagePath frames:(int)numFrames autoReverse:(BOOL)reverses;
+
+// imagePath.png, decoded, nil if the bundle doesn't have it; safe from any thread
+- (UIImage*)stillImage:(NSString*)imagePath;
+
+// drop every sequence nobody is using, and the stills
+- (void)purge;
+
+@end
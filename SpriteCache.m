@@ -0,0 +1,331 @@
+//
+//  SpriteCache.m
+//  Papercut
+//
+//  Shares frame animation images between every Paper using the same
+//    imagePath, decoded once into a packed strip per frame set.
+//
+
+#import "SpriteCache.h"
+
+static SpriteCache *mySharedSpriteCache = nil;
+
+// ___ SPRITE SEQUENCE
+
+@interface SpriteSequence ()
+
+@property (nonatomic, readwrite, retain) NSString *key;
+@property (nonatomic, readwrite, retain) NSArray *frameImages;
+@property (nonatomic, readwrite, retain) NSArray *frameRects;
+@property (nonatomic, readwrite) NSUInteger bytes;
+
+@end
+
+@implementation SpriteSequence
+
+@synthesize key, frameImages, frameRects, bytes, useCount, lastUse;
+
+@end
+
+// ___ SPRITE CACHE
+
+@interface SpriteCache ()
+
+- (void)trimToBudget;
+- (SpriteSequence*)cachedSequence:(NSString*)imagePath frames:(int)numFrames autoReverse:(BOOL)reverses acquire:(BOOL)acquire;
+- (void)useSequence:(SpriteSequence*)sequence;
+- (UIImage*)decodeStill:(NSString*)imagePath;
+- (SpriteSequence*)decodeSequence:(NSString*)imagePath frames:(int)numFrames autoReverse:(BOOL)reverses;
+
+@end
+
+@implementation SpriteCache
+
+@synthesize sequences, stills, budget, totalBytes, useClock;
+
++ (id) theSpriteCache {
+    @synchronized([SpriteCache class]) {
+        if (!mySharedSpriteCache) { mySharedSpriteCache = [[self alloc] init]; }
+    }
+    return mySharedSpriteCache;
+}
+
++ (id) alloc
+{
+    @synchronized([SpriteCache class])
+    {
+        NSAssert(mySharedSpriteCache == nil, @"Attempted to allocate a second instance of the SpriteCache.");
+        mySharedSpriteCache = [super alloc];
+        return mySharedSpriteCache;
+    }
+
+    return nil;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    return self;
+}
+
+- (id)init {
+    self = [super init];
+    if(nil != self)
+    {
+        sequences   = [[NSMutableDictionary alloc] init];
+        stills      = [[NSMutableDictionary alloc] init];
+        budget      = SPRITE_CACHE_BUDGET;
+        totalBytes  = 0;
+        useClock    = 0;
+
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(purge)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+// finding a sequence and taking a use of it happen under the one lock,
+//   otherwise trimToBudget on another thread could drop it in between
+- (SpriteSequence*)cachedSequence:(NSString*)imagePath frames:(int)numFrames autoReverse:(BOOL)reverses acquire:(BOOL)acquire {
+
+    NSString *key = [NSString stringWithFormat:@"%@.%d.%d", imagePath, numFrames, reverses];
+
+    @synchronized(self) {
+        SpriteSequence *sequence = [sequences objectForKey:key];
+        if (sequence) {
+            if (acquire) { [self useSequence:sequence]; }
+            return sequence;
+        }
+    }
+
+    // decode outside the lock so a loading worker doesn't hold up the main thread
+    SpriteSequence *decoded = [self decodeSequence:imagePath frames:numFrames autoReverse:reverses];
+    decoded.key = key;
+
+    @synchronized(self) {
+        // another thread may have got there first, keep theirs
+        SpriteSequence *sequence = [sequences objectForKey:key];
+        if (!sequence) {
+            sequence = decoded;
+            [sequences setObject:decoded forKey:key];
+            totalBytes += decoded.bytes;
+            decoded.lastUse = ++useClock;
+        }
+
+        if (acquire) { [self useSequence:sequence]; }
+        return sequence;
+    }
+}
+
+// called with the cache locked
+- (void)useSequence:(SpriteSequence*)sequence {
+
+    sequence.useCount++;
+    sequence.lastUse = ++useClock;
+
+    [self trimToBudget];
+}
+
+- (SpriteSequence*)acquireSequence:(NSString*)imagePath frames:(int)numFrames autoReverse:(BOOL)reverses {
+
+    return [self cachedSequence:imagePath frames:numFrames autoReverse:reverses acquire:YES];
+}
+
+- (void)preloadSequence:(NSString*)imagePath frames:(int)numFrames autoReverse:(BOOL)reverses {
+
+    [self cachedSequence:imagePath frames:numFrames autoReverse:reverses acquire:NO];
+}
+
+- (void)releaseSequence:(SpriteSequence*)sequence {
+
+    if (!sequence) { return; }
+
+    @synchronized(self) {
+        // stays cached for the next spawn unless we're over budget
+        if (sequence.useCount > 0) { sequence.useCount--; }
+        sequence.lastUse = ++useClock;
+
+        [self trimToBudget];
+    }
+}
+
+- (void)purge {
+
+    @synchronized(self) {
+        for (NSString *key in [sequences allKeys]) {
+            SpriteSequence *sequence = [sequences objectForKey:key];
+            if (sequence.useCount == 0) {
+                totalBytes -= sequence.bytes;
+                [sequences removeObjectForKey:key];
+            }
+        }
+
+        // the views showing a still keep their own reference
+        [stills removeAllObjects];
+    }
+}
+
+- (UIImage*)stillImage:(NSString*)imagePath {
+
+    @synchronized(self) {
+        UIImage *still = [stills objectForKey:imagePath];
+        if (still) { return still; }
+    }
+
+    UIImage *decoded = [self decodeStill:imagePath];
+    if (!decoded) { return nil; }
+
+    @synchronized(self) {
+        UIImage *still = [stills objectForKey:imagePath];
+        if (still) { return still; }
+
+        [stills setObject:decoded forKey:imagePath];
+        return decoded;
+    }
+}
+
+// called with the cache locked
+- (void)trimToBudget {
+
+    // drop the least recently used sequences nobody has, the ones
+    //   still on screen have to stay whatever the budget says
+    while (totalBytes > budget) {
+
+        SpriteSequence *oldest = nil;
+        for (SpriteSequence *sequence in [sequences objectEnumerator]) {
+            if ((sequence.useCount == 0) && ((!oldest) || (sequence.lastUse < oldest.lastUse))) {
+                oldest = sequence;
+            }
+        }
+
+        if (!oldest) { break; }
+
+        totalBytes -= oldest.bytes;
+        [sequences removeObjectForKey:oldest.key];
+    }
+}
+
+- (SpriteSequence*)decodeSequence:(NSString*)imagePath frames:(int)numFrames autoReverse:(BOOL)reverses {
+
+    // load straight from the bundle, imageNamed would keep its own
+    //   decoded copy of every frame on top of the strip
+    NSMutableArray *sourceFrames = [[NSMutableArray alloc] initWithCapacity:numFrames];
+    UIImage *tFrame, *tempFrame = nil;
+
+    for(int i = 1; i < numFrames + 1; i++) {
+        NSString *framePath = [[NSBundle mainBundle] pathForResource:[NSString stringWithFormat:@"%@%d", imagePath, i] ofType:@"png"];
+        tFrame = (framePath) ? [UIImage imageWithContentsOfFile:framePath] : nil;
+
+        // if the image frame # doesn't exist, use the most recent one
+        if (tFrame) { tempFrame = tFrame; }
+        if (!tempFrame) { continue; }
+
+        [sourceFrames addObject:tempFrame];
+    }
+
+    SpriteSequence *sequence = [[SpriteSequence alloc] init];
+    int stripFrames = (int)[sourceFrames count];
+
+    if (stripFrames == 0) {
+        sequence.frameImages = [NSArray array];
+        sequence.frameRects = [NSArray array];
+        sequence.bytes = 0;
+        return sequence;
+    }
+
+    // frames can differ in size, so each gets a cell of its own size and
+    //   comes back out at that size, exactly the image the view would have
+    //   been given frame by frame; a repeated frame shares its cell
+    NSMutableArray *rects = [[NSMutableArray alloc] initWithCapacity:stripFrames];
+    size_t stripWidth = 0;
+    size_t pixelHeight = 0;
+
+    for (int i = 0; i < stripFrames; i++) {
+        UIImage *frameImage = [sourceFrames objectAtIndex:i];
+        if ((i > 0) && (frameImage == [sourceFrames objectAtIndex:i - 1])) {
+            [rects addObject:[rects objectAtIndex:i - 1]];
+            continue;
+        }
+
+        size_t frameWidth  = (size_t)ceilf(frameImage.size.width * frameImage.scale);
+        size_t frameHeight = (size_t)ceilf(frameImage.size.height * frameImage.scale);
+
+        // x across the strip, y down from its top edge as CGImageCreateWithImageInRect has it
+        [rects addObject:[NSValue valueWithCGRect:CGRectMake(stripWidth, 0, frameWidth, frameHeight)]];
+        stripWidth += frameWidth;
+        pixelHeight = MAX(pixelHeight, frameHeight);
+    }
+
+    // decode every frame side by side into one strip
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef stripContext = CGBitmapContextCreate(NULL, stripWidth, pixelHeight, 8, 0, colorSpace,
+                                                      kCGImageAlphaPremultipliedLast);
+    CGColorSpaceRelease(colorSpace);
+
+    for (int i = 0; i < stripFrames; i++) {
+        if ((i > 0) && ([rects objectAtIndex:i] == [rects objectAtIndex:i - 1])) { continue; }
+
+        // the context's y runs up from the bottom, so a short frame's top
+        //   edge sits at the strip's top edge
+        CGRect frameRect = [[rects objectAtIndex:i] CGRectValue];
+        frameRect.origin.y = pixelHeight - frameRect.size.height;
+        CGContextDrawImage(stripContext, frameRect, ((UIImage*)[sourceFrames objectAtIndex:i]).CGImage);
+    }
+
+    CGImageRef strip = CGBitmapContextCreateImage(stripContext);
+    sequence.bytes = CGBitmapContextGetBytesPerRow(stripContext) * pixelHeight;
+    CGContextRelease(stripContext);
+
+    // each frame is a window onto its own cell of the strip, no pixels of its own
+    NSMutableArray *stripImages = [[NSMutableArray alloc] initWithCapacity:stripFrames];
+    for (int i = 0; i < stripFrames; i++) {
+        UIImage *frameImage = [sourceFrames objectAtIndex:i];
+        CGImageRef frameRef = CGImageCreateWithImageInRect(strip, [[rects objectAtIndex:i] CGRectValue]);
+        [stripImages addObject:[UIImage imageWithCGImage:frameRef scale:frameImage.scale orientation:UIImageOrientationUp]];
+        CGImageRelease(frameRef);
+    }
+    CGImageRelease(strip);
+
+    sequence.frameRects = [NSArray arrayWithArray:rects];
+
+    // loop back down for autoreverse, dropping the first and last frames
+    NSMutableArray *frameArray = [[NSMutableArray alloc] initWithArray:stripImages];
+    if (reverses) {
+        for(int i = stripFrames - 2; i > 0; i--) {
+            [frameArray addObject:[stripImages objectAtIndex:i]];
+        }
+    }
+
+    sequence.frameImages = [NSArray arrayWithArray:frameArray];
+
+    return sequence;
+}
+
+- (UIImage*)decodeStill:(NSString*)imagePath {
+
+    NSString *stillPath = [[NSBundle mainBundle] pathForResource:imagePath ofType:@"png"];
+    UIImage *source = (stillPath) ? [UIImage imageWithContentsOfFile:stillPath] : nil;
+    if (!source) { return nil; }
+
+    // draw it once here, otherwise it's decoded on the main thread the first time it shows
+    size_t pixelWidth  = (size_t)ceilf(source.size.width * source.scale);
+    size_t pixelHeight = (size_t)ceilf(source.size.height * source.scale);
+
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef stillContext = CGBitmapContextCreate(NULL, pixelWidth, pixelHeight, 8, 0, colorSpace,
+                                                      kCGImageAlphaPremultipliedLast);
+    CGColorSpaceRelease(colorSpace);
+    if (!stillContext) { return source; }
+
+    CGContextDrawImage(stillContext, CGRectMake(0, 0, pixelWidth, pixelHeight), source.CGImage);
+    CGImageRef stillRef = CGBitmapContextCreateImage(stillContext);
+    CGContextRelease(stillContext);
+
+    UIImage *still = [UIImage imageWithCGImage:stillRef scale:source.scale orientation:UIImageOrientationUp];
+    CGImageRelease(stillRef);
+
+    return still;
+}
+
+@end
@@ -0,0 +1,51 @@
+//
+//  StartupTrace.h
+//  Papercut
+//
+//  Times how long a story takes to come up, from the tap on the splash
+//    screen to the first frame the scene is interactive.  Each step of
+//    the loader is a named stage with a start and end, on the main
+//    thread or a worker, and the milestones in between are marks.
+//    finish logs the whole trace (with STARTUP_TRACE_ON) and keeps it
+//    for the next look.
+//
+//  Every method is safe from any thread.
+//
+
+#import <Foundation/Foundation.h>
+#import <QuartzCore/QuartzCore.h>
+#import "Variables.h"
+
+@interface StartupStage : NSObject {
+
+}
+
+@property (nonatomic, retain) NSString *name;
+@property (assign) CFTimeInterval start;        // seconds since the trace started
+@property (assign) CFTimeInterval end;          // 0 until the stage ends
+@property (assign) BOOL onMain;                 // ran on the main thread
+
+@end
+
+@interface StartupTrace : NSObject {
+
+}
+
+@property (nonatomic, retain) NSMutableArray *stages;    // StartupStages and marks, in the order they began
+@property (assign) CFTimeInterval startTime;
+@property (assign) BOOL running;
+
++ (id) theStartupTrace;
+
+- (id)init;
+
+- (void)start;                                  // time zero, drops the last trace
+- (void)beginStage:(NSString*)name;             // starts the trace too if it isn't running
+- (void)endStage:(NSString*)name;
+- (void)mark:(NSString*)name;                   // a stage that starts and ends at once
+- (void)finish;                                 // stops the trace and logs it
+
+- (CFTimeInterval)elapsed;                      // seconds since start
+- (NSString*)report;                            // one line per stage
+
+@end
@@ -0,0 +1,159 @@
+//
+//  StartupTrace.m
+//  Papercut
+//
+//  Per-stage timings of a story's startup, from the splash tap to the
+//    first interactive frame.
+//
+
+#import "StartupTrace.h"
+
+static StartupTrace *mySharedStartupTrace = nil;
+
+// ___ STARTUP STAGE
+
+@implementation StartupStage
+
+@synthesize name, start, end, onMain;
+
+@end
+
+// ___ STARTUP TRACE
+
+@interface StartupTrace ()
+
+- (StartupStage*)openStage:(NSString*)stageName;
+
+@end
+
+@implementation StartupTrace
+
+@synthesize stages, startTime, running;
+
++ (id) theStartupTrace {
+    @synchronized([StartupTrace class]) {
+        if (!mySharedStartupTrace) { mySharedStartupTrace = [[self alloc] init]; }
+    }
+    return mySharedStartupTrace;
+}
+
++ (id) alloc
+{
+    @synchronized([StartupTrace class])
+    {
+        NSAssert(mySharedStartupTrace == nil, @"Attempted to allocate a second instance of the StartupTrace.");
+        mySharedStartupTrace = [super alloc];
+        return mySharedStartupTrace;
+    }
+
+    return nil;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    return self;
+}
+
+- (id)init {
+    self = [super init];
+    if(nil != self)
+    {
+        stages      = [[NSMutableArray alloc] initWithCapacity:64];
+        startTime   = 0.0;
+        running     = NO;
+    }
+    return self;
+}
+
+- (void)start {
+    @synchronized(self) {
+        [stages removeAllObjects];
+        startTime = CACurrentMediaTime();
+        running = YES;
+    }
+}
+
+- (CFTimeInterval)elapsed {
+    @synchronized(self) {
+        return CACurrentMediaTime() - startTime;
+    }
+}
+
+// called with the trace locked
+- (StartupStage*)openStage:(NSString*)stageName {
+
+    // a scene reset loads without a splash tap, so it starts its own trace
+    if (!running) {
+        [stages removeAllObjects];
+        startTime = CACurrentMediaTime();
+        running = YES;
+    }
+
+    StartupStage *stage = [[StartupStage alloc] init];
+    stage.name = stageName;
+    stage.start = CACurrentMediaTime() - startTime;
+    stage.end = 0.0;
+    stage.onMain = [NSThread isMainThread];
+    [stages addObject:stage];
+
+    return stage;
+}
+
+- (void)beginStage:(NSString*)stageName {
+    @synchronized(self) {
+        [self openStage:stageName];
+    }
+}
+
+- (void)endStage:(NSString*)stageName {
+    @synchronized(self) {
+        if (!running) { return; }
+
+        // the latest open stage by that name
+        for (StartupStage *stage in [stages reverseObjectEnumerator]) {
+            if ((stage.end == 0.0) && ([stage.name isEqualToString:stageName])) {
+                stage.end = CACurrentMediaTime() - startTime;
+                return;
+            }
+        }
+    }
+}
+
+- (void)mark:(NSString*)stageName {
+    @synchronized(self) {
+        StartupStage *stage = [self openStage:stageName];
+        stage.end = stage.start;
+    }
+}
+
+- (void)finish {
+
+    NSString *summary;
+
+    @synchronized(self) {
+        if (!running) { return; }
+        running = NO;
+        summary = [self report];
+    }
+
+#ifdef STARTUP_TRACE_ON
+    NSLog(@"Startup trace\n%@", summary);
+#endif
+}
+
+- (NSString*)report {
+
+    @synchronized(self) {
+        NSMutableString *lines = [[NSMutableString alloc] init];
+
+        for (StartupStage *stage in stages) {
+            CFTimeInterval duration = (stage.end > 0.0) ? (stage.end - stage.start) : 0.0;
+            [lines appendFormat:@"%9.1f ms  %8.1f ms  %@  %@\n",
+                                stage.start * 1000.0, duration * 1000.0, (stage.onMain) ? @"main  " : @"worker", stage.name];
+        }
+
+        return lines;
+    }
+}
+
+@end
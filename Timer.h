@@ -64,7 +64,7 @@
 withIntervalMax:(CGFloat)tIntervalMax
 withIntervalMin:(CGFloat)tIntervalMin;
 
-- (void)randomizeInterval;
+- (void)randomizeInterval:(SimRandomStream *)stream;     // the owner's stream
 - (BOOL)timerComplete;
 - (void)timerReset;
 - (void)timerUpdate:(CGFloat)interval;
@@ -82,8 +82,8 @@
     
 }
 
-- (void)randomizeInterval {
-    timeInterval = RAND_NUM(timeIntervalMax, timeIntervalMin);
+- (void)randomizeInterval:(SimRandomStream *)stream {
+    timeInterval = SimRandomNextRange(stream, timeIntervalMax, timeIntervalMin);
     return;
 }
 
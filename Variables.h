@@ -13,6 +13,9 @@
 #define MENUS_ON        // toggle menu links
 #define COLLISION   0   // master collision
 #define ACCEL_ON
+//#define STARTUP_TRACE_ON  // log how long each stage of loading a story takes
+//#define FRAME_PROFILE_ON  // time each phase of the main loop, written to Documents when a story unloads
+//#define INPUT_JOURNAL_ON  // record every touch, shake and frame for simbench -replay, written to Documents when a story unloads
 
 //#define TEST_FLIGHT_ON
 //#define NSLog TFLog   // uncomment to turn on TestFlight logging
@@ -22,8 +25,10 @@
 #define DEGREES_TO_RADIANS(angle) (angle / 180.0 * M_PI)
 #define RADIANS(degrees) ((degrees * M_PI) / 180.0)
 
-#define RAND_NUM(smallNumber, bigNumber) ((((float) (arc4random() % ((unsigned)RAND_MAX + 1)) / RAND_MAX) * (bigNumber - smallNumber)) + smallNumber)
-#define RAND_NUM_INT(smallNumber, bigNumber) ((((int) (arc4random() % ((unsigned)RAND_MAX + 1)) / RAND_MAX) * (bigNumber - smallNumber)) + smallNumber)
+// random numbers come from SimRandom's seeded streams, see SimCore/SimRandom.h
+#include "SimCore/SimRandom.h"
+#define RAND_NUM(smallNumber, bigNumber) SimRandomRange((smallNumber), (bigNumber))
+#define RAND_NUM_INT(smallNumber, bigNumber) ((int)SimRandomRange((smallNumber), (bigNumber)))
 
 // WORLD
 #define FRAME_INTERVAL  1
@@ -34,6 +39,9 @@
 #define MAX_OBJECTS     60          // max objects allowed to be active at once - things like bubbles, notefish, etc
 #define MIN_CHIME_DIST  300         // swipe must be this length or greater in pixels for chime/shudder to fire
 #define RESTITUTION     1.0         // for elastic collisions
+#define MAX_TICKS       4           // catch-up ticks allowed in one display frame, the world steps in fixed ticks of fps
+#define MAX_FRAME_TIME  0.25        // a longer gap is an inactive stretch, not dropped frames
+#define RENDER_SNAP     60.0        // moved further than this in a tick (toroid respawn, peek reset), drawn where it is
 
 // OBJECTS / BEHAVIOR
 #define MIN_FORCE         0.5       // min force/velocity allowed
@@ -42,6 +50,10 @@
 #define TILT_THRESHOLD    0.3       // drift applied once accelerometer passes this value
 #define TILT_FORCE_CAP    2.5       // max force/velocity allowed when tilting
 #define FRAMES_ON                   // set to FRAMES_OFF to disable frame animation
+#define SPRITE_CACHE_BUDGET (24 * 1024 * 1024)  // bytes of decoded frame strips kept around once no object uses them
+#define SCENE_LOAD_WORKERS  2       // background threads decoding a story's images and paths while it loads
+#define PAPER_POOL_PREWARM  4       // pieces built ahead for each objID that can spawn, when a story loads
+#define PAPER_POOL_CAP      MAX_OBJECTS // most retired pieces of one objID kept for its next spawns
 
 
 // ________________ BEHAVIOR
@@ -331,9 +343,18 @@ typedef struct {
 // ** NOTE - FOR ALL PROPERTY TABLES, YOU MUST UPDATE THE bobAmp PROPERTY FOR RECORD INDEX = 0
 //    TO REFLECT THE CORRECT NUMBER OF OBJECTS, OR YOU WILL BE MISSING OBJECTS.  THIS IS DONE
 //    BECAUSE WE CAN'T DETERMINE THE SIZE OF AN ARRAY AFTER PASSING IT TO A FUNCTION (initScene).
+//    Building SimCore checks these counts and every ID the tables refer to (SimCore/SimScene.h),
+//    so a table that doesn't add up fails "make -C SimCore" instead of corrupting memory.
+
+// C++ (SimCore) sees the tables as constexpr so it can check them at compile time
+#if defined(__cplusplus) && !defined(__OBJC__)
+#define SCENE_TABLE constexpr
+#else
+#define SCENE_TABLE
+#endif
 
 // MERMAIDS Properties
-static PaperProps __unused paperMermaidsTable[] = {
+static SCENE_TABLE PaperProps __unused paperMermaidsTable[] = {
     
 //  FIRST ROW = BORDER & HIGH-LEVEL PROPERTIES ROW
     {0, "Border",   NO,  NO,
@@ -648,7 +669,7 @@ static PaperProps __unused paperMermaidsTable[] = {
     
 };
 
-static PaperPropsAnim __unused paperMermaidsAnimations[] = {
+static SCENE_TABLE PaperPropsAnim __unused paperMermaidsAnimations[] = {
     
     // FIRST ROW IS A DUMMY DEFAULT ROW
     // ID  AncX AncY Durtn  Rpt   #Ang   A01     A02     A03     A04     A05     A06     A07     A08     A09
@@ -704,7 +725,7 @@ static PaperPropsAnim __unused paperMermaidsAnimations[] = {
     
 };
 
-static PaperPropsTouchspot __unused paperMermaidsTouchspots[] = {
+static SCENE_TABLE PaperPropsTouchspot __unused paperMermaidsTouchspots[] = {
     
     // FIRST ROW IS A DUMMY DEFAULT ROW
     // ID    X Off   Y Off  Width Height Obj Rndm
@@ -718,7 +739,7 @@ static PaperPropsTouchspot __unused paperMermaidsTouchspots[] = {
     
 };
 
-static PaperRandom __unused paperMermaidsRandom[] = {
+static SCENE_TABLE PaperRandom __unused paperMermaidsRandom[] = {
     
     // FIRST ROW IS A DUMMY DEFAULT ROW
     // R01 R02 R03 R04 R05
@@ -729,7 +750,7 @@ static PaperRandom __unused paperMermaidsRandom[] = {
     
 };
 
-static PaperGroups __unused paperMermaidsGroups[] = {
+static SCENE_TABLE PaperGroups __unused paperMermaidsGroups[] = {
     
     // FIRST ROW IS A DUMMY DEFAULT ROW
     // ID Mstr  #  S01 S02 S03 S04 S05 S06 S07 S08 S09 S10
@@ -738,7 +759,7 @@ static PaperGroups __unused paperMermaidsGroups[] = {
     {   2, 40,  2, 41, 42,  0,  0,  0,  0,  0,  0,  0,  0 }   // school of small fish
 };
 
-static PaperPropsSounds __unused paperMermaidsSounds[] = {
+static SCENE_TABLE PaperPropsSounds __unused paperMermaidsSounds[] = {
 
     // FIRST ROW IS A DUMMY DEFAULT ROW
     {  22, "default",  "wav" }, // first value is # of sounds
@@ -766,7 +787,7 @@ static PaperPropsSounds __unused paperMermaidsSounds[] = {
     {  23, "FX_ChimeR2", "wav" }
 };
 
-static PaperWorldTimers __unused paperMemmaidsTimers[] = {
+static SCENE_TABLE PaperWorldTimers __unused paperMemmaidsTimers[] = {
   
     // FIRST ROW IS A DUMMY DEFAULT ROW
     // msgType  timerType  objID time  tMax  tMin
@@ -777,6 +798,10 @@ static PaperWorldTimers __unused paperMemmaidsTimers[] = {
         
 };
 
-@interface Variables : NSObject 
+// the headless simulation core (SimCore) includes this file from plain C++,
+//   so keep the Objective-C class out of its way
+#ifdef __OBJC__
+@interface Variables : NSObject
 
 @end
+#endif